@@ -57,6 +57,11 @@ static int native_hwtimer_isset[HWTIMER_MAXTIMERS];
 static int next_timer = -1;
 static void (*int_handler)(int);
 
+/* the clock of the simulated medium, see nativesim.h */
+int _native_virtual_time;
+static uint64_t native_virtual_now;
+static uint64_t native_virtual_deadline[HWTIMER_MAXTIMERS];
+
 
 /**
  * Subtract the `struct timeval' values x and y, storing the result in
@@ -134,6 +139,11 @@ void schedule_timer(void)
     }
     if (next_timer == -1) {
         DEBUG("schedule_timer(): no valid timer found - nothing to schedule\n");
+
+        if (_native_virtual_time) {
+            return;
+        }
+
         struct itimerval null_timer;
         null_timer.it_interval.tv_sec = 0;
         null_timer.it_interval.tv_usec = 0;
@@ -145,6 +155,17 @@ void schedule_timer(void)
         return;
     }
 
+    if (_native_virtual_time) {
+        /* the medium wakes the node up when the earliest timer expires */
+        for (int i = 0; i < HWTIMER_MAXTIMERS; i++) {
+            if ((native_hwtimer_isset[i] == 1) &&
+                (native_virtual_deadline[i] < native_virtual_deadline[next_timer])) {
+                next_timer = i;
+            }
+        }
+        return;
+    }
+
     /* find the next pending timer (next_timer now points to *a* valid pending timer) */
     for (int i = 0; i < HWTIMER_MAXTIMERS; i++) {
         if (
@@ -195,6 +216,17 @@ void hwtimer_isr_timer(void)
         return;
     }
 
+    if (_native_virtual_time) {
+        /* timers may expire at the same time */
+        while ((next_timer != -1) &&
+               (native_virtual_deadline[next_timer] <= native_virtual_now)) {
+            native_hwtimer_isset[next_timer] = 0;
+            int_handler(next_timer);
+            schedule_timer();
+        }
+        return;
+    }
+
     if (native_hwtimer_isset[next_timer] == 1) {
         native_hwtimer_isset[next_timer] = 0;
         DEBUG("hwtimer_isr_timer(): calling hwtimer.int_handler(%i)\n", next_timer);
@@ -256,6 +288,16 @@ void hwtimer_arch_set_absolute(unsigned long value, short timer)
 
     ticks2tv(value, &(native_hwtimer[timer].it_value));
 
+    if (_native_virtual_time) {
+        /* the ticks wrap around, a timer in the past is due now */
+        uint32_t offset = (uint32_t)(value - (uint32_t) native_virtual_now);
+        native_virtual_deadline[timer] = native_virtual_now;
+
+        if (offset <= INT32_MAX) {
+            native_virtual_deadline[timer] += offset;
+        }
+    }
+
     DEBUG("hwtimer_arch_set_absolute(): that is at %lu s %lu us\n",
           (unsigned long)native_hwtimer[timer].it_value.tv_sec,
           (unsigned long)native_hwtimer[timer].it_value.tv_usec);
@@ -272,6 +314,13 @@ unsigned long hwtimer_arch_now(void)
 
     DEBUG("hwtimer_arch_now()\n");
 
+    if (_native_virtual_time) {
+        /* the clock advances a tick per reading, so busy waits end,
+         * see nativesim.h */
+        native_hwtimer_now = (unsigned long) native_virtual_now++;
+        return native_hwtimer_now;
+    }
+
     _native_syscall_enter();
 #ifdef __MACH__
     clock_serv_t cclock;
@@ -300,6 +349,31 @@ unsigned long hwtimer_arch_now(void)
     return native_hwtimer_now;
 }
 
+uint64_t native_hwtimer_virtual_now(void)
+{
+    return native_virtual_now;
+}
+
+uint64_t native_hwtimer_next_deadline(void)
+{
+    if (next_timer == -1) {
+        return UINT64_MAX;
+    }
+
+    return native_virtual_deadline[next_timer];
+}
+
+void native_hwtimer_advance(uint64_t time)
+{
+    if (time > native_virtual_now) {
+        native_virtual_now = time;
+    }
+
+    if ((next_timer != -1) && (native_virtual_deadline[next_timer] <= native_virtual_now)) {
+        _native_raise_interrupt(SIGALRM);
+    }
+}
+
 /**
  * Called once on process creation in order to mimic the behaviour a
  * regular hardware timer.
@@ -53,6 +53,14 @@ void native_cpu_init(void);
 void native_interrupt_init(void);
 extern void native_hwtimer_pre_init(void);
 
+/**
+ * virtual time of the simulated medium, see nativesim.h
+ */
+extern int _native_virtual_time;
+uint64_t native_hwtimer_virtual_now(void);
+uint64_t native_hwtimer_next_deadline(void);
+void native_hwtimer_advance(uint64_t time);
+
 void native_irq_handler(void);
 extern void _native_sig_leave_tramp(void);
 
@@ -114,6 +122,11 @@ extern fd_set _native_rfds;
 ssize_t _native_read(int fd, void *buf, size_t count);
 ssize_t _native_write(int fd, const void *buf, size_t count);
 
+/**
+ * queue interrupt sig as if its signal arrived during a system call
+ */
+void _native_raise_interrupt(int sig);
+
 /**
  * register interrupt handler handler for interrupt sig
  */
@@ -0,0 +1,73 @@
+/**
+ * Simulated radio medium for native
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup native_cpu
+ * @{
+ * @file
+ * @brief   Protocol between native instances and the simulated medium
+ *
+ * Instead of a tap interface a native instance can connect to the
+ * medium of dist/tools/nativesim on a unix socket. The medium owns the
+ * clock of all its nodes: a node only runs when the medium wakes it up,
+ * for a timer or a frame. When it is idle again it tells the medium when
+ * its next timer expires. Only one node runs at a time, so a simulation
+ * with the same topology and seed always has the same result, and it
+ * runs as fast as the nodes get idle.
+ *
+ * While a node runs its clock advances by one microsecond every time it
+ * is read, so busy waits like hwtimer_spin() end. The clock of a node is
+ * ahead of the medium by the readings since it was woken up, the medium
+ * sends a frame at the time of the sender, not at its own.
+ *
+ * Every message is a nativesim_hdr_t with length bytes of payload.
+ * @}
+ */
+
+#ifndef _NATIVESIM_H
+#define _NATIVESIM_H
+
+#include <stdint.h>
+
+#define NATIVESIM_HELLO     (1)     /**< node to medium: id is the node id */
+#define NATIVESIM_WAIT      (2)     /**< node to medium: idle until time */
+#define NATIVESIM_FRAME     (3)     /**< a frame, sent or received at time */
+#define NATIVESIM_TIME      (4)     /**< medium to node: it is time now */
+
+/** time of a node without timers */
+#define NATIVESIM_NEVER     (UINT64_MAX)
+
+/** largest payload of a message */
+#define NATIVESIM_MAX_LEN   (1500)
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t length;    /**< bytes of payload after the header */
+    uint32_t id;
+    uint64_t time;      /**< virtual time in microseconds */
+} nativesim_hdr_t;
+
+#ifdef MODULE_NATIVENET
+extern int _native_sim_fd;
+
+/**
+ * connect to the medium at path and wait until it starts the node
+ */
+void nativesim_init(const char *path);
+
+/**
+ * tell the medium when the next timer expires and wait until it wakes
+ * the node up
+ */
+void _native_sim_sleep(void);
+#endif
+
+#endif /* _NATIVESIM_H */
@@ -354,6 +354,14 @@ void native_isr_entry(int sig, siginfo_t *info, void *context)
 #endif
 }
 
+void _native_raise_interrupt(int sig)
+{
+    if (real_write(_sig_pipefd[1], &sig, sizeof(int)) == -1) {
+        err(EXIT_FAILURE, "_native_raise_interrupt(): real_write()");
+    }
+    _native_sigpend++;
+}
+
 /**
  * register signal/interrupt handler for signal sig
  *
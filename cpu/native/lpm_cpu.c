@@ -30,6 +30,9 @@
 #include "cpu.h"
 
 #include "native_internal.h"
+#ifdef MODULE_NATIVENET
+#include "nativesim.h"
+#endif
 #ifdef MODULE_UART0
 #include "board_internal.h"
 #endif
@@ -45,6 +48,19 @@ void lpm_init(void)
 
 void _native_lpm_sleep(void)
 {
+#ifdef MODULE_NATIVENET
+    if (_native_virtual_time) {
+        /* the medium decides when the node wakes up, stdin is not read */
+        _native_sim_sleep();
+
+        if (_native_sigpend > 0) {
+            _native_in_syscall++;
+            _native_syscall_leave();
+        }
+        return;
+    }
+#endif
+
 #ifdef MODULE_UART0
     int nfds;
 
@@ -0,0 +1,227 @@
+/**
+ * nativesim.h implementation
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup native_cpu
+ * @{
+ * @file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <err.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#include "cpu.h"
+#include "tap.h"
+#include "nativenet.h"
+#include "nativenet_internal.h"
+#include "native_internal.h"
+#include "nativesim.h"
+
+#include "hwtimer.h"
+
+int _native_sim_fd = -1;
+
+/* the frame the medium delivered last, handled in the SIGIO handler */
+static struct nativenet_packet rx_frame;
+static uint16_t rx_length;
+
+static void sim_write(nativesim_hdr_t *hdr, void *payload)
+{
+    if (real_write(_native_sim_fd, hdr, sizeof(*hdr)) != sizeof(*hdr) ||
+        (hdr->length > 0 && real_write(_native_sim_fd, payload, hdr->length) != hdr->length)) {
+        err(EXIT_FAILURE, "nativesim: write");
+    }
+}
+
+static void sim_read_all(void *buf, size_t count)
+{
+    uint8_t *p = buf;
+
+    while (count > 0) {
+        ssize_t n = real_read(_native_sim_fd, p, count);
+
+        if (n == 0) {
+            /* the simulation is over */
+            exit(EXIT_SUCCESS);
+        }
+
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            err(EXIT_FAILURE, "nativesim: read");
+        }
+
+        p += n;
+        count -= n;
+    }
+}
+
+/* waits for the next message of the medium, frames go to rx_frame */
+static void sim_read(nativesim_hdr_t *hdr)
+{
+    sim_read_all(hdr, sizeof(*hdr));
+
+    if (hdr->length > sizeof(rx_frame)) {
+        errx(EXIT_FAILURE, "nativesim: message of %" PRIu16 " bytes", hdr->length);
+    }
+
+    if (hdr->length > 0) {
+        sim_read_all(&rx_frame, hdr->length);
+    }
+}
+
+static void _native_handle_sim_input(void)
+{
+    radio_packet_t p;
+    unsigned long t = hwtimer_now();
+    uint16_t nread = rx_length;
+
+    DEBUG("_native_handle_sim_input\n");
+
+    rx_length = 0;
+
+    if (nread <= sizeof(struct nativenet_header)) {
+        DEBUG("_native_handle_sim_input: no payload\n");
+        return;
+    }
+
+    p.processing = 0;
+    p.src = ntohs(rx_frame.nn_header.src);
+    p.dst = ntohs(rx_frame.nn_header.dst);
+    p.rssi = 0;
+    p.lqi = 0;
+    p.toa.seconds = HWTIMER_TICKS_TO_US(t) / 1000000;
+    p.toa.microseconds = HWTIMER_TICKS_TO_US(t) % 1000000;
+    p.length = ntohs(rx_frame.nn_header.length);
+    p.data = rx_frame.data;
+
+    if (p.length > (nread - sizeof(struct nativenet_header))) {
+        warnx("_native_handle_sim_input: packet with malicious length field received, discarding");
+        return;
+    }
+
+    _nativenet_handle_packet(&p);
+}
+
+int8_t _native_sim_send(radio_packet_t *packet)
+{
+    struct nativenet_packet frame;
+    nativesim_hdr_t hdr;
+
+    if (packet->length > sizeof(frame.data)) {
+        warnx("_native_sim_send: packet too long");
+        return -1;
+    }
+
+    frame.nn_header.length = htons(packet->length);
+    frame.nn_header.dst = htons(packet->dst);
+    frame.nn_header.src = htons(packet->src);
+    memcpy(frame.data, packet->data, packet->length);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = NATIVESIM_FRAME;
+    hdr.length = sizeof(struct nativenet_header) + packet->length;
+    hdr.time = native_hwtimer_virtual_now();
+
+    _native_syscall_enter();
+    sim_write(&hdr, &frame);
+    _native_syscall_leave();
+
+    return (hdr.length > INT8_MAX) ? INT8_MAX : hdr.length;
+}
+
+void _native_sim_sleep(void)
+{
+    nativesim_hdr_t hdr;
+
+    _native_in_syscall++; /* no switching here */
+
+    /* the output of the nodes stays in the order they ran */
+    fflush(stdout);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = NATIVESIM_WAIT;
+    hdr.time = native_hwtimer_next_deadline();
+    sim_write(&hdr, NULL);
+
+    sim_read(&hdr);
+    _native_in_syscall--;
+
+    native_hwtimer_advance(hdr.time);
+
+    if (hdr.type == NATIVESIM_FRAME) {
+        rx_length = hdr.length;
+        _native_raise_interrupt(SIGIO);
+    }
+}
+
+void nativesim_init(const char *path)
+{
+    struct sockaddr_un addr;
+    nativesim_hdr_t hdr;
+
+    if ((_native_sim_fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+        err(EXIT_FAILURE, "nativesim_init: socket");
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (connect(_native_sim_fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        err(EXIT_FAILURE, "nativesim_init: connect(%s)", path);
+    }
+
+    /* a locally administered MAC address from the node id */
+    _native_tap_mac[0] = 0x02;
+    _native_tap_mac[1] = 0x00;
+    _native_tap_mac[2] = (_native_id >> 24) & 0xff;
+    _native_tap_mac[3] = (_native_id >> 16) & 0xff;
+    _native_tap_mac[4] = (_native_id >> 8) & 0xff;
+    _native_tap_mac[5] = _native_id & 0xff;
+
+    unsigned char *eui_64 = (unsigned char *) &_native_net_addr_long;
+    eui_64[0] = _native_tap_mac[0];
+    eui_64[1] = _native_tap_mac[1];
+    eui_64[2] = _native_tap_mac[2];
+    eui_64[3] = 0xff;
+    eui_64[4] = 0xfe;
+    eui_64[5] = _native_tap_mac[3];
+    eui_64[6] = _native_tap_mac[4];
+    eui_64[7] = _native_tap_mac[5];
+
+    register_interrupt(SIGIO, _native_handle_sim_input);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = NATIVESIM_HELLO;
+    hdr.id = _native_id;
+    sim_write(&hdr, NULL);
+
+    /* the medium starts the nodes one after the other */
+    do {
+        sim_read(&hdr);
+    } while (hdr.type != NATIVESIM_TIME);
+
+    native_hwtimer_advance(hdr.time);
+
+    DEBUG("RIOT native sim initialized.\n");
+}
+/** @} */
@@ -53,6 +53,7 @@
 #include "nativenet.h"
 #include "nativenet_internal.h"
 #include "native_internal.h"
+#include "nativesim.h"
 
 #include "hwtimer.h"
 #include "timex.h"
@@ -219,6 +220,11 @@ int8_t send_buf(radio_packet_t *packet)
     uint8_t buf[TAP_BUFFER_LENGTH];
     int nsent, to_send;
 
+    /* the simulated medium replaces the tap interface */
+    if (_native_sim_fd != -1) {
+        return _native_sim_send(packet);
+    }
+
     memset(buf, 0, sizeof(buf));
 
     DEBUG("send_buf:  Sending packet of length %" PRIu16 " from %" PRIu16 " to %" PRIu16 "\n", packet->length, packet->src, packet->dst);
@@ -36,6 +36,9 @@
 #include "board_internal.h"
 #include "native_internal.h"
 #include "tap.h"
+#ifdef MODULE_NATIVENET
+#include "nativesim.h"
+#endif
 
 int _native_null_in_pipe[2];
 int _native_null_out_file;
@@ -155,7 +158,7 @@ void usage_exit(void)
     real_printf("usage: %s", _progname);
 
 #ifdef MODULE_NATIVENET
-    real_printf(" <tap interface>");
+    real_printf(" <tap interface>|-s <medium socket>");
 #endif
 
 #ifdef MODULE_UART0
@@ -176,6 +179,11 @@ void usage_exit(void)
             /tmp/riot.tty.PID otherwise)\n\
 -r          replay missed output when (re-)attaching to socket\n\
             (implies -o)\n");
+#endif
+#ifdef MODULE_NATIVENET
+    real_printf("\
+-s <path>   connect to the simulated medium at <path> instead of a tap\n\
+            interface, see dist/tools/nativesim\n");
 #endif
     real_printf("\
 -i <id>     specify instance id (set by config module)\n\
@@ -211,6 +219,9 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
     char *ioparam = NULL;
     int replay = 0;
 #endif
+#ifdef MODULE_NATIVENET
+    char *sim_path = NULL;
+#endif
 
 #ifdef MODULE_NATIVENET
     if (
@@ -222,6 +233,13 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
        ) {
         usage_exit();
     }
+    if (strcmp("-s", argv[argp]) == 0) {
+        if (argc < 3) {
+            usage_exit();
+        }
+        sim_path = argv[++argp];
+        _native_virtual_time = 1;
+    }
     argp++;
 #endif
 
@@ -312,7 +330,12 @@ __attribute__((constructor)) static void startup(int argc, char **argv)
     native_cpu_init();
     native_interrupt_init();
 #ifdef MODULE_NATIVENET
-    tap_init(argv[1]);
+    if (sim_path != NULL) {
+        nativesim_init(sim_path);
+    }
+    else {
+        tap_init(argv[1]);
+    }
 #endif
 
     board_init();
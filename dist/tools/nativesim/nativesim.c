@@ -0,0 +1,680 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/*
+ * Simulated radio medium for native instances, see README.md and
+ * cpu/native/include/nativesim.h.
+ *
+ * The medium runs one node at a time: it wakes up the node with the
+ * earliest timer or frame, passes on the frames the node sends and
+ * waits until the node is idle again. Frames are lost with the loss rate
+ * of their link, drawn from a random generator with a fixed seed, so
+ * every run with the same topology and seed is the same.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <err.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "nativesim.h"
+
+#define DEFAULT_LATENCY     (1000)  /* microseconds */
+#define DEFAULT_DURATION    (60)    /* seconds */
+
+typedef struct {
+    uint32_t id;
+    int fd;
+    pid_t pid;
+    int alive;
+    uint64_t deadline;      /* next timer, NATIVESIM_NEVER if none */
+    unsigned sent;
+    unsigned received;
+    unsigned wakeups;
+    uint64_t drift;         /* most the clock of the node was ahead */
+} node_t;
+
+typedef struct {
+    int from;
+    int to;
+    unsigned loss;          /* percent */
+    uint32_t latency;       /* microseconds */
+} link_t;
+
+/* a frame on its way to a node */
+typedef struct {
+    uint64_t time;
+    uint32_t seq;
+    int to;
+    uint16_t length;
+    uint8_t data[NATIVESIM_MAX_LEN];
+} event_t;
+
+static node_t *nodes;
+static int node_count;
+static link_t *links;
+static int link_count;
+
+/* binary heap of the pending frames, ordered by time and sequence */
+static event_t **heap;
+static int heap_count;
+static int heap_size;
+static uint32_t event_seq;
+
+static uint64_t now;
+static uint32_t rng_state;
+static int verbose;
+static int failed;
+static unsigned frames_sent, frames_delivered, frames_lost;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-r <seed>] [-d <seconds>] [-v] <socket> <topology> "
+            "[<program> [<args>]]\n\n", prog);
+    fprintf(stderr, "-r <seed>     seed of the loss generator (default 1)\n");
+    fprintf(stderr, "-d <seconds>  virtual time to simulate (default %d)\n", DEFAULT_DURATION);
+    fprintf(stderr, "-v            per node statistics\n\n");
+    fprintf(stderr, "With a program, it is started for every node as\n");
+    fprintf(stderr, "    <program> -s <socket> -i <id> <args>\n");
+    fprintf(stderr, "otherwise the medium waits for the nodes of the topology to connect.\n");
+    exit(EXIT_FAILURE);
+}
+
+/* xorshift32, good enough for loss decisions */
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int find_node(uint32_t id)
+{
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].id == id) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int add_node(uint32_t id)
+{
+    int i = find_node(id);
+
+    if (i >= 0) {
+        return i;
+    }
+
+    if (id == 0) {
+        errx(EXIT_FAILURE, "node id 0 is not allowed");
+    }
+
+    nodes = realloc(nodes, (node_count + 1) * sizeof(node_t));
+
+    if (nodes == NULL) {
+        err(EXIT_FAILURE, "realloc");
+    }
+
+    /* keep the nodes sorted by id, they are started in this order */
+    for (i = node_count; i > 0 && nodes[i - 1].id > id; i--) {
+        nodes[i] = nodes[i - 1];
+    }
+
+    for (int l = 0; l < link_count; l++) {
+        links[l].from += (links[l].from >= i);
+        links[l].to += (links[l].to >= i);
+    }
+
+    memset(&nodes[i], 0, sizeof(node_t));
+    nodes[i].id = id;
+    nodes[i].fd = -1;
+    nodes[i].deadline = NATIVESIM_NEVER;
+    node_count++;
+
+    return i;
+}
+
+static void add_link(uint32_t a, uint32_t b, unsigned loss, uint32_t latency)
+{
+    if (a == b) {
+        errx(EXIT_FAILURE, "link from node %" PRIu32 " to itself", a);
+    }
+
+    add_node(a);
+    add_node(b);
+
+    links = realloc(links, (link_count + 2) * sizeof(link_t));
+
+    if (links == NULL) {
+        err(EXIT_FAILURE, "realloc");
+    }
+
+    /* links are symmetric */
+    links[link_count].from = find_node(a);
+    links[link_count].to = find_node(b);
+    links[link_count].loss = loss;
+    links[link_count].latency = latency;
+    links[link_count + 1].from = find_node(b);
+    links[link_count + 1].to = find_node(a);
+    links[link_count + 1].loss = loss;
+    links[link_count + 1].latency = latency;
+    link_count += 2;
+}
+
+/*
+ * node <id>
+ * link <a> <b> [<loss %> [<latency us>]]
+ * grid <width> <height> [<loss %> [<latency us>]]
+ */
+static void read_topology(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int lineno = 0;
+
+    if (f == NULL) {
+        err(EXIT_FAILURE, "%s", path);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char cmd[16];
+        unsigned long a, b;
+        unsigned loss = 0;
+        unsigned long latency = DEFAULT_LATENCY;
+        int n;
+
+        lineno++;
+
+        if (sscanf(line, "%15s", cmd) != 1 || cmd[0] == '#') {
+            continue;
+        }
+
+        n = sscanf(line, "%*s %lu %lu %u %lu", &a, &b, &loss, &latency);
+
+        if (loss > 100) {
+            errx(EXIT_FAILURE, "%s:%d: loss of more than 100%%", path, lineno);
+        }
+
+        if (strcmp(cmd, "node") == 0 && n >= 1) {
+            add_node(a);
+        }
+        else if (strcmp(cmd, "link") == 0 && n >= 2) {
+            add_link(a, b, loss, latency);
+        }
+        else if (strcmp(cmd, "grid") == 0 && n >= 2) {
+            /* node ids row by row from 1, links to the four neighbours */
+            for (unsigned long y = 0; y < b; y++) {
+                for (unsigned long x = 0; x < a; x++) {
+                    uint32_t id = y * a + x + 1;
+
+                    add_node(id);
+
+                    if (x + 1 < a) {
+                        add_link(id, id + 1, loss, latency);
+                    }
+
+                    if (y + 1 < b) {
+                        add_link(id, id + a, loss, latency);
+                    }
+                }
+            }
+        }
+        else {
+            errx(EXIT_FAILURE, "%s:%d: syntax error", path, lineno);
+        }
+    }
+
+    fclose(f);
+
+    if (node_count == 0) {
+        errx(EXIT_FAILURE, "%s: no nodes", path);
+    }
+}
+
+static int event_before(event_t *a, event_t *b)
+{
+    return (a->time < b->time) || ((a->time == b->time) && (a->seq < b->seq));
+}
+
+static void heap_push(event_t *ev)
+{
+    int i;
+
+    if (heap_count == heap_size) {
+        heap_size = heap_size ? 2 * heap_size : 64;
+        heap = realloc(heap, heap_size * sizeof(event_t *));
+
+        if (heap == NULL) {
+            err(EXIT_FAILURE, "realloc");
+        }
+    }
+
+    ev->seq = event_seq++;
+
+    for (i = heap_count++; i > 0 && event_before(ev, heap[(i - 1) / 2]); i = (i - 1) / 2) {
+        heap[i] = heap[(i - 1) / 2];
+    }
+
+    heap[i] = ev;
+}
+
+static event_t *heap_pop(void)
+{
+    event_t *top = heap[0];
+    event_t *last = heap[--heap_count];
+    int i = 0;
+
+    for (;;) {
+        int c = 2 * i + 1;
+
+        if (c >= heap_count) {
+            break;
+        }
+
+        if (c + 1 < heap_count && event_before(heap[c + 1], heap[c])) {
+            c++;
+        }
+
+        if (!event_before(heap[c], last)) {
+            break;
+        }
+
+        heap[i] = heap[c];
+        i = c;
+    }
+
+    heap[i] = last;
+    return top;
+}
+
+static int read_all(int fd, void *buf, size_t count)
+{
+    uint8_t *p = buf;
+
+    while (count > 0) {
+        ssize_t n = read(fd, p, count);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return -1;
+        }
+
+        p += n;
+        count -= n;
+    }
+
+    return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t count)
+{
+    const uint8_t *p = buf;
+
+    while (count > 0) {
+        ssize_t n = write(fd, p, count);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            return -1;
+        }
+
+        p += n;
+        count -= n;
+    }
+
+    return 0;
+}
+
+static void node_died(node_t *node)
+{
+    warnx("node %" PRIu32 " died at %" PRIu64 " us", node->id, now);
+    close(node->fd);
+    node->fd = -1;
+    node->alive = 0;
+    failed = 1;
+}
+
+/* the clock of the sender is ahead of the medium by the time it ran */
+static void send_frame(int from, uint64_t time, uint8_t *data, uint16_t length)
+{
+    frames_sent++;
+    nodes[from].sent++;
+
+    if (time < now) {
+        time = now;
+    }
+
+    if (time - now > nodes[from].drift) {
+        nodes[from].drift = time - now;
+    }
+
+    for (int l = 0; l < link_count; l++) {
+        event_t *ev;
+
+        if (links[l].from != from) {
+            continue;
+        }
+
+        if (links[l].loss > 0 && (rng() % 100) < links[l].loss) {
+            frames_lost++;
+            continue;
+        }
+
+        if ((ev = malloc(sizeof(event_t))) == NULL) {
+            err(EXIT_FAILURE, "malloc");
+        }
+
+        ev->time = time + links[l].latency;
+        ev->to = links[l].to;
+        ev->length = length;
+        memcpy(ev->data, data, length);
+        heap_push(ev);
+    }
+}
+
+/* wake the node up and pass on its frames until it waits again */
+static void run_node(node_t *node, uint8_t type, uint8_t *data, uint16_t length)
+{
+    nativesim_hdr_t hdr;
+    uint8_t buf[NATIVESIM_MAX_LEN];
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = type;
+    hdr.length = length;
+    hdr.id = node->id;
+    hdr.time = now;
+
+    node->wakeups++;
+
+    if (write_all(node->fd, &hdr, sizeof(hdr)) == -1 ||
+        (length > 0 && write_all(node->fd, data, length) == -1)) {
+        node_died(node);
+        return;
+    }
+
+    for (;;) {
+        if (read_all(node->fd, &hdr, sizeof(hdr)) == -1) {
+            node_died(node);
+            return;
+        }
+
+        if (hdr.length > NATIVESIM_MAX_LEN ||
+            (hdr.length > 0 && read_all(node->fd, buf, hdr.length) == -1)) {
+            node_died(node);
+            return;
+        }
+
+        if (hdr.type == NATIVESIM_FRAME) {
+            send_frame(node - nodes, hdr.time, buf, hdr.length);
+        }
+        else if (hdr.type == NATIVESIM_WAIT) {
+            node->deadline = hdr.time;
+            return;
+        }
+        else {
+            warnx("node %" PRIu32 ": unexpected message %d", node->id, hdr.type);
+        }
+    }
+}
+
+static void spawn_nodes(const char *sock, char **prog_argv, int prog_argc)
+{
+    char **argv = calloc(prog_argc + 6, sizeof(char *));
+
+    if (argv == NULL) {
+        err(EXIT_FAILURE, "calloc");
+    }
+
+    for (int i = 0; i < node_count; i++) {
+        char id[16];
+
+        snprintf(id, sizeof(id), "%" PRIu32, nodes[i].id);
+        argv[0] = prog_argv[0];
+        argv[1] = "-s";
+        argv[2] = (char *) sock;
+        argv[3] = "-i";
+        argv[4] = id;
+
+        for (int a = 1; a < prog_argc; a++) {
+            argv[4 + a] = prog_argv[a];
+        }
+
+        fflush(stdout);
+
+        if ((nodes[i].pid = fork()) == -1) {
+            err(EXIT_FAILURE, "fork");
+        }
+
+        if (nodes[i].pid == 0) {
+            execvp(argv[0], argv);
+            err(EXIT_FAILURE, "%s", argv[0]);
+        }
+    }
+
+    free(argv);
+}
+
+static void accept_nodes(int listen_fd)
+{
+    int connected = 0;
+
+    while (connected < node_count) {
+        struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+        nativesim_hdr_t hdr;
+        pid_t pid;
+        int status, fd, i;
+
+        /* a node that exits before it connects would stall the start */
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (i = 0; i < node_count && nodes[i].pid != pid; i++) {
+            }
+
+            errx(EXIT_FAILURE, "node %" PRIu32 " exited before the start",
+                 (i < node_count) ? nodes[i].id : 0);
+        }
+
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+
+        if ((fd = accept(listen_fd, NULL, NULL)) == -1) {
+            err(EXIT_FAILURE, "accept");
+        }
+
+        if (read_all(fd, &hdr, sizeof(hdr)) == -1 || hdr.type != NATIVESIM_HELLO) {
+            warnx("a node did not say hello");
+            close(fd);
+            continue;
+        }
+
+        if ((i = find_node(hdr.id)) == -1 || nodes[i].alive) {
+            errx(EXIT_FAILURE, "node %" PRIu32 " is not in the topology or connected twice", hdr.id);
+        }
+
+        nodes[i].fd = fd;
+        nodes[i].alive = 1;
+        connected++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_un addr;
+    struct timespec start, end;
+    uint64_t duration = DEFAULT_DURATION * 1000000ULL;
+    int listen_fd, opt;
+    const char *sock;
+
+    rng_state = 1;
+
+    while ((opt = getopt(argc, argv, "+r:d:vh")) != -1) {
+        switch (opt) {
+            case 'r':
+                rng_state = strtoul(optarg, NULL, 0);
+                /* xorshift never leaves 0 */
+                rng_state = rng_state ? rng_state : 1;
+                break;
+
+            case 'd':
+                duration = strtoull(optarg, NULL, 0) * 1000000ULL;
+                break;
+
+            case 'v':
+                verbose = 1;
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (argc - optind < 2) {
+        usage(argv[0]);
+    }
+
+    sock = argv[optind];
+    read_topology(argv[optind + 1]);
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+        err(EXIT_FAILURE, "socket");
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sock, sizeof(addr.sun_path) - 1);
+    unlink(sock);
+
+    if (bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) == -1 ||
+        listen(listen_fd, 64) == -1) {
+        err(EXIT_FAILURE, "%s", sock);
+    }
+
+    if (argc - optind > 2) {
+        spawn_nodes(sock, &argv[optind + 2], argc - optind - 2);
+    }
+
+    accept_nodes(listen_fd);
+    close(listen_fd);
+    unlink(sock);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* boot the nodes in the order of their ids */
+    for (int i = 0; i < node_count; i++) {
+        run_node(&nodes[i], NATIVESIM_TIME, NULL, 0);
+    }
+
+    for (;;) {
+        node_t *next = NULL;
+        uint64_t t = NATIVESIM_NEVER;
+
+        for (int i = 0; i < node_count; i++) {
+            if (nodes[i].alive && nodes[i].deadline < t) {
+                next = &nodes[i];
+                t = nodes[i].deadline;
+            }
+        }
+
+        /* frames go before timers that expire at the same time */
+        if (heap_count > 0 && heap[0]->time <= t) {
+            event_t *ev = heap_pop();
+
+            now = (ev->time > now) ? ev->time : now;
+
+            if (now > duration) {
+                free(ev);
+                break;
+            }
+
+            if (nodes[ev->to].alive) {
+                frames_delivered++;
+                nodes[ev->to].received++;
+                run_node(&nodes[ev->to], NATIVESIM_FRAME, ev->data, ev->length);
+            }
+
+            free(ev);
+            continue;
+        }
+
+        if (next == NULL) {
+            break;
+        }
+
+        now = (t > now) ? t : now;
+
+        if (now > duration) {
+            break;
+        }
+
+        run_node(next, NATIVESIM_TIME, NULL, 0);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fflush(stdout);
+
+    printf("nativesim: %d nodes, %.3f s virtual time in %.3f s\n", node_count,
+           (now > duration ? duration : now) / 1e6,
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    printf("nativesim: %u frames sent, %u delivered, %u lost\n",
+           frames_sent, frames_delivered, frames_lost);
+
+    if (verbose) {
+        for (int i = 0; i < node_count; i++) {
+            printf("nativesim: node %4" PRIu32 ": %5u sent %6u received %7u wakeups "
+                   "%4" PRIu64 " us drift%s\n",
+                   nodes[i].id, nodes[i].sent, nodes[i].received, nodes[i].wakeups,
+                   nodes[i].drift, nodes[i].alive ? "" : " (died)");
+        }
+    }
+
+    fflush(stdout);
+
+    /* the nodes exit when their socket is closed */
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].fd != -1) {
+            close(nodes[i].fd);
+        }
+    }
+
+    for (int i = 0; i < node_count; i++) {
+        int status;
+
+        if (nodes[i].pid > 0 && waitpid(nodes[i].pid, &status, 0) == nodes[i].pid &&
+            !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+            failed = 1;
+        }
+    }
+
+    while (heap_count > 0) {
+        free(heap_pop());
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -131,7 +131,7 @@ static void riot_ccn_relay_config(int argc, char **argv)
     }
 
     if (argc < 2) {
-        printf("%s: <max_cache_entries>\n", argv[0]);
+        printf("%s: <max_cache_entries> [max_cache_bytes]\n", argv[0]);
         return;
     }
 
@@ -139,6 +139,44 @@ static void riot_ccn_relay_config(int argc, char **argv)
     m.content.value = atoi(argv[1]);
     m.type = CCNL_RIOT_CONFIG_CACHE;
     msg_send(&m, _relay_pid, 1);
+
+    if (argc > 2) {
+        m.content.value = atoi(argv[2]);
+        m.type = CCNL_RIOT_CONFIG_CACHE_BYTES;
+        msg_send(&m, _relay_pid, 1);
+    }
+}
+
+static void riot_ccn_strategy(int argc, char **argv)
+{
+    if (_relay_pid == KERNEL_PID_UNDEF) {
+        puts("ccnl stack not running");
+        return;
+    }
+
+    if (argc < 2) {
+        printf("%s: <multicast|bestroute|adaptive>\n", argv[0]);
+        return;
+    }
+
+    msg_t m;
+    m.type = CCNL_RIOT_CONFIG_STRATEGY;
+
+    if (strcmp(argv[1], "multicast") == 0) {
+        m.content.value = CCNL_STRATEGY_MULTICAST;
+    }
+    else if (strcmp(argv[1], "bestroute") == 0) {
+        m.content.value = CCNL_STRATEGY_BEST_ROUTE;
+    }
+    else if (strcmp(argv[1], "adaptive") == 0) {
+        m.content.value = CCNL_STRATEGY_ADAPTIVE;
+    }
+    else {
+        printf("%s: unknown strategy '%s'\n", argv[0], argv[1]);
+        return;
+    }
+
+    msg_send(&m, _relay_pid, 1);
 }
 
 static void riot_ccn_transceiver_start(kernel_pid_t _relay_pid)
@@ -310,6 +348,7 @@ static const shell_command_t sc[] = {
     { "prefix", "registers a prefix to a face", riot_ccn_register_prefix },
     { "stat", "prints out forwarding statistics", riot_ccn_stat },
     { "config", "changes the runtime config of the ccn lite relay", riot_ccn_relay_config },
+    { "strategy", "sets the forwarding strategy of the ccn lite relay", riot_ccn_strategy },
 #if RIOT_CCN_APPSERVER
     { "appserver", "starts an application server to reply to interests", riot_ccn_appserver },
 #endif
@@ -79,9 +79,8 @@ void rpl_udp_init(int argc, char **argv)
             rpl_init_root();
             is_root = 1;
         }
-        else {
-            ipv6_iface_set_routing_provider(rpl_get_next_hop);
-        }
+
+        ipv6_iface_set_routing_provider(rpl_get_next_hop);
 
         DEBUGF("Start monitor\n");
         kernel_pid_t monitor_pid = thread_create(monitor_stack_buffer,
@@ -130,7 +129,7 @@ void rpl_udp_dodag(int argc, char **argv)
     (void) argv;
 
     printf("---------------------------\n");
-    rpl_dodag_t *mydodag = rpl_get_my_dodag();
+    rpl_dodag_t *mydodag = rpl_next_joined_dodag(NULL);
 
     if (mydodag == NULL) {
         printf("Not part of a dodag\n");
@@ -138,16 +137,18 @@ void rpl_udp_dodag(int argc, char **argv)
         return;
     }
 
-    printf("Part of Dodag:\n");
-    printf("%s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                                    (&mydodag->dodag_id)));
-    printf("my rank: %d\n", mydodag->my_rank);
-
-    if (!is_root) {
-        printf("my preferred parent:\n");
+    for (; mydodag != NULL; mydodag = rpl_next_joined_dodag(mydodag)) {
+        printf("Part of Dodag of instance %u:\n", mydodag->instance->id);
         printf("%s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                                        (&mydodag->my_preferred_parent->addr)));
-    }
+                                        (&mydodag->dodag_id)));
+        printf("my rank: %d\n", mydodag->my_rank);
 
-    printf("---------------------------\n");
+        if (mydodag->my_preferred_parent != NULL) {
+            printf("my preferred parent:\n");
+            printf("%s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
+                                            (&mydodag->my_preferred_parent->addr)));
+        }
+
+        printf("---------------------------\n");
+    }
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_trickle Trickle
+ * @ingroup     sys
+ * @brief       The Trickle algorithm of RFC 6206
+ *
+ * A trickle instance is a trickle_t the user owns, so there can be as many
+ * instances as needed. An instance needs no thread of its own: its only
+ * vtimer sends a message of type MSG_TIMER with the instance as
+ * content.ptr to the thread given to trickle_start(), which calls
+ * trickle_callback() with the instance when it receives the message. The
+ * callback of the user runs in that thread, so it may send packets and
+ * access the state of the user without further locking.
+ *
+ * @{
+ *
+ * @file        trickle.h
+ * @brief       Trickle timers
+ */
+
+#ifndef __TRICKLE_H
+#define __TRICKLE_H
+
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "vtimer.h"
+
+/**
+ * @brief   Function the instance calls when it is time to transmit.
+ */
+typedef void (*trickle_callback_t)(void *arg);
+
+/**
+ * @brief   State of a trickle instance, all times in milliseconds.
+ */
+typedef struct {
+    uint32_t Imin;                  /**< minimum interval size */
+    uint8_t Imax;                   /**< doublings of Imin up to the maximum interval size */
+    uint8_t k;                      /**< redundancy constant, 0 means infinity */
+    uint16_t c;                     /**< consistent transmissions heard in this interval */
+    uint32_t I;                     /**< current interval size, 0 if stopped */
+    uint32_t t;                     /**< time in the current interval to transmit at */
+    uint8_t interval_end;           /**< 1 if the timer runs to the end of the interval */
+    kernel_pid_t pid;               /**< thread that gets the timer messages */
+    trickle_callback_t callback;    /**< transmits */
+    void *arg;                      /**< argument of @p callback */
+    vtimer_t timer;                 /**< timer of the instance */
+} trickle_t;
+
+/**
+ * @brief   Starts a trickle instance.
+ *
+ * The first interval has a random size between Imin and the maximum
+ * interval size.
+ *
+ * @param[in] pid       thread that gets the timer messages of the instance
+ * @param[out] trickle  the instance
+ * @param[in] callback  function to transmit with
+ * @param[in] arg       argument of @p callback
+ * @param[in] Imin      minimum interval size in milliseconds
+ * @param[in] Imax      doublings of @p Imin up to the maximum interval size
+ * @param[in] k         redundancy constant, 0 transmits in every interval
+ */
+void trickle_start(kernel_pid_t pid, trickle_t *trickle,
+                   trickle_callback_t callback, void *arg,
+                   uint32_t Imin, uint8_t Imax, uint8_t k);
+
+/**
+ * @brief   Stops a trickle instance, it may be started again.
+ *
+ * A timer message that is already queued for the instance is ignored
+ * by trickle_callback().
+ *
+ * @param[in] trickle   the instance
+ */
+void trickle_stop(trickle_t *trickle);
+
+/**
+ * @brief   Resets the interval of the instance to Imin.
+ *
+ * To call on an inconsistent transmission, nothing happens if the current
+ * interval has the size Imin already.
+ *
+ * @param[in] trickle   the instance
+ */
+void trickle_reset_timer(trickle_t *trickle);
+
+/**
+ * @brief   Counts a consistent transmission that was heard.
+ *
+ * @param[in] trickle   the instance
+ */
+void trickle_increment_counter(trickle_t *trickle);
+
+/**
+ * @brief   Handles the timer message of an instance.
+ *
+ * The thread given to trickle_start() calls this for every message of type
+ * MSG_TIMER that carries the instance as content.ptr.
+ *
+ * @param[in] trickle   the instance
+ */
+void trickle_callback(trickle_t *trickle);
+
+#endif /* __TRICKLE_H */
+/** @} */
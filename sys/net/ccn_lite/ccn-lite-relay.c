@@ -54,37 +54,26 @@ msg_t msg_buffer_relay[RELAY_MSG_BUFFER_SIZE];
 
 struct ccnl_relay_s *theRelay = NULL;
 
-struct timeval *
-ccnl_run_events(void)
+/* runs the handlers of all expired timers, returns the time until the next
+ * deadline in us, -1 if no timer is armed */
+long ccnl_run_events(void)
 {
-    static struct timeval now;
+    struct ccnl_timer_s *t;
+    struct timeval now;
     ccnl_get_timeval(&now);
-    //DEBUGMSG(1, "ccnl_run_events now: %ld:%ld\n", now.tv_sec, now.tv_usec);
 
-    while (eventqueue) {
-        struct ccnl_timer_s *t = eventqueue;
-        long usec = timevaldelta(&(t->timeout), &now);
+    while ((t = ccnl_timer_first())) {
+        long usec = timevaldelta(&t->timeout, &now);
 
-        if (usec >= 0) {
-            //DEBUGMSG(1, "ccnl_run_events nothing to do: %ld:%ld\n", now.tv_sec, now.tv_usec);
-            now.tv_sec = usec / 1000000;
-            now.tv_usec = usec % 1000000;
-            return &now;
+        if (usec > 0) {
+            return usec;
         }
 
-        //DEBUGMSG(1, "ccnl_run_events run event handler: %ld:%ld\n", now.tv_sec, now.tv_usec);
-        if (t->fct) {
-            (t->fct)(t->node, t->intarg);
-        }
-        else if (t->fct2) {
-            (t->fct2)(t->aux1, t->aux2);
-        }
-
-        eventqueue = t->next;
-        ccnl_free(t);
+        ccnl_timer_cancel(t);
+        (t->fct)(t->aux1, t->aux2);
     }
 
-    return NULL;
+    return -1;
 }
 
 // ----------------------------------------------------------------------
@@ -109,177 +98,176 @@ void ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
 
 // ----------------------------------------------------------------------
 
-void ccnl_ageing(void *relay, void *aux)
-{
-    ccnl_do_ageing(relay, aux);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_CHECK_TIMEOUT_SEC, CCNL_CHECK_TIMEOUT_USEC), ccnl_ageing, relay, 0);
-}
+/* interfaces added before the relay starts, behind the msg and the
+ * transceiver interface */
+static struct {
+    int (*sendfunc)(uint8_t *, uint16_t, uint16_t);
+    uint16_t mtu;
+} riot_ifs[CCNL_MAX_INTERFACES];
+static int riot_ifcount = RIOT_TRANS_IDX + 1;
 
-void ccnl_retransmit(void *relay, void *aux)
+int ccnl_riot_relay_add_interface(int (*sendfunc)(uint8_t *buf, uint16_t size,
+                                  uint16_t to), uint16_t mtu)
 {
-    ccnl_do_retransmit(relay, aux);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC), ccnl_retransmit, relay, 0);
-}
+    if (theRelay || riot_ifcount >= CCNL_MAX_INTERFACES) {
+        return -1;
+    }
 
-void ccnl_nonce_timeout(void *relay, void *aux)
-{
-    ccnl_do_nonce_timeout(relay, aux);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_NONCE_TIMEOUT_SEC, CCNL_NONCE_TIMEOUT_USEC), ccnl_nonce_timeout, relay, 0);
+    riot_ifs[riot_ifcount].sendfunc = sendfunc;
+    riot_ifs[riot_ifcount].mtu = mtu;
+    return riot_ifcount++;
 }
 
-// ----------------------------------------------------------------------
+/* content images added before the relay starts */
+static struct {
+    const unsigned char *data;
+    int len;
+} riot_images[CCNL_MAX_IMAGES];
+static int riot_imagecount;
 
-void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries, int fib_threshold_prefix, int fib_threshold_aggregate)
+int ccnl_riot_relay_add_image(const unsigned char *image, int len)
 {
-    struct ccnl_if_s *i;
-
-    DEBUGMSG(99, "ccnl_relay_config\n");
-
-    relay->max_cache_entries = max_cache_entries;
-    relay->fib_threshold_prefix = fib_threshold_prefix;
-    relay->fib_threshold_aggregate = fib_threshold_aggregate;
-
-    if (RIOT_MSG_IDX != relay->ifcount) {
-        DEBUGMSG(1, "sorry, idx did not match: riot msg device\n");
+    if (theRelay || riot_imagecount >= CCNL_MAX_IMAGES) {
+        return -1;
     }
 
-    i = &relay->ifs[relay->ifcount];
-    i->sock = ccnl_open_riotmsgdev();
-    i->sendfunc = &riot_send_msg;
-    i->mtu = 4000;
-    i->reflect = 0;
-    i->fwdalli = 0;
+    riot_images[riot_imagecount].data = image;
+    riot_images[riot_imagecount].len = len;
+    riot_imagecount++;
+    return 0;
+}
 
-    if (i->sock >= 0) {
-        relay->ifcount++;
+#ifdef CPU_NATIVE
+int ccnl_riot_relay_load_image(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    unsigned char *image = NULL;
+    long len;
 
-        if (relay->defaultInterfaceScheduler) {
-            i->sched = relay->defaultInterfaceScheduler(relay,
-                       ccnl_interface_CTS);
-        }
-    }
-    else {
-        DEBUGMSG(1, "sorry, could not open riot msg device\n");
+    if (!f) {
+        printf("can't open the content image %s\n", path);
+        return -1;
     }
 
-    if (RIOT_TRANS_IDX != relay->ifcount) {
-        DEBUGMSG(1, "sorry, idx did not match: riot trans device\n");
+    if (fseek(f, 0, SEEK_END) < 0 || (len = ftell(f)) <= 0
+        || fseek(f, 0, SEEK_SET) < 0 || !(image = ccnl_malloc(len))
+        || fread(image, 1, len, f) != (size_t) len
+        || ccnl_riot_relay_add_image(image, len) < 0) {
+        printf("can't load the content image %s\n", path);
+        ccnl_free(image);
+        fclose(f);
+        return -1;
     }
 
-    i = &relay->ifs[relay->ifcount];
-    i->sock = ccnl_open_riottransdev();
-    i->sendfunc = &riot_send_transceiver;
-#ifdef USE_FRAG
-    i->mtu = 120;
-#else
-    i->mtu = 1500;
+    /* the image is kept as long as the process runs */
+    fclose(f);
+    return 0;
+}
 #endif
+
+static void ccnl_relay_open_if(struct ccnl_relay_s *relay, int sock,
+                               int (*sendfunc)(uint8_t *, uint16_t, uint16_t),
+                               int mtu)
+{
+    struct ccnl_if_s *i = &relay->ifs[relay->ifcount];
+
+    i->sock = sock;
+    i->sendfunc = sendfunc;
+    i->mtu = mtu;
     i->reflect = 0;
     i->fwdalli = 0;
 
-    if (i->sock >= 0) {
-        relay->ifcount++;
-
-        if (relay->defaultInterfaceScheduler) {
-            i->sched = relay->defaultInterfaceScheduler(relay,
-                       ccnl_interface_CTS);
-        }
+    if (i->sock < 0) {
+        DEBUGMSG(1, "sorry, could not open interface %d\n", relay->ifcount);
+        return;
     }
-    else {
-        DEBUGMSG(1, "sorry, could not open riot trans device\n");
+
+    if (relay->defaultInterfaceScheduler) {
+        i->sched = relay->defaultInterfaceScheduler(relay, ccnl_interface_CTS);
     }
 
-    /* create default boardcast face on transceiver interface */
-    struct ccnl_face_s * f = ccnl_get_face_or_create(relay, RIOT_TRANS_IDX, RIOT_BROADCAST);
-    f->flags |= CCNL_FACE_FLAGS_STATIC;
-    i->broadcast_face = f;
+    relay->ifcount++;
 
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_CHECK_TIMEOUT_SEC, CCNL_CHECK_TIMEOUT_USEC), ccnl_ageing, relay, 0);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC), ccnl_retransmit, relay, 0);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_NONCE_TIMEOUT_SEC, CCNL_NONCE_TIMEOUT_USEC), ccnl_nonce_timeout, relay, 0);
-}
+    /* create default broadcast face on all but the msg interface */
+    if (relay->ifcount - 1 != RIOT_MSG_IDX) {
+        struct ccnl_face_s *f = ccnl_get_face_or_create(relay, relay->ifcount - 1,
+                                RIOT_BROADCAST);
 
-#if RIOT_CCNL_POPULATE
+        if (f) {
+            f->flags |= CCNL_FACE_FLAGS_STATIC;
+            i->broadcast_face = f;
+        }
+    }
+}
 
-void ccnl_populate_cache(struct ccnl_relay_s *ccnl, unsigned char *buf, int datalen)
+void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries, int fib_threshold_prefix, int fib_threshold_aggregate)
 {
-    if (buf[0] == 0x04 && buf[1] == 0x82) {
-        struct ccnl_prefix_s *prefix = 0;
-        struct ccnl_content_s *c = 0;
-        struct ccnl_buf_s *nonce = 0, *ppkd = 0, *pkt = 0;
-        unsigned char *content, *data = buf + 2;
-        int contlen;
-
-        datalen -= 2;
-
-        pkt = ccnl_extract_prefix_nonce_ppkd(&data, &datalen, 0, 0,
-                                             0, 0, &prefix, &nonce, &ppkd, &content, &contlen);
+    DEBUGMSG(99, "ccnl_relay_config\n");
 
-        if (!pkt) {
-            DEBUGMSG(6, "  parsing error\n");
-            goto Done;
-        }
+    relay->max_cache_entries = max_cache_entries;
+    relay->max_cache_bytes = CCNL_DEFAULT_MAX_CACHE_BYTES;
+    relay->fib_threshold_prefix = fib_threshold_prefix;
+    relay->fib_threshold_aggregate = fib_threshold_aggregate;
+    relay->strategy = CCNL_DEFAULT_STRATEGY;
 
-        if (!prefix) {
-            DEBUGMSG(6, "  no prefix error\n");
-            goto Done;
-        }
+    if (RIOT_MSG_IDX != relay->ifcount) {
+        DEBUGMSG(1, "sorry, idx did not match: riot msg device\n");
+    }
 
-        printf("populating: %s\n", ccnl_prefix_to_path(prefix));
+    ccnl_relay_open_if(relay, ccnl_open_riotmsgdev(), &riot_send_msg, 4000);
 
-        c = ccnl_content_new(ccnl, &pkt, &prefix, &ppkd, content,
-                             contlen);
+    if (RIOT_TRANS_IDX != relay->ifcount) {
+        DEBUGMSG(1, "sorry, idx did not match: riot trans device\n");
+    }
 
-        if (!c) {
-            goto Done;
-        }
+#ifdef USE_FRAG
+    ccnl_relay_open_if(relay, ccnl_open_riottransdev(), &riot_send_transceiver, 120);
+#else
+    ccnl_relay_open_if(relay, ccnl_open_riottransdev(), &riot_send_transceiver, 1500);
+#endif
 
-        c->flags |= CCNL_CONTENT_FLAGS_STATIC;
-        if (!ccnl_content_add2cache(ccnl, c)) {
-            // content store error
-            free_content(c);
+    for (int k = RIOT_TRANS_IDX + 1; k < riot_ifcount; k++) {
+        if (k != relay->ifcount) {
+            DEBUGMSG(1, "sorry, idx did not match: interface %d\n", k);
+            break;
         }
 
-    Done:
-        free_prefix(prefix);
-        ccnl_free(pkt);
-        ccnl_free(nonce);
-        ccnl_free(ppkd);
-    }
-    else {
-        DEBUGMSG(6, "  not a content object\n");
+        ccnl_relay_open_if(relay, k + 1, riot_ifs[k].sendfunc, riot_ifs[k].mtu);
     }
 }
 
+#if RIOT_CCNL_POPULATE
+
 void handle_populate_cache(struct ccnl_relay_s *ccnl)
 {
+    /* the chunks stay where they are, the relay only indexes them */
     DEBUGMSG(1, "ccnl_populate_cache with: text_txt_ccnb\n");
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_0, (int) text_txt_ccnb_0_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_1, (int) text_txt_ccnb_1_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_2, (int) text_txt_ccnb_2_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_3, (int) text_txt_ccnb_3_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_4, (int) text_txt_ccnb_4_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_5, (int) text_txt_ccnb_5_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_6, (int) text_txt_ccnb_6_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_7, (int) text_txt_ccnb_7_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_8, (int) text_txt_ccnb_8_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_9, (int) text_txt_ccnb_9_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_10, (int) text_txt_ccnb_10_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_11, (int) text_txt_ccnb_11_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_12, (int) text_txt_ccnb_12_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_13, (int) text_txt_ccnb_13_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_14, (int) text_txt_ccnb_14_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_15, (int) text_txt_ccnb_15_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_16, (int) text_txt_ccnb_16_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_17, (int) text_txt_ccnb_17_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_18, (int) text_txt_ccnb_18_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_19, (int) text_txt_ccnb_19_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_20, (int) text_txt_ccnb_20_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_21, (int) text_txt_ccnb_21_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_22, (int) text_txt_ccnb_22_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_23, (int) text_txt_ccnb_23_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_24, (int) text_txt_ccnb_24_len);
-    ccnl_populate_cache(ccnl, (unsigned char *) text_txt_ccnb_25, (int) text_txt_ccnb_25_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_0, text_txt_ccnb_0_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_1, text_txt_ccnb_1_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_2, text_txt_ccnb_2_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_3, text_txt_ccnb_3_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_4, text_txt_ccnb_4_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_5, text_txt_ccnb_5_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_6, text_txt_ccnb_6_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_7, text_txt_ccnb_7_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_8, text_txt_ccnb_8_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_9, text_txt_ccnb_9_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_10, text_txt_ccnb_10_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_11, text_txt_ccnb_11_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_12, text_txt_ccnb_12_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_13, text_txt_ccnb_13_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_14, text_txt_ccnb_14_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_15, text_txt_ccnb_15_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_16, text_txt_ccnb_16_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_17, text_txt_ccnb_17_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_18, text_txt_ccnb_18_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_19, text_txt_ccnb_19_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_20, text_txt_ccnb_20_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_21, text_txt_ccnb_21_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_22, text_txt_ccnb_22_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_23, text_txt_ccnb_23_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_24, text_txt_ccnb_24_len);
+    ccnl_image_add(ccnl, text_txt_ccnb_25, text_txt_ccnb_25_len);
 }
 
 #endif
@@ -303,12 +291,19 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
     msg_t in;
     radio_packet_t *p;
     riot_ccnl_msg_t *m;
+    ccnl_riot_if_pkt_t *q;
 
     while (!ccnl->halt_flag) {
+        /* sleep until a message arrives or the next timer expires */
+        long usec = ccnl_run_events();
 
-        msg_receive(&in);
+        if (usec < 0) {
+            msg_receive(&in);
+        }
+        else if (vtimer_msg_receive_timeout(&in, timex_from_uint64(usec)) < 0) {
+            continue;
+        }
 
-        mutex_lock(&ccnl->global_lock);
         switch (in.type) {
             case PKT_PENDING:
                 /* msg from transceiver */
@@ -336,6 +331,21 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                              in.sender_pid);
                 break;
 
+            case (CCNL_RIOT_IF_PKT):
+                /* frame from an added interface */
+                q = (ccnl_riot_if_pkt_t *) in.content.ptr;
+                DEBUGMSG(1, "\tLength:\t%u\n", q->size);
+                DEBUGMSG(1, "\tSrc:\t%u\n", q->src);
+                DEBUGMSG(1, "\tIf:\t%d\n", q->ifndx);
+
+                if (q->ifndx > RIOT_TRANS_IDX && q->ifndx < ccnl->ifcount) {
+                    ccnl_core_RX(ccnl, q->ifndx, (unsigned char *) q->payload,
+                                 q->size, q->src ? q->src : RIOT_BROADCAST);
+                }
+
+                q->processing--;
+                break;
+
             case (CCNL_RIOT_HALT):
                 /* cmd to stop the relay */
                 DEBUGMSG(1, "\tSrc:\t%" PRIkernel_pid "\n", in.sender_pid);
@@ -359,6 +369,7 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 for (struct ccnl_face_s *f = ccnl->faces; f; f = f->next) {
                     ccnl_face_print_stat(f);
                 }
+                ccnl_pool_print_stats();
                 break;
 #endif
             case (CCNL_RIOT_CONFIG_CACHE):
@@ -366,6 +377,16 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 ccnl->max_cache_entries = in.content.value;
                 DEBUGMSG(1, "max_cache_entries set to %d\n", ccnl->max_cache_entries);
                 break;
+            case (CCNL_RIOT_CONFIG_CACHE_BYTES):
+                /* cmd to configure the byte budget of the cache at runtime */
+                ccnl->max_cache_bytes = in.content.value;
+                DEBUGMSG(1, "max_cache_bytes set to %d\n", ccnl->max_cache_bytes);
+                break;
+            case (CCNL_RIOT_CONFIG_STRATEGY):
+                /* cmd to choose the forwarding strategy at runtime */
+                ccnl->strategy = in.content.value;
+                DEBUGMSG(1, "strategy set to %d\n", ccnl->strategy);
+                break;
             case (ENOBUFFER):
                 /* transceiver has not enough buffer to store incoming packets, one packet is dropped  */
                 DEBUGMSG(1, "transceiver: one packet is dropped because buffers are full\n");
@@ -376,7 +397,6 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 DEBUGMSG(1, "\tdropping it...\n");
                 break;
         }
-        mutex_unlock(&ccnl->global_lock);
     }
 
     return 0;
@@ -394,47 +414,27 @@ void *ccnl_riot_relay_start(void *arg)
     theRelay = calloc(1, sizeof(struct ccnl_relay_s));
     ccnl_get_timeval(&theRelay->startup_time);
     theRelay->riot_pid = sched_active_pid;
-    mutex_init(&theRelay->global_lock);
 
     DEBUGMSG(1, "This is ccn-lite-relay, starting at %lu:%lu\n", theRelay->startup_time.tv_sec, theRelay->startup_time.tv_usec);
     DEBUGMSG(1, "  compile time: %s %s\n", __DATE__, __TIME__);
     DEBUGMSG(1, "  max_cache_entries: %d\n", CCNL_DEFAULT_MAX_CACHE_ENTRIES);
+    DEBUGMSG(1, "  max_cache_bytes: %d\n", CCNL_DEFAULT_MAX_CACHE_BYTES);
     DEBUGMSG(1, "  threshold_prefix: %d\n", CCNL_DEFAULT_THRESHOLD_PREFIX);
     DEBUGMSG(1, "  threshold_aggregate: %d\n", CCNL_DEFAULT_THRESHOLD_AGGREGATE);
 
     ccnl_relay_config(theRelay, CCNL_DEFAULT_MAX_CACHE_ENTRIES, CCNL_DEFAULT_THRESHOLD_PREFIX, CCNL_DEFAULT_THRESHOLD_AGGREGATE);
 
-    theRelay->riot_helper_pid = riot_start_helper_thread();
+    for (int k = 0; k < riot_imagecount; k++) {
+        ccnl_image_add(theRelay, riot_images[k].data, riot_images[k].len);
+    }
 
     ccnl_io_loop(theRelay);
     DEBUGMSG(1, "ioloop stopped\n");
 
-    while (eventqueue) {
-        ccnl_rem_timer(eventqueue);
-    }
-
     ccnl_core_cleanup(theRelay);
-
-    mutex_lock(&theRelay->stop_lock);
+    ccnl_timer_cleanup();
     ccnl_free(theRelay);
     return NULL;
 }
 
-void *ccnl_riot_relay_helper_start(void *arg)
-{
-    (void) arg;
-    unsigned long us = CCNL_CHECK_RETRANSMIT_USEC;
-    mutex_lock(&theRelay->stop_lock);
-    while (!theRelay->halt_flag) {
-        mutex_lock(&theRelay->global_lock);
-        ccnl_run_events();
-        mutex_unlock(&theRelay->global_lock);
-
-        vtimer_usleep(us);
-    }
-
-    mutex_unlock(&theRelay->stop_lock);
-    return NULL;
-}
-
 // eof
@@ -0,0 +1,386 @@
+/*
+ * @f ccnl-ccnb.c
+ * @b CCN lite, ccnb parsing into views of the received frame
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * ccnl_ccnb_parse() decodes an interest or a content object in a single
+ * pass and without allocating: the name components, nonce, ppkd and content
+ * of the resulting view point into the frame. Most packets are answered from
+ * the content store, are duplicates or join a known interest, so the relay
+ * copies a packet with ccnl_pkt_view_copy() only when it keeps it.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+#include "ccnx.h"
+
+// ----------------------------------------------------------------------
+// skipping elements
+
+// skips up to the end of the depth-th enclosing element, valptr gets the
+// last blob or udata on the way
+static int ccnl_ccnb_skip(unsigned char **buf, int *len, int depth,
+                          unsigned char **valptr, int *vallen)
+{
+    int num, typ;
+
+    while (depth > 0) {
+        if (dehead(buf, len, &num, &typ) != 0) {
+            return -1;
+        }
+
+        if (num == 0 && typ == 0) {
+            depth--;
+        }
+        else if (typ == CCN_TT_BLOB || typ == CCN_TT_UDATA) {
+            if (num > *len) {
+                return -1;
+            }
+
+            if (valptr) {
+                *valptr = *buf;
+            }
+
+            if (vallen) {
+                *vallen = num;
+            }
+
+            *buf += num, *len -= num;
+        }
+        else if (typ == CCN_TT_DTAG || typ == CCN_TT_DATTR) {
+            depth++;
+        }
+        else {
+            //  case CCN_TT_TAG, CCN_TT_ATTR:
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int hunt_for_end(unsigned char **buf, int *len, unsigned char **valptr,
+                 int *vallen)
+{
+    return ccnl_ccnb_skip(buf, len, 1, valptr, vallen);
+}
+
+int consume(int typ, int num, unsigned char **buf, int *len,
+            unsigned char **valptr, int *vallen)
+{
+    if (typ == CCN_TT_BLOB || typ == CCN_TT_UDATA) {
+        if (num > *len) {
+            return -1;
+        }
+
+        if (valptr) {
+            *valptr = *buf;
+        }
+
+        if (vallen) {
+            *vallen = num;
+        }
+
+        *buf += num, *len -= num;
+        return 0;
+    }
+
+    if (typ == CCN_TT_DTAG || typ == CCN_TT_DATTR) {
+        return hunt_for_end(buf, len, valptr, vallen);
+    }
+
+    //  case CCN_TT_TAG, CCN_TT_ATTR:
+    return -1;
+}
+
+static int data2uint(unsigned char *cp, int len)
+{
+    int i, val;
+
+    for (i = 0, val = 0; i < len; i++)
+        if (isdigit(cp[i])) {
+            val = 10 * val + cp[i] - '0';
+        }
+        else {
+            return -1;
+        }
+
+    return val;
+}
+
+// ----------------------------------------------------------------------
+// views
+
+static int ccnl_ccnb_parse_name(unsigned char **data, int *datalen,
+                                struct ccnl_pkt_view_s *v)
+{
+    int num, typ;
+
+    for (;;) {
+        if (dehead(data, datalen, &num, &typ) != 0) {
+            return -1;
+        }
+
+        if (num == 0 && typ == 0) {
+            return 0;
+        }
+
+        if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT
+            && v->compcnt < CCNL_MAX_NAME_COMP) {
+            // an empty component has no blob
+            v->comp[v->compcnt] = *data;
+            v->complen[v->compcnt] = 0;
+
+            if (hunt_for_end(data, datalen, v->comp + v->compcnt,
+                             v->complen + v->compcnt) < 0) {
+                return -1;
+            }
+
+            v->compcnt++;
+        }
+        else if (consume(typ, num, data, datalen, 0, 0) < 0) {
+            return -1;
+        }
+    }
+}
+
+static int ccnl_ccnb_parse_signedinfo(unsigned char **data, int *datalen,
+                                      struct ccnl_pkt_view_s *v)
+{
+    int num, typ;
+
+    for (;;) {
+        if (dehead(data, datalen, &num, &typ) != 0) {
+            return -1;
+        }
+
+        if (num == 0 && typ == 0) {
+            return 0;
+        }
+
+        if (typ == CCN_TT_DTAG && num == CCN_DTAG_FINALBLOCKID) {
+            if (hunt_for_end(data, datalen, &v->finalblock, &v->finalblocklen) < 0) {
+                return -1;
+            }
+        }
+        else if (consume(typ, num, data, datalen, 0, 0) < 0) {
+            return -1;
+        }
+    }
+}
+
+// *data points behind the 2 byte header of the interest or content object
+int ccnl_ccnb_parse(unsigned char **data, int *datalen, struct ccnl_pkt_view_s *v)
+{
+    unsigned char *cp;
+    int num, typ, len;
+    DEBUGMSG(99, "ccnl_ccnb_parse\n");
+
+    v->start = *data - 2;
+    v->compcnt = 0;
+    v->nonce = v->ppkd = v->content = v->finalblock = NULL;
+    v->noncelen = v->ppkdlen = v->contlen = v->finalblocklen = 0;
+    v->scope = 3;
+    v->aok = 3;
+    v->minsfx = 0;
+    v->maxsfx = CCNL_MAX_NAME_COMP;
+
+    while (dehead(data, datalen, &num, &typ) == 0) {
+        if (num == 0 && typ == 0) {
+            break;    // end
+        }
+
+        if (typ != CCN_TT_DTAG) {
+            if (consume(typ, num, data, datalen, 0, 0) < 0) {
+                return -1;
+            }
+
+            continue;
+        }
+
+        switch (num) {
+            case CCN_DTAG_NAME:
+                if (ccnl_ccnb_parse_name(data, datalen, v) < 0) {
+                    return -1;
+                }
+
+                break;
+
+            case CCN_DTAG_SCOPE:
+            case CCN_DTAG_NONCE:
+            case CCN_DTAG_MINSUFFCOMP:
+            case CCN_DTAG_MAXSUFFCOMP:
+            case CCN_DTAG_PUBPUBKDIGEST:
+                cp = *data;
+                len = 0;
+
+                if (hunt_for_end(data, datalen, &cp, &len) < 0) {
+                    return -1;
+                }
+
+                if (num == CCN_DTAG_SCOPE && len == 1) {
+                    v->scope = isdigit(*cp) && (*cp < '3') ? *cp - '0' : -1;
+                }
+                else if (num == CCN_DTAG_MINSUFFCOMP) {
+                    v->minsfx = data2uint(cp, len);
+                }
+                else if (num == CCN_DTAG_MAXSUFFCOMP) {
+                    v->maxsfx = data2uint(cp, len);
+                }
+                else if (num == CCN_DTAG_NONCE && !v->nonce) {
+                    v->nonce = cp;
+                    v->noncelen = len;
+                }
+                else if (num == CCN_DTAG_PUBPUBKDIGEST && !v->ppkd) {
+                    v->ppkd = cp;
+                    v->ppkdlen = len;
+                }
+
+                break;
+
+            case CCN_DTAG_SIGNEDINFO:
+                if (ccnl_ccnb_parse_signedinfo(data, datalen, v) < 0) {
+                    return -1;
+                }
+
+                break;
+
+            case CCN_DTAG_CONTENT:
+            case CCN_DTAG_CONTENTOBJ:
+                if (hunt_for_end(data, datalen, &v->content, &v->contlen) < 0) {
+                    return -1;
+                }
+
+                break;
+
+            default:
+                if (hunt_for_end(data, datalen, 0, 0) < 0) {
+                    return -1;
+                }
+        }
+    }
+
+    v->comp[v->compcnt] = NULL;
+    v->len = *data - v->start;
+    return 0;
+}
+
+// a prefix borrowing the components of v, valid as long as the frame is
+void ccnl_pkt_view_prefix(struct ccnl_pkt_view_s *v, struct ccnl_prefix_s *p)
+{
+    p->comp = v->comp;
+    p->complen = v->complen;
+    p->compcnt = v->compcnt;
+    p->path = NULL;
+}
+
+// copies the packet of v into a buffer, prefix and content point into it
+struct ccnl_buf_s *
+ccnl_pkt_view_copy(struct ccnl_pkt_view_s *v, struct ccnl_prefix_s **prefix,
+                   unsigned char **content)
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(v->start, v->len);
+
+    if (!buf) {
+        puts("can't get more memory from malloc, dropping ccn msg...");
+        return NULL;
+    }
+
+    if (prefix) {
+        *prefix = ccnl_prefix_new(v->compcnt);
+
+        if (!*prefix) {
+            puts("can't get more memory from malloc, dropping ccn msg...");
+            ccnl_buf_free(buf);
+            return NULL;
+        }
+
+        for (int k = 0; k < v->compcnt; k++) {
+            (*prefix)->comp[k] = buf->data + (v->comp[k] - v->start);
+            (*prefix)->complen[k] = v->complen[k];
+        }
+
+        (*prefix)->comp[v->compcnt] = NULL;
+        (*prefix)->compcnt = v->compcnt;
+    }
+
+    if (content) {
+        *content = v->content ? buf->data + (v->content - v->start) : NULL;
+    }
+
+    return buf;
+}
+
+struct ccnl_buf_s *
+ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
+                               int *aok, int *min, int *max, struct ccnl_prefix_s **prefix,
+                               struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkd,
+                               unsigned char **content, int *contlen)
+{
+    struct ccnl_pkt_view_s v;
+    struct ccnl_buf_s *buf, *n = NULL, *pub = NULL;
+    DEBUGMSG(99, "ccnl_extract_prefix\n");
+
+    if (ccnl_ccnb_parse(data, datalen, &v) < 0) {
+        return NULL;
+    }
+
+    if ((nonce && v.nonce && !(n = ccnl_buf_new(v.nonce, v.noncelen)))
+        || (ppkd && v.ppkd && !(pub = ccnl_buf_new(v.ppkd, v.ppkdlen)))
+        || !(buf = ccnl_pkt_view_copy(&v, prefix, content))) {
+        ccnl_buf_free(n);
+        ccnl_buf_free(pub);
+        return NULL;
+    }
+
+    if (scope) {
+        *scope = v.scope;
+    }
+
+    if (aok) {
+        *aok = v.aok;
+    }
+
+    if (min) {
+        *min = v.minsfx;
+    }
+
+    if (max) {
+        *max = v.maxsfx;
+    }
+
+    if (nonce) {
+        *nonce = n;
+    }
+
+    if (ppkd) {
+        *ppkd = pub;
+    }
+
+    if (contlen) {
+        *contlen = v.contlen;
+    }
+
+    return buf;
+}
+
+// eof
@@ -42,6 +42,11 @@
 static struct ccnl_interest_s *ccnl_interest_remove(struct ccnl_relay_s *ccnl,
         struct ccnl_interest_s *i);
 
+static void ccnl_interest_timer(void *relay, void *aux);
+
+struct ccnl_buf_s *ccnl_face_dequeue(struct ccnl_relay_s *ccnl,
+                                     struct ccnl_face_s *f);
+
 void ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                 sockunion *dest, struct ccnl_buf_s *buf);
 
@@ -64,17 +69,12 @@ void free_4ptr_list(void *a, void *b, void *c, void *d)
     ccnl_free(d);
 }
 
-void free_prefix(struct ccnl_prefix_s *p)
-{
-    if (p) {
-        free_4ptr_list(p->path, p->comp, p->complen, p);
-    }
-}
-
 void free_content(struct ccnl_content_s *c)
 {
     free_prefix(c->name);
-    free_2ptr_list(c->pkt, c);
+    ccnl_buf_free(c->pkt);
+    ccnl_buf_free(c->ppkd);
+    ccnl_pool_free(&ccnl_content_pool, c);
 }
 
 void free_forward(struct ccnl_forward_s *fwd)
@@ -86,30 +86,6 @@ void free_forward(struct ccnl_forward_s *fwd)
 // ----------------------------------------------------------------------
 // datastructure support functions
 
-struct ccnl_buf_s *
-ccnl_buf_new(void *data, int len)
-{
-    struct ccnl_buf_s *b = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*b) + len);
-
-    if (!b) {
-        return NULL;
-    }
-
-    b->next = NULL;
-    b->datalen = len;
-
-    if (data) {
-        memcpy(b->data, data, len);
-    }
-
-    return b;
-}
-
-struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B)
-{
-    return (B) ? ccnl_buf_new(B->data, B->datalen) : NULL;
-}
-
 int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y)
 {
     return ((X) && (Y) && (X->datalen == Y->datalen) && !memcmp(X->data, Y->data, X->datalen));
@@ -148,259 +124,36 @@ done:
 }
 
 // ----------------------------------------------------------------------
-// ccnb parsing support
+// addresses, interfaces and faces
 
-static int hunt_for_end(unsigned char **buf, int *len, unsigned char **valptr,
-                        int *vallen)
+/* Refreshing last_used leaves the timer of an entry alone, so a timer may
+ * fire early: it then moves to the actual deadline, and only reports the
+ * entry as expired once that has passed. */
+static int ccnl_timer_expired(struct ccnl_timer_s *t, struct timeval *last_used,
+                              long usec)
 {
-    int typ, num;
-
-    while (dehead(buf, len, &num, &typ) == 0) {
-        if (num == 0 && typ == 0) {
-            return 0;
-        }
+    struct timeval now;
+    ccnl_get_timeval(&now);
 
-        if (consume(typ, num, buf, len, valptr, vallen) < 0) {
-            return -1;
-        }
+    if (timevaldelta(&now, last_used) >= usec) {
+        return 1;
     }
 
-    return -1;
+    ccnl_timer_set(t, last_used, usec, t->fct, t->aux1, t->aux2);
+    return 0;
 }
 
-int consume(int typ, int num, unsigned char **buf, int *len,
-            unsigned char **valptr, int *vallen)
+static void ccnl_face_timer(void *relay, void *aux)
 {
-    if (typ == CCN_TT_BLOB || typ == CCN_TT_UDATA) {
-        if (valptr) {
-            *valptr = *buf;
-        }
-
-        if (vallen) {
-            *vallen = num;
-        }
+    struct ccnl_face_s *f = (struct ccnl_face_s *) aux;
 
-        *buf += num, *len -= num;
-        return 0;
-    }
-
-    if (typ == CCN_TT_DTAG || typ == CCN_TT_DATTR) {
-        return hunt_for_end(buf, len, valptr, vallen);
+    if (!(f->flags & CCNL_FACE_FLAGS_STATIC)
+        && ccnl_timer_expired(&f->timer, &f->last_used,
+                              TIMEOUT_TO_US(CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC))) {
+        ccnl_face_remove((struct ccnl_relay_s *) relay, f);
     }
-
-    //  case CCN_TT_TAG, CCN_TT_ATTR:
-    //  case DTAG, DATTR:
-    return -1;
 }
 
-static int data2uint(unsigned char *cp, int len)
-{
-    int i, val;
-
-    for (i = 0, val = 0; i < len; i++)
-        if (isdigit(cp[i])) {
-            val = 10 * val + cp[i] - '0';
-        }
-        else {
-            return -1;
-        }
-
-    return val;
-}
-
-struct ccnl_nonce_s *ccnl_nonce_new(struct ccnl_buf_s *that)
-{
-    struct ccnl_nonce_s *n = (struct ccnl_nonce_s *) ccnl_malloc(sizeof(struct ccnl_nonce_s));
-
-    n->buf = buf_dup(that);
-    ccnl_get_timeval(&n->created);
-
-    n->next = NULL;
-    n->prev = NULL;
-
-    return n;
-}
-
-struct ccnl_nonce_s *ccnl_nonce_remove(struct ccnl_relay_s *ccnl, struct ccnl_nonce_s *nonce)
-{
-    DEBUGMSG(99, "ccnl_nonce_remove: %u:%u:%u:%u\n",
-             nonce->buf->data[0], nonce->buf->data[1], nonce->buf->data[2], nonce->buf->data[3]);
-
-    struct ccnl_nonce_s *next = nonce->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->nonces, nonce);
-
-    free(nonce->buf);
-    free(nonce);
-
-    return next;
-}
-
-struct ccnl_buf_s *
-ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
-                               int *aok, int *min, int *max, struct ccnl_prefix_s **prefix,
-                               struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkd,
-                               unsigned char **content, int *contlen)
-{
-    unsigned char *start = *data - 2, *cp;
-    int num, typ, len;
-    struct ccnl_prefix_s *p;
-    struct ccnl_buf_s *buf, *n = 0, *pub = 0;
-    DEBUGMSG(99, "ccnl_extract_prefix\n");
-
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
-
-    if (!p) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-        return NULL;
-    }
-
-    p->comp = (unsigned char **) ccnl_malloc(
-                  CCNL_MAX_NAME_COMP * sizeof(unsigned char **));
-    p->complen = (int *) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
-
-    if (!p->comp || !p->complen) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-        goto Bail;
-    }
-
-    while (dehead(data, datalen, &num, &typ) == 0) {
-        if (num == 0 && typ == 0) {
-            break;    // end
-        }
-
-        if (typ == CCN_TT_DTAG) {
-            if (num == CCN_DTAG_NAME) {
-                while (1) {
-                    if (dehead(data, datalen, &num, &typ) != 0) {
-                        goto Bail;
-                    }
-
-                    if (num == 0 && typ == 0) {
-                        break;
-                    }
-
-                    if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT
-                        && p->compcnt < CCNL_MAX_NAME_COMP) {
-                        if (hunt_for_end(data, datalen, p->comp + p->compcnt,
-                                         p->complen + p->compcnt) < 0) {
-                            goto Bail;
-                        }
-
-                        p->compcnt++;
-                    }
-                    else {
-                        if (consume(typ, num, data, datalen, 0, 0) < 0) {
-                            goto Bail;
-                        }
-                    }
-                }
-
-                continue;
-            }
-
-            if (num == CCN_DTAG_SCOPE || num == CCN_DTAG_NONCE
-                || num == CCN_DTAG_MINSUFFCOMP
-                || num == CCN_DTAG_MAXSUFFCOMP
-                || num == CCN_DTAG_PUBPUBKDIGEST) {
-                if (hunt_for_end(data, datalen, &cp, &len) < 0) {
-                    goto Bail;
-                }
-
-                if (num == CCN_DTAG_SCOPE && len == 1 && scope) {
-                    *scope = isdigit(*cp) && (*cp < '3') ? *cp - '0' : -1;
-                }
-
-                if (num == CCN_DTAG_ANSWERORIGKIND && aok) {
-                    *aok = data2uint(cp, len);
-                }
-
-                if (num == CCN_DTAG_MINSUFFCOMP && min) {
-                    *min = data2uint(cp, len);
-                }
-
-                if (num == CCN_DTAG_MAXSUFFCOMP && max) {
-                    *max = data2uint(cp, len);
-                }
-
-                if (num == CCN_DTAG_NONCE && !n) {
-                    n = ccnl_buf_new(cp, len);
-                }
-
-                if (num == CCN_DTAG_PUBPUBKDIGEST && !pub) {
-                    pub = ccnl_buf_new(cp, len);
-                }
-
-                if (num == CCN_DTAG_EXCLUDE) {
-                    DEBUGMSG(49, "warning: 'exclude' field ignored\n");
-                }
-                else {
-                    continue;
-                }
-            }
-
-            if (num == CCN_DTAG_CONTENT || num == CCN_DTAG_CONTENTOBJ) {
-                if (consume(typ, num, data, datalen, content, contlen) < 0) {
-                    goto Bail;
-                }
-
-                continue;
-            }
-        }
-
-        if (consume(typ, num, data, datalen, 0, 0) < 0) {
-            goto Bail;
-        }
-    }
-
-    if (prefix) {
-        p->comp[p->compcnt] = NULL;
-        *prefix = p;
-    }
-    else {
-        free_prefix(p);
-    }
-
-    if (nonce) {
-        *nonce = n;
-    }
-    else {
-        ccnl_free(n);
-    }
-
-    if (ppkd) {
-        *ppkd = pub;
-    }
-    else {
-        ccnl_free(pub);
-    }
-
-    buf = ccnl_buf_new(start, *data - start);
-
-    if (!buf) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-    }
-
-    // carefully rebase ptrs to new buf because of 64bit pointers:
-    if (content) {
-        *content = buf->data + (*content - start);
-    }
-
-    for (num = 0; num < p->compcnt; num++) {
-        p->comp[num] = buf->data + (p->comp[num] - start);
-    }
-
-    return buf;
-Bail:
-    free_prefix(p);
-    free_2ptr_list(n, pub);
-    return NULL;
-}
-
-// ----------------------------------------------------------------------
-// addresses, interfaces and faces
-
-static void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
-
 int ccnl_addr_cmp(sockunion *s1, sockunion *s2)
 {
     return (s1->id == s2->id);
@@ -452,9 +205,7 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
     if (ifndx == RIOT_TRANS_IDX) {
         // if newly created face, no fragment policy is defined yet
         // turning on fragmentation for riot trans dev based faces
-        int flagval = CCNL_FACE_FLAGS_STATIC;
-        f->flags = flagval &
-                   (CCNL_FACE_FLAGS_STATIC | CCNL_FACE_FLAGS_REFLECT);
+        f->flags |= CCNL_FACE_FLAGS_STATIC;
 
         if (f->frag) {
             ccnl_frag_destroy(f->frag);
@@ -468,6 +219,16 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
 #endif
 
     ccnl_get_timeval(&f->last_used);
+
+    if (ccnl_timer_set(&f->timer, &f->last_used,
+                       TIMEOUT_TO_US(CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC),
+                       ccnl_face_timer, ccnl, f) < 0) {
+        ccnl_sched_destroy(f->sched);
+        ccnl_frag_destroy(f->frag);
+        ccnl_free(f);
+        return NULL;
+    }
+
     DBL_LINKED_LIST_ADD(ccnl->faces, f);
 
     return f;
@@ -478,7 +239,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
     struct ccnl_face_s *f2;
     struct ccnl_interest_s *pit;
-    struct ccnl_forward_s **ppfwd;
+    struct ccnl_forward_s *fwd;
     DEBUGMSG(1, "ccnl_face_remove relay=%p face=%p\n", (void *) ccnl, (void *) f);
 
     ccnl_sched_destroy(f->sched);
@@ -495,7 +256,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
             if ((*ppend)->face == f) {
                 pend = *ppend;
                 *ppend = pend->next;
-                ccnl_free(pend);
+                ccnl_pool_free(&ccnl_pendint_pool, pend);
             }
             else {
                 ppend = &(*ppend)->next;
@@ -510,22 +271,17 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
         }
     }
 
-    for (ppfwd = &ccnl->fib; *ppfwd;) {
-        if ((*ppfwd)->face == f) {
-            struct ccnl_forward_s *pfwd = *ppfwd;
-            *ppfwd = pfwd->next;
-
-            ccnl_forward_remove(ccnl, pfwd);
+    for (fwd = ccnl->fib; fwd;) {
+        if (fwd->face == f) {
+            fwd = ccnl_forward_remove(ccnl, fwd);
         }
         else {
-            ppfwd = &(*ppfwd)->next;
+            fwd = fwd->next;
         }
     }
 
-    while (f->outq) {
-        struct ccnl_buf_s *tmp = f->outq->next;
-        ccnl_free(f->outq);
-        f->outq = tmp;
+    while (f->outqlen > 0) {
+        ccnl_buf_free(ccnl_face_dequeue(ccnl, f));
     }
 
 #if ENABLE_DEBUG
@@ -534,6 +290,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 
     f2 = f->next;
     DBL_LINKED_LIST_REMOVE(ccnl->faces, f);
+    ccnl_timer_cancel(&f->timer);
     ccnl_free(f);
     return f2;
 }
@@ -541,7 +298,8 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 #if ENABLE_DEBUG
 void ccnl_face_print_stat(struct ccnl_face_s *f)
 {
-    DEBUGMSG(1, "ccnl_face_print_stat: faceid=%d ifndx=%d\n", f->faceid, f->ifndx);
+    DEBUGMSG(1, "ccnl_face_print_stat: faceid=%d ifndx=%d srtt=%ldus\n", f->faceid,
+             f->ifndx, f->srtt);
     DEBUGMSG(1, "  STAT interest send=%d:%d:%d:%d:%d\n", f->stat.send_interest[0],
              f->stat.send_interest[1], f->stat.send_interest[2],
              f->stat.send_interest[3], f->stat.send_interest[4]);
@@ -553,6 +311,18 @@ void ccnl_face_print_stat(struct ccnl_face_s *f)
     DEBUGMSG(1, "  STAT interest received=%d\n", f->stat.received_interest);
 
     DEBUGMSG(1, "  STAT content  received=%d\n", f->stat.received_content);
+
+#ifdef USE_FRAG
+    if (f->frag) {
+        struct ccnl_frag_stat_s *st = &f->frag->stat;
+
+        DEBUGMSG(1, "  STAT fragments sent=%u resent=%u lost=%u acks=%u\n",
+                 st->txfrags, st->txretrans, st->txlost, st->rxacks);
+        DEBUGMSG(1, "  STAT fragments received=%u dups=%u skipped=%u packets=%u acks=%u\n",
+                 st->rxfrags, st->rxdups, st->rxlost, st->rxpkts, st->txacks);
+        DEBUGMSG(1, "  STAT fragments resyncs=%u\n", st->resyncs);
+    }
+#endif
 }
 #endif
 
@@ -566,7 +336,7 @@ void ccnl_interface_cleanup(struct ccnl_if_s *i)
     for (j = 0; j < i->qlen; j++) {
         struct ccnl_txrequest_s *r = i->queue
                                      + (i->qfront + j) % CCNL_MAX_IF_QLEN;
-        ccnl_free(r->buf);
+        ccnl_buf_free(r->buf);
     }
 }
 
@@ -591,7 +361,7 @@ void ccnl_interface_CTS(void *aux1, void *aux2)
     ifc->qlen--;
 
     ccnl_ll_TX(ccnl, ifc, &req.dst, req.buf);
-    ccnl_free(req.buf);
+    ccnl_buf_free(req.buf);
 }
 
 void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
@@ -604,7 +374,7 @@ void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
 
     if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
         DEBUGMSG(2, "  DROPPING buf=%p\n", (void *) buf);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
         return;
     }
 
@@ -627,18 +397,13 @@ ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     DEBUGMSG(20, "ccnl_face_dequeue face=%p (id=%d.%d)\n", (void *) f, ccnl->id,
              f->faceid);
 
-    if (!f->outq) {
+    if (f->outqlen <= 0) {
         return NULL;
     }
 
-    pkt = f->outq;
-    f->outq = pkt->next;
-
-    if (!pkt->next) {
-        f->outqend = NULL;
-    }
-
-    pkt->next = NULL;
+    pkt = f->outq[f->outqfront];
+    f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+    f->outqlen--;
     return pkt;
 }
 
@@ -665,19 +430,44 @@ void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 
 #ifdef USE_FRAG
     else {
+        struct ccnl_buf_s *buf;
         sockunion dst;
         int ifndx = f->ifndx;
-        buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
 
-        if (!buf) {
-            buf = ccnl_face_dequeue(ccnl, f);
-            ccnl_frag_reset(f->frag, buf, f->ifndx, &f->peer);
-            buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
+        // acknowledgements first, they open the window of our peer
+        if ((buf = ccnl_frag_getack(f->frag))) {
+            ccnl_interface_enqueue(ccnl_face_CTS_done, f, ccnl,
+                                   ccnl->ifs + f->ifndx, buf, &f->peer);
         }
 
-        if (buf) {
+        // as many fragments as the window takes, the next packet is
+        // fragmented while the previous one is still in flight
+        for (;;) {
+            buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
+
+            if (!buf && ccnl_frag_nomorefragments(f->frag) && f->outqlen > 0
+                && ccnl_frag_winfree(f->frag)) {
+                ccnl_frag_reset(f->frag, ccnl_face_dequeue(ccnl, f), f->ifndx,
+                                &f->peer);
+                continue;
+            }
+
+            if (!buf) {
+                break;
+            }
+
             ccnl_interface_enqueue(ccnl_face_CTS_done, f,
                                    ccnl, ccnl->ifs + ifndx, buf, &dst);
+
+            // nobody acknowledges a broadcast
+            if (f->flags & CCNL_FACE_FLAGS_BROADCAST) {
+                ccnl_frag_tx_ack(f->frag, f->frag->sendseq, 0);
+            }
+        }
+
+        if (ccnl_frag_inflight(f->frag) && !f->frag->timer.pos) {
+            ccnl_timer_set(&f->frag->timer, NULL, CCNL_FRAG_RTO_USEC,
+                           ccnl_frag_timer, ccnl, f);
         }
     }
 
@@ -687,27 +477,25 @@ void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                       struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *msg;
     DEBUGMSG(20, "ccnl_face_enqueue face=%p (id=%d.%d) buf=%p len=%d\n",
              (void *) to, ccnl->id, to->faceid, (void *) buf, buf->datalen);
 
-    for (msg = to->outq; msg; msg = msg->next) // already in the queue?
-        if (buf_equal(msg, buf)) {
+    for (int k = 0; k < to->outqlen; k++) { // already in the queue?
+        if (buf_equal(to->outq[(to->outqfront + k) % CCNL_MAX_FACE_QLEN], buf)) {
             DEBUGMSG(31, "    not enqueued because already there\n");
-            ccnl_free(buf);
+            ccnl_buf_free(buf);
             return -1;
         }
-
-    buf->next = NULL;
-
-    if (to->outqend) {
-        to->outqend->next = buf;
     }
-    else {
-        to->outq = buf;
+
+    if (to->outqlen >= CCNL_MAX_FACE_QLEN) {
+        DEBUGMSG(2, "  DROPPING buf=%p\n", (void *) buf);
+        ccnl_buf_free(buf);
+        return -1;
     }
 
-    to->outqend = buf;
+    to->outq[(to->outqfront + to->outqlen) % CCNL_MAX_FACE_QLEN] = buf;
+    to->outqlen++;
     ccnl_face_CTS(ccnl, to);
     return 0;
 }
@@ -715,38 +503,53 @@ int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
 // ----------------------------------------------------------------------
 // handling of interest messages
 
-int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
-                              struct ccnl_buf_s *nonce)
+static uint32_t ccnl_nonce_now(void)
 {
-    struct ccnl_nonce_s *n, *last;
-    int i;
-    DEBUGMSG(99, "ccnl_nonce_find_or_append: %u:%u:%u:%u\n",
-             nonce->data[0], nonce->data[1], nonce->data[2], nonce->data[3]);
+    struct timeval now;
+    ccnl_get_timeval(&now);
+    return now.tv_sec * 1000 + now.tv_usec / 1000;
+}
 
-    /* test for noce in nonce cache */
+/* Nonces are kept in an open addressing table and probed in a fixed window
+ * of CCNL_NONCE_PROBES slots. Expired slots count as free, so there is
+ * neither a removal nor a sweep; a full window gives up its oldest nonce. */
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                              unsigned char *nonce, int noncelen)
+{
+    struct ccnl_nonce_s *n, *slot = NULL;
+    uint32_t now = ccnl_nonce_now();
+    uint32_t h = ccnl_hash_comp(CCNL_HASH_INIT, nonce, noncelen);
+    int len = noncelen < CCNL_NONCE_LEN ? noncelen : CCNL_NONCE_LEN;
+    DEBUGMSG(99, "ccnl_nonce_find_or_append: %d bytes\n", noncelen);
+
+    for (int k = 0; k < CCNL_NONCE_PROBES; k++) {
+        n = &ccnl->nonces[(h + k) & (CCNL_MAX_NONCES - 1)];
+
+        if (n->len == 0 || now - n->created > CCNL_NONCE_TIMEOUT_MS) {
+            /* free or expired */
+            if (!slot || slot->len != 0) {
+                slot = n;
+            }
+            continue;
+        }
 
-    for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        DEBUGMSG(1, "known: %u:%u:%u:%u\n",
-                 n->buf->data[0], n->buf->data[1], n->buf->data[2], n->buf->data[3]);
-        if (buf_equal(n->buf, nonce)) {
+        if (n->hash == h && n->len == len && !memcmp(n->data, nonce, len)) {
             /* nonce in cache -> known */
             return -1;
         }
-        if (n->next) {
-            last = n->next;
-        }
-    }
-
-    /* nonce not in local cache, add it */
-    n = ccnl_nonce_new(nonce);
-    DBL_LINKED_LIST_ADD(ccnl->nonces, n);
 
-    /* nonce chache full? */
-    if (i >= CCNL_MAX_NONCES) {
-        /* cache is full, drop oldest nonce: its the last element in the list */
-        ccnl_nonce_remove(ccnl, last);
+        if (!slot || (slot->len != 0 && (now - n->created) > (now - slot->created))) {
+            /* the oldest nonce of the window, unless a free slot exists */
+            slot = n;
+        }
     }
 
+    /* nonce not in local cache, add it (longer nonces are told apart by
+     * the hash of all their bytes) */
+    slot->hash = h;
+    slot->created = now;
+    slot->len = len;
+    memcpy(slot->data, nonce, len);
     return 0;
 }
 
@@ -755,8 +558,8 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                   struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, int minsuffix,
                   int maxsuffix, struct ccnl_buf_s **ppkd)
 {
-    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_calloc(1,
-                                sizeof(struct ccnl_interest_s));
+    struct ccnl_interest_s *i = (struct ccnl_interest_s *)
+                                ccnl_pool_calloc(&ccnl_interest_pool, sizeof(struct ccnl_interest_s));
     DEBUGMSG(99, "ccnl_new_interest\n");
 
     if (!i) {
@@ -774,6 +577,20 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     i->minsuffix = minsuffix;
     i->maxsuffix = maxsuffix;
     ccnl_get_timeval(&i->last_used);
+
+    if (ccnl_timer_set(&i->timer, &i->last_used,
+                       TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC),
+                       ccnl_interest_timer, ccnl, i) < 0
+        || ccnl_trie_add_interest(ccnl, i) < 0) {
+        ccnl_timer_cancel(&i->timer);
+        puts("can't get more memory from malloc, dropping ccn msg...");
+        free_prefix(i->prefix);
+        ccnl_buf_free(i->ppkd);
+        ccnl_buf_free(i->pkt);
+        ccnl_pool_free(&ccnl_interest_pool, i);
+        return NULL;
+    }
+
     DBL_LINKED_LIST_ADD(ccnl->pit, i);
     return i;
 }
@@ -794,7 +611,7 @@ int ccnl_interest_append_pending(struct ccnl_interest_s *i,
         last = pi;
     }
 
-    pi = (struct ccnl_pendint_s *) ccnl_calloc(1,
+    pi = (struct ccnl_pendint_s *) ccnl_pool_calloc(&ccnl_pendint_pool,
             sizeof(struct ccnl_pendint_s));
     DEBUGMSG(40, "  appending a new pendint entry %p\n", (void *) pi);
 
@@ -815,48 +632,176 @@ int ccnl_interest_append_pending(struct ccnl_interest_s *i,
     return 0;
 }
 
+// ----------------------------------------------------------------------
+// forwarding strategies
+
+static long ccnl_face_rtt(struct ccnl_face_s *f)
+{
+    return f->srtt ? f->srtt : CCNL_RTT_UNKNOWN_USEC;
+}
+
+// srtt += (sample - srtt) / 8, as TCP does
+static void ccnl_face_rtt_sample(struct ccnl_face_s *f, long usec)
+{
+    if (usec > CCNL_RTT_MAX_USEC) {
+        usec = CCNL_RTT_MAX_USEC;
+    }
+    else if (usec < 1) {
+        usec = 1;
+    }
+
+    f->srtt = f->srtt ? f->srtt + (usec - f->srtt) / 8 : usec;
+}
+
+// an unanswered interest doubles the estimate, so the face drops in rank
+static void ccnl_face_rtt_timeout(struct ccnl_face_s *f)
+{
+    long usec = 2 * ccnl_face_rtt(f);
+
+    f->srtt = usec > CCNL_RTT_MAX_USEC ? CCNL_RTT_MAX_USEC : usec;
+}
+
+// the FIB entries along the name of i with one entry per face, fastest
+// face first and longer prefixes first among equals; the origin of i is
+// left out unless it reflects
+static int ccnl_interest_nexthops(struct ccnl_relay_s *ccnl,
+                                  struct ccnl_interest_s *i,
+                                  struct ccnl_forward_s **hops)
+{
+    struct ccnl_trie_s *path[CCNL_MAX_NAME_COMP + 1];
+    int depth = ccnl_trie_path(ccnl, i->prefix, path), cnt = 0;
+
+    for (int k = depth - 1; k >= 0; k--) {
+        for (struct ccnl_forward_s *fwd = path[k]->fib; fwd; fwd = fwd->trie_next) {
+            int j;
+
+            if (i->from && fwd->face == i->from
+                && !(i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
+                continue;
+            }
+
+            for (j = 0; j < cnt && hops[j]->face != fwd->face; j++);
+
+            if (j < cnt || cnt == CCNL_MAX_NEXTHOPS) {
+                continue;
+            }
+
+            for (j = cnt++; j > 0 && ccnl_face_rtt(hops[j - 1]->face)
+                 > ccnl_face_rtt(fwd->face); j--) {
+                hops[j] = hops[j - 1];
+            }
+
+            hops[j] = fwd;
+        }
+    }
+
+    return cnt;
+}
+
+static void ccnl_interest_send(struct ccnl_relay_s *ccnl,
+                               struct ccnl_interest_s *i, struct ccnl_face_s *f)
+{
+    f->stat.send_interest[i->retries]++;
+    ccnl_face_enqueue(ccnl, f, buf_dup(i->pkt));
+}
+
 void ccnl_interest_propagate(struct ccnl_relay_s *ccnl,
                              struct ccnl_interest_s *i)
 {
-    struct ccnl_forward_s *fwd;
+    struct ccnl_forward_s *hops[CCNL_MAX_NEXTHOPS];
     DEBUGMSG(99, "ccnl_interest_propagate\n");
 
     // CONFORM: "A node MUST implement some strategy rule, even if it is only to
     // transmit an Interest Message on all listed dest faces in sequence."
-    // CCNL strategy: we forward on all FWD entries with a prefix match
-    int forward_cnt = 0;
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
-        int rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->prefix, CMP_LONGEST);
-        DEBUGMSG(40, "  ccnl_interest_propagate, rc=%d/%d\n", rc,
-                 fwd->prefix->compcnt);
-
-        if (rc < fwd->prefix->compcnt) {
-            continue;
+    // CCNL strategy: multicast forwards on all faces of FWD entries with a
+    // prefix match, best route only on the fastest of them; a retransmission
+    // goes to the next face if the fastest one did not answer
+    int cnt = ccnl_interest_nexthops(ccnl, i, hops);
+    int first = 0, last = cnt;
+
+    if (cnt > 0 && ccnl->strategy != CCNL_STRATEGY_MULTICAST) {
+        if (i->retries > 0 && cnt > 1 && hops[0] == i->forwarded_over) {
+            first = 1;
+        }
+
+        last = first + 1;
+
+        // adaptive: now and then the runner-up gets a copy as well, so its
+        // rtt is known when the fastest face degrades
+        if (ccnl->strategy == CCNL_STRATEGY_ADAPTIVE && i->retries == 0
+            && cnt > 1 && ++ccnl->probe_cnt >= CCNL_STRATEGY_PROBE_INTERVAL) {
+            DEBUGMSG(40, "  probing face %d\n", hops[1]->face->faceid);
+            ccnl->probe_cnt = 0;
+            last = 2;
+        }
+    }
+
+    ccnl_get_timeval(&i->last_used);
+
+    for (int k = first; k < last; k++) {
+        DEBUGMSG(40, "  ccnl_interest_propagate, fwd==%p\n", (void *) hops[k]);
+        i->forwarded_over = hops[k];
+        ccnl_interest_send(ccnl, i, hops[k]->face);
+        hops[k]->last_used = i->last_used;
+    }
+
+    if (cnt == 0) {
+        DEBUGMSG(40, "  ccnl_interest_propagate: using broadcast faces!\n");
+
+        for (int k = 0; k < ccnl->ifcount; k++) {
+            if (k != RIOT_MSG_IDX && ccnl->ifs[k].broadcast_face) {
+                ccnl_interest_send(ccnl, i, ccnl->ifs[k].broadcast_face);
+            }
         }
+    }
 
-        DEBUGMSG(40, "  ccnl_interest_propagate, fwd==%p\n", (void *) fwd);
+    // the next retransmission is due a period after this one
+    ccnl_timer_set(&i->timer, &i->last_used,
+                   TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC),
+                   ccnl_interest_timer, ccnl, i);
+}
 
-        // suppress forwarding to origin of interest, except wireless
-        if (!i->from || fwd->face != i->from
-            || (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
+static void ccnl_interest_timer(void *relay, void *aux)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s *) relay;
+    struct ccnl_interest_s *i = (struct ccnl_interest_s *) aux;
+
+    // CONFORM: "Entries in the PIT MUST timeout rather
+    // than being held indefinitely."
+    if (i->retries <= CCNL_MAX_INTEREST_RETRANSMIT) {
+        // CONFORM: "A node MUST retransmit Interest Messages
+        // periodically for pending PIT entries."
+        DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
+                 ccnl_prefix_to_path(i->prefix));
+
+        if (i->forwarded_over && ccnl->strategy != CCNL_STRATEGY_MULTICAST) {
+            ccnl_face_rtt_timeout(i->forwarded_over->face);
+        }
 
-            i->forwarded_over = fwd;
-            fwd->face->stat.send_interest[i->retries]++;
-            ccnl_get_timeval(&i->last_used);
-            ccnl_face_enqueue(ccnl, fwd->face, buf_dup(i->pkt));
-            ccnl_get_timeval(&fwd->last_used);
-            forward_cnt++;
+        if (i->forwarded_over
+            && !(i->forwarded_over->flags & CCNL_FORWARD_FLAGS_STATIC)
+            && (i->retries >= CCNL_MAX_INTEREST_OPTIMISTIC)) {
+            DEBUGMSG(1, "  removed dynamic forward %p\n", (void *) i->forwarded_over);
+            ccnl_forward_remove(ccnl, i->forwarded_over);
         }
+
+        i->retries++;
+        ccnl_interest_propagate(ccnl, i);
+        return;
+    }
+
+    if (!ccnl_timer_expired(&i->timer, &i->last_used,
+                            TIMEOUT_TO_US(CCNL_INTEREST_TIMEOUT_SEC, CCNL_INTEREST_TIMEOUT_USEC))) {
+        return;
     }
 
-    if (forward_cnt == 0) {
-        DEBUGMSG(40, "  ccnl_interest_propagate: using broadcast face!\n");
-        ccnl->ifs[RIOT_TRANS_IDX].broadcast_face->stat.send_interest[i->retries]++;
-        ccnl_get_timeval(&i->last_used);
-        ccnl_face_enqueue(ccnl, ccnl->ifs[RIOT_TRANS_IDX].broadcast_face, buf_dup(i->pkt));
+    if (i->from && i->from->ifndx == RIOT_MSG_IDX) {
+        /* this interest was requested by an app from this node */
+        /* inform this app about this problem */
+        riot_send_nack(i->from->faceid);
     }
 
-    return;
+    ccnl_interest_remove(ccnl, i);
 }
 
 struct ccnl_interest_s *
@@ -867,14 +812,18 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 
     while (i->pending) {
         struct ccnl_pendint_s *tmp = i->pending->next;
-        ccnl_free(i->pending);
+        ccnl_pool_free(&ccnl_pendint_pool, i->pending);
         i->pending = tmp;
     }
 
     i2 = i->next;
     DBL_LINKED_LIST_REMOVE(ccnl->pit, i);
+    ccnl_timer_cancel(&i->timer);
+    ccnl_trie_remove_interest(ccnl, i);
     free_prefix(i->prefix);
-    free_3ptr_list(i->ppkd, i->pkt, i);
+    ccnl_buf_free(i->ppkd);
+    ccnl_buf_free(i->pkt);
+    ccnl_pool_free(&ccnl_interest_pool, i);
     return i2;
 }
 
@@ -922,7 +871,8 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
     //    DEBUGMSG(99, "ccnl_content_new <%s>\n",
     //            prefix == NULL ? NULL : ccnl_prefix_to_path(*prefix));
 
-    c = (struct ccnl_content_s *) ccnl_calloc(1, sizeof(struct ccnl_content_s));
+    c = (struct ccnl_content_s *) ccnl_pool_calloc(&ccnl_content_pool,
+            sizeof(struct ccnl_content_s));
 
     if (!c) {
         return NULL;
@@ -944,58 +894,6 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
     return c;
 }
 
-struct ccnl_content_s *
-ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
-{
-    struct ccnl_content_s *c2;
-    DEBUGMSG(99, "ccnl_content_remove: %s\n", ccnl_prefix_to_path(c->name));
-
-    c2 = c->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
-    free_content(c);
-    ccnl->contentcnt--;
-    return c2;
-}
-
-struct ccnl_content_s *
-ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
-{
-    DEBUGMSG(99, "ccnl_content_add2cache (%d/%d)\n", ccnl->contentcnt,
-             ccnl->max_cache_entries);
-
-    if (ccnl->max_cache_entries <= 0) {
-        DEBUGMSG(1, "  content store disabled...\n");
-        return NULL;
-    }
-
-    while (ccnl->max_cache_entries <= ccnl->contentcnt) {
-        DEBUGMSG(1, "  remove Least Recently Used content...\n");
-        struct ccnl_content_s *c2, *lru = NULL;
-
-        for (c2 = ccnl->contents; c2; c2 = c2->next) {
-            DEBUGMSG(1, "    '%s' -> %ld:%ld\n", ccnl_prefix_to_path(c2->name), c2->last_used.tv_sec, c2->last_used.tv_usec);
-            if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC)
-                && ((!lru) || timevaldelta(&c2->last_used, &lru->last_used) < 0)) {
-                lru = c2;
-            }
-        }
-
-        if (lru) {
-            DEBUGMSG(1, "   replaced: '%s'\n", ccnl_prefix_to_path(lru->name));
-            ccnl_content_remove(ccnl, lru);
-        }
-        else {
-            DEBUGMSG(1, "   no dynamic content to remove...\n");
-            break;
-        }
-    }
-
-    DEBUGMSG(1, "  add new content to store: '%s'\n", ccnl_prefix_to_path(c->name));
-    DBL_LINKED_LIST_ADD(ccnl->contents, c);
-    ccnl->contentcnt++;
-    return c;
-}
-
 // deliver new content c to all clients with (loosely) matching interest,
 // but only one copy per face
 // returns: number of forwards
@@ -1005,49 +903,74 @@ int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
 {
     struct ccnl_interest_s *i;
     struct ccnl_face_s *f;
+    struct ccnl_trie_s *path[CCNL_MAX_NAME_COMP + 2];
+    struct timeval now;
     int cnt = 0;
     DEBUGMSG(99, "ccnl_content_serve_pending\n");
 
+    ccnl_get_timeval(&now);
+
     for (f = ccnl->faces; f; f = f->next) {
         f->flags &= ~CCNL_FACE_FLAGS_SERVED;    // reply on a face only once
     }
 
-    for (i = ccnl->pit; i;) {
-        struct ccnl_pendint_s *pi;
+    // matching interests are named by a prefix of the content name, or by
+    // the full name plus the digest of the content
+    int depth = ccnl_trie_path(ccnl, c->name, path);
 
-        if (!ccnl_i_prefixof_c(i->prefix, i->ppkd, i->minsuffix, i->maxsuffix,
-                               c)) {
-            i = i->next;
-            continue;
-        }
+    if (depth == c->name->compcnt + 1 && path[depth - 1]->children) {
+        path[depth] = ccnl_trie_child(ccnl, path[depth - 1],
+                                      compute_ccnx_digest(c->pkt), 32);
+        depth += (path[depth] != NULL);
+    }
 
-        // CONFORM: "Data MUST only be transmitted in response to
-        // an Interest that matches the Data."
-        for (pi = i->pending; pi; pi = pi->next) {
-            if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
+    // shorter names first: removing their interests never frees a node
+    // further down the path
+    for (int k = 0; k < depth; k++) {
+        for (i = path[k]->pit; i;) {
+            struct ccnl_pendint_s *pi;
+
+            if (!ccnl_i_prefixof_c(i->prefix, i->ppkd, i->minsuffix, i->maxsuffix,
+                                   c)) {
+                i = i->trie_next;
                 continue;
             }
 
-            if (pi->face == from) {
-                // the existing pending interest is from the same face
-                // as the newly arrived content is...no need to send content back
-                DEBUGMSG(1, "  detected looping content, before loop could happen\n");
-                continue;
+            // Karn: a retransmitted interest does not tell which copy was answered
+            if (from && i->retries == 0) {
+                ccnl_face_rtt_sample(from, timevaldelta(&now, &i->last_used));
             }
 
-            pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
+            // CONFORM: "Data MUST only be transmitted in response to
+            // an Interest that matches the Data."
+            for (pi = i->pending; pi; pi = pi->next) {
+                if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
+                    continue;
+                }
+
+                if (pi->face == from) {
+                    // the existing pending interest is from the same face
+                    // as the newly arrived content is...no need to send content back
+                    DEBUGMSG(1, "  detected looping content, before loop could happen\n");
+                    continue;
+                }
+
+                pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
 
-            DEBUGMSG(6, "  forwarding content <%s>\n",
-                     ccnl_prefix_to_path(c->name));
-            pi->face->stat.send_content[c->served_cnt % CCNL_MAX_CONTENT_SERVED_STAT]++;
-            ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
+                DEBUGMSG(6, "  forwarding content <%s>\n",
+                         ccnl_prefix_to_path(c->name));
+                pi->face->stat.send_content[c->served_cnt % CCNL_MAX_CONTENT_SERVED_STAT]++;
+                ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
 
-            c->served_cnt++;
-            ccnl_get_timeval(&c->last_used);
-            cnt++;
-        }
+                c->served_cnt++;
+                ccnl_get_timeval(&c->last_used);
+                cnt++;
+            }
 
-        i = ccnl_interest_remove(ccnl, i);
+            struct ccnl_interest_s *next = i->trie_next;
+            ccnl_interest_remove(ccnl, i);
+            i = next;
+        }
     }
 
     return cnt;
@@ -1064,29 +987,49 @@ struct ccnl_forward_s *ccn_forward_find_common_prefix_to_aggregate(struct ccnl_r
         return NULL;
     }
 
-    /* fib as at least one enty */
-    struct ccnl_forward_s *fwd2 = ccnl->fib;
-    while (fwd2) {
-        DEBUGMSG(1, "ccn_forward_find_common_prefix: '%s' vs. '%s'\n", ccnl_prefix_to_path(p), ccnl_prefix_to_path(fwd2->prefix));
-        *match_len = ccnl_prefix_cmp(fwd2->prefix, 0, p, CMP_LONGEST);
+    /* the trie knows which subtrees hold dynamic entries, never date up a static enty */
+    return ccnl_trie_find_aggregate(ccnl, p, ccnl->fib_threshold_aggregate, match_len);
+}
 
-        /* check for threshold and never date up a static enty */
-        if ((ccnl->fib_threshold_aggregate <= *match_len) && !(fwd2->flags & CCNL_FORWARD_FLAGS_STATIC)) {
-            return fwd2;
-        }
+// dynamic FIB entries expire CCNL_FWD_TIMEOUT after their last use
+static void ccnl_forward_timer(void *relay, void *aux)
+{
+    struct ccnl_forward_s *fwd = (struct ccnl_forward_s *) aux;
 
-        fwd2 = fwd2->next;
+    if (ccnl_timer_expired(&fwd->timer, &fwd->last_used,
+                           TIMEOUT_TO_US(CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC))) {
+        ccnl_forward_remove((struct ccnl_relay_s *) relay, fwd);
     }
-
-    return NULL;
 }
 
-static struct ccnl_forward_s *ccnl_forward_new(struct ccnl_prefix_s *p, struct ccnl_face_s *f, int threshold_prefix, int flags)
+static struct ccnl_forward_s *ccnl_forward_add(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, struct ccnl_face_s *f, int threshold_prefix, int flags)
 {
     struct ccnl_forward_s *fwd = ccnl_calloc(1, sizeof(struct ccnl_forward_s));
+
+    if (!fwd) {
+        return NULL;
+    }
+
     fwd->prefix = ccnl_prefix_clone_strip(p, threshold_prefix);
     fwd->face = f;
     fwd->flags = flags;
+    ccnl_get_timeval(&fwd->last_used);
+
+    if (!(flags & CCNL_FORWARD_FLAGS_STATIC)
+        && ccnl_timer_set(&fwd->timer, &fwd->last_used,
+                          TIMEOUT_TO_US(CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC),
+                          ccnl_forward_timer, ccnl, fwd) < 0) {
+        free_forward(fwd);
+        return NULL;
+    }
+
+    if (!fwd->prefix || ccnl_trie_add_forward(ccnl, fwd) < 0) {
+        ccnl_timer_cancel(&fwd->timer);
+        free_forward(fwd);
+        return NULL;
+    }
+
+    DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
     return fwd;
 }
 
@@ -1102,8 +1045,10 @@ void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix
         /* there was no prefix match with the user defined creteria. */
 
         /* create a new fib entry */
-        fwd = ccnl_forward_new(p, f, threshold_prefix, flags);
-        DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
+        fwd = ccnl_forward_add(ccnl, p, f, threshold_prefix, flags);
+        if (!fwd) {
+            return;
+        }
         DEBUGMSG(999, "ccnl_content_learn_name_route: new route '%s' on face %d learned\n", ccnl_prefix_to_path(fwd->prefix), f->faceid);
     }
     else {
@@ -1112,11 +1057,13 @@ void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix
         /* if the new entry has shorter prefix */
         if (p->compcnt < fwd->prefix->compcnt) {
             /* we need to aggregate! */
-            DBL_LINKED_LIST_REMOVE(ccnl->fib, fwd);
+            ccnl_forward_remove(ccnl, fwd);
 
             /* create a new fib entry */
-            fwd = ccnl_forward_new(p, f, (p->compcnt - match_len), flags);
-            DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
+            fwd = ccnl_forward_add(ccnl, p, f, (p->compcnt - match_len), flags);
+            if (!fwd) {
+                return;
+            }
             DEBUGMSG(999, "ccnl_content_learn_name_route: route '%s' on face %d replaced\n", ccnl_prefix_to_path(fwd->prefix), f->faceid);
         }
         else {
@@ -1137,6 +1084,8 @@ ccnl_forward_remove(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
 
     fwd2 = fwd->next;
     DBL_LINKED_LIST_REMOVE(ccnl->fib, fwd);
+    ccnl_timer_cancel(&fwd->timer);
+    ccnl_trie_remove_forward(ccnl, fwd);
 
     for (struct ccnl_interest_s *p = ccnl->pit; p; p = p->next) {
         if (p->forwarded_over == fwd) {
@@ -1149,122 +1098,6 @@ ccnl_forward_remove(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
     return fwd2;
 }
 
-bool ccnl_is_timed_out(struct timeval *now, struct timeval *last_used, uint32_t timeout_s, uint32_t timeout_us)
-{
-    timex_t time = timex_set(timeout_s, timeout_us);
-    timex_normalize(&time);
-    struct timeval abs_timeout = { last_used->tv_sec + time.seconds, last_used->tv_usec + time.microseconds };
-    return timevaldelta(now, &abs_timeout) > 0;
-}
-
-void ccnl_do_retransmit(void *ptr, void *dummy)
-{
-    (void) dummy; /* unused */
-
-    struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-
-    for (struct ccnl_interest_s *i = relay->pit; i; i = i->next) {
-        // CONFORM: "Entries in the PIT MUST timeout rather
-        // than being held indefinitely."
-        if(i->retries <= CCNL_MAX_INTEREST_RETRANSMIT) {
-            // CONFORM: "A node MUST retransmit Interest Messages
-            // periodically for pending PIT entries."
-            DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
-                     ccnl_prefix_to_path(i->prefix));
-
-            if (i->forwarded_over
-                && !(i->forwarded_over->flags & CCNL_FORWARD_FLAGS_STATIC)
-                && (i->retries >= CCNL_MAX_INTEREST_OPTIMISTIC)) {
-                DEBUGMSG(1, "  removed dynamic forward %p\n", (void *) i->forwarded_over);
-                ccnl_forward_remove(relay, i->forwarded_over);
-            }
-
-            i->retries++;
-            ccnl_interest_propagate(relay, i);
-        }
-    }
-}
-
-void ccnl_do_nonce_timeout(void *ptr, void *dummy)
-{
-    (void) dummy; /* unused */
-
-    struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-
-    struct timeval now;
-    ccnl_get_timeval(&now);
-    //DEBUGMSG(99, "ccnl_do_nonce_timeout: %lu:%lu\n", now.tv_sec, now.tv_usec);
-
-    for (struct ccnl_nonce_s *n = relay->nonces; n;) {
-        if (ccnl_is_timed_out(&now, &n->created, CCNL_NONCE_TIMEOUT_SEC, CCNL_NONCE_TIMEOUT_USEC)) {
-            n = ccnl_nonce_remove(relay, n);
-        } else {
-            n = n->next;
-        }
-    }
-}
-
-void ccnl_do_ageing(void *ptr, void *dummy)
-{
-
-    (void) dummy; /* unused */
-
-    struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-    struct ccnl_interest_s *i = relay->pit;
-    struct ccnl_content_s *c = relay->contents;
-
-    struct ccnl_face_s *f = relay->faces;
-    struct timeval now;
-    ccnl_get_timeval(&now);
-    //DEBUGMSG(999, "ccnl_do_ageing %ld:%ld\n", now.tv_sec, now.tv_usec);
-
-    while (i) {
-        if (ccnl_is_timed_out(&now, &i->last_used, CCNL_INTEREST_TIMEOUT_SEC,
-                CCNL_INTEREST_TIMEOUT_USEC)) {
-            if (i->from->ifndx == RIOT_MSG_IDX) {
-                /* this interest was requested by an app from this node */
-                /* inform this app about this problem */
-                riot_send_nack(i->from->faceid);
-            }
-            i = ccnl_interest_remove(relay, i);
-        }
-        else {
-            i = i->next;
-        }
-    }
-
-    while (c) {
-        if (ccnl_is_timed_out(&now, &c->last_used, CCNL_CONTENT_TIMEOUT_SEC, CCNL_CONTENT_TIMEOUT_USEC)
-            && !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-            c = ccnl_content_remove(relay, c);
-        }
-        else {
-            c = c->next;
-        }
-    }
-
-    while (f) {
-        if (!(f->flags & CCNL_FACE_FLAGS_STATIC)
-            && ccnl_is_timed_out(&now, &f->last_used, CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC)) {
-            f = ccnl_face_remove(relay, f);
-        }
-        else {
-            f = f->next;
-        }
-    }
-
-    struct ccnl_forward_s *fwd = relay->fib;
-    while (fwd) {
-        if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)
-            && ccnl_is_timed_out(&now, &fwd->last_used, CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC)) {
-            fwd = ccnl_forward_remove(relay, fwd);
-        }
-        else {
-            fwd = fwd->next;
-        }
-    }
-}
-
 void ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 {
     int k;
@@ -1278,13 +1111,9 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
         ccnl_face_remove(ccnl, ccnl->faces);    // also removes all FWD entries
     }
 
-    while (ccnl->contents) {
-        ccnl_content_remove(ccnl, ccnl->contents);
-    }
-
-    while (ccnl->nonces) {
-        ccnl_nonce_remove(ccnl, ccnl->nonces);
-    }
+    ccnl_content_cleanup(ccnl);
+    ccnl_image_cleanup(ccnl);
+    ccnl_trie_cleanup(ccnl);
 
     for (k = 0; k < ccnl->ifcount; k++) {
         ccnl_interface_cleanup(ccnl->ifs + k);
@@ -1297,50 +1126,58 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                         unsigned char **data, int *datalen)
 {
-    int rc = -1, scope = 3, aok = 3, minsfx = 0, maxsfx = CCNL_MAX_NAME_COMP,
-        contlen;
-    struct ccnl_buf_s *buf = 0, *nonce = 0, *ppkd = 0;
+    int rc = -1;
+    struct ccnl_pkt_view_s v;
+    struct ccnl_prefix_s name; // borrows the components of the view
+    struct ccnl_buf_s *buf = 0, *ppkd = 0;
     struct ccnl_interest_s *i = 0;
     struct ccnl_content_s *c = 0;
     struct ccnl_prefix_s *p = 0;
     unsigned char *content = 0;
     DEBUGMSG(1, "ccnl_core_RX_i_or_c: (%d bytes left)\n", *datalen);
 
-    buf = ccnl_extract_prefix_nonce_ppkd(data, datalen, &scope, &aok, &minsfx,
-                                         &maxsfx, &p, &nonce, &ppkd, &content, &contlen);
+    // the packet is only copied below where the relay keeps it
+    if (ccnl_ccnb_parse(data, datalen, &v) < 0) {
+        DEBUGMSG(6, "  parsing error\n");
+        goto Done;
+    }
+
+    ccnl_pkt_view_prefix(&v, &name);
 
-    if (!buf) {
-        DEBUGMSG(6, "  parsing error or no prefix\n");
+    if (v.ppkd && !(ppkd = ccnl_buf_new(v.ppkd, v.ppkdlen))) {
         goto Done;
     }
 
-    if (nonce && ccnl_nonce_find_or_append(relay, nonce)) {
+    if (v.nonce && ccnl_nonce_find_or_append(relay, v.nonce, v.noncelen)) {
         DEBUGMSG(6, "  dropped because of duplicate nonce\n");
         goto Skip;
     }
 
-    if (buf->data[0] == 0x01 && buf->data[1] == 0xd2) { // interest
-        DEBUGMSG(1, "ccnl_core_RX_i_or_c: interest=<%s>\n", ccnl_prefix_to_path(p));
+    if (v.start[0] == 0x01 && v.start[1] == 0xd2) { // interest
+        DEBUGMSG(1, "ccnl_core_RX_i_or_c: interest=<%s>\n", ccnl_prefix_to_path(&name));
         from->stat.received_interest++;
 
-        if (p->compcnt > 0 && p->comp[0][0] == (unsigned char) 0xc1) {
+        if (v.compcnt > 0 && v.complen[0] > 0 && v.comp[0][0] == (unsigned char) 0xc1) {
             goto Skip;
         }
 
-        if (p->compcnt == 4 && !memcmp(p->comp[0], "ccnx", 4)) {
+        if (v.compcnt == 4 && v.complen[0] == 4 && !memcmp(v.comp[0], "ccnx", 4)) {
             DEBUGMSG(1, "it's a mgnt msg!\n");
-            rc = ccnl_mgmt(relay, buf, p, from);
+            buf = ccnl_pkt_view_copy(&v, &p, NULL);
+
+            if (buf) {
+                rc = ccnl_mgmt(relay, buf, p, from);
+            }
+
             DEBUGMSG(1, "mgnt processing done!\n");
             goto Done;
         }
 
         // CONFORM: Step 1:
-        if (aok & 0x01) { // honor "answer-from-existing-content-store" flag
-            for (c = relay->contents; c; c = c->next) {
-                if (!ccnl_i_prefixof_c(p, ppkd, minsfx, maxsfx, c)) {
-                    continue;
-                }
+        if (v.aok & 0x01) { // honor "answer-from-existing-content-store" flag
+            c = ccnl_content_lookup(relay, &name, ppkd, v.minsfx, v.maxsfx);
 
+            if (c) {
                 // FIXME: should check stale bit in aok here
                 DEBUGMSG(7, "  matching content for interest, content %p\n",
                          (void *) c);
@@ -1353,29 +1190,42 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
                 goto Skip;
             }
-        }
 
-        // CONFORM: Step 2: check whether interest is already known
-        for (i = relay->pit; i; i = i->next) {
-            if (!ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT)
-                && i->minsuffix == minsfx && i->maxsuffix == maxsfx
-                && ((!ppkd && !i->ppkd) || buf_equal(ppkd, i->ppkd))) {
-                break;
+            // static content is answered from the image it is stored in
+            buf = ccnl_image_lookup(relay, &name, ppkd, v.minsfx, v.maxsfx);
+
+            if (buf) {
+                DEBUGMSG(7, "  matching content for interest in the image\n");
+                from->stat.send_content[0]++;
+
+                if (from->ifndx >= 0) {
+                    ccnl_face_enqueue(relay, from, buf);
+                    buf = NULL;
+                }
+
+                goto Skip;
             }
         }
 
+        // CONFORM: Step 2: check whether interest is already known
+        i = ccnl_trie_find_interest(relay, &name, v.minsfx, v.maxsfx, ppkd);
+
         if (!i) { // this is a new/unknown I request: create and propagate
-            i = ccnl_interest_new(relay, from, &buf, &p, minsfx, maxsfx, &ppkd);
+            buf = ccnl_pkt_view_copy(&v, &p, NULL);
+
+            if (buf) {
+                i = ccnl_interest_new(relay, from, &buf, &p, v.minsfx, v.maxsfx, &ppkd);
+            }
 
             if (i) { // CONFORM: Step 3 (and 4)
                 DEBUGMSG(7, "  created new interest entry %p\n", (void *) i);
 
-                if (scope > 2) {
+                if (v.scope > 2) {
                     ccnl_interest_propagate(relay, i);
                 }
             }
         }
-        else if (scope > 2 && (from->flags & CCNL_FACE_FLAGS_FWDALLI)) {
+        else if (v.scope > 2 && (from->flags & CCNL_FACE_FLAGS_FWDALLI)) {
             DEBUGMSG(7, "  old interest, nevertheless propagated %p\n",
                      (void *) i);
             ccnl_interest_propagate(relay, i);
@@ -1387,18 +1237,22 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         }
     }
     else {   // content
-        DEBUGMSG(6, "  content=<%s>\n", ccnl_prefix_to_path(p));
+        DEBUGMSG(6, "  content=<%s>\n", ccnl_prefix_to_path(&name));
         from->stat.received_content++;
 
         // CONFORM: Step 1:
-        for (c = relay->contents; c; c = c->next) {
-            if (buf_equal(c->pkt, buf)) {
-                DEBUGMSG(1, "content is dup: skip\n");
-                goto Skip;
-            }
+        if (ccnl_content_find_dup(relay, &name, v.start, v.len)) {
+            DEBUGMSG(1, "content is dup: skip\n");
+            goto Skip;
+        }
+
+        buf = ccnl_pkt_view_copy(&v, &p, &content);
+
+        if (!buf) {
+            goto Done;
         }
 
-        c = ccnl_content_new(relay, &buf, &p, &ppkd, content, contlen);
+        c = ccnl_content_new(relay, &buf, &p, &ppkd, content, v.contlen);
 
         if (c) { // CONFORM: Step 2 (and 3)
             if (!ccnl_content_serve_pending(relay, c, from)) { // unsolicited content
@@ -1416,7 +1270,10 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
             if (relay->max_cache_entries != 0) { // it's set to -1 or a limit
                 DEBUGMSG(7, "  adding content to cache\n");
-                ccnl_content_add2cache(relay, c);
+
+                if (!ccnl_content_add2cache(relay, c)) {
+                    free_content(c);
+                }
             }
             else {
                 DEBUGMSG(7, "  content not added to cache\n");
@@ -1429,7 +1286,8 @@ Skip:
     rc = 0;
 Done:
     free_prefix(p);
-    free_3ptr_list(buf, nonce, ppkd);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(ppkd);
     DEBUGMSG(1, "leaving\n");
     return rc;
 }
@@ -1489,6 +1347,13 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, unsigned char *data,
     DEBUGMSG(1, "ccnl_core_RX: faceid=%d frag=%p\n", from->faceid, (void *) from->frag);
 
     ccnl_core_RX_datagram(relay, from, &data, &datalen);
+
+#ifdef USE_FRAG
+    // acknowledgements are due, or our window has moved
+    if (from->frag) {
+        ccnl_face_CTS(relay, from);
+    }
+#endif
 }
 
 // eof
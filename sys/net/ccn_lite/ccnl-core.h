@@ -47,6 +47,7 @@
 #define CCNL_FORWARD_FLAGS_STATIC  0x01
 
 #include <inttypes.h>
+#include <stdbool.h>
 #include <time.h>
 #include <sys/time.h>
 
@@ -82,16 +83,61 @@ struct ccnl_if_s { // interface for packet IO
     struct ccnl_face_s *broadcast_face;
 };
 
+// node of the name trie indexing PIT, FIB and content store, one per name
+// component
+struct ccnl_trie_s {
+    struct ccnl_trie_s *parent;
+    struct ccnl_trie_s *children, *sibling;
+    struct ccnl_trie_s *index_next; // collision chain of trie_index
+    uint32_t hash;      // hash of the name up to and including this component
+    int refs;           // children and entries referring to this node
+    int dynfwd;         // dynamic FIB entries in this subtree
+    int cached;         // cached contents in this subtree
+    struct ccnl_interest_s *pit; // interests for exactly this name
+    struct ccnl_forward_s *fib;  // FIB entries for exactly this prefix
+    struct ccnl_content_s *cs;   // cached contents with exactly this name
+    int complen;
+    unsigned char comp[1];
+};
+
+struct ccnl_timer_s {
+    struct timeval timeout;
+    void (*fct)(void *aux1, void *aux2);
+    void *aux1;
+    void *aux2;
+    int pos; // in the event heap, 0: not armed
+};
+
+struct ccnl_nonce_s {
+    uint32_t hash;      // of all bytes of the nonce
+    uint32_t created;   // in ms
+    uint8_t len;        // 0: free slot
+    unsigned char data[CCNL_NONCE_LEN];
+};
+
 struct ccnl_relay_s {
     struct timeval startup_time;
     int id;
     struct ccnl_face_s *faces;
     struct ccnl_forward_s *fib;
     struct ccnl_interest_s *pit;
-    struct ccnl_content_s *contents; //, *contentsend;
-    struct ccnl_nonce_s *nonces;
+    struct ccnl_trie_s trie;    // root, the empty name
+    struct ccnl_trie_s **trie_index; // hashed trie nodes, see ccnl-trie.c
+    int trie_index_size;
+    int trie_nodes;
+    struct ccnl_content_s *contents; // most recently used first
+    struct ccnl_content_s *contents_lru; // tail of contents, next to evict
+    struct ccnl_content_s **content_index; // hashed exact names, see ccnl-cs.c
+    int content_index_size;
+    struct ccnl_timer_s content_timer; // expiry of contents_lru
+    struct ccnl_image_entry_s *image; // read-only content, sorted by name
+    int imagecnt;
+    int image_size;
+    struct ccnl_nonce_s nonces[CCNL_MAX_NONCES]; // see ccnl_nonce_find_or_append
     int contentcnt;     // number of cached items
+    int contentbytes;   // size of the cached packets
     int max_cache_entries;  // -1: unlimited
+    int max_cache_bytes;    // 0: no limit besides max_cache_entries
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;        // number of active interfaces
     char halt_flag;
@@ -104,22 +150,20 @@ struct ccnl_relay_s {
     void *aux;
     int fib_threshold_prefix; /* how may name components should be considdered as dynamic */
     int fib_threshold_aggregate;
+    int strategy;       // CCNL_STRATEGY_*, see ccnl_interest_propagate
+    unsigned int probe_cnt; // interests until the adaptive strategy probes
     kernel_pid_t riot_pid;
-    kernel_pid_t riot_helper_pid;
-    mutex_t global_lock;
-    mutex_t stop_lock;
 };
 
 struct ccnl_buf_s {
-    struct ccnl_buf_s *next;
     unsigned int datalen;
-    unsigned char data[1];
+    unsigned short refs; // buf_dup() shares, ccnl_buf_free() releases
+    unsigned char *data; // behind the buffer, or borrowed, see ccnl_buf_borrow
 };
 
-struct ccnl_nonce_s {
-    struct ccnl_nonce_s *next, *prev;
-    struct timeval created;
-    struct ccnl_buf_s *buf;
+struct ccnl_image_entry_s {
+    const unsigned char *pkt; // a content object of an image, see ccnl-image.c
+    unsigned int len;
 };
 
 struct ccnl_prefix_s {
@@ -136,6 +180,19 @@ struct ccnl_stat_s {
     int received_content;
 };
 
+struct ccnl_frag_stat_s {
+    unsigned int txfrags;   // fragments sent
+    unsigned int txretrans; // fragments sent again
+    unsigned int txlost;    // fragments given up after CCNL_FRAG_MAX_RETRIES
+    unsigned int txacks;
+    unsigned int rxfrags;   // fragments received
+    unsigned int rxdups;    // fragments received twice
+    unsigned int rxlost;    // fragments the sender gave up on
+    unsigned int rxacks;
+    unsigned int rxpkts;    // packets reassembled
+    unsigned int resyncs;   // sequence numbers restarted by either side
+};
+
 struct ccnl_frag_s {
     int protocol; // (0=plain CCNx)
     int mtu;
@@ -154,6 +211,18 @@ struct ccnl_frag_s {
     unsigned char sendseqwidth;
     unsigned char losscountwidth;
     unsigned char recvseqwidth;
+
+    // sliding window of CCNx2013, slots are indexed by seq % CCNL_FRAG_WINDOW
+    unsigned int txbase;    // oldest fragment sent and not acknowledged
+    struct ccnl_buf_s *txwin[CCNL_FRAG_WINDOW]; // NULL: acknowledged
+    unsigned char txtries[CCNL_FRAG_WINDOW];
+    unsigned char txresend[CCNL_FRAG_WINDOW];
+    struct ccnl_timer_s timer; // retransmission of unacknowledged fragments
+    struct ccnl_buf_s *rxwin[CCNL_FRAG_WINDOW]; // received ahead of recvseq
+    unsigned char rxflags[CCNL_FRAG_WINDOW];
+    unsigned char rxsinceack;
+    unsigned char ackdue;
+    struct ccnl_frag_stat_s stat;
 };
 
 struct ccnl_face_s {
@@ -163,23 +232,31 @@ struct ccnl_face_s {
     sockunion peer;
     int flags;
     struct timeval last_used; // updated when we receive a packet
-    struct ccnl_buf_s *outq, *outqend; // queue of packets to send
+    struct ccnl_timer_s timer; // checks last_used for expiry
+    struct ccnl_buf_s *outq[CCNL_MAX_FACE_QLEN]; // ring of packets to send
+    int outqfront, outqlen;
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
+    long srtt; // smoothed round trip time of interests in us, 0: unknown
 
     struct ccnl_stat_s stat;
 };
 
 struct ccnl_forward_s {
     struct ccnl_forward_s *next, *prev;
+    struct ccnl_trie_s *trie;
+    struct ccnl_forward_s *trie_next;
     struct ccnl_prefix_s *prefix;
     struct ccnl_face_s *face;
     int flags;
     struct timeval last_used; // updated when we use this fib entry
+    struct ccnl_timer_s timer; // checks last_used for expiry
 };
 
 struct ccnl_interest_s {
     struct ccnl_interest_s *next, *prev;
+    struct ccnl_trie_s *trie;
+    struct ccnl_interest_s *trie_next;
     struct ccnl_face_s *from;
     struct ccnl_pendint_s *pending; // linked list of faces wanting that content
     struct ccnl_prefix_s *prefix;
@@ -187,6 +264,7 @@ struct ccnl_interest_s {
     struct ccnl_buf_s *ppkd;       // publisher public key digest
     struct ccnl_buf_s *pkt;    // full datagram
     struct timeval last_used;
+    struct ccnl_timer_s timer; // next retransmission or expiry
     int retries;
     struct ccnl_forward_s *forwarded_over;
 };
@@ -199,6 +277,10 @@ struct ccnl_pendint_s { // pending interest
 
 struct ccnl_content_s {
     struct ccnl_content_s *next, *prev;
+    struct ccnl_content_s *index_next; // collision chain of content_index
+    struct ccnl_trie_s *trie;
+    struct ccnl_content_s *trie_next;
+    uint32_t namehash;
     struct ccnl_prefix_s *name;
     struct ccnl_buf_s *ppkd; // publisher public key digest
     struct ccnl_buf_s *pkt; // full datagram
@@ -211,6 +293,20 @@ struct ccnl_content_s {
     int served_cnt;
 };
 
+// a parsed interest or content object, see ccnl-ccnb.c
+struct ccnl_pkt_view_s {
+    unsigned char *start; // of the received packet, including its header
+    int len;
+    unsigned char *comp[CCNL_MAX_NAME_COMP + 1]; // NULL terminated
+    int complen[CCNL_MAX_NAME_COMP];
+    int compcnt;
+    unsigned char *nonce, *ppkd, *content;
+    int noncelen, ppkdlen, contlen;
+    unsigned char *finalblock; // FinalBlockID of a content object, the last chunk
+    int finalblocklen;
+    int scope, aok, minsfx, maxsfx;
+};
+
 // ----------------------------------------------------------------------
 // macros for double linked lists (these double linked lists are not rings)
 
@@ -233,15 +329,78 @@ const char *compile_string(void);
 int consume(int typ, int num, unsigned char **buf, int *len,
             unsigned char **valptr, int *vallen);
 
+int hunt_for_end(unsigned char **buf, int *len, unsigned char **valptr,
+                 int *vallen);
+
+int ccnl_ccnb_parse(unsigned char **data, int *datalen, struct ccnl_pkt_view_s *v);
+
+void ccnl_pkt_view_prefix(struct ccnl_pkt_view_s *v, struct ccnl_prefix_s *p);
+
+struct ccnl_buf_s *
+ccnl_pkt_view_copy(struct ccnl_pkt_view_s *v, struct ccnl_prefix_s **prefix,
+                   unsigned char **content);
+
 void
 ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, unsigned char *data,
              int datalen, uint16_t sender_id);
 
+void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries,
+                       int fib_threshold_prefix, int fib_threshold_aggregate);
+
 void ccnl_core_cleanup(struct ccnl_relay_s *ccnl);
 
+struct ccnl_pool_s {
+    const char *name;
+    unsigned int size;      // of an object
+    unsigned int count;     // objects in mem
+    unsigned char *mem;
+    void *free;             // released objects, linked through their first word
+    unsigned int fresh;     // objects of mem handed out at least once
+    unsigned int used;
+    unsigned int peak;
+    unsigned int fallbacks; // requests served by ccnl_malloc
+};
+
+extern struct ccnl_pool_s ccnl_interest_pool, ccnl_pendint_pool,
+       ccnl_content_pool;
+extern struct ccnl_pool_s *const ccnl_pools[];  // NULL terminated
+
+void *ccnl_pool_alloc(struct ccnl_pool_s *pool, unsigned int size);
+
+void *ccnl_pool_calloc(struct ccnl_pool_s *pool, unsigned int size);
+
+void ccnl_pool_free(struct ccnl_pool_s *pool, void *p);
+
+void ccnl_pool_print_stats(void);
+
 struct ccnl_buf_s *
 ccnl_buf_new(void *data, int len);
 
+struct ccnl_buf_s *
+ccnl_buf_borrow(const void *data, int len);
+
+struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B);
+
+void ccnl_buf_free(struct ccnl_buf_s *B);
+
+struct ccnl_prefix_s *ccnl_prefix_new(int compcnt);
+
+int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y);
+
+// 0 for a nonce not seen within CCNL_NONCE_TIMEOUT_MS, it is remembered
+// then, -1 for a known one
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                              unsigned char *nonce, int noncelen);
+
+struct ccnl_interest_s *
+ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
+                  struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, int minsuffix,
+                  int maxsuffix, struct ccnl_buf_s **ppkd);
+
+int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
+                               struct ccnl_content_s *c,
+                               struct ccnl_face_s *from);
+
 struct ccnl_content_s *
 ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
                  struct ccnl_prefix_s **prefix, struct ccnl_buf_s **ppkd,
@@ -250,6 +409,70 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
 struct ccnl_content_s *
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+struct ccnl_content_s *
+ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+struct ccnl_content_s *
+ccnl_content_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                    struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix);
+
+struct ccnl_content_s *
+ccnl_content_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name,
+                      unsigned char *pkt, int pktlen);
+
+
+void ccnl_content_cleanup(struct ccnl_relay_s *ccnl);
+
+int ccnl_image_add(struct ccnl_relay_s *ccnl, const unsigned char *image, int len);
+
+struct ccnl_buf_s *
+ccnl_image_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                  struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix);
+
+void ccnl_image_cleanup(struct ccnl_relay_s *ccnl);
+
+#define CCNL_HASH_INIT  2166136261u
+
+uint32_t ccnl_hash_comp(uint32_t h, unsigned char *comp, int complen);
+
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int compcnt);
+
+int ccnl_trie_add_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+
+void ccnl_trie_remove_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+
+struct ccnl_interest_s *
+ccnl_trie_find_interest(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                        int minsuffix, int maxsuffix, struct ccnl_buf_s *ppkd);
+
+int ccnl_trie_add_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd);
+
+void ccnl_trie_remove_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd);
+
+struct ccnl_forward_s *
+ccnl_trie_find_aggregate(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                         int threshold, int *match_len);
+
+int ccnl_trie_add_content(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+void ccnl_trie_remove_content(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+struct ccnl_content_s *
+ccnl_trie_find_content(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                       struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix);
+
+int ccnl_trie_path(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                   struct ccnl_trie_s **path);
+
+struct ccnl_trie_s *
+ccnl_trie_child(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *node,
+                unsigned char *comp, int complen);
+
+void ccnl_trie_cleanup(struct ccnl_relay_s *ccnl);
+
+int ccnl_i_prefixof_c(struct ccnl_prefix_s *prefix, struct ccnl_buf_s *ppkd,
+                      int minsuffix, int maxsuffix, struct ccnl_content_s *c);
+
 void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
                                    struct ccnl_face_s *f, int threshold_prefix, int flags);
 
@@ -259,6 +482,11 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
 int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                       struct ccnl_buf_s *buf);
 
+void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+
+int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                        unsigned char **data, int *datalen);
+
 struct ccnl_face_s *
 ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 
@@ -271,9 +499,7 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
                                struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkd,
                                unsigned char **content, int *contlen);
 
-void ccnl_do_retransmit(void *ptr, void *dummy);
-void ccnl_do_ageing(void *ptr, void *dummy);
-void ccnl_do_nonce_timeout(void *ptr, void *dummy);
+void ccnl_content_timer(void *relay, void *dummy);
 
 void ccnl_interface_CTS(void *aux1, void *aux2);
 
@@ -0,0 +1,360 @@
+/*
+ * @f ccnl-cs.c
+ * @b CCN lite, content store with hashed name index and LRU/LFU eviction
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * The cached contents form a double linked list ordered by last use, the
+ * most recently used entry first. A hit moves the entry to the front, so
+ * the victim is found at relay->contents_lru without looking at the others.
+ * content_index maps the hash of a content name to its entries, the
+ * names are also entered into the name trie (ccnl-trie.c), so an interest
+ * allowing a suffix only walks the contents below its prefix.
+ * A single timer watches the least recently used dynamic entry, the one to
+ * expire first, and is armed only while the store holds dynamic content.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-platform.h"
+
+#define CCNL_CONTENT_TIMEOUT TIMEOUT_TO_US(CCNL_CONTENT_TIMEOUT_SEC, CCNL_CONTENT_TIMEOUT_USEC)
+
+// ----------------------------------------------------------------------
+// name index
+
+uint32_t ccnl_hash_comp(uint32_t h, unsigned char *comp, int complen)
+{
+    /* FNV-1a over the component and its length */
+    h = (h ^ (uint32_t) complen) * 16777619u;
+
+    for (int j = 0; j < complen; j++) {
+        h = (h ^ comp[j]) * 16777619u;
+    }
+
+    return h;
+}
+
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int compcnt)
+{
+    uint32_t h = CCNL_HASH_INIT;
+
+    for (int i = 0; i < compcnt; i++) {
+        h = ccnl_hash_comp(h, p->comp[i], p->complen[i]);
+    }
+
+    return h;
+}
+
+static struct ccnl_content_s **
+ccnl_cs_bucket(struct ccnl_relay_s *ccnl, uint32_t h)
+{
+    return &ccnl->content_index[h & (ccnl->content_index_size - 1)];
+}
+
+static void ccnl_cs_index_add(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s **bucket = ccnl_cs_bucket(ccnl, c->namehash);
+
+    c->index_next = *bucket;
+    *bucket = c;
+}
+
+static void ccnl_cs_index_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s **pp;
+
+    if (!ccnl->content_index) {
+        return;
+    }
+
+    for (pp = ccnl_cs_bucket(ccnl, c->namehash); *pp; pp = &(*pp)->index_next) {
+        if (*pp == c) {
+            *pp = c->index_next;
+            return;
+        }
+    }
+}
+
+// keeps the load factor below 2, the old index stays on allocation failure
+static int ccnl_cs_index_grow(struct ccnl_relay_s *ccnl)
+{
+    int size = ccnl->content_index_size ? ccnl->content_index_size * 2
+               : CCNL_CS_INDEX_MIN_SIZE;
+    struct ccnl_content_s **index, *c;
+
+    if (ccnl->content_index && ccnl->contentcnt < 2 * ccnl->content_index_size) {
+        return 0;
+    }
+
+    index = (struct ccnl_content_s **) ccnl_calloc(size, sizeof(*index));
+
+    if (!index) {
+        return ccnl->content_index ? 0 : -1;
+    }
+
+    DEBUGMSG(1, "  content index grows to %d buckets\n", size);
+    ccnl_free(ccnl->content_index);
+    ccnl->content_index = index;
+    ccnl->content_index_size = size;
+
+    for (c = ccnl->contents; c; c = c->next) {
+        ccnl_cs_index_add(ccnl, c);
+    }
+
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// recency list
+
+static void ccnl_cs_unlink(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    if (ccnl->contents_lru == c) {
+        ccnl->contents_lru = c->prev;
+    }
+
+    DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
+    c->next = c->prev = NULL;
+}
+
+static void ccnl_cs_push(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    DBL_LINKED_LIST_ADD(ccnl->contents, c);
+
+    if (!ccnl->contents_lru) {
+        ccnl->contents_lru = c;
+    }
+}
+
+static void ccnl_cs_touch(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    ccnl_get_timeval(&c->last_used);
+
+    if (ccnl->contents != c) {
+        ccnl_cs_unlink(ccnl, c);
+        ccnl_cs_push(ccnl, c);
+    }
+}
+
+static struct ccnl_content_s *ccnl_cs_victim(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_content_s *c, *victim = NULL;
+#if CCNL_CS_POLICY == CCNL_CS_POLICY_LFU
+    int candidates = 0;
+
+    // the least often served of the least recently used entries
+    for (c = ccnl->contents_lru; c && candidates < CCNL_CS_LFU_SAMPLE; c = c->prev) {
+        if (c->flags & CCNL_CONTENT_FLAGS_STATIC) {
+            continue;
+        }
+
+        if (!victim || c->served_cnt < victim->served_cnt) {
+            victim = c;
+        }
+
+        candidates++;
+    }
+#else
+    for (c = ccnl->contents_lru; c; c = c->prev) {
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            victim = c;
+            break;
+        }
+    }
+#endif
+    return victim;
+}
+
+static int ccnl_cs_full(struct ccnl_relay_s *ccnl, int size)
+{
+    if (ccnl->max_cache_entries > 0 && ccnl->contentcnt >= ccnl->max_cache_entries) {
+        return 1;
+    }
+
+    return ccnl->max_cache_bytes > 0 && ccnl->contentcnt > 0
+           && ccnl->contentbytes + size > ccnl->max_cache_bytes;
+}
+
+// ----------------------------------------------------------------------
+
+struct ccnl_content_s *
+ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s *c2;
+    DEBUGMSG(99, "ccnl_content_remove: %s\n", ccnl_prefix_to_path(c->name));
+
+    c2 = c->next;
+    ccnl_cs_index_remove(ccnl, c);
+    ccnl_trie_remove_content(ccnl, c);
+    ccnl_cs_unlink(ccnl, c);
+    ccnl->contentbytes -= c->pkt->datalen;
+    free_content(c);
+    ccnl->contentcnt--;
+    return c2;
+}
+
+struct ccnl_content_s *
+ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    DEBUGMSG(99, "ccnl_content_add2cache (%d/%d, %d/%d bytes)\n", ccnl->contentcnt,
+             ccnl->max_cache_entries, ccnl->contentbytes, ccnl->max_cache_bytes);
+
+    if (ccnl->max_cache_entries == 0) {
+        DEBUGMSG(1, "  content store disabled...\n");
+        return NULL;
+    }
+
+    if (ccnl->max_cache_bytes > 0 && (int) c->pkt->datalen > ccnl->max_cache_bytes) {
+        DEBUGMSG(1, "  content exceeds the cache budget...\n");
+        return NULL;
+    }
+
+    while (ccnl_cs_full(ccnl, c->pkt->datalen)) {
+        struct ccnl_content_s *victim = ccnl_cs_victim(ccnl);
+
+        if (!victim) {
+            DEBUGMSG(1, "   no dynamic content to remove...\n");
+            break;
+        }
+
+        DEBUGMSG(1, "   replaced: '%s'\n", ccnl_prefix_to_path(victim->name));
+        ccnl_content_remove(ccnl, victim);
+    }
+
+    if (ccnl_cs_index_grow(ccnl) < 0 || ccnl_trie_add_content(ccnl, c) < 0) {
+        return NULL;
+    }
+
+    if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC) && !ccnl->content_timer.pos
+        && ccnl_timer_set(&ccnl->content_timer, &c->last_used, CCNL_CONTENT_TIMEOUT,
+                          ccnl_content_timer, ccnl, NULL) < 0) {
+        ccnl_trie_remove_content(ccnl, c);
+        return NULL;
+    }
+
+    DEBUGMSG(1, "  add new content to store: '%s'\n", ccnl_prefix_to_path(c->name));
+    c->namehash = ccnl_prefix_hash(c->name, c->name->compcnt);
+    ccnl_cs_push(ccnl, c);
+    ccnl_cs_index_add(ccnl, c);
+    ccnl->contentcnt++;
+    ccnl->contentbytes += c->pkt->datalen;
+    return c;
+}
+
+struct ccnl_content_s *
+ccnl_content_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                    struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix)
+{
+    struct ccnl_content_s *c;
+
+    if (!ccnl->contents) {
+        return NULL;
+    }
+
+    /* exact name first, then the name with an implicit digest component */
+    for (int n = prefix->compcnt; n >= 0 && n >= prefix->compcnt - 1; n--) {
+        uint32_t h = ccnl_prefix_hash(prefix, n);
+
+        for (c = *ccnl_cs_bucket(ccnl, h); c; c = c->index_next) {
+            if (c->namehash == h && c->name->compcnt == n
+                && ccnl_i_prefixof_c(prefix, ppkd, minsuffix, maxsuffix, c)) {
+                ccnl_cs_touch(ccnl, c);
+                return c;
+            }
+        }
+    }
+
+    /* content names longer than the prefix only match with a suffix */
+    if (maxsuffix < 2) {
+        return NULL;
+    }
+
+    if ((c = ccnl_trie_find_content(ccnl, prefix, ppkd, minsuffix, maxsuffix))) {
+        ccnl_cs_touch(ccnl, c);
+    }
+
+    return c;
+}
+
+struct ccnl_content_s *
+ccnl_content_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name,
+                      unsigned char *pkt, int pktlen)
+{
+    struct ccnl_content_s *c;
+    uint32_t h;
+
+    if (!ccnl->contents) {
+        return NULL;
+    }
+
+    h = ccnl_prefix_hash(name, name->compcnt);
+
+    for (c = *ccnl_cs_bucket(ccnl, h); c; c = c->index_next) {
+        if (c->namehash == h && (int) c->pkt->datalen == pktlen
+            && !memcmp(c->pkt->data, pkt, pktlen)) {
+            return c;
+        }
+    }
+
+    return NULL;
+}
+
+void ccnl_content_timer(void *relay, void *dummy)
+{
+    (void) dummy; /* unused */
+
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s *) relay;
+    struct ccnl_content_s *c = ccnl->contents_lru, *prev;
+    struct timeval now;
+    ccnl_get_timeval(&now);
+
+    /* ordered by last use: stop at the first entry still valid and wait
+     * for it to expire */
+    while (c) {
+        prev = c->prev;
+
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            if (timevaldelta(&now, &c->last_used) < CCNL_CONTENT_TIMEOUT) {
+                ccnl_timer_set(&ccnl->content_timer, &c->last_used,
+                               CCNL_CONTENT_TIMEOUT, ccnl_content_timer, ccnl, NULL);
+                break;
+            }
+
+            ccnl_content_remove(ccnl, c);
+        }
+
+        c = prev;
+    }
+}
+
+void ccnl_content_cleanup(struct ccnl_relay_s *ccnl)
+{
+    ccnl_timer_cancel(&ccnl->content_timer);
+
+    while (ccnl->contents) {
+        ccnl_content_remove(ccnl, ccnl->contents);
+    }
+
+    ccnl_free(ccnl->content_index);
+    ccnl->content_index = NULL;
+    ccnl->content_index_size = 0;
+}
+
+// eof
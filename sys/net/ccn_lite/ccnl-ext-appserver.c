@@ -65,7 +65,8 @@ static int appserver_create_content(char **prefix, uint8_t *out)
         buf[i] = 'a' + i%26;
     }
 
-    int len = mkContent(prefix, buf, CCNL_RIOT_CHUNK_SIZE - 1, out);
+    /* the whole content is this one chunk */
+    int len = mkChunk(prefix, "0", buf, CCNL_RIOT_CHUNK_SIZE - 1, out);
     return len;
 }
 
@@ -27,6 +27,8 @@
 #include "ccnl-includes.h"
 #include "ccnl-core.h"
 #include "ccnl-ext.h"
+#include "ccnl-pdu.h"
+#include "ccnl-platform.h"
 #include "ccnx.h"
 
 
@@ -46,9 +48,17 @@
  *    It serves as a container for various wire format types,
  *    including carrying fragments of bigger CCNX objects
  *  - all attributes from SEQUENCED2012 are retained
+ *  - up to CCNL_FRAG_WINDOW fragments are in flight, the receiver
+ *    acknowledges them with the next seq it expects (YSEQN) and a bitmap
+ *    of the fragments it holds beyond (SACK), so only lost fragments are
+ *    sent again. Data fragments carry the oldest seq the sender still
+ *    holds (WBASE), the receiver skips what the sender has given up on.
  *
  */
 
+#define SEQ_LT(a, b)    ((int)((a) - (b)) < 0)
+#define SLOT(seq)       ((seq) & (CCNL_FRAG_WINDOW - 1))
+
 /* ---------------------------------------------------------------------- */
 struct ccnl_frag_s *
 ccnl_frag_new(int protocol, int mtu)
@@ -92,7 +102,7 @@ void ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf, int ifndx,
 
     e->ifndx = ifndx;
     memcpy(&e->dest, dst, sizeof(*dst));
-    ccnl_free(e->bigpkt);
+    ccnl_buf_free(e->bigpkt);
     e->bigpkt = buf;
     e->sendoffs = 0;
 }
@@ -217,7 +227,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     if (datalen >= e->bigpkt->datalen) { /* fits in a single fragment */
         buf->data[flagoffs + e->flagwidth - 1] =
             CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else if (e->sendoffs == 0) { /* this is the start fragment */
@@ -225,7 +235,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     }
     else if (datalen >= (e->bigpkt->datalen - e->sendoffs)) { /* the end */
         buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else
@@ -258,6 +268,31 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     int hdrlen, blobtaglen, flagoffs;
     unsigned int datalen;
 
+    if (ifndx) {
+        *ifndx = fr->ifndx;
+    }
+
+    if (su) {
+        memcpy(su, &fr->dest, sizeof(*su));
+    }
+
+    /* lost fragments first, they hold back the receiver */
+    for (unsigned int seq = fr->txbase; seq != fr->sendseq; seq++) {
+        int slot = SLOT(seq);
+
+        if (fr->txwin[slot] && fr->txresend[slot]) {
+            DEBUGMSG(17, "  resending fragment %u\n", seq);
+            fr->txresend[slot] = 0;
+            fr->txtries[slot]++;
+            fr->stat.txretrans++;
+            return buf_dup(fr->txwin[slot]);
+        }
+    }
+
+    if (!fr->bigpkt || !ccnl_frag_winfree(fr)) {
+        return NULL;
+    }
+
     /* switch among encodings of fragments here (ccnb, TLV, etc) */
 
     hdrlen = mkHeader(header, CCNL_DTAG_FRAGMENT, CCN_TT_DTAG); /* fragment */
@@ -275,6 +310,9 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
                           fr->flagwidth);
     flagoffs = hdrlen - 2; /* most significant byte of flag element */
 
+    hdrlen += mkBinaryInt(header + hdrlen, CCNL_DTAG_FRAG_WBASE, CCN_TT_DTAG,
+                          fr->txbase, fr->sendseqwidth);
+
     /* other optional fields would go here */
 
     hdrlen += mkHeader(header + hdrlen, CCN_DTAG_CONTENT, CCN_TT_DTAG);
@@ -302,7 +340,7 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     /* patch flag field: */
     if (datalen >= fr->bigpkt->datalen) { /* single */
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_SINGLE;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else if (fr->sendoffs == 0) { /* start */
@@ -310,39 +348,37 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     }
     else if (datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { /* end */
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else {
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_MID;
     }
 
+    /* kept until acknowledged */
+    fr->txwin[SLOT(fr->sendseq)] = buf;
+    fr->txtries[SLOT(fr->sendseq)] = 1;
+    fr->txresend[SLOT(fr->sendseq)] = 0;
+    fr->stat.txfrags++;
+
     fr->sendoffs += datalen;
     fr->sendseq++;
 
-    if (ifndx) {
-        *ifndx = fr->ifndx;
-    }
-
-    if (su) {
-        memcpy(su, &fr->dest, sizeof(*su));
-    }
-
-    return buf;
+    return buf_dup(buf);
 }
 
 struct ccnl_buf_s *
 ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
 {
-    if (!fr->bigpkt) {
-        return NULL;
-    }
-
-    DEBUGMSG(99, "fragmenting %d bytes (@ %d)\n", fr->bigpkt->datalen,
-             fr->sendoffs);
+    DEBUGMSG(99, "fragmenting %d bytes (@ %d)\n",
+             fr->bigpkt ? (int) fr->bigpkt->datalen : -1, fr->sendoffs);
 
     switch (fr->protocol) {
         case CCNL_FRAG_SEQUENCED2012:
+            if (!fr->bigpkt) {
+                return NULL;
+            }
+
             return ccnl_frag_getnextSEQD2012(fr, ifndx, su);
 
         case CCNL_FRAG_CCNx2013:
@@ -365,19 +401,195 @@ int ccnl_frag_nomorefragments(struct ccnl_frag_s *e)
 void ccnl_frag_destroy(struct ccnl_frag_s *e)
 {
     if (e) {
-        ccnl_free(e->bigpkt);
-        ccnl_free(e->defrag);
+        ccnl_timer_cancel(&e->timer);
+
+        for (int k = 0; k < CCNL_FRAG_WINDOW; k++) {
+            ccnl_buf_free(e->txwin[k]);
+            ccnl_buf_free(e->rxwin[k]);
+        }
+
+        ccnl_buf_free(e->bigpkt);
+        ccnl_buf_free(e->defrag);
         ccnl_free(e);
     }
 }
 
+/* ---------------------------------------------------------------------- */
+/* sliding window, sender side */
+
+/* whether another fragment may be sent before acknowledgements arrive */
+int ccnl_frag_winfree(struct ccnl_frag_s *e)
+{
+    return !e || e->protocol != CCNL_FRAG_CCNx2013
+           || e->sendseq - e->txbase < CCNL_FRAG_WINDOW;
+}
+
+int ccnl_frag_inflight(struct ccnl_frag_s *e)
+{
+    return e && e->protocol == CCNL_FRAG_CCNx2013 && e->txbase != e->sendseq;
+}
+
+static int ccnl_frag_tx_release(struct ccnl_frag_s *e, unsigned int seq)
+{
+    if (SEQ_LT(seq, e->txbase) || !SEQ_LT(seq, e->sendseq)
+        || !e->txwin[SLOT(seq)]) {
+        return 0;
+    }
+
+    ccnl_buf_free(e->txwin[SLOT(seq)]);
+    e->txwin[SLOT(seq)] = NULL;
+    return 1;
+}
+
+static void ccnl_frag_tx_slide(struct ccnl_frag_s *e)
+{
+    while (e->txbase != e->sendseq && !e->txwin[SLOT(e->txbase)]) {
+        e->txbase++;
+    }
+}
+
+/* we restarted and the peer still expects the numbers of before, what is
+ * in flight is given up and numbering continues where the peer is */
+static void ccnl_frag_tx_resync(struct ccnl_frag_s *e, unsigned int yseq)
+{
+    for (unsigned int seq = e->txbase; seq != e->sendseq; seq++) {
+        if (ccnl_frag_tx_release(e, seq)) {
+            e->stat.txlost++;
+        }
+    }
+
+    e->txbase = e->sendseq = yseq;
+    e->stat.resyncs++;
+}
+
+/* returns the number of fragments acknowledged for the first time */
+int ccnl_frag_tx_ack(struct ccnl_frag_s *e, unsigned int yseq, unsigned int sack)
+{
+    unsigned int seq, highest = yseq;
+    int acked = 0;
+
+    if (SEQ_LT(e->sendseq, yseq)) {
+        DEBUGMSG(1, "  ack %u beyond our seq %u, resync\n", yseq, e->sendseq);
+        ccnl_frag_tx_resync(e, yseq);
+        return 0;
+    }
+
+    e->stat.rxacks++;
+
+    for (seq = e->txbase; SEQ_LT(seq, yseq); seq++) {
+        acked += ccnl_frag_tx_release(e, seq);
+    }
+
+    for (int k = 0; k < CCNL_FRAG_WINDOW - 1; k++) {
+        seq = yseq + 1 + k;
+
+        if ((sack & (1u << k)) && SEQ_LT(seq, e->sendseq)) {
+            acked += ccnl_frag_tx_release(e, seq);
+            highest = seq;
+        }
+    }
+
+    /* what is missing below a selectively acknowledged fragment is lost,
+     * it is sent again right away once, later on the timeout */
+    for (seq = yseq; SEQ_LT(seq, highest); seq++) {
+        if (!SEQ_LT(seq, e->txbase) && e->txwin[SLOT(seq)]
+            && e->txtries[SLOT(seq)] == 1) {
+            e->txresend[SLOT(seq)] = 1;
+        }
+    }
+
+    ccnl_frag_tx_slide(e);
+    return acked;
+}
+
+void ccnl_frag_timeout(struct ccnl_frag_s *e)
+{
+    for (unsigned int seq = e->txbase; seq != e->sendseq; seq++) {
+        int slot = SLOT(seq);
+
+        if (!e->txwin[slot]) {
+            continue;
+        }
+
+        if (e->txtries[slot] > CCNL_FRAG_MAX_RETRIES) {
+            DEBUGMSG(8, "  fragment %u lost\n", seq);
+            ccnl_buf_free(e->txwin[slot]);
+            e->txwin[slot] = NULL;
+            e->stat.txlost++;
+            continue;
+        }
+
+        e->txresend[slot] = 1;
+    }
+
+    ccnl_frag_tx_slide(e);
+}
+
+void ccnl_frag_timer(void *relay, void *face)
+{
+    struct ccnl_face_s *f = (struct ccnl_face_s *) face;
+
+    ccnl_frag_timeout(f->frag);
+    ccnl_face_CTS((struct ccnl_relay_s *) relay, f);
+}
+
+/* ---------------------------------------------------------------------- */
+/* sliding window, receiver side */
+
+struct ccnl_buf_s *ccnl_frag_getack(struct ccnl_frag_s *e)
+{
+    struct ccnl_buf_s *buf;
+    unsigned char ack[64];
+    unsigned int sack = 0;
+    int len;
+
+    if (!e || !e->ackdue || e->protocol != CCNL_FRAG_CCNx2013) {
+        return NULL;
+    }
+
+    for (int k = 0; k < CCNL_FRAG_WINDOW - 1; k++) {
+        if (e->rxwin[SLOT(e->recvseq + 1 + k)]) {
+            sack |= 1u << k;
+        }
+    }
+
+    len = mkHeader(ack, CCNL_DTAG_FRAGMENT, CCN_TT_DTAG);
+    len += mkHeader(ack + len, CCNL_DTAG_FRAG_TYPE, CCN_TT_DTAG);
+    len += mkHeader(ack + len, 3, CCN_TT_BLOB);
+    memcpy(ack + len, CCNL_FRAG_TYPE_CCNx2013_VAL, 3);
+    ack[len + 3] = '\0';
+    len += 4;
+    len += mkBinaryInt(ack + len, CCNL_DTAG_FRAG_YSEQN, CCN_TT_DTAG,
+                       e->recvseq, e->recvseqwidth);
+    len += mkBinaryInt(ack + len, CCNL_DTAG_FRAG_SACK, CCN_TT_DTAG, sack, 4);
+    ack[len++] = '\0'; /* end of fragment */
+
+    buf = ccnl_buf_new(ack, len);
+
+    if (buf) {
+        e->ackdue = 0;
+        e->rxsinceack = 0;
+        e->stat.txacks++;
+    }
+
+    return buf;
+}
+
 /* ---------------------------------------------------------------------- */
 
+#define HAS_FLAGS  0x01
+#define HAS_OSEQ   0x02
+#define HAS_OLOS   0x04
+#define HAS_YSEQ   0x08
+#define HAS_WBASE  0x10
+#define HAS_SACK   0x20
+
 struct serialFragPDU_s { /* collect all fields of a numbered HBH fragment */
     int contlen;
     unsigned char *content;
-    unsigned int flags, ourseq, ourloss, yourseq, HAS;
+    unsigned int flags, ourseq, ourloss, yourseq, wbase, sack, HAS;
     unsigned char flagwidth, ourseqwidth, ourlosswidth, yourseqwidth;
+    unsigned char wbasewidth, sackwidth;
 };
 
 void serialFragPDU_init(struct serialFragPDU_s *s)
@@ -386,109 +598,166 @@ void serialFragPDU_init(struct serialFragPDU_s *s)
     s->contlen = -1;
     s->flagwidth = 1;
     s->ourseqwidth = s->ourlosswidth = s->yourseqwidth = sizeof(int);
+    s->wbasewidth = s->sackwidth = sizeof(int);
 }
 
-void ccnl_frag_RX_serialfragment(RX_datagram callback,
-                                 struct ccnl_relay_s *relay, struct ccnl_face_s *from,
-                                 struct serialFragPDU_s *s)
+/* passes the fragment at recvseq on to the reassembly, a missing one
+ * breaks the packet it belongs to */
+static void ccnl_frag_RX_next(RX_datagram callback, struct ccnl_relay_s *relay,
+                              struct ccnl_face_s *from, struct ccnl_frag_s *e)
 {
-    struct ccnl_buf_s *buf = NULL;
-    struct ccnl_frag_s *e = from->frag;
-    DEBUGMSG(8, "  frag %p protocol=%d, flags=%04x, seq=%d (%d)\n", (void *) e,
-             e->protocol, s->flags, s->ourseq, e->recvseq);
+    int slot = SLOT(e->recvseq);
+    struct ccnl_buf_s *frag = e->rxwin[slot], *buf;
+    int flags = e->rxflags[slot];
+
+    e->rxwin[slot] = NULL;
+    e->recvseq++;
+
+    if (!frag) {
+        DEBUGMSG(17, "  >> fragment %u skipped\n", e->recvseq - 1);
+        e->stat.rxlost++;
+        ccnl_buf_free(e->defrag);
+        e->defrag = NULL;
+        return;
+    }
 
-    if (e->recvseq != s->ourseq) {
-        /* should increase error counter here */
+    if (flags & CCNL_DTAG_FRAG_FLAG_FIRST) {
         if (e->defrag) {
-            DEBUGMSG(17, "  >> seqnum mismatch (%d/%d), dropped defrag buf\n",
-                     s->ourseq, e->recvseq);
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
+            DEBUGMSG(18, "    had to drop defrag buf\n");
         }
-    }
 
-    switch (s->flags & (CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST)) {
-        case CCNL_DTAG_FRAG_FLAG_SINGLE: /* single packet */
-            DEBUGMSG(17, "  >> single fragment\n");
+        ccnl_buf_free(e->defrag);
+        e->defrag = frag;
+    }
+    else if (!e->defrag) {
+        /* the rest of a broken packet */
+        ccnl_buf_free(frag);
+        return;
+    }
+    else {
+        buf = ccnl_buf_new(NULL, e->defrag->datalen + frag->datalen);
 
-            if (e->defrag) {
-                DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
-                e->defrag = NULL;
-            }
+        if (buf) {
+            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
+            memcpy(buf->data + e->defrag->datalen, frag->data, frag->datalen);
+        }
 
-            /* no need to copy the buffer: */
-            callback(relay, from, &s->content, &s->contlen);
-            return;
+        ccnl_buf_free(e->defrag);
+        ccnl_buf_free(frag);
+        e->defrag = buf;
+    }
 
-        case CCNL_DTAG_FRAG_FLAG_FIRST: /* start of fragment sequence */
-            DEBUGMSG(17, "  >> start of fragment series\n");
+    if ((flags & CCNL_DTAG_FRAG_FLAG_LAST) && e->defrag) {
+        unsigned char *data = e->defrag->data;
+        int datalen = e->defrag->datalen;
 
-            if (e->defrag) {
-                DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
-            }
+        buf = e->defrag;
+        e->defrag = NULL;
+        e->stat.rxpkts++;
+        DEBUGMSG(1, "  >> reassembled fragment is %d bytes\n", datalen);
+        callback(relay, from, &data, &datalen);
+        ccnl_buf_free(buf);
+    }
+}
 
-            e->defrag = ccnl_buf_new(s->content, s->contlen);
-            break;
+/* moves recvseq up to base */
+static void ccnl_frag_RX_skip(RX_datagram callback, struct ccnl_relay_s *relay,
+                              struct ccnl_face_s *from, struct ccnl_frag_s *e,
+                              unsigned int base)
+{
+    for (int k = 0; k < CCNL_FRAG_WINDOW && SEQ_LT(e->recvseq, base); k++) {
+        ccnl_frag_RX_next(callback, relay, from, e);
+    }
 
-        case CCNL_DTAG_FRAG_FLAG_LAST: /* end of fragment sequence */
-            DEBUGMSG(17, "  >> last fragment of a series\n");
+    if (SEQ_LT(e->recvseq, base)) {
+        e->stat.rxlost += base - e->recvseq;
+        e->recvseq = base;
+        ccnl_buf_free(e->defrag);
+        e->defrag = NULL;
+    }
+}
 
-            if (!e->defrag) {
-                break;
-            }
+/* the peer restarted, what we hold of its old numbering is dropped */
+static void ccnl_frag_RX_resync(struct ccnl_frag_s *e, unsigned int base)
+{
+    for (int k = 0; k < CCNL_FRAG_WINDOW; k++) {
+        ccnl_buf_free(e->rxwin[k]);
+        e->rxwin[k] = NULL;
+    }
 
-            buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
+    ccnl_buf_free(e->defrag);
+    e->defrag = NULL;
+    e->recvseq = base;
+    e->stat.resyncs++;
+}
 
-            if (buf) {
-                memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-                memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
-            }
+void ccnl_frag_RX_serialfragment(RX_datagram callback,
+                                 struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                                 struct serialFragPDU_s *s)
+{
+    struct ccnl_frag_s *e = from->frag;
+    unsigned int seq = s->ourseq;
+    unsigned int base = (s->HAS & HAS_WBASE) ? s->wbase : seq;
+    DEBUGMSG(8, "  frag %p protocol=%d, flags=%04x, seq=%u (%u)\n", (void *) e,
+             e->protocol, s->flags, seq, e->recvseq);
 
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
-            break;
+    e->stat.rxfrags++;
 
-        case CCNL_DTAG_FRAG_FLAG_MID:  /* fragment in the middle of a squence */
-        default:
-            DEBUGMSG(17, "  >> fragment in the middle of a series\n");
+    /* a sender never holds back fragments more than a window below what we
+     * expect, it numbers from scratch after a restart. The faces of the
+     * transceiver are static, so nothing else resets our side. */
+    if (SEQ_LT(base + CCNL_FRAG_WINDOW, e->recvseq)) {
+        DEBUGMSG(1, "  seq %u far below %u, resync\n", base, e->recvseq);
+        ccnl_frag_RX_resync(e, base);
+    }
 
-            if (!e->defrag) {
-                break;
-            }
+    /* the sender gave up on what lies below its window, and one without
+     * retransmissions (SEQUENCED2012) may run ahead of ours */
+    if (s->HAS & HAS_WBASE) {
+        ccnl_frag_RX_skip(callback, relay, from, e, s->wbase);
+    }
 
-            buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
+    ccnl_frag_RX_skip(callback, relay, from, e, seq - CCNL_FRAG_WINDOW + 1);
 
-            if (buf) {
-                memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-                memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
-                ccnl_free(e->defrag);
-                e->defrag = buf;
-                buf = NULL;
-            }
-            else {
-                ccnl_free(e->defrag);
-                e->defrag = NULL;
-            }
+    if (SEQ_LT(seq, e->recvseq) || e->rxwin[SLOT(seq)]) {
+        /* our acknowledgement got lost */
+        DEBUGMSG(17, "  >> duplicate fragment %u\n", seq);
+        e->stat.rxdups++;
+        e->ackdue = 1;
+        return;
+    }
 
-            break;
+    if (seq == e->recvseq && !e->defrag
+        && (s->flags & CCNL_DTAG_FRAG_FLAG_SINGLE) == CCNL_DTAG_FRAG_FLAG_SINGLE) {
+        /* no need to copy the buffer: */
+        DEBUGMSG(17, "  >> single fragment\n");
+        e->recvseq++;
+        e->stat.rxpkts++;
+        callback(relay, from, &s->content, &s->contlen);
     }
+    else {
+        e->rxwin[SLOT(seq)] = ccnl_buf_new(s->content, s->contlen);
 
-    /* FIXME: we should only bump recvseq if s->ourseq is ahead, or 0 */
-    e->recvseq = s->ourseq + 1;
-    DEBUGMSG(1, ">>> seq from %d to %d (w=%d)\n", s->ourseq, e->recvseq,
-             s->ourseqwidth);
+        if (!e->rxwin[SLOT(seq)]) {
+            return;
+        }
 
-    if (buf) {
-        unsigned char *frag = buf->data;
-        int fraglen = buf->datalen;
-        DEBUGMSG(1, "  >> reassembled fragment is %d bytes\n", buf->datalen);
-        callback(relay, from, &frag, &fraglen);
-        ccnl_free(buf);
+        e->rxflags[SLOT(seq)] = s->flags;
+
+        if (seq != e->recvseq) {
+            /* a gap, tell the sender right away */
+            e->ackdue = 1;
+        }
+    }
+
+    while (e->rxwin[SLOT(e->recvseq)]) {
+        ccnl_frag_RX_next(callback, relay, from, e);
     }
 
-    DEBUGMSG(1, "leaving function\n");
+    if ((s->flags & CCNL_DTAG_FRAG_FLAG_LAST)
+        || ++e->rxsinceack >= CCNL_FRAG_WINDOW / 2) {
+        e->ackdue = 1;
+    }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -498,10 +767,6 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
     if (unmkBinaryInt(data, datalen, &var, &len) != 0) \
         goto Bail; \
     s.HAS |= flag
-#define HAS_FLAGS  0x01
-#define HAS_OSEQ   0x02
-#define HAS_OLOS   0x04
-#define HAS_YSEQ   0x08
 
 int ccnl_frag_RX_frag2012(RX_datagram callback, struct ccnl_relay_s *relay,
                           struct ccnl_face_s *from, unsigned char **data, int *datalen)
@@ -653,6 +918,16 @@ int ccnl_frag_RX_CCNx2013(RX_datagram callback, struct ccnl_relay_s *relay,
                     ;
                     continue;
 
+                case CCNL_DTAG_FRAG_SACK:
+                    getNumField(s.sack, s.sackwidth, HAS_SACK, "sack")
+                    ;
+                    continue;
+
+                case CCNL_DTAG_FRAG_WBASE:
+                    getNumField(s.wbase, s.wbasewidth, HAS_WBASE, "wbase")
+                    ;
+                    continue;
+
                 default:
                     break;
             }
@@ -663,30 +938,32 @@ int ccnl_frag_RX_CCNx2013(RX_datagram callback, struct ccnl_relay_s *relay,
         }
     }
 
-    if (!pdutype || !s.content) {
-        /* ||
-         (s.HAS&(HAS_FLAGS|HAS_OSEQ)) != (HAS_FLAGS|HAS_OSEQ) ) {
-         */
+    /* an acknowledgement has no content */
+    if (!pdutype || (!s.content && !(s.HAS & HAS_YSEQ))
+        || (s.content && (s.HAS & (HAS_FLAGS | HAS_OSEQ)) != (HAS_FLAGS | HAS_OSEQ))) {
         DEBUGMSG(1, "* incomplete frag\n");
         return 0;
     }
 
     DEBUGMSG(1, "hop-by-hop\n");
 
-    if (memcmp(pdutype, CCNL_FRAG_TYPE_CCNx2013_VAL, 3) == 0) { /* hop-by-hop */
-        if (from) {
-            if (!from->frag)
-                from->frag = ccnl_frag_new(CCNL_FRAG_CCNx2013,
-                                           relay->ifs[from->ifndx].mtu);
+    if (memcmp(pdutype, CCNL_FRAG_TYPE_CCNx2013_VAL, 3) == 0 && from) { /* hop-by-hop */
+        if (!from->frag)
+            from->frag = ccnl_frag_new(CCNL_FRAG_CCNx2013,
+                                       relay->ifs[from->ifndx].mtu);
 
-            if (from->frag && from->frag->protocol == CCNL_FRAG_CCNx2013) {
-                ccnl_frag_RX_serialfragment(callback, relay, from, &s);
-            }
-            else {
-                DEBUGMSG(1, "WRONG FRAG PROTOCOL\n");
-            }
+        if (!from->frag || from->frag->protocol != CCNL_FRAG_CCNx2013) {
+            DEBUGMSG(1, "WRONG FRAG PROTOCOL\n");
+            return 0;
         }
-        else {
+
+        /* the retransmission timeout starts over when the window moves */
+        if ((s.HAS & HAS_YSEQ)
+            && ccnl_frag_tx_ack(from->frag, s.yourseq, s.sack) > 0) {
+            ccnl_timer_cancel(&from->frag->timer);
+        }
+
+        if (s.content) {
             ccnl_frag_RX_serialfragment(callback, relay, from, &s);
         }
     }
@@ -41,6 +41,20 @@ int ccnl_frag_getfragcount(struct ccnl_frag_s *e, int origlen,
 struct ccnl_buf_s *ccnl_frag_getnext(struct ccnl_frag_s *e,
                                      int *ifndx, sockunion *su);
 
+int ccnl_frag_winfree(struct ccnl_frag_s *e);
+
+int ccnl_frag_inflight(struct ccnl_frag_s *e);
+
+int ccnl_frag_tx_ack(struct ccnl_frag_s *e, unsigned int yseq, unsigned int sack);
+
+void ccnl_frag_timeout(struct ccnl_frag_s *e);
+
+void ccnl_frag_timer(void *relay, void *face);
+
+struct ccnl_buf_s *ccnl_frag_getack(struct ccnl_frag_s *e);
+
+int ccnl_frag_nomorefragments(struct ccnl_frag_s *e);
+
 /*
 struct ccnl_buf_s* ccnl_frag_handle_fragment(struct ccnl_relay_s *r,
         struct ccnl_face_s *f, unsigned char *data, int datalen);
@@ -0,0 +1,272 @@
+/*
+ * @f ccnl-image.c
+ * @b CCN lite, read-only content images
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * A content image is a sequence of signed ccnb content objects that is
+ * built into the firmware, or read from a file on native, and never
+ * changes. The relay keeps an index of the objects sorted by name instead
+ * of copying them into the content store: the names that start with a
+ * prefix are a run of the index, so an interest is answered after a binary
+ * search, and the answer borrows the object from the image. Per object the
+ * index costs a pointer and a length, the objects themselves stay in flash.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto/sha256.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-pdu.h"
+
+#define CCNL_IMAGE_MIN_SIZE (16)
+
+// ----------------------------------------------------------------------
+
+static int ccnl_image_view(struct ccnl_image_entry_s *e, struct ccnl_pkt_view_s *v)
+{
+    unsigned char *data = (unsigned char *) e->pkt + 2;
+    int datalen = e->len - 2;
+
+    return ccnl_ccnb_parse(&data, &datalen, v);
+}
+
+// canonical CCNx order: component by component, shorter components first,
+// a name sorts right before the names it is a prefix of
+static int ccnl_image_cmp(struct ccnl_pkt_view_s *v, struct ccnl_prefix_s *p)
+{
+    for (int k = 0; k < v->compcnt && k < p->compcnt; k++) {
+        int rc;
+
+        if (v->complen[k] != p->complen[k]) {
+            return v->complen[k] - p->complen[k];
+        }
+
+        rc = memcmp(v->comp[k], p->comp[k], v->complen[k]);
+
+        if (rc) {
+            return rc;
+        }
+    }
+
+    return v->compcnt - p->compcnt;
+}
+
+static int ccnl_image_prefixof(struct ccnl_prefix_s *p, struct ccnl_pkt_view_s *v)
+{
+    if (v->compcnt < p->compcnt) {
+        return 0;
+    }
+
+    for (int k = 0; k < p->compcnt; k++) {
+        if (v->complen[k] != p->complen[k]
+            || memcmp(v->comp[k], p->comp[k], p->complen[k])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int ccnl_image_ppkd(struct ccnl_buf_s *ppkd, struct ccnl_pkt_view_s *v)
+{
+    return !ppkd || ((int) ppkd->datalen == v->ppkdlen
+                     && !memcmp(ppkd->data, v->ppkd, v->ppkdlen));
+}
+
+// the first entry whose name does not sort before p
+static int ccnl_image_lower_bound(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    struct ccnl_pkt_view_s v;
+    int lo = 0, hi = ccnl->imagecnt;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+
+        if (ccnl_image_view(ccnl->image + mid, &v) == 0
+            && ccnl_image_cmp(&v, p) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static int ccnl_image_grow(struct ccnl_relay_s *ccnl)
+{
+    int size = ccnl->image_size ? ccnl->image_size * 2 : CCNL_IMAGE_MIN_SIZE;
+    struct ccnl_image_entry_s *image;
+
+    if (ccnl->imagecnt < ccnl->image_size) {
+        return 0;
+    }
+
+    image = (struct ccnl_image_entry_s *) ccnl_realloc(ccnl->image,
+            size * sizeof(*image));
+
+    if (!image) {
+        return -1;
+    }
+
+    ccnl->image = image;
+    ccnl->image_size = size;
+    return 0;
+}
+
+static int ccnl_image_insert(struct ccnl_relay_s *ccnl, const unsigned char *pkt,
+                             int len, struct ccnl_pkt_view_s *v)
+{
+    struct ccnl_prefix_s name;
+    struct ccnl_pkt_view_s w;
+    int k;
+
+    ccnl_pkt_view_prefix(v, &name);
+    k = ccnl_image_lower_bound(ccnl, &name);
+
+    // the same object registered twice
+    for (; k < ccnl->imagecnt; k++) {
+        struct ccnl_image_entry_s *e = ccnl->image + k;
+
+        if (ccnl_image_view(e, &w) < 0 || ccnl_image_cmp(&w, &name) != 0) {
+            break;
+        }
+
+        if ((int) e->len == len && !memcmp(e->pkt, pkt, len)) {
+            return 0;
+        }
+    }
+
+    if (ccnl_image_grow(ccnl) < 0) {
+        puts("can't get more memory from malloc, image not indexed...");
+        return -1;
+    }
+
+    memmove(ccnl->image + k + 1, ccnl->image + k,
+            (ccnl->imagecnt - k) * sizeof(*ccnl->image));
+    ccnl->image[k].pkt = pkt;
+    ccnl->image[k].len = len;
+    ccnl->imagecnt++;
+    return 1;
+}
+
+// ----------------------------------------------------------------------
+
+int ccnl_image_add(struct ccnl_relay_s *ccnl, const unsigned char *image, int len)
+{
+    const unsigned char *pkt = image;
+    int cnt = 0;
+
+    while (len > 2) {
+        struct ccnl_pkt_view_s v;
+        unsigned char *data = (unsigned char *) pkt + 2;
+        int datalen = len - 2, rc;
+
+        if (pkt[0] != 0x04 || pkt[1] != 0x82
+            || ccnl_ccnb_parse(&data, &datalen, &v) < 0) {
+            DEBUGMSG(1, "  image: no content object at offset %d\n",
+                     (int)(pkt - image));
+            return -1;
+        }
+
+        rc = ccnl_image_insert(ccnl, pkt, v.len, &v);
+
+        if (rc < 0) {
+            return -1;
+        }
+
+        cnt += rc;
+        pkt += v.len;
+        len -= v.len;
+    }
+
+    DEBUGMSG(1, "  image: %d new objects, %d indexed\n", cnt, ccnl->imagecnt);
+    return cnt;
+}
+
+struct ccnl_buf_s *
+ccnl_image_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                  struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix)
+{
+    struct ccnl_pkt_view_s v;
+    struct ccnl_image_entry_s *e;
+    int k;
+
+    if (!ccnl->imagecnt) {
+        return NULL;
+    }
+
+    // the names below prefix, counting the implicit digest as a suffix
+    for (k = ccnl_image_lower_bound(ccnl, prefix); k < ccnl->imagecnt; k++) {
+        int sfx;
+
+        e = ccnl->image + k;
+
+        if (ccnl_image_view(e, &v) < 0 || !ccnl_image_prefixof(prefix, &v)) {
+            break;
+        }
+
+        sfx = v.compcnt + 1 - prefix->compcnt;
+
+        if (sfx >= minsuffix && sfx <= maxsuffix && ccnl_image_ppkd(ppkd, &v)) {
+            return ccnl_buf_borrow(e->pkt, e->len);
+        }
+    }
+
+    // the last component of the prefix may be the digest of the object
+    if (prefix->compcnt > 0 && minsuffix <= 0 && maxsuffix >= 0
+        && prefix->complen[prefix->compcnt - 1] == 32) { // SHA256_DIGEST_LEN
+        struct ccnl_prefix_s name = *prefix;
+
+        name.compcnt--;
+
+        for (k = ccnl_image_lower_bound(ccnl, &name); k < ccnl->imagecnt; k++) {
+            struct ccnl_buf_s obj, *pkt = &obj;
+
+            e = ccnl->image + k;
+
+            if (ccnl_image_view(e, &v) < 0 || ccnl_image_cmp(&v, &name) != 0) {
+                break;
+            }
+
+            pkt->datalen = e->len;
+            pkt->data = (unsigned char *) e->pkt;
+
+            if (ccnl_image_ppkd(ppkd, &v)
+                && !memcmp(compute_ccnx_digest(pkt),
+                           prefix->comp[name.compcnt], 32)) {
+                return ccnl_buf_borrow(e->pkt, e->len);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+void ccnl_image_cleanup(struct ccnl_relay_s *ccnl)
+{
+    ccnl_free(ccnl->image);
+    ccnl->image = NULL;
+    ccnl->imagecnt = ccnl->image_size = 0;
+}
+
+// eof
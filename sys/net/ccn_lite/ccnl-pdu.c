@@ -26,6 +26,7 @@
 
 #include "ccnl-core.h"
 #include "ccnx.h"
+#include "ccnl-pdu.h"
 
 int dehead(unsigned char **buf, int *len, int *num, int *typ)
 {
@@ -202,6 +203,15 @@ int mkInterest(char **namecomp, unsigned int *nonce, unsigned char *out)
 
 int
 mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
+{
+    return mkChunk(namecomp, NULL, data, datalen, out);
+}
+
+// a chunk of a larger object, finalblock is the name component of its last
+// chunk (FinalBlockID) and tells consumers where to stop, NULL if unknown
+int
+mkChunk(char **namecomp, char *finalblock, char *data, int datalen,
+        unsigned char *out)
 {
     int len = mkHeader(out, CCN_DTAG_CONTENTOBJ, CCN_TT_DTAG); // content
     len += mkHeader(out + len, CCN_DTAG_NAME, CCN_TT_DTAG);    // name
@@ -217,6 +227,12 @@ mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
 
     out[len++] = 0; // end-of-name
 
+    if (finalblock) {
+        len += mkHeader(out + len, CCN_DTAG_SIGNEDINFO, CCN_TT_DTAG); // signed info
+        len += mkStrBlob(out + len, CCN_DTAG_FINALBLOCKID, CCN_TT_DTAG, finalblock);
+        out[len++] = 0; // end-of-signed info
+    }
+
     len += mkHeader(out + len, CCN_DTAG_CONTENT, CCN_TT_DTAG); // content obj
     len += mkHeader(out + len, datalen, CCN_TT_BLOB);
     memcpy(out + len, data, datalen);
@@ -26,3 +26,5 @@ int unmkBinaryInt(unsigned char **data, int *datalen, unsigned int *result,
                   unsigned char *width);
 int mkInterest(char **namecomp, unsigned int *nonce, unsigned char *out);
 int mkContent(char **namecomp, char *data, int datalen, unsigned char *out);
+int mkChunk(char **namecomp, char *finalblock, char *data, int datalen,
+            unsigned char *out);
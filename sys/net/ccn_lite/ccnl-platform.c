@@ -40,8 +40,6 @@ timevaldelta(struct timeval *a, struct timeval *b)
 
 // ----------------------------------------------------------------------
 
-struct ccnl_timer_s *eventqueue;
-
 void
 ccnl_get_timeval(struct timeval *tv)
 {
@@ -53,88 +51,133 @@ ccnl_get_timeval(struct timeval *tv)
     tv->tv_usec = now.microseconds;
 }
 
-void *
-ccnl_set_timer(int usec, void (*fct)(void *aux1, void *aux2),
-               void *aux1, void *aux2)
+// ----------------------------------------------------------------------
+// timers: a binary min heap ordered by deadline. Timers are embedded in the
+// objects they expire, heap positions start at 1 so a zeroed timer is idle.
+
+static struct ccnl_timer_s **eventheap;
+static int eventheap_size, eventheap_len;
+
+static int
+ccnl_timer_before(struct ccnl_timer_s *a, struct ccnl_timer_s *b)
 {
-    struct ccnl_timer_s *t, **pp;
-    static int handlercnt;
+    return timevaldelta(&a->timeout, &b->timeout) < 0;
+}
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+static void
+ccnl_timer_place(struct ccnl_timer_s *t, int pos)
+{
+    eventheap[pos - 1] = t;
+    t->pos = pos;
+}
 
-    if (!t) {
-        return 0;
+static void
+ccnl_timer_sift(struct ccnl_timer_s *t, int pos)
+{
+    // up while earlier than the parent ...
+    while (pos > 1 && ccnl_timer_before(t, eventheap[pos / 2 - 1])) {
+        ccnl_timer_place(eventheap[pos / 2 - 1], pos);
+        pos /= 2;
     }
 
-    t->fct2 = fct;
-    ccnl_get_timeval(&t->timeout);
-    usec += t->timeout.tv_usec;
-    t->timeout.tv_sec += usec / 1000000;
-    t->timeout.tv_usec = usec % 1000000;
-    t->aux1 = aux1;
-    t->aux2 = aux2;
+    // ... else down while a child is earlier
+    for (;;) {
+        int child = 2 * pos;
+
+        if (child > eventheap_len) {
+            break;
+        }
+
+        if (child < eventheap_len
+            && ccnl_timer_before(eventheap[child], eventheap[child - 1])) {
+            child++;
+        }
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-        if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-            ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-             (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-            t->next = *pp;
-            t->handler = handlercnt++;
-            *pp = t;
-            return t;
+        if (!ccnl_timer_before(eventheap[child - 1], t)) {
+            break;
         }
+
+        ccnl_timer_place(eventheap[child - 1], pos);
+        pos = child;
     }
 
-    return NULL; // ?
+    ccnl_timer_place(t, pos);
 }
 
-void *
-ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
-                        void *aux1, void *aux2)
+// (re)arms t to fire usec after base (now if NULL), -1 if out of memory
+int
+ccnl_timer_set(struct ccnl_timer_s *t, struct timeval *base, long usec,
+               void (*fct)(void *aux1, void *aux2), void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    static int handlercnt;
-
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    struct timeval now;
 
-    if (!t) {
-        return 0;
+    if (!base) {
+        ccnl_get_timeval(&now);
+        base = &now;
     }
 
-    t->fct2 = fct;
-    t->timeout = abstime;
+    usec += base->tv_usec;
+    t->timeout.tv_sec = base->tv_sec + usec / 1000000;
+    t->timeout.tv_usec = usec % 1000000;
+    t->fct = fct;
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-        if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-            ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-             (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-            t->next = *pp;
-            t->handler = handlercnt++;
-            *pp = t;
-            return t;
+    if (t->pos) {
+        ccnl_timer_sift(t, t->pos);
+        return 0;
+    }
+
+    if (eventheap_len == eventheap_size) {
+        int size = eventheap_size ? 2 * eventheap_size : CCNL_TIMER_HEAP_MIN_SIZE;
+        struct ccnl_timer_s **heap = ccnl_realloc(eventheap, size * sizeof(*heap));
+
+        if (!heap) {
+            return -1;
         }
+
+        eventheap = heap;
+        eventheap_size = size;
     }
 
-    return NULL; // ?
+    ccnl_timer_sift(t, ++eventheap_len);
+    return 0;
 }
 
 void
-ccnl_rem_timer(void *h)
+ccnl_timer_cancel(struct ccnl_timer_s *t)
 {
-    struct ccnl_timer_s **pp;
+    struct ccnl_timer_s *last;
 
-    DEBUGMSG(99, "removing time handler %p\n", h);
+    if (!t->pos) {
+        return;
+    }
 
-    for (pp = &eventqueue; *pp; pp = &((*pp)->next)) {
-        if ((void *)*pp == h) {
-            struct ccnl_timer_s *e = *pp;
-            *pp = e->next;
-            ccnl_free(e);
-            break;
-        }
+    last = eventheap[--eventheap_len];
+
+    if (last != t) {
+        ccnl_timer_sift(last, t->pos);
     }
+
+    t->pos = 0;
+}
+
+struct ccnl_timer_s *
+ccnl_timer_first(void)
+{
+    return eventheap_len ? eventheap[0] : NULL;
+}
+
+void
+ccnl_timer_cleanup(void)
+{
+    while (eventheap_len) {
+        ccnl_timer_cancel(eventheap[0]);
+    }
+
+    ccnl_free(eventheap);
+    eventheap = NULL;
+    eventheap_size = 0;
 }
 
 char *
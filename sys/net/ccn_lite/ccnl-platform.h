@@ -20,30 +20,20 @@
 
 #include <sys/time.h>
 
-// (ms) I moved the following struct def here because it is used by all
-// containers apart from the kernel (this way I don't need to redefine it
-// for omnet.
-//
-struct ccnl_timer_s {
-    struct ccnl_timer_s *next;
-    struct timeval timeout;
-    void (*fct)(char, int);
-    void (*fct2)(void *, void *);
-    char node;
-    int intarg;
-    void *aux1;
-    void *aux2;
-    int handler;
-};
+struct ccnl_timer_s;
 
 void ccnl_get_timeval(struct timeval *tv);
 
 long timevaldelta(struct timeval *a, struct timeval *b);
 
-void *ccnl_set_timer(int usec, void (*fct)(void *aux1, void *aux2),
-               void *aux1, void *aux2);
+int ccnl_timer_set(struct ccnl_timer_s *t, struct timeval *base, long usec,
+                   void (*fct)(void *aux1, void *aux2), void *aux1, void *aux2);
 
-void
-ccnl_rem_timer(void *h);
+void ccnl_timer_cancel(struct ccnl_timer_s *t);
 
-extern struct ccnl_timer_s *eventqueue;
+struct ccnl_timer_s *ccnl_timer_first(void);
+
+void ccnl_timer_cleanup(void);
+
+// runs the handlers of expired timers, see ccn-lite-relay.c
+long ccnl_run_events(void);
@@ -0,0 +1,255 @@
+/*
+ * @f ccnl-pool.c
+ * @b CCN lite, fixed size object pools for packet buffers and control structures
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Every packet passes through a buffer, a prefix and usually an interest
+ * or a content entry. These objects are taken from static pools of fixed
+ * size slots, so a long running relay does not fragment its heap. A pool
+ * that is exhausted, or asked for more than a slot holds, falls back to
+ * ccnl_malloc and counts it; ccnl_pool_free tells both apart by address.
+ * The pools are shared with the client threads, so they are guarded by
+ * disabling interrupts for the few instructions of a list operation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "irq.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+
+#define CCNL_POOL_ALIGN(s)  (((s) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
+#define CCNL_POOL(NAME, SIZE, COUNT) \
+    static uint64_t NAME ## _mem[CCNL_POOL_ALIGN(SIZE) * (COUNT) / sizeof(uint64_t)]; \
+    struct ccnl_pool_s NAME = { #NAME, CCNL_POOL_ALIGN(SIZE), (COUNT), \
+                                (unsigned char *) NAME ## _mem, NULL, 0, 0, 0, 0 }
+
+// a prefix with its arrays, comp is NULL terminated
+#define CCNL_PREFIX_SIZE(n) (sizeof(struct ccnl_prefix_s) \
+                             + ((n) + 1) * sizeof(unsigned char *) \
+                             + (n) * sizeof(int))
+
+CCNL_POOL(ccnl_buf_small_pool,
+          sizeof(struct ccnl_buf_s) + CCNL_POOL_BUF_SMALL_LEN,
+          CCNL_POOL_BUF_SMALL_CNT);
+CCNL_POOL(ccnl_buf_large_pool,
+          sizeof(struct ccnl_buf_s) + CCNL_POOL_BUF_LARGE_LEN,
+          CCNL_POOL_BUF_LARGE_CNT);
+CCNL_POOL(ccnl_prefix_pool, CCNL_PREFIX_SIZE(CCNL_MAX_NAME_COMP),
+          CCNL_POOL_PREFIX_CNT);
+CCNL_POOL(ccnl_interest_pool, sizeof(struct ccnl_interest_s),
+          CCNL_POOL_INTEREST_CNT);
+CCNL_POOL(ccnl_pendint_pool, sizeof(struct ccnl_pendint_s),
+          CCNL_POOL_PENDINT_CNT);
+CCNL_POOL(ccnl_content_pool, sizeof(struct ccnl_content_s),
+          CCNL_POOL_CONTENT_CNT);
+
+struct ccnl_pool_s *const ccnl_pools[] = {
+    &ccnl_buf_small_pool, &ccnl_buf_large_pool, &ccnl_prefix_pool,
+    &ccnl_interest_pool, &ccnl_pendint_pool, &ccnl_content_pool, NULL
+};
+
+// ----------------------------------------------------------------------
+
+static int ccnl_pool_owns(struct ccnl_pool_s *pool, void *p)
+{
+    unsigned char *cp = (unsigned char *) p;
+
+    return cp >= pool->mem && cp < pool->mem + pool->size * pool->count;
+}
+
+void *ccnl_pool_alloc(struct ccnl_pool_s *pool, unsigned int size)
+{
+    void *p = NULL;
+    unsigned state = disableIRQ();
+
+    if (size <= pool->size) {
+        if (pool->free) {
+            p = pool->free;
+            pool->free = *(void **) p;
+        }
+        else if (pool->fresh < pool->count) {
+            p = pool->mem + pool->size * pool->fresh++;
+        }
+    }
+
+    if (p) {
+        if (++pool->used > pool->peak) {
+            pool->peak = pool->used;
+        }
+    }
+    else {
+        pool->fallbacks++;
+    }
+
+    restoreIRQ(state);
+
+    if (!p) {
+        DEBUGMSG(99, "  pool %s: %u bytes from the heap\n", pool->name, size);
+        p = ccnl_malloc(size);
+    }
+
+    return p;
+}
+
+void *ccnl_pool_calloc(struct ccnl_pool_s *pool, unsigned int size)
+{
+    void *p = ccnl_pool_alloc(pool, size);
+
+    if (p) {
+        memset(p, 0, size);
+    }
+
+    return p;
+}
+
+void ccnl_pool_free(struct ccnl_pool_s *pool, void *p)
+{
+    unsigned state;
+
+    if (!p) {
+        return;
+    }
+
+    if (!ccnl_pool_owns(pool, p)) {
+        ccnl_free(p);
+        return;
+    }
+
+    state = disableIRQ();
+    *(void **) p = pool->free;
+    pool->free = p;
+    pool->used--;
+    restoreIRQ(state);
+}
+
+void ccnl_pool_print_stats(void)
+{
+    puts("pool                  used  peak  slots  size  fallbacks");
+
+    for (int k = 0; ccnl_pools[k]; k++) {
+        struct ccnl_pool_s *pool = ccnl_pools[k];
+
+        printf("%-20s %5u %5u %6u %5u %10u\n", pool->name, pool->used,
+               pool->peak, pool->count, pool->size, pool->fallbacks);
+    }
+}
+
+// ----------------------------------------------------------------------
+// buffers
+
+struct ccnl_buf_s *
+ccnl_buf_new(void *data, int len)
+{
+    unsigned int size = sizeof(struct ccnl_buf_s) + len;
+    struct ccnl_buf_s *b;
+
+    if (size <= ccnl_buf_small_pool.size) {
+        b = ccnl_pool_alloc(&ccnl_buf_small_pool, size);
+    }
+    else {
+        b = ccnl_pool_alloc(&ccnl_buf_large_pool, size);
+    }
+
+    if (!b) {
+        return NULL;
+    }
+
+    b->datalen = len;
+    b->refs = 1;
+    b->data = (unsigned char *)(b + 1);
+
+    if (data) {
+        memcpy(b->data, data, len);
+    }
+
+    return b;
+}
+
+// a buffer for data that outlives it, e.g. a content image in flash: only
+// the header is allocated, the data is neither copied nor written
+struct ccnl_buf_s *
+ccnl_buf_borrow(const void *data, int len)
+{
+    struct ccnl_buf_s *b = ccnl_pool_alloc(&ccnl_buf_small_pool,
+                                           sizeof(struct ccnl_buf_s));
+
+    if (!b) {
+        return NULL;
+    }
+
+    b->datalen = len;
+    b->refs = 1;
+    b->data = (unsigned char *) data;
+    return b;
+}
+
+// buffers are never written once filled, so a duplicate is a reference
+struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B)
+{
+    if (B) {
+        B->refs++;
+    }
+
+    return B;
+}
+
+void ccnl_buf_free(struct ccnl_buf_s *B)
+{
+    if (!B || --B->refs > 0) {
+        return;
+    }
+
+    if (ccnl_pool_owns(&ccnl_buf_small_pool, B)) {
+        ccnl_pool_free(&ccnl_buf_small_pool, B);
+    }
+    else {
+        ccnl_pool_free(&ccnl_buf_large_pool, B);
+    }
+}
+
+// ----------------------------------------------------------------------
+// prefixes
+
+// room for compcnt components, the component data is not copied
+struct ccnl_prefix_s *ccnl_prefix_new(int compcnt)
+{
+    unsigned int size = CCNL_PREFIX_SIZE(compcnt);
+    struct ccnl_prefix_s *p = ccnl_pool_calloc(&ccnl_prefix_pool, size);
+
+    if (!p) {
+        return NULL;
+    }
+
+    p->comp = (unsigned char **)(p + 1);
+    p->complen = (int *)(p->comp + compcnt + 1);
+    return p;
+}
+
+void free_prefix(struct ccnl_prefix_s *p)
+{
+    if (p) {
+        ccnl_free(p->path);
+        ccnl_pool_free(&ccnl_prefix_pool, p);
+    }
+}
+
+// eof
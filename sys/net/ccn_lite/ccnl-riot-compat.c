@@ -40,8 +40,6 @@ radio_packet_t p;
 transceiver_command_t tcmd;
 msg_t mesg, rep;
 
-char relay_helper_stack[KERNEL_CONF_STACKSIZE_MAIN];
-
 int riot_send_transceiver(uint8_t *buf, uint16_t size, uint16_t to)
 {
     DEBUGMSG(1, "this is a RIOT TRANSCEIVER based connection\n");
@@ -108,15 +106,6 @@ void riot_send_nack(uint16_t to)
     msg_send(&m, to, 0);
 }
 
-void *ccnl_riot_relay_helper_start(void *);
-
-kernel_pid_t riot_start_helper_thread(void)
-{
-    return thread_create(relay_helper_stack, sizeof(relay_helper_stack),
-                         PRIORITY_MAIN - 2, CREATE_STACKTEST,
-                         ccnl_riot_relay_helper_start, NULL, "relay-helper");
-}
-
 char *riot_ccnl_event_to_string(int event)
 {
     switch (event) {
@@ -135,6 +124,18 @@ char *riot_ccnl_event_to_string(int event)
         case CCNL_RIOT_PRINT_STAT:
             return "CCNL_RIOT_PRINT_STAT";
 
+        case CCNL_RIOT_CONFIG_CACHE:
+            return "CCNL_RIOT_CONFIG_CACHE";
+
+        case CCNL_RIOT_CONFIG_CACHE_BYTES:
+            return "CCNL_RIOT_CONFIG_CACHE_BYTES";
+
+        case CCNL_RIOT_CONFIG_STRATEGY:
+            return "CCNL_RIOT_CONFIG_STRATEGY";
+
+        case CCNL_RIOT_IF_PKT:
+            return "CCNL_RIOT_IF_PKT";
+
         case ENOBUFFER:
             return "ENOBUFFER";
 
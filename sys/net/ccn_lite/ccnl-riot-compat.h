@@ -30,5 +30,4 @@ typedef struct riot_ccnl_msg {
 int riot_send_transceiver(uint8_t *buf, uint16_t size, uint16_t to);
 int riot_send_msg(uint8_t *buf, uint16_t size, uint16_t to);
 void riot_send_nack(uint16_t to);
-kernel_pid_t riot_start_helper_thread(void);
 char *riot_ccnl_event_to_string(int event);
@@ -0,0 +1,421 @@
+/*
+ * @f ccnl-trie.c
+ * @b CCN lite, name trie indexing the PIT, the FIB and the content store
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Every name used by an interest, a FIB entry or a cached content has a
+ * trie node per component. A node carries the hash of the name up to its
+ * component (the root, the empty name, hashes to 0) and children are found
+ * through trie_index by that hash, so walking a name costs one hash lookup
+ * per component regardless of the table sizes.
+ * Nodes live as long as entries or children refer to them.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+
+// ----------------------------------------------------------------------
+// nodes
+
+static struct ccnl_trie_s **
+ccnl_trie_bucket(struct ccnl_relay_s *ccnl, uint32_t h)
+{
+    return &ccnl->trie_index[h & (ccnl->trie_index_size - 1)];
+}
+
+static void ccnl_trie_index_add(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *n)
+{
+    struct ccnl_trie_s **bucket = ccnl_trie_bucket(ccnl, n->hash);
+
+    n->index_next = *bucket;
+    *bucket = n;
+}
+
+static void ccnl_trie_index_rebuild(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *n)
+{
+    for (struct ccnl_trie_s *child = n->children; child; child = child->sibling) {
+        ccnl_trie_index_add(ccnl, child);
+        ccnl_trie_index_rebuild(ccnl, child);
+    }
+}
+
+// keeps the load factor below 2, the old index stays on allocation failure
+static int ccnl_trie_index_grow(struct ccnl_relay_s *ccnl)
+{
+    int size = ccnl->trie_index_size ? ccnl->trie_index_size * 2
+               : CCNL_TRIE_INDEX_MIN_SIZE;
+    struct ccnl_trie_s **index;
+
+    if (ccnl->trie_index && ccnl->trie_nodes < 2 * ccnl->trie_index_size) {
+        return 0;
+    }
+
+    index = (struct ccnl_trie_s **) ccnl_calloc(size, sizeof(*index));
+
+    if (!index) {
+        return ccnl->trie_index ? 0 : -1;
+    }
+
+    ccnl_free(ccnl->trie_index);
+    ccnl->trie_index = index;
+    ccnl->trie_index_size = size;
+    ccnl_trie_index_rebuild(ccnl, &ccnl->trie);
+    return 0;
+}
+
+struct ccnl_trie_s *
+ccnl_trie_child(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *node,
+                unsigned char *comp, int complen)
+{
+    uint32_t h;
+
+    if (!ccnl->trie_index || !node->children) {
+        return NULL;
+    }
+
+    h = ccnl_hash_comp(node->hash, comp, complen);
+
+    for (struct ccnl_trie_s *n = *ccnl_trie_bucket(ccnl, h); n; n = n->index_next) {
+        if (n->hash == h && n->parent == node && n->complen == complen
+            && !memcmp(n->comp, comp, complen)) {
+            return n;
+        }
+    }
+
+    return NULL;
+}
+
+static struct ccnl_trie_s *
+ccnl_trie_child_new(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *node,
+                    unsigned char *comp, int complen)
+{
+    struct ccnl_trie_s *n;
+
+    if (ccnl_trie_index_grow(ccnl) < 0) {
+        return NULL;
+    }
+
+    n = (struct ccnl_trie_s *) ccnl_calloc(1, sizeof(*n) + complen);
+
+    if (!n) {
+        return NULL;
+    }
+
+    n->parent = node;
+    n->hash = ccnl_hash_comp(node->hash, comp, complen);
+    n->complen = complen;
+    memcpy(n->comp, comp, complen);
+
+    n->sibling = node->children;
+    node->children = n;
+    node->refs++;
+    ccnl_trie_index_add(ccnl, n);
+    ccnl->trie_nodes++;
+    return n;
+}
+
+// frees n and its ancestors as far as nothing refers to them anymore
+static void ccnl_trie_release(struct ccnl_relay_s *ccnl, struct ccnl_trie_s *n)
+{
+    while (n != &ccnl->trie && n->refs == 0) {
+        struct ccnl_trie_s *parent = n->parent, **pp;
+
+        for (pp = &parent->children; *pp != n; pp = &(*pp)->sibling);
+        *pp = n->sibling;
+
+        for (pp = ccnl_trie_bucket(ccnl, n->hash); *pp != n; pp = &(*pp)->index_next);
+        *pp = n->index_next;
+
+        ccnl_free(n);
+        ccnl->trie_nodes--;
+        parent->refs--;
+        n = parent;
+    }
+}
+
+static struct ccnl_trie_s *
+ccnl_trie_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int create)
+{
+    struct ccnl_trie_s *n = &ccnl->trie, *child;
+
+    for (int k = 0; k < p->compcnt; k++) {
+        child = ccnl_trie_child(ccnl, n, p->comp[k], p->complen[k]);
+
+        if (!child && create) {
+            child = ccnl_trie_child_new(ccnl, n, p->comp[k], p->complen[k]);
+
+            if (!child) {
+                ccnl_trie_release(ccnl, n);
+            }
+        }
+
+        if (!child) {
+            return NULL;
+        }
+
+        n = child;
+    }
+
+    return n;
+}
+
+int ccnl_trie_path(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                   struct ccnl_trie_s **path)
+{
+    int k;
+
+    path[0] = &ccnl->trie;
+
+    for (k = 0; k < p->compcnt && k < CCNL_MAX_NAME_COMP; k++) {
+        path[k + 1] = ccnl_trie_child(ccnl, path[k], p->comp[k], p->complen[k]);
+
+        if (!path[k + 1]) {
+            break;
+        }
+    }
+
+    return k + 1;
+}
+
+void ccnl_trie_cleanup(struct ccnl_relay_s *ccnl)
+{
+    ccnl_free(ccnl->trie_index);
+    ccnl->trie_index = NULL;
+    ccnl->trie_index_size = 0;
+}
+
+// ----------------------------------------------------------------------
+// PIT
+
+int ccnl_trie_add_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    struct ccnl_trie_s *n = ccnl_trie_lookup(ccnl, i->prefix, 1);
+
+    if (!n) {
+        return -1;
+    }
+
+    i->trie = n;
+    i->trie_next = n->pit;
+    n->pit = i;
+    n->refs++;
+    return 0;
+}
+
+void ccnl_trie_remove_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    struct ccnl_interest_s **pp;
+
+    if (!i->trie) {
+        return;
+    }
+
+    for (pp = &i->trie->pit; *pp != i; pp = &(*pp)->trie_next);
+    *pp = i->trie_next;
+
+    i->trie->refs--;
+    ccnl_trie_release(ccnl, i->trie);
+    i->trie = NULL;
+}
+
+struct ccnl_interest_s *
+ccnl_trie_find_interest(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                        int minsuffix, int maxsuffix, struct ccnl_buf_s *ppkd)
+{
+    struct ccnl_trie_s *n = ccnl_trie_lookup(ccnl, prefix, 0);
+
+    for (struct ccnl_interest_s *i = n ? n->pit : NULL; i; i = i->trie_next) {
+        if (i->minsuffix == minsuffix && i->maxsuffix == maxsuffix
+            && ((!ppkd && !i->ppkd) || buf_equal(ppkd, i->ppkd))) {
+            return i;
+        }
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------
+// FIB
+
+int ccnl_trie_add_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
+{
+    struct ccnl_trie_s *n = ccnl_trie_lookup(ccnl, fwd->prefix, 1);
+
+    if (!n) {
+        return -1;
+    }
+
+    fwd->trie = n;
+    fwd->trie_next = n->fib;
+    n->fib = fwd;
+    n->refs++;
+
+    if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+        for (; n; n = n->parent) {
+            n->dynfwd++;
+        }
+    }
+
+    return 0;
+}
+
+void ccnl_trie_remove_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
+{
+    struct ccnl_forward_s **pp;
+
+    if (!fwd->trie) {
+        return;
+    }
+
+    for (pp = &fwd->trie->fib; *pp != fwd; pp = &(*pp)->trie_next);
+    *pp = fwd->trie_next;
+
+    if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+        for (struct ccnl_trie_s *n = fwd->trie; n; n = n->parent) {
+            n->dynfwd--;
+        }
+    }
+
+    fwd->trie->refs--;
+    ccnl_trie_release(ccnl, fwd->trie);
+    fwd->trie = NULL;
+}
+
+/* a dynamic FIB entry sharing at least *threshold* components with p,
+ * the longest common prefix wins */
+struct ccnl_forward_s *
+ccnl_trie_find_aggregate(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                         int threshold, int *match_len)
+{
+    struct ccnl_trie_s *path[CCNL_MAX_NAME_COMP + 1], *n;
+    int k = ccnl_trie_path(ccnl, p, path) - 1;
+
+    // the deepest node along p with dynamic entries below it
+    for (; k >= threshold && k >= 0 && !path[k]->dynfwd; k--);
+
+    if (k < threshold || k < 0) {
+        return NULL;
+    }
+
+    *match_len = k;
+
+    // every dynamic entry of this subtree shares k components with p
+    for (n = path[k]; n;) {
+        struct ccnl_trie_s *child;
+
+        for (struct ccnl_forward_s *fwd = n->fib; fwd; fwd = fwd->trie_next) {
+            if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+                return fwd;
+            }
+        }
+
+        for (child = n->children; child && !child->dynfwd; child = child->sibling);
+        n = child;
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------
+// content store
+
+int ccnl_trie_add_content(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_trie_s *n = ccnl_trie_lookup(ccnl, c->name, 1);
+
+    if (!n) {
+        return -1;
+    }
+
+    c->trie = n;
+    c->trie_next = n->cs;
+    n->cs = c;
+    n->refs++;
+
+    for (; n; n = n->parent) {
+        n->cached++;
+    }
+
+    return 0;
+}
+
+void ccnl_trie_remove_content(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s **pp;
+
+    if (!c->trie) {
+        return;
+    }
+
+    for (pp = &c->trie->cs; *pp != c; pp = &(*pp)->trie_next);
+    *pp = c->trie_next;
+
+    for (struct ccnl_trie_s *n = c->trie; n; n = n->parent) {
+        n->cached--;
+    }
+
+    c->trie->refs--;
+    ccnl_trie_release(ccnl, c->trie);
+    c->trie = NULL;
+}
+
+/* a cached content named prefix or longer that the interest matches,
+ * only the subtrees with content up to maxsuffix - 1 components below
+ * prefix are walked */
+struct ccnl_content_s *
+ccnl_trie_find_content(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                       struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix)
+{
+    struct ccnl_trie_s *top = ccnl_trie_lookup(ccnl, prefix, 0), *n, *next;
+    int depth = 0;
+
+    for (n = top; n && n->cached; n = next) {
+        for (struct ccnl_content_s *c = n->cs; c; c = c->trie_next) {
+            if (ccnl_i_prefixof_c(prefix, ppkd, minsuffix, maxsuffix, c)) {
+                return c;
+            }
+        }
+
+        // the first child with content, as long as longer names can match
+        next = NULL;
+
+        if (depth + 1 < maxsuffix) {
+            for (next = n->children; next && !next->cached; next = next->sibling);
+        }
+
+        if (next) {
+            depth++;
+            continue;
+        }
+
+        // else the next sibling with content of n or of an ancestor
+        for (; n != top; n = n->parent, depth--) {
+            for (next = n->sibling; next && !next->cached; next = next->sibling);
+
+            if (next) {
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// eof
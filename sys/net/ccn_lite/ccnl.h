@@ -21,7 +21,13 @@
  * 2011-03-30 created
  */
 
-#define CCNL_MAX_INTERFACES             2 /* transceiver and msg interfaces */
+#ifndef CCNL_MAX_INTERFACES
+#define CCNL_MAX_INTERFACES             3 /* msg, transceiver and one added interface */
+#endif
+
+#ifndef CCNL_MAX_IMAGES
+#define CCNL_MAX_IMAGES                 4 /* see ccnl_riot_relay_add_image */
+#endif
 
 #define CCNL_INTEREST_TIMEOUT_SEC       0
 #define CCNL_INTEREST_TIMEOUT_USEC      ((CCNL_CHECK_RETRANSMIT_USEC) * ((CCNL_MAX_INTEREST_RETRANSMIT) + 1))
@@ -29,8 +35,7 @@
 #define CCNL_CONTENT_TIMEOUT_SEC        2
 #define CCNL_CONTENT_TIMEOUT_USEC       0
 
-#define CCNL_NONCE_TIMEOUT_SEC          0
-#define CCNL_NONCE_TIMEOUT_USEC         (3 * (CCNL_CHECK_RETRANSMIT_USEC))
+#define CCNL_NONCE_TIMEOUT_MS           (3 * (CCNL_CHECK_RETRANSMIT_USEC) / 1000)
 
 #define CCNL_MAX_CONTENT_SERVED_STAT    10
 
@@ -43,16 +48,67 @@
 #define CCNL_FWD_TIMEOUT_SEC            10
 #define CCNL_FWD_TIMEOUT_USEC           0
 
-#define CCNL_CHECK_TIMEOUT_SEC          1
-#define CCNL_CHECK_TIMEOUT_USEC         0
-
 #define CCNL_CHECK_RETRANSMIT_SEC       0
 #define CCNL_CHECK_RETRANSMIT_USEC      (300 * 1000)
 
+#define CCNL_TIMER_HEAP_MIN_SIZE        16 /* initial slots of the event heap */
+
 #define CCNL_MAX_NAME_COMP              16
 #define CCNL_MAX_IF_QLEN                64
-
-#define CCNL_MAX_NONCES                 256 // for detected dups
+#define CCNL_MAX_FACE_QLEN              8
+
+#define CCNL_MAX_NONCES                 256 // for detected dups, a power of 2
+#define CCNL_NONCE_PROBES               8   // slots probed per nonce
+#define CCNL_NONCE_LEN                  8   // stored bytes, longer nonces by hash
+
+// content store (ccnl-cs.c)
+#define CCNL_CS_POLICY_LRU              0
+#define CCNL_CS_POLICY_LFU              1
+#ifndef CCNL_CS_POLICY
+#define CCNL_CS_POLICY                  CCNL_CS_POLICY_LRU
+#endif
+#define CCNL_CS_LFU_SAMPLE              8 // LFU: least recently used candidates
+#define CCNL_CS_INDEX_MIN_SIZE          16 // buckets, doubled as the store grows
+
+// forwarding strategies (ccnl_interest_propagate), CCNL_STRATEGY_* in ccnl-riot.h
+#define CCNL_STRATEGY_PROBE_INTERVAL    8 // adaptive: every n-th interest also probes
+#define CCNL_RTT_UNKNOWN_USEC           ((CCNL_CHECK_RETRANSMIT_USEC) / 2) // unmeasured faces
+#define CCNL_RTT_MAX_USEC               (4 * (CCNL_CHECK_RETRANSMIT_USEC))
+#define CCNL_MAX_NEXTHOPS               8 // faces considered per interest
+
+// windowed fragmentation (ccnl-ext-frag.c, CCNL_FRAG_CCNx2013)
+#define CCNL_FRAG_WINDOW                8 // fragments in flight, a power of 2 up to 32
+#define CCNL_FRAG_RTO_USEC              (100 * 1000)
+#define CCNL_FRAG_MAX_RETRIES           3 // retransmissions before a fragment is lost
+
+// name trie of PIT and FIB (ccnl-trie.c)
+#define CCNL_TRIE_INDEX_MIN_SIZE        16 // buckets, doubled as the trie grows
+
+// object pools (ccnl-pool.c), exhausted pools fall back to malloc
+#ifndef CCNL_POOL_BUF_SMALL_LEN
+#define CCNL_POOL_BUF_SMALL_LEN         32  // nonces, digests, short interests
+#endif
+#ifndef CCNL_POOL_BUF_SMALL_CNT
+#define CCNL_POOL_BUF_SMALL_CNT         16
+#endif
+#ifndef CCNL_POOL_BUF_LARGE_LEN
+#define CCNL_POOL_BUF_LARGE_LEN         144 // a chunk with its ccnb header
+#endif
+#ifndef CCNL_POOL_BUF_LARGE_CNT
+#define CCNL_POOL_BUF_LARGE_CNT         16
+#endif
+#ifndef CCNL_POOL_PREFIX_CNT
+#define CCNL_POOL_PREFIX_CNT            16
+#endif
+#ifndef CCNL_POOL_INTEREST_CNT
+#define CCNL_POOL_INTEREST_CNT          8
+#endif
+#ifndef CCNL_POOL_PENDINT_CNT
+#define CCNL_POOL_PENDINT_CNT           8
+#endif
+#ifndef CCNL_POOL_CONTENT_CNT
+#define CCNL_POOL_CONTENT_CNT           8
+#endif
 
 #define TIMEOUT_TO_US(SEC, USEC) ((SEC)*1000*1000 + (USEC))
 
@@ -109,6 +165,8 @@
 
 #define CCNL_DTAG_FRAG_OLOSS    (CCNL_DTAG_FRAGMENT+5)  // our loss count
 #define CCNL_DTAG_FRAG_YSEQN    (CCNL_DTAG_FRAGMENT+6)  // your (highest) seq no
+#define CCNL_DTAG_FRAG_SACK     (CCNL_DTAG_FRAGMENT+7)  // bit k: got YSEQN+1+k
+#define CCNL_DTAG_FRAG_WBASE    (CCNL_DTAG_FRAGMENT+8)  // our oldest seq held
 /*
 #define CCNL_DTAG_FRAG_YSEQN16  (CCNL_DTAG_FRAGMENT+4)
 #define CCNL_DTAG_FRAG_YSEQN32  (CCNL_DTAG_FRAGMENT+5)
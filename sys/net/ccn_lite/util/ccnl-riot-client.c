@@ -19,63 +19,200 @@
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <stdlib.h>
 
 #include "msg.h"
 #include "random.h"
+#include "vtimer.h"
 
 #include "ccnl.h"
 #include "ccnl-core.h"
 #include "ccnl-riot-compat.h"
 #include "ccn-lite-ctrl.h"
 #include "ccnl-pdu.h"
+#include "ccn_lite/util/ccnl-riot-client.h"
+
+/* an outstanding interest of a pipelined fetch, the relay reads rmsg and
+ * interest from the queue of its thread, so they live until the chunk is in */
+struct ccnl_riot_client_slot {
+    int chunk;
+    int received;
+    int retries;
+    int timed_out;
+    uint32_t sent;          // last expression of the interest in us
+    uint32_t waiting;       // start of the current timeout period in us
+    riot_ccnl_msg_t rmsg;
+    unsigned char interest[PAYLOAD_SIZE];
+};
 
-int ccnl_riot_client_get(kernel_pid_t relay_pid, char *name, char *reply_buf)
+static uint32_t client_now(void)
 {
-    char *prefix[CCNL_MAX_NAME_COMP];
-    char *cp = strtok(name, "/");
-    int i = 0;
+    timex_t now;
+    vtimer_now(&now);
+    return (uint32_t) timex_uint64(now);
+}
+
+static void client_express(kernel_pid_t relay_pid, char **prefix, int n,
+                           struct ccnl_riot_client_slot *slot)
+{
+    char segment_string[16];
+    unsigned int interest_nonce = genrand_uint32();
+    msg_t m;
+
+    snprintf(segment_string, sizeof(segment_string), "%d", slot->chunk);
+    prefix[n] = segment_string;
+    prefix[n + 1] = NULL;
+    slot->rmsg.payload = slot->interest;
+    slot->rmsg.size = mkInterest(prefix, &interest_nonce, slot->interest);
+    prefix[n] = NULL;
+    DEBUGMSG(1, "relay_pid=%" PRIkernel_pid " chunk=%d interest_len=%d\n",
+             relay_pid, slot->chunk, slot->rmsg.size);
+
+    m.content.ptr = (char *) &slot->rmsg;
+    m.type = CCNL_RIOT_MSG;
+    slot->sent = slot->waiting = client_now();
+    msg_send(&m, relay_pid, 1);
+}
+
+/* the chunk number in a name component, -1 if it is none */
+static int client_chunk_number(unsigned char *comp, int complen)
+{
+    char num[16];
+
+    if (!comp || complen < 1 || complen >= (int) sizeof(num)) {
+        return -1;
+    }
+
+    memcpy(num, comp, complen);
+    num[complen] = '\0';
+    return atoi(num);
+}
 
-    while (i < (CCNL_MAX_NAME_COMP - 1) && cp) {
-        prefix[i++] = cp;
+/* the chunk number of a content of name prefix[0..n-1], -1 for others */
+static int client_chunk_of(struct ccnl_pkt_view_s *v, char **prefix, int n)
+{
+    if (v->compcnt != n + 1) {
+        return -1;
+    }
+
+    for (int k = 0; k < n; k++) {
+        if (v->complen[k] != (int) strlen(prefix[k])
+            || memcmp(v->comp[k], prefix[k], v->complen[k])) {
+            return -1;
+        }
+    }
+
+    return client_chunk_number(v->comp[n], v->complen[n]);
+}
+
+int ccnl_riot_client_fetch(kernel_pid_t relay_pid, char *name,
+                           unsigned char *reply_buf, int reply_size,
+                           int window_max, ccnl_riot_client_stats_t *stats)
+{
+    char *prefix[CCNL_MAX_NAME_COMP + 1];
+    char *cp = strtok(name, "/");
+    struct ccnl_riot_client_slot *slots, *slot;
+    ccnl_riot_client_stats_t dummy;
+    int n = 0, base = 0, next = 0, last = -1, content_len = 0;
+    int win = 1, acc = 0;   // congestion window and its additive increase
+    int outstanding = 0;
+    uint32_t srtt = 0, rttvar = 0, rto = CCNL_RIOT_CLIENT_RTO_INIT;
+    uint32_t youngest = 0, lifetime;
+    msg_t rep;
+
+    while (n < (CCNL_MAX_NAME_COMP - 1) && cp) {
+        prefix[n++] = cp;
         cp = strtok(NULL, "/");
     }
 
-    //prefix[i] = 0; //segment to request
-    prefix[i + 1] = 0;
+    prefix[n] = NULL;
+
+    if (window_max < 1) {
+        window_max = 1;
+    }
+
+    stats = stats ? stats : &dummy;
+    memset(stats, 0, sizeof(*stats));
+    stats->window_max = win;
+
+    slots = calloc(window_max, sizeof(*slots));
+
+    if (!slots) {
+        puts("ccnl_riot_client_fetch: malloc failed");
+        return 0;
+    }
 
-    int content_len = 0;
+    while (last < 0 || base <= last) {
+        /* keep win interests outstanding */
+        while (next < base + win && (last < 0 || next <= last)
+               && next * CCNL_RIOT_CHUNK_SIZE < reply_size) {
+            slot = &slots[next % window_max];
+            memset(slot, 0, sizeof(*slot));
+            slot->chunk = next++;
+            client_express(relay_pid, prefix, n, slot);
+            stats->interests++;
+        }
 
-    for (int segment = 0; ; segment++) {
-        char segment_string[16]; //max=999\0
-        memset(segment_string, 0, 16);
-        snprintf(segment_string, 16, "%d", segment);
-        prefix[i] = segment_string;
-        unsigned char *interest_pkg = malloc(PAYLOAD_SIZE);
-        if (!interest_pkg) {
-            puts("ccnl_riot_client_get: malloc failed");
-            return 0;
+        if (base == next) {
+            /* reply_buf is full */
+            break;
         }
-        unsigned int interest_nonce = genrand_uint32();
-        int interest_len = mkInterest(prefix, &interest_nonce, interest_pkg);
-        DEBUGMSG(1, "relay_pid=%" PRIkernel_pid " interest_len=%d\n", relay_pid, interest_len);
 
-        riot_ccnl_msg_t rmsg;
-        rmsg.payload = interest_pkg;
-        rmsg.size = interest_len;
+        /* the oldest missing chunk is due after rto */
+        for (slot = NULL; base < next && (last < 0 || base <= last) && !slot; ) {
+            slot = &slots[base % window_max];
+            slot = slot->received ? NULL : slot;
+            base += !slot;
+        }
 
-        msg_t m, rep;
-        m.content.ptr = (char *) &rmsg;
-        m.type = CCNL_RIOT_MSG;
-        msg_send(&m, relay_pid, 1);
+        if (!slot) {
+            continue;
+        }
 
-        /* ######################################################################### */
+        uint32_t waited = client_now() - slot->waiting;
+
+        if (waited >= rto
+            || vtimer_msg_receive_timeout(&rep, timex_from_uint64(rto - waited)) < 0) {
+            /* multiplicative decrease, the relay retransmits the interest */
+            DEBUGMSG(1, "chunk %d overdue, window %d\n", slot->chunk, win);
+            stats->timeouts++;
+            slot->timed_out = 1;
+            slot->waiting = client_now();
+            win = (win > 1) ? win / 2 : 1;
+            acc = 0;
+            rto = (2 * rto < CCNL_RIOT_CLIENT_RTO_MAX) ? 2 * rto : CCNL_RIOT_CLIENT_RTO_MAX;
+            continue;
+        }
 
-        msg_receive(&rep);
-        free(interest_pkg);
         if (rep.type == CCNL_RIOT_NACK) {
-            /* network stack was not able to fetch this chunk */
-            return 0;
+            /* the relay gave up some interest, express the expired ones again */
+            uint32_t now = client_now();
+
+            for (int chunk = base; chunk < next; chunk++) {
+                slot = &slots[chunk % window_max];
+
+                if (slot->received || now - slot->sent
+                    < TIMEOUT_TO_US(CCNL_INTEREST_TIMEOUT_SEC, CCNL_INTEREST_TIMEOUT_USEC)) {
+                    continue;
+                }
+
+                if (slot->retries++ >= CCNL_RIOT_CLIENT_MAX_RETRIES) {
+                    /* network stack was not able to fetch this chunk */
+                    content_len = 0;
+                    goto Drain;
+                }
+
+                client_express(relay_pid, prefix, n, slot);
+                stats->interests++;
+                stats->retransmissions++;
+            }
+
+            continue;
+        }
+
+        if (rep.type != CCNL_RIOT_MSG) {
+            continue;
         }
 
         /* we got a chunk of data from the network stack */
@@ -85,38 +222,131 @@ int ccnl_riot_client_get(kernel_pid_t relay_pid, char *name, char *reply_buf)
         int datalen = (int) rmsg_reply->size;
         DEBUGMSG(1, "%d bytes left; msg from=%" PRIkernel_pid "\n", datalen, rep.sender_pid);
 
-        int scope = 3, aok = 3, minsfx = 0, maxsfx = CCNL_MAX_NAME_COMP,
-            contlen = 0;
-        struct ccnl_buf_s *buf = 0, *nonce = 0, *ppkd = 0;
-        struct ccnl_prefix_s *p = 0;
-        unsigned char *content = 0;
+        if (datalen > 2 && data[0] == 0x04 && data[1] == 0x82) {
+            /* skip the ContentObject tag, the name is parsed from its body */
+            data += 2;
+            datalen -= 2;
+        }
 
-        buf = ccnl_extract_prefix_nonce_ppkd(&data, &datalen, &scope, &aok, &minsfx,
-                                             &maxsfx, &p, &nonce, &ppkd, &content, &contlen);
+        /* the content is read in place, the message is freed below */
+        struct ccnl_pkt_view_s v;
+        int chunk = -1, contlen;
 
-        if (!buf) {
-            DEBUGMSG(6, "  parsing error or no prefix\n");
-            return 0;
+        if (ccnl_ccnb_parse(&data, &datalen, &v) == 0 && v.content) {
+            chunk = client_chunk_of(&v, prefix, n);
         }
 
-        DEBUGMSG(1, "content_len=%d contlen=%d\n", content_len, contlen);
-        memcpy(reply_buf + content_len, content, contlen);
-        content_len += contlen;
+        contlen = v.contlen;
+        slot = &slots[(chunk < 0 ? 0 : chunk) % window_max];
+
+        if (chunk < base || chunk >= next || slot->received) {
+            DEBUGMSG(6, "  parsing error or not an outstanding chunk\n");
+        }
+        else {
+            int offset = chunk * CCNL_RIOT_CHUNK_SIZE;
+            int len = (contlen < reply_size - offset) ? contlen : reply_size - offset;
+            int final = client_chunk_number(v.finalblock, v.finalblocklen);
+
+            DEBUGMSG(1, "chunk=%d contlen=%d final=%d\n", chunk, contlen, final);
+            memcpy(reply_buf + offset, v.content, len);
+
+            if (final >= chunk && (last < 0 || final < last)) {
+                /* no interests past the final block */
+                last = final;
+            }
+
+            slot->received = 1;
+            stats->chunks++;
+
+            if (offset + len > content_len) {
+                content_len = offset + len;
+            }
+
+            if (!slot->retries && !slot->timed_out) {
+                /* RTT estimation as in RFC 6298 */
+                uint32_t rtt = client_now() - slot->sent;
+
+                if (!srtt) {
+                    srtt = rtt;
+                    rttvar = rtt / 2;
+                }
+                else {
+                    rttvar = (3 * rttvar + (srtt > rtt ? srtt - rtt : rtt - srtt)) / 4;
+                    srtt = (7 * srtt + rtt) / 8;
+                }
+
+                rto = srtt + 4 * rttvar;
+                rto = (rto < CCNL_RIOT_CLIENT_RTO_MIN) ? CCNL_RIOT_CLIENT_RTO_MIN : rto;
+                rto = (rto > CCNL_RIOT_CLIENT_RTO_MAX) ? CCNL_RIOT_CLIENT_RTO_MAX : rto;
+            }
+
+            /* additive increase by one chunk per window */
+            if (++acc >= win && win < window_max) {
+                win++;
+                acc = 0;
+
+                if (win > (int) stats->window_max) {
+                    stats->window_max = win;
+                }
+            }
+
+            if (contlen < CCNL_RIOT_CHUNK_SIZE || CCNL_RIOT_CHUNK_SIZE < contlen) {
+                /* last chunk */
+                last = chunk;
+                content_len = offset + len;
+            }
+        }
 
-        free_prefix(p);
-        free_3ptr_list(buf, nonce, ppkd);
         ccnl_free(rmsg_reply);
+    }
+
+Drain:
+    /* The relay answers every interest still outstanding with content or
+     * a NACK once it expired, at the latest a retransmission period after
+     * its lifetime. Wait for them, they must neither end in the queue of
+     * the caller nor find the slots freed. */
+    lifetime = TIMEOUT_TO_US(CCNL_INTEREST_TIMEOUT_SEC, CCNL_INTEREST_TIMEOUT_USEC)
+               + TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC);
+
+    for (int chunk = base; chunk < next; chunk++) {
+        slot = &slots[chunk % window_max];
+
+        if (!slot->received) {
+            if (!outstanding++ || (int32_t)(slot->sent - youngest) > 0) {
+                youngest = slot->sent;
+            }
+        }
+    }
+
+    stats->drained = outstanding;
+
+    while (outstanding > 0) {
+        uint32_t age = client_now() - youngest;
 
-        DEBUGMSG(1, "contentlen=%d CCNL_RIOT_CHUNK_SIZE=%d\n", contlen, CCNL_RIOT_CHUNK_SIZE);
-        if (contlen < CCNL_RIOT_CHUNK_SIZE || CCNL_RIOT_CHUNK_SIZE < contlen) {
-            /* last chunk */
+        if (age >= lifetime
+            || vtimer_msg_receive_timeout(&rep, timex_from_uint64(lifetime - age)) < 0) {
             break;
         }
+
+        if (rep.type == CCNL_RIOT_MSG) {
+            ccnl_free(rep.content.ptr);
+            outstanding--;
+        }
+        else if (rep.type == CCNL_RIOT_NACK) {
+            outstanding--;
+        }
     }
 
+    free(slots);
     return content_len;
 }
 
+int ccnl_riot_client_get(kernel_pid_t relay_pid, char *name, char *reply_buf)
+{
+    return ccnl_riot_client_fetch(relay_pid, name, (unsigned char *) reply_buf,
+                                  INT_MAX, CCNL_RIOT_CLIENT_WINDOW, NULL);
+}
+
 int ccnl_riot_client_new_face(kernel_pid_t relay_pid, char *type, char *faceid,
                   unsigned char *reply_buf)
 {
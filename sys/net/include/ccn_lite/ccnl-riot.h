@@ -42,8 +42,15 @@
 
 #define CCNL_DEFAULT_CHANNEL 6
 #define CCNL_DEFAULT_MAX_CACHE_ENTRIES  0   /* 0: no content caching, cache is disabled */
+#define CCNL_DEFAULT_MAX_CACHE_BYTES    0   /* 0: cache size limited by entries only */
 #define CCNL_DEFAULT_THRESHOLD_PREFIX   1
 #define CCNL_DEFAULT_THRESHOLD_AGGREGATE 2
+#define CCNL_DEFAULT_STRATEGY           CCNL_STRATEGY_MULTICAST
+
+/* forwarding strategies, how interests are sent to the faces of the FIB */
+#define CCNL_STRATEGY_MULTICAST     (0) /* every matching face */
+#define CCNL_STRATEGY_BEST_ROUTE    (1) /* the face with the lowest rtt */
+#define CCNL_STRATEGY_ADAPTIVE      (2) /* best route, probing the runner-up */
 
 #define CCNL_RIOT_EVENT_NUMBER_OFFSET (1 << 8)
 #define CCNL_RIOT_MSG                 (CCNL_RIOT_EVENT_NUMBER_OFFSET + 0)
@@ -52,7 +59,10 @@
 #define CCNL_RIOT_PRINT_STAT          (CCNL_RIOT_EVENT_NUMBER_OFFSET + 3)
 #define CCNL_RIOT_NACK                (CCNL_RIOT_EVENT_NUMBER_OFFSET + 4)
 #define CCNL_RIOT_CONFIG_CACHE        (CCNL_RIOT_EVENT_NUMBER_OFFSET + 5)
-#define CCNL_RIOT_RESERVED            (CCNL_RIOT_EVENT_NUMBER_OFFSET + 6)
+#define CCNL_RIOT_CONFIG_CACHE_BYTES  (CCNL_RIOT_EVENT_NUMBER_OFFSET + 6)
+#define CCNL_RIOT_CONFIG_STRATEGY     (CCNL_RIOT_EVENT_NUMBER_OFFSET + 7)
+#define CCNL_RIOT_IF_PKT              (CCNL_RIOT_EVENT_NUMBER_OFFSET + 8)
+#define CCNL_RIOT_RESERVED            (CCNL_RIOT_EVENT_NUMBER_OFFSET + 9)
 
 #define CCNL_HEADER_SIZE (40)
 
@@ -67,6 +77,66 @@
 #  define CCNL_RIOT_CHUNK_SIZE (PAYLOAD_SIZE - CCNL_HEADER_SIZE)
 #endif
 
+/**
+ * @brief a frame received on an interface added by
+ *        ccnl_riot_relay_add_interface(), sent as CCNL_RIOT_IF_PKT
+ */
+typedef struct ccnl_riot_if_pkt {
+    void *payload;
+    uint16_t size;
+    uint16_t src;               /**< link layer address of the sender */
+    int ifndx;                  /**< the interface it was received on */
+    volatile uint8_t processing; /**< decremented by the relay when done */
+} ccnl_riot_if_pkt_t;
+
+/**
+ * @brief adds an interface to the relay, next to the msg and the transceiver
+ *        interface, e.g. a tap device of a border node
+ *
+ * @note  must be called before the relay is started
+ *
+ * By default there is room for one added interface, every interface
+ * takes a transmit queue of CCNL_MAX_IF_QLEN requests. Define
+ * CCNL_MAX_INTERFACES for more.
+ *
+ * @param sendfunc  sends a frame to a link layer address, UINT16_MAX
+ *                  addresses all neighbours
+ * @param mtu       the largest frame sendfunc can send
+ *
+ * @return the index of the interface, -1 if CCNL_MAX_INTERFACES are in use
+ */
+int ccnl_riot_relay_add_interface(int (*sendfunc)(uint8_t *buf, uint16_t size,
+                                  uint16_t to), uint16_t mtu);
+
+/**
+ * @brief adds a content image to the relay, signed content objects in ccnb
+ *        one after another, e.g. a firmware built into the flash
+ *
+ * The relay answers interests from an index of the image, the objects are
+ * neither copied nor do they count against the cache size.
+ *
+ * @note  must be called before the relay is started
+ *
+ * @param image     the content objects, must stay valid and unchanged
+ * @param len       the size of the image
+ *
+ * @return 0 on success, -1 if CCNL_MAX_IMAGES are in use
+ */
+int ccnl_riot_relay_add_image(const unsigned char *image, int len);
+
+#ifdef CPU_NATIVE
+/**
+ * @brief reads a content image from a file and adds it to the relay
+ *
+ * @note  must be called before the relay is started
+ *
+ * @param path      the file, see ccnl_riot_relay_add_image()
+ *
+ * @return 0 on success, -1 on error
+ */
+int ccnl_riot_relay_load_image(const char *path);
+#endif
+
 /**
  * @brief starts the ccnl relay
  *
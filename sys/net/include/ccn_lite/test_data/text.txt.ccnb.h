@@ -20,7 +20,7 @@
 
 #if RIOT_CCNL_POPULATE
 
-unsigned char text_txt_ccnb_0[] = {
+const unsigned char text_txt_ccnb_0[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x30, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x48, 0x69, 0x73, 0x74, 0x6f, 0x72, 0x79, 0x0a, 0x3d, 0x3d,
@@ -32,8 +32,8 @@ unsigned char text_txt_ccnb_0[] = {
   0x57, 0x61, 0x72, 0x65, 0x2c, 0x20, 0x61, 0x6e, 0x20, 0x6f, 0x70, 0x65,
   0x72, 0x61, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x73, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_0_len = 118;
-unsigned char text_txt_ccnb_1[] = {
+const unsigned int text_txt_ccnb_0_len = 118;
+const unsigned char text_txt_ccnb_1[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x31, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x79, 0x73, 0x74, 0x65, 0x6d, 0x20, 0x66, 0x6f, 0x72, 0x20,
@@ -45,8 +45,8 @@ unsigned char text_txt_ccnb_1[] = {
   0x65, 0x63, 0x74, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20, 0x66, 0x69,
   0x72, 0x65, 0x66, 0x69, 0x67, 0x68, 0x74, 0x65, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_1_len = 118;
-unsigned char text_txt_ccnb_10[] = {
+const unsigned int text_txt_ccnb_1_len = 118;
+const unsigned char text_txt_ccnb_10[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x30, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x6d, 0x69, 0x73, 0x73,
@@ -58,8 +58,8 @@ unsigned char text_txt_ccnb_10[] = {
   0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d,
   0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_10_len = 119;
-unsigned char text_txt_ccnb_11[] = {
+const unsigned int text_txt_ccnb_10_len = 119;
+const unsigned char text_txt_ccnb_11[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x31, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d, 0x3d,
@@ -71,8 +71,8 @@ unsigned char text_txt_ccnb_11[] = {
   0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
   0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x0a, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_11_len = 119;
-unsigned char text_txt_ccnb_12[] = {
+const unsigned int text_txt_ccnb_11_len = 119;
+const unsigned char text_txt_ccnb_12[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x32, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x0a, 0x50, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20,
@@ -84,8 +84,8 @@ unsigned char text_txt_ccnb_12[] = {
   0x65, 0x6e, 0x76, 0x69, 0x72, 0x6f, 0x6e, 0x6d, 0x65, 0x6e, 0x74, 0x73,
   0x2e, 0x0a, 0x0a, 0x2d, 0x20, 0x53, 0x74, 0x61, 0x6e, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_12_len = 119;
-unsigned char text_txt_ccnb_13[] = {
+const unsigned int text_txt_ccnb_12_len = 119;
+const unsigned char text_txt_ccnb_13[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x33, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x64, 0x61, 0x72, 0x64, 0x20, 0x70, 0x72, 0x6f, 0x67,
@@ -97,8 +97,8 @@ unsigned char text_txt_ccnb_13[] = {
   0x2c, 0x20, 0x67, 0x64, 0x62, 0x0a, 0x2d, 0x20, 0x4d, 0x69, 0x6e, 0x69,
   0x6d, 0x69, 0x7a, 0x65, 0x64, 0x20, 0x68, 0x61, 0x72, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_13_len = 119;
-unsigned char text_txt_ccnb_14[] = {
+const unsigned int text_txt_ccnb_13_len = 119;
+const unsigned char text_txt_ccnb_14[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x34, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x64, 0x77, 0x61, 0x72, 0x65, 0x20, 0x64, 0x65, 0x70,
@@ -110,8 +110,8 @@ unsigned char text_txt_ccnb_14[] = {
   0x20, 0x43, 0x6f, 0x64, 0x65, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x2c, 0x20,
   0x72, 0x75, 0x6e, 0x20, 0x62, 0x6f, 0x74, 0x68, 0x20, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_14_len = 119;
-unsigned char text_txt_ccnb_15[] = {
+const unsigned int text_txt_ccnb_14_len = 119;
+const unsigned char text_txt_ccnb_15[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x35, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x6f, 0x6e, 0x20, 0x31, 0x36, 0x2d, 0x62, 0x69, 0x74,
@@ -123,8 +123,8 @@ unsigned char text_txt_ccnb_15[] = {
   0x2d, 0x20, 0x50, 0x61, 0x72, 0x74, 0x69, 0x61, 0x6c, 0x20, 0x50, 0x4f,
   0x53, 0x49, 0x58, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x6c, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_15_len = 119;
-unsigned char text_txt_ccnb_16[] = {
+const unsigned int text_txt_ccnb_15_len = 119;
+const unsigned char text_txt_ccnb_16[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x36, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x69, 0x61, 0x6e, 0x63, 0x65, 0x2e, 0x20, 0x54, 0x6f,
@@ -136,8 +136,8 @@ unsigned char text_txt_ccnb_16[] = {
   0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
   0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_16_len = 119;
-unsigned char text_txt_ccnb_17[] = {
+const unsigned int text_txt_ccnb_16_len = 119;
+const unsigned char text_txt_ccnb_17[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x37, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x0a, 0x0a, 0x42, 0x65, 0x6e, 0x65, 0x66, 0x69, 0x74,
@@ -149,8 +149,8 @@ unsigned char text_txt_ccnb_17[] = {
   0x20, 0x76, 0x65, 0x72, 0x79, 0x20, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x77,
   0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x65, 0x76, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_17_len = 119;
-unsigned char text_txt_ccnb_18[] = {
+const unsigned int text_txt_ccnb_17_len = 119;
+const unsigned char text_txt_ccnb_18[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x38, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x69, 0x63, 0x65, 0x73, 0x2e, 0x0a, 0x0a, 0x2d, 0x20,
@@ -162,8 +162,8 @@ unsigned char text_txt_ccnb_18[] = {
   0x6e, 0x65, 0x72, 0x67, 0x79, 0x2d, 0x65, 0x66, 0x66, 0x69, 0x63, 0x69,
   0x65, 0x6e, 0x63, 0x79, 0x0a, 0x2d, 0x20, 0x52, 0x65, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_18_len = 119;
-unsigned char text_txt_ccnb_19[] = {
+const unsigned int text_txt_ccnb_18_len = 119;
+const unsigned char text_txt_ccnb_19[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x31, 0x39, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x61, 0x6c, 0x2d, 0x74, 0x69, 0x6d, 0x65, 0x20, 0x63,
@@ -175,8 +175,8 @@ unsigned char text_txt_ccnb_19[] = {
   0x65, 0x73, 0x29, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x70, 0x72, 0x69, 0x6f,
   0x72, 0x69, 0x74, 0x79, 0x2d, 0x62, 0x61, 0x73, 0x65, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_19_len = 119;
-unsigned char text_txt_ccnb_2[] = {
+const unsigned int text_txt_ccnb_19_len = 119;
+const unsigned char text_txt_ccnb_2[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x32, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x72, 0x73, 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20,
@@ -188,8 +188,8 @@ unsigned char text_txt_ccnb_2[] = {
   0x69, 0x6d, 0x65, 0x20, 0x67, 0x75, 0x61, 0x72, 0x61, 0x6e, 0x74, 0x65,
   0x65, 0x73, 0x2e, 0x0a, 0x0a, 0x32, 0x30, 0x31, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_2_len = 118;
-unsigned char text_txt_ccnb_20[] = {
+const unsigned int text_txt_ccnb_2_len = 118;
+const unsigned char text_txt_ccnb_20[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x30, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x64, 0x20, 0x73, 0x63, 0x68, 0x65, 0x64, 0x75, 0x6c,
@@ -201,8 +201,8 @@ unsigned char text_txt_ccnb_20[] = {
   0x20, 0x62, 0x79, 0x74, 0x65, 0x73, 0x20, 0x70, 0x65, 0x72, 0x20, 0x74,
   0x68, 0x72, 0x65, 0x61, 0x64, 0x29, 0x0a, 0x0a, 0x52, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_20_len = 119;
-unsigned char text_txt_ccnb_21[] = {
+const unsigned int text_txt_ccnb_20_len = 119;
+const unsigned char text_txt_ccnb_21[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x31, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x49, 0x4f, 0x54, 0x20, 0x69, 0x73, 0x20, 0x49, 0x6f,
@@ -214,8 +214,8 @@ unsigned char text_txt_ccnb_21[] = {
   0x79, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x6d,
   0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20, 0x74, 0x68, 0x69, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_21_len = 119;
-unsigned char text_txt_ccnb_22[] = {
+const unsigned int text_txt_ccnb_21_len = 119;
+const unsigned char text_txt_ccnb_22[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x32, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x6e, 0x67, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68,
@@ -227,8 +227,8 @@ unsigned char text_txt_ccnb_22[] = {
   0x2c, 0x20, 0x54, 0x43, 0x50, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x55,
   0x44, 0x50, 0x0a, 0x2d, 0x20, 0x53, 0x74, 0x61, 0x74, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_22_len = 119;
-unsigned char text_txt_ccnb_23[] = {
+const unsigned int text_txt_ccnb_22_len = 119;
+const unsigned char text_txt_ccnb_23[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x33, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x69, 0x63, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x64, 0x79,
@@ -240,8 +240,8 @@ unsigned char text_txt_ccnb_23[] = {
   0x20, 0x48, 0x69, 0x67, 0x68, 0x20, 0x72, 0x65, 0x73, 0x6f, 0x6c, 0x75,
   0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_23_len = 119;
-unsigned char text_txt_ccnb_24[] = {
+const unsigned int text_txt_ccnb_23_len = 119;
+const unsigned char text_txt_ccnb_24[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x34, 0x00, 0x00, 0x01,
   0x9a, 0x05, 0xd5, 0x6c, 0x6f, 0x6e, 0x67, 0x2d, 0x74, 0x65, 0x72, 0x6d,
@@ -253,8 +253,8 @@ unsigned char text_txt_ccnb_24[] = {
   0x72, 0x6f, 0x75, 0x74, 0x69, 0x6e, 0x67, 0x2c, 0x20, 0x63, 0x6c, 0x75,
   0x73, 0x74, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x2c, 0x20, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_24_len = 119;
-unsigned char text_txt_ccnb_25[] = {
+const unsigned int text_txt_ccnb_24_len = 119;
+const unsigned char text_txt_ccnb_25[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x95, 0x32, 0x35, 0x00, 0x00, 0x01,
   0x9a, 0x03, 0xb5, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x79, 0x6e, 0x63, 0x2c,
@@ -263,8 +263,8 @@ unsigned char text_txt_ccnb_25[] = {
   0x61, 0x6e, 0x64, 0x20, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x61, 0x6c, 0x67,
   0x6f, 0x72, 0x69, 0x74, 0x68, 0x6d, 0x73, 0x29, 0x0a, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_25_len = 83;
-unsigned char text_txt_ccnb_3[] = {
+const unsigned int text_txt_ccnb_25_len = 83;
+const unsigned char text_txt_ccnb_3[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x33, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x30, 0x0a, 0x2d, 0x2d, 0x2d, 0x2d, 0x0a, 0x0a, 0x54, 0x6f,
@@ -276,8 +276,8 @@ unsigned char text_txt_ccnb_3[] = {
   0x65, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x49, 0x45, 0x54, 0x46, 0x0a, 0x70,
   0x72, 0x6f, 0x74, 0x6f, 0x63, 0x6f, 0x6c, 0x73, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_3_len = 118;
-unsigned char text_txt_ccnb_4[] = {
+const unsigned int text_txt_ccnb_3_len = 118;
+const unsigned char text_txt_ccnb_4[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x34, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x2c, 0x20, 0x26, 0x6d, 0x69, 0x63, 0x72, 0x6f, 0x3b, 0x6b,
@@ -289,8 +289,8 @@ unsigned char text_txt_ccnb_4[] = {
   0x72, 0x74, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x36, 0x4c, 0x6f, 0x57, 0x50,
   0x41, 0x4e, 0x2c, 0x20, 0x52, 0x50, 0x4c, 0x2c, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_4_len = 118;
-unsigned char text_txt_ccnb_5[] = {
+const unsigned int text_txt_ccnb_4_len = 118;
+const unsigned char text_txt_ccnb_5[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x35, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x54, 0x43, 0x50, 0x20, 0x77,
@@ -302,8 +302,8 @@ unsigned char text_txt_ccnb_5[] = {
   0x73, 0x20, 0x70, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x2e, 0x20, 0x52, 0x49,
   0x4f, 0x54, 0x20, 0x69, 0x73, 0x20, 0x74, 0x68, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_5_len = 118;
-unsigned char text_txt_ccnb_6[] = {
+const unsigned int text_txt_ccnb_5_len = 118;
+const unsigned char text_txt_ccnb_6[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x36, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x65, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x20, 0x73,
@@ -315,8 +315,8 @@ unsigned char text_txt_ccnb_6[] = {
   0x20, 0x70, 0x72, 0x6f, 0x62, 0x6c, 0x65, 0x6d, 0x73, 0x20, 0x77, 0x69,
   0x74, 0x68, 0x20, 0x73, 0x70, 0x65, 0x6c, 0x6c, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_6_len = 118;
-unsigned char text_txt_ccnb_7[] = {
+const unsigned int text_txt_ccnb_6_len = 118;
+const unsigned char text_txt_ccnb_7[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x37, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x69, 0x6e, 0x67, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x70, 0x72,
@@ -328,8 +328,8 @@ unsigned char text_txt_ccnb_7[] = {
   0x6f, 0x6d, 0x6f, 0x74, 0x65, 0x20, 0x52, 0x49, 0x4f, 0x54, 0x20, 0x74,
   0x6f, 0x20, 0x61, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_7_len = 118;
-unsigned char text_txt_ccnb_8[] = {
+const unsigned int text_txt_ccnb_7_len = 118;
+const unsigned char text_txt_ccnb_8[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x38, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x65, 0x72, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x75, 0x6e, 0x69,
@@ -341,8 +341,8 @@ unsigned char text_txt_ccnb_8[] = {
   0x74, 0x20, 0x6f, 0x6e, 0x67, 0x6f, 0x69, 0x6e, 0x67, 0x20, 0x65, 0x6e,
   0x68, 0x61, 0x6e, 0x63, 0x65, 0x6d, 0x65, 0x6e, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_8_len = 118;
-unsigned char text_txt_ccnb_9[] = {
+const unsigned int text_txt_ccnb_8_len = 118;
+const unsigned char text_txt_ccnb_9[] = {
   0x04, 0x82, 0xf2, 0xfa, 0xa5, 0x72, 0x69, 0x6f, 0x74, 0x00, 0xfa, 0xa5,
   0x74, 0x65, 0x78, 0x74, 0x00, 0xfa, 0x8d, 0x39, 0x00, 0x00, 0x01, 0x9a,
   0x05, 0xd5, 0x74, 0x73, 0x0a, 0x69, 0x6e, 0x20, 0x6f, 0x75, 0x72, 0x20,
@@ -354,6 +354,6 @@ unsigned char text_txt_ccnb_9[] = {
   0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x75, 0x6e, 0x69, 0x74, 0x79, 0x20, 0x6b,
   0x6e, 0x6f, 0x77, 0x20, 0x77, 0x68, 0x61, 0x74, 0x00, 0x00
 };
-unsigned int text_txt_ccnb_9_len = 118;
+const unsigned int text_txt_ccnb_9_len = 118;
 
 #endif
@@ -28,7 +28,68 @@
 #define CCNL_RIOT_CLIENT_H
 
 /**
- * @brief  high level function to fetch a file (all chunks of a file)
+ * @brief  largest number of outstanding interests of ccnl_riot_client_get
+ */
+#define CCNL_RIOT_CLIENT_WINDOW         (4)
+
+/**
+ * @brief  bounds of the timeout after which an overdue chunk halves the
+ *         window, in microseconds
+ */
+#define CCNL_RIOT_CLIENT_RTO_INIT       (600 * 1000)
+#define CCNL_RIOT_CLIENT_RTO_MIN        (50 * 1000)
+#define CCNL_RIOT_CLIENT_RTO_MAX        (2 * 1000 * 1000)
+
+/**
+ * @brief  interests expressed again for a chunk the relay gave up on
+ */
+#define CCNL_RIOT_CLIENT_MAX_RETRIES    (3)
+
+/**
+ * @brief  statistics of ccnl_riot_client_fetch
+ */
+typedef struct {
+    unsigned int chunks;            /**< chunks received */
+    unsigned int interests;         /**< interests expressed, repeated ones included */
+    unsigned int retransmissions;   /**< interests expressed again after a NACK */
+    unsigned int timeouts;          /**< overdue chunks, each halved the window */
+    unsigned int window_max;        /**< largest window reached */
+    unsigned int drained;           /**< interests still outstanding at the end */
+} ccnl_riot_client_stats_t;
+
+/**
+ * @brief  fetches all chunks of a file with up to *window_max* interests
+ *         outstanding
+ *
+ * The window starts at one interest, grows by one for every window of
+ * chunks received and is halved whenever a chunk is overdue. Chunks may
+ * arrive in any order, each is copied to its offset in reply_buf. No
+ * interests are expressed past the FinalBlockID of a chunk (see mkChunk())
+ * or past a chunk shorter than CCNL_RIOT_CHUNK_SIZE. Before it returns, the
+ * fetch waits for the answers to interests that are still outstanding.
+ *
+ * @param relay_pid pid of the relay thread
+ *
+ * @param name c string represenation of the name to fetch e.g. "/riot/test",
+ *             the string is modified
+ *
+ * @param reply_buf buffer for the content
+ *
+ * @param reply_size size of reply_buf, the fetch stops when it is full
+ *
+ * @param window_max largest number of outstanding interests
+ *
+ * @param stats statistics of the fetch, may be NULL
+ *
+ * @return the length of the content stored in reply_buf, 0 on failure
+ */
+int ccnl_riot_client_fetch(kernel_pid_t relay_pid, char *name,
+                           unsigned char *reply_buf, int reply_size,
+                           int window_max, ccnl_riot_client_stats_t *stats);
+
+/**
+ * @brief  high level function to fetch a file (all chunks of a file),
+ *         pipelining up to CCNL_RIOT_CLIENT_WINDOW interests
  *
  * @param relay_pid pid of the relay thread
  *
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_rpl
+ * @{
+ *
+ * @file        link_estimator.h
+ * @brief       Passive estimation of the ETX of the links to the neighbors
+ *
+ * The estimator listens to the frames the 6LoWPAN MAC layer exchanges
+ * anyway and sends no probes. Every unicast frame the radio sends or
+ * fails to send is a sample of the ETX of the link to that neighbor,
+ * the frames received from a neighbor keep it in the table and give the
+ * smoothed RSSI and LQI of the link. The ETX is kept in fixed point,
+ * LINK_ESTIMATOR_ETX_ONE is an ETX of 1.
+ *
+ * A transmission only counts as failed if the transceiver returns an
+ * error for it. The radios driven through the transceiver module, native
+ * among them, do not report missing acknowledgements, so there the ETX of
+ * every link a frame can be sent over converges to 1 and MRHOF ranks the
+ * parents by the hop count alone.
+ */
+
+#ifndef LINK_ESTIMATOR_H
+#define LINK_ESTIMATOR_H
+
+#include <stdint.h>
+
+#include "sixlowpan/types.h"
+#include "sixlowpan/mac.h"
+#include "net_if.h"
+
+/**
+ * @brief   ETX of 1, as in the representation of RFC 6551.
+ */
+#define LINK_ESTIMATOR_ETX_ONE      (128)
+
+/**
+ * @brief   ETX of a neighbor nothing was sent to so far.
+ */
+#ifndef LINK_ESTIMATOR_ETX_INIT
+#define LINK_ESTIMATOR_ETX_INIT     (2 * LINK_ESTIMATOR_ETX_ONE)
+#endif
+
+/**
+ * @brief   Sample of a frame that failed LINK_ESTIMATOR_MAX_TX times in a row.
+ */
+#define LINK_ESTIMATOR_ETX_MAX      (8 * LINK_ESTIMATOR_ETX_ONE)
+
+/**
+ * @brief   Failed transmissions in a row that count as a lost frame.
+ */
+#define LINK_ESTIMATOR_MAX_TX       (4)
+
+/**
+ * @brief   A sample changes the estimate by 1 / 2^LINK_ESTIMATOR_ALPHA_SHIFT
+ *          of the difference.
+ */
+#define LINK_ESTIMATOR_ALPHA_SHIFT  (3)
+
+/**
+ * @brief   Number of neighbors the estimator keeps.
+ */
+#ifndef LINK_ESTIMATOR_MAX_NEIGHBORS
+#define LINK_ESTIMATOR_MAX_NEIGHBORS    (16)
+#endif
+
+/**
+ * @brief   Estimate of the link to a neighbor.
+ */
+typedef struct {
+    net_if_eui64_t addr;    /**< link layer address of the neighbor */
+    uint16_t etx;           /**< ETX, LINK_ESTIMATOR_ETX_ONE is 1 */
+    uint8_t tx_fail;        /**< failed transmissions since the last success */
+    uint8_t rssi;           /**< smoothed RSSI, as the radio reports it */
+    uint8_t lqi;            /**< smoothed LQI, as the radio reports it */
+    uint8_t heard;          /**< 1 once a frame was received from the neighbor */
+    uint8_t used;           /**< 1 if the entry is in use */
+    uint32_t last_heard;    /**< time of the last received frame in seconds */
+} link_estimator_neighbor_t;
+
+/**
+ * @brief   Starts the estimation, the 6LoWPAN MAC layer must be up.
+ */
+void link_estimator_init(void);
+
+/**
+ * @brief   Moves an estimate towards a sample by
+ *          1 / 2^LINK_ESTIMATOR_ALPHA_SHIFT of the difference, but by
+ *          at least 1.
+ *
+ * @param[in] value     The estimate.
+ * @param[in] sample    The new sample.
+ *
+ * @return  The new estimate.
+ */
+uint16_t link_estimator_ewma(uint16_t value, uint16_t sample);
+
+/**
+ * @brief   The handler link_estimator_init() registers with the 6LoWPAN
+ *          MAC layer, see sixlowpan_mac_link_handler_t.
+ */
+void link_estimator_handler(sixlowpan_mac_link_event_t event,
+                            const net_if_eui64_t *neighbor,
+                            uint8_t rssi, uint8_t lqi);
+
+/**
+ * @brief   Returns the ETX of the link to a neighbor.
+ *
+ * @param[in] addr  IPv6 address of the neighbor, only its interface
+ *                  identifier is looked at.
+ *
+ * @return  ETX of the link, LINK_ESTIMATOR_ETX_ONE is 1, 0 if the
+ *          neighbor is unknown.
+ */
+uint16_t link_estimator_get_etx(ipv6_addr_t *addr);
+
+/**
+ * @brief   Prints the neighbors and the estimates of their links.
+ */
+void link_estimator_show_neighbors(void);
+
+#endif /* LINK_ESTIMATOR_H */
+/** @} */
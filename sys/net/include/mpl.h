@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_mpl MPL
+ * @ingroup     net
+ * @brief       Multicast Protocol for Low-Power and Lossy Networks, RFC 7731
+ *
+ * MPL disseminates packets to all nodes of a realm-local MPL domain, for
+ * example configuration updates or firmware chunks. Once mpl_init() ran,
+ * every packet the node sends to a realm-local multicast address
+ * (ff03::/16), e.g. with a UDP socket, is originated as an MPL data
+ * message with the node as its seed. Every node buffers the messages it
+ * receives and retransmits them as long as its trickle timer for the
+ * message runs, a message is delivered locally only once and only if the
+ * node subscribed to the destination address.
+ *
+ * Only proactive forwarding is implemented: there are no MPL control
+ * messages, so a message that is no longer buffered by the neighbors of a
+ * node is not requested again. A neighbor that sends an older message
+ * with the M flag set restarts the timers of the newer messages of the
+ * seed. The seed id is always the source address of the message.
+ *
+ * @{
+ *
+ * @file        mpl.h
+ * @brief       MPL forwarder
+ */
+
+#ifndef __MPL_H
+#define __MPL_H
+
+#include <stdint.h>
+
+#include "ipv6.h"
+
+/**
+ * @brief   Number of seeds a node keeps the sequence window of.
+ */
+#ifndef MPL_SEED_SET_SIZE
+#define MPL_SEED_SET_SIZE                   (8)
+#endif
+
+/**
+ * @brief   Number of messages a node buffers to retransmit them.
+ */
+#ifndef MPL_BUFFERED_MESSAGES
+#define MPL_BUFFERED_MESSAGES               (8)
+#endif
+
+/**
+ * @brief   Seconds a seed stays in the seed set after its last new message.
+ */
+#ifndef MPL_SEED_SET_ENTRY_LIFETIME
+#define MPL_SEED_SET_ENTRY_LIFETIME         (1800)
+#endif
+
+/**
+ * @brief   Minimum trickle interval of data messages in milliseconds.
+ */
+#ifndef MPL_DATA_MESSAGE_IMIN
+#define MPL_DATA_MESSAGE_IMIN               (64)
+#endif
+
+/**
+ * @brief   Doublings of MPL_DATA_MESSAGE_IMIN up to the maximum interval.
+ */
+#ifndef MPL_DATA_MESSAGE_IMAX
+#define MPL_DATA_MESSAGE_IMAX               (2)
+#endif
+
+/**
+ * @brief   Redundancy constant of the trickle timer of data messages.
+ */
+#ifndef MPL_DATA_MESSAGE_K
+#define MPL_DATA_MESSAGE_K                  (1)
+#endif
+
+/**
+ * @brief   Trickle intervals a message is retransmitted in, after that
+ *          it is only kept to detect duplicates.
+ */
+#ifndef MPL_DATA_MESSAGE_TIMER_EXPIRATIONS
+#define MPL_DATA_MESSAGE_TIMER_EXPIRATIONS  (3)
+#endif
+
+#define MPL_PKT_RECV_BUF_SIZE               (16)
+#define MPL_PROCESS_STACKSIZE               KERNEL_CONF_STACKSIZE_DEFAULT
+
+/**
+ * @brief   Counters of the MPL forwarder.
+ */
+typedef struct {
+    uint32_t originated;    /**< messages this node is the seed of */
+    uint32_t received;      /**< new messages of other seeds */
+    uint32_t duplicates;    /**< messages received again or too old */
+    uint32_t dropped;       /**< new messages that could not be buffered */
+    uint32_t transmitted;   /**< transmissions of all messages */
+} mpl_stats_t;
+
+/**
+ * @brief   Starts the MPL forwarder and subscribes the interface to the
+ *          All MPL Forwarders address.
+ *
+ * The interface has to be initialized with sixlowpan_lowpan_init_interface()
+ * or rpl_init() before.
+ *
+ * @param[in] if_id     interface to forward on
+ *
+ * @return  0 on success, -1 on failure.
+ */
+int mpl_init(int if_id);
+
+/**
+ * @brief   Sets *addr* to the All MPL Forwarders address ff03::fc.
+ *
+ * @param[out] addr     the address
+ */
+void mpl_addr_set_all_forwarders(ipv6_addr_t *addr);
+
+/**
+ * @brief   Copies the counters of the MPL forwarder to *stats*.
+ *
+ * @param[out] stats    the counters
+ */
+void mpl_get_stats(mpl_stats_t *stats);
+
+#endif /* __MPL_H */
+/** @} */
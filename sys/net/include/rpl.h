@@ -43,7 +43,6 @@
 
 /* global variables */
 extern rpl_of_t *rpl_objective_functions[NUMBER_IMPLEMENTED_OFS];
-extern rpl_routing_entry_t rpl_routing_table[RPL_MAX_ROUTING_ENTRIES];
 extern kernel_pid_t rpl_process_pid;
 
 /* needed for receiving messages with ICMP-code 155. Received via IPC from ipv6.c */
@@ -93,6 +92,42 @@ rpl_of_t *rpl_get_of_for_ocp(uint16_t ocp);
  */
 void rpl_init_root(void);
 
+/**
+ * @brief Initialization of an RPL instance with this node as root.
+ *
+ * Like rpl_init_root(), but for a DODAG of the given instance and objective function.
+ * A node may be root of several instances and member of others at the same time.
+ *
+ * @param[in] instanceid        ID of the new instance
+ * @param[in] ocp               Objective code point of the objective function of the instance
+ *
+ */
+void rpl_init_root_instance(uint8_t instanceid, uint16_t ocp);
+
+/**
+ * @brief Maps packets to a destination port to an RPL instance.
+ *
+ * UDP and TCP packets this node sends to @p port carry an RPL option (RFC 6553) for the
+ * instance and are routed by it on every hop. All other packets use the default instance.
+ * Mapping a port again replaces its instance.
+ *
+ * @param[in] port              Destination port
+ * @param[in] instanceid        ID of the instance
+ *
+ * @return 0 on success
+ * @return -1 if all RPL_MAX_PORT_MAPPINGS mappings are in use
+ *
+ */
+int rpl_map_port(uint16_t port, uint8_t instanceid);
+
+/**
+ * @brief Removes the instance mapping of a destination port.
+ *
+ * @param[in] port              Destination port
+ *
+ */
+void rpl_unmap_port(uint16_t port);
+
 /**
  * @brief Sends a DIO-message to a given destination
  *
@@ -100,25 +135,28 @@ void rpl_init_root(void);
  * differently in different modes, this function just sets the mutex and call the DIO
  * sending function of the chosen mode.
  *
+ * @param[in] dodag             DODAG the DIO is sent for.
  * @param[in] destination       IPv6-address of the destination of the DIO. Should be a direct neighbor.
  *
  */
-void send_DIO(ipv6_addr_t *destination);
+void send_DIO(rpl_dodag_t *dodag, ipv6_addr_t *destination);
 
 /**
  * @brief Sends a DAO-message to a given destination
  *
  * This function sends a DAO message to a given destination. Because nodes can act
  * differently in different modes, this function just sets the mutex and call the DAO
- * sending function of the chosen mode.
+ * sending function of the chosen mode. Only the targets the parent has not
+ * acknowledged yet are sent, in as many DAOs as needed. A lifetime of 0
+ * withdraws every target.
  *
+ * @param[in] dodag             DODAG the DAO is sent for.
  * @param[in] destination       IPv6-address of the destination of the DAO. Should be the preferred parent.
  * @param[in] lifetime          Lifetime of the node. Reflect the estimated time of presence in the network.
  * @param[in] default_lifetime  If true, param lifetime is ignored and lifetime is dodag default-lifetime
- * @param[in] start_index       Describes whether a DAO must be split because of too many routing entries.
  *
  */
-void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index);
+void send_DAO(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime);
 
 /**
  * @brief Sends a DIS-message to a given destination
@@ -139,10 +177,12 @@ void send_DIS(ipv6_addr_t *destination);
  * differently in different modes, this function just sets the mutex and call the DAO_ACK
  * sending function of the chosen mode.
  *
+ * @param[in] dodag             DODAG of the acknowledged DAO.
  * @param[in] destination       IPv6-address of the destination of the DAO_ACK. Should be a direct neighbor.
+ * @param[in] sequence          DAO sequence number of the acknowledged DAO.
  *
  */
-void send_DAO_ACK(ipv6_addr_t *destination);
+void send_DAO_ACK(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t sequence);
 
 /**
  * @brief Receives a DIO message
@@ -194,7 +234,7 @@ void recv_rpl_DAO_ACK(void);
 void *rpl_process(void *arg);
 
 /**
- * @brief Returns next hop from routing table.
+ * @brief Returns next hop from the routing table of the default instance.
  *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
@@ -206,18 +246,57 @@ void *rpl_process(void *arg);
  * */
 ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr);
 
+/**
+ * @brief Returns next hop within a DODAG.
+ *
+ * @param[in] dodag                 Joined DODAG
+ * @param[in] addr                  Destination address
+ *
+ * @return Next hop address, the preferred parent if there is no route
+ *
+ * */
+ipv6_addr_t *rpl_get_instance_next_hop(rpl_dodag_t *dodag, ipv6_addr_t *addr);
+
+/**
+ * @brief Fills the RPL option of a packet this node originates.
+ *
+ * Registered with the IPv6 layer, see ipv6_iface_set_rpl_option_provider().
+ *
+ * @param[in] packet                The packet
+ * @param[out] opt                  The option
+ *
+ * @return 1 if the destination port of the packet is mapped to a joined instance, 0 otherwise
+ *
+ * */
+int rpl_set_option(ipv6_hdr_t *packet, ipv6_rpl_opt_t *opt);
+
+/**
+ * @brief Returns next hop for a packet with an RPL option.
+ *
+ * Routes within the instance of the option, detects rank inconsistencies (RFC 6550,
+ * section 11.2) and updates the option for the next hop.
+ *
+ * @param[in] addr                  Destination address
+ * @param[in,out] opt               RPL option of the packet
+ *
+ * @return Next hop address, NULL if the packet is to be dropped
+ *
+ * */
+ipv6_addr_t *rpl_get_next_hop_for_option(ipv6_addr_t *addr, ipv6_rpl_opt_t *opt);
+
 /**
  * @brief Adds routing entry to routing table
  *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
+ * @param[in] inst                  Instance of the routing table
  * @param[in] addr                  Destination address
  * @param[in] next_hop              Next hop address
  * @param[in] lifetime              Lifetime of the entry
  *
  * */
-void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime);
+void rpl_add_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime);
 
 /**
  * @brief Deletes routing entry to routing table
@@ -225,10 +304,11 @@ void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t li
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
+ * @param[in] inst                  Instance of the routing table
  * @param[in] addr                  Destination address
  *
  * */
-void rpl_del_routing_entry(ipv6_addr_t *addr);
+void rpl_del_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr);
 
 /**
  * @brief Finds routing entry for a given destination.
@@ -236,12 +316,13 @@ void rpl_del_routing_entry(ipv6_addr_t *addr);
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
+ * @param[in] inst                  Instance of the routing table
  * @param[in] addr                  Destination address
  *
  * @return Routing entry address
  *
  * */
-rpl_routing_entry_t *rpl_find_routing_entry(ipv6_addr_t *addr);
+rpl_routing_entry_t *rpl_find_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr);
 
 /**
  * @brief Clears routing table.
@@ -249,8 +330,10 @@ rpl_routing_entry_t *rpl_find_routing_entry(ipv6_addr_t *addr);
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
+ * @param[in] inst                  Instance of the routing table
+ *
  * */
-void rpl_clear_routing_table(void);
+void rpl_clear_routing_table(rpl_instance_t *inst);
 
 /**
  * @brief Returns routing table
@@ -258,10 +341,23 @@ void rpl_clear_routing_table(void);
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
+ * @param[in] inst                  Instance of the routing table
+ *
  * @return Routing table
  *
  * */
-rpl_routing_entry_t *rpl_get_routing_table(void);
+rpl_routing_entry_t *rpl_get_routing_table(rpl_instance_t *inst);
+
+/**
+ * @brief Returns the seconds until a routing entry expires.
+ *
+ * @param[in] inst                  Instance of the routing table
+ * @param[in] entry                 Entry of the routing table
+ *
+ * @return Remaining lifetime, 0 for a withdrawn route
+ *
+ * */
+uint16_t rpl_get_routing_entry_lifetime(rpl_instance_t *inst, rpl_routing_entry_t *entry);
 
 /** @} */
 #endif /* __RPL_H */
@@ -43,6 +43,7 @@
 #define RPL_OPT_SOLICITED_INFO_LEN  19
 #define RPL_OPT_TARGET_LEN          18
 #define RPL_OPT_TRANSIT_LEN         4
+#define RPL_OPT_TRANSIT_PARENT_LEN  20
 
 /* message options */
 #define RPL_OPT_PAD1                 0
@@ -92,7 +93,9 @@ static inline bool RPL_COUNTER_GREATER_THAN(uint8_t A,uint8_t B)
 
 /*  RPL Constants and Variables */
 
+#ifndef RPL_DEFAULT_MOP
 #define RPL_DEFAULT_MOP RPL_STORING_MODE_NO_MC
+#endif
 #define BASE_RANK 0
 #define INFINITE_RANK 0xFFFF
 #define RPL_DEFAULT_INSTANCE 0
@@ -111,15 +114,49 @@ static inline bool RPL_COUNTER_GREATER_THAN(uint8_t A,uint8_t B)
 #define REGULAR_DAO_INTERVAL 300
 #define DAO_SEND_RETRIES 4
 #define DEFAULT_WAIT_FOR_DAO_ACK 15
+#define RPL_DAO_K_FLAG 0x80
+/* bytes of Target and Transit options in one DAO, more targets go into further DAOs */
+#ifndef RPL_DAO_MAX_LEN
+#define RPL_DAO_MAX_LEN 128
+#endif
+/* shortest prefix a sub-DODAG is announced with, 0 announces every node on its own */
+#ifndef RPL_DAO_AGGREGATE_LEN
+#define RPL_DAO_AGGREGATE_LEN 0
+#endif
 #define RPL_DODAG_ID_LEN 16
 
 /* others */
 
 #define NUMBER_IMPLEMENTED_OFS 2
+#ifndef RPL_MAX_DODAGS
 #define RPL_MAX_DODAGS 3
+#endif
+/* every instance has a routing table of its own */
+#ifndef RPL_MAX_INSTANCES
 #define RPL_MAX_INSTANCES 1
+#endif
+/* destination ports whose packets go through a given instance */
+#ifndef RPL_MAX_PORT_MAPPINGS
+#define RPL_MAX_PORT_MAPPINGS 4
+#endif
 #define RPL_MAX_PARENTS 5
+/* another parent is only preferred if the rank through it is lower by this
+ * much, 1.5 times the ETX rank of a link in MRHOF */
+#ifndef RPL_PARENT_SWITCH_THRESHOLD
+#define RPL_PARENT_SWITCH_THRESHOLD 192
+#endif
+/* seconds after a parent switch in which only the loss of the parent causes another one */
+#ifndef RPL_PARENT_SWITCH_HOLD
+#define RPL_PARENT_SWITCH_HOLD 30
+#endif
+/* routes of an instance, at most 65534 */
+#ifndef RPL_MAX_ROUTING_ENTRIES
 #define RPL_MAX_ROUTING_ENTRIES 128
+#endif
+/* hash buckets of a routing table, about four routes per bucket when it is full */
+#ifndef RPL_ROUTING_HASH_SIZE
+#define RPL_ROUTING_HASH_SIZE (RPL_MAX_ROUTING_ENTRIES / 4 + 1)
+#endif
 #define RPL_ROOT_RANK 256
 #define RPL_DEFAULT_LIFETIME 0xff
 #define RPL_LIFETIME_UNIT 2
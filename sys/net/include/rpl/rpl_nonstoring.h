@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_rpl
+ * @{
+ *
+ * @file        rpl_nonstoring.h
+ * @brief       RPL non-storing mode, source routes of the root
+ *
+ * In non-storing mode only the root keeps routes. Every node names its
+ * preferred parent in the DAO it sends to the root, the root stores one
+ * routing entry per node with the parent as next hop and finds the route
+ * to a node by following the parents up to itself. The root inserts the
+ * route as an RFC 6554 source routing header, the other nodes forward
+ * such packets along the header and everything else to their preferred
+ * parent, so they need no routing table at all.
+ */
+
+#ifndef __RPL_NS_H
+#define __RPL_NS_H
+
+#include "rpl_structs.h"
+#include "rpl_config.h"
+#include "rpl.h"
+
+/**
+ * @brief Initialization of the root of a non-storing DODAG.
+ *
+ * Registers the source routes of the root with the IPv6 layer. Packets with an RPL
+ * option are source routed in the DODAG of its instance, all others in the DODAG of
+ * the default instance.
+ *
+ */
+void rpl_ns_init_root(void);
+
+/**
+ * @brief Stores the parent a node announced in its DAO.
+ *
+ * A lifetime of 0 is a No-Path DAO, it removes the entry if it still
+ * names the given parent.
+ *
+ * @param[in] dodag                 DODAG this node is root of.
+ * @param[in] target                Address of the node.
+ * @param[in] parent                Address of the parent of the node.
+ * @param[in] lifetime              Lifetime of the entry.
+ *
+ */
+void rpl_ns_add_route(rpl_dodag_t *dodag, ipv6_addr_t *target, ipv6_addr_t *parent, uint16_t lifetime);
+
+/**
+ * @brief Returns the neighbor of the root a node is reached through.
+ *
+ * @param[in] dodag                 DODAG this node is root of.
+ * @param[in] addr                  Destination address
+ *
+ * @return Next hop address, NULL if there is no route to the destination
+ *
+ */
+ipv6_addr_t *rpl_ns_get_next_hop(rpl_dodag_t *dodag, ipv6_addr_t *addr);
+
+/**
+ * @brief Returns the source route from the root to a node.
+ *
+ * @param[in] dest                  Destination address
+ * @param[in] opt                   RPL option of the packet, NULL if it has none
+ * @param[out] hops                 The hops between the root and the destination, the first hop first
+ * @param[in] max_hops              Size of @p hops
+ *
+ * @return Number of hops, 0 if the destination is a neighbor of the root and -1 if there is no route
+ *
+ */
+int rpl_ns_get_source_route(ipv6_addr_t *dest, ipv6_rpl_opt_t *opt, ipv6_addr_t *hops, int max_hops);
+
+#endif /* __RPL_NS_H */
+/** @} */
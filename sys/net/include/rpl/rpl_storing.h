@@ -36,8 +36,11 @@
  * This function initializes all RPL resources especially for root purposes. Initializes a new DODAG and sets
  * itself as root. Starts trickle-timer so sending DIOs starts and other can join the DODAG.
  *
+ * @param[in] instanceid            ID of the instance of the new DODAG.
+ * @param[in] ocp                   Objective code point of the objective function of the instance.
+ *
  */
-void rpl_init_root_mode(void);
+void rpl_init_root_mode(uint8_t instanceid, uint16_t ocp);
 
 /**
  * @brief Initialization of RPL storing mode.
@@ -55,23 +58,24 @@ void rpl_init_mode(ipv6_addr_t *my_ipv6_address);
  *
  * This function sends a DIO message to a given destination. This is triggered by the trickle-timer.
  *
+ * @param[in] dodag                 DODAG the DIO is sent for.
  * @param[in] destination           IPv6-address of the destination of the DIO. Should be a direct neighbor or multicast address.
  *
  */
-void send_DIO_mode(ipv6_addr_t *destination);
+void send_DIO_mode(rpl_dodag_t *dodag, ipv6_addr_t *destination);
 
 /**
  * @brief Sends a DAO-message to a given destination
  *
  * This function sends a DAO message to a given destination.
  *
+ * @param[in] dodag                 DODAG the DAO is sent for.
  * @param[in] destination           IPv6-address of the destination of the DAO. Should be the proffered parent.
  * @param[in] lifetime              Lifetime of the node. Reflect the estimated time of presence in the network.
  * @param[in] default_lifetime      If true, param lifetime is ignored and lifetime is DODAG default-lifetime
- * @param[in] start_index           Describes whether a DAO must be split because of too many routing entries.
  *
  */
-void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index);
+void send_DAO_mode(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime);
 
 /**
  * @brief Sends a DIS-message to a given destination
@@ -88,10 +92,12 @@ void send_DIS_mode(ipv6_addr_t *destination);
  *
  * This function sends a DAO_ACK message to a given destination.
  *
+ * @param[in] dodag                 DODAG of the acknowledged DAO.
  * @param[in] destination           IPv6-address of the destination of the DAO_ACK. Should be a direct neighbor.
+ * @param[in] sequence              DAO sequence number of the acknowledged DAO.
  *
  */
-void send_DAO_ACK_mode(ipv6_addr_t *destination);
+void send_DAO_ACK_mode(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t sequence);
 
 /**
  * @brief Receives a DIO message
@@ -133,13 +139,14 @@ void recv_rpl_dao_ack_mode(void);
  * relaying it in lower layers to sixlowpan. Because send-functions are wrapped by a mutex in rpl.c, the same
  * mutex applies here.
  *
+ * @param[in] dodag                 DODAG the message belongs to, NULL if none.
  * @param[in] destination           IPv6-address of the destination of the message.
  * @param[in] payload               Payload of the message.
  * @param[in] len                   Length of the message
  * @param[in] next_header           Index to next header in message.
  *
  */
-void rpl_send(ipv6_addr_t *destination, uint8_t *payload, uint16_t p_len, uint8_t next_header);
+void rpl_send(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t *payload, uint16_t p_len, uint8_t next_header);
 
 #endif /* __RPL_SM_H */
 /** @} */
@@ -17,6 +17,8 @@
 
 #include <string.h>
 #include "ipv6.h"
+#include "trickle.h"
+#include "rpl_config.h"
 
 #ifndef RPL_STRUCTS_H_INCLUDED
 #define RPL_STRUCTS_H_INCLUDED
@@ -111,6 +113,7 @@ typedef struct __attribute__((packed)) {
     uint8_t path_control;
     uint8_t path_sequence;
     uint8_t path_lifetime;
+    ipv6_addr_t parent;     /* non-storing mode only */
 } rpl_opt_transit_t;
 
 struct rpl_dodag_t;
@@ -121,18 +124,39 @@ typedef struct {
     uint8_t             dtsn;
     struct rpl_dodag_t *dodag;
     uint16_t            lifetime;
-    double              link_metric;
+    uint16_t            cost;   /* own rank through this parent, see rpl_parent_update() */
+    uint16_t            link_metric;        /* ETX of the link, LINK_ESTIMATOR_ETX_ONE is 1 */
     uint8_t             link_metric_type;
     uint8_t             used;
 } rpl_parent_t;
 
 struct rpl_of_t;
 
+typedef struct {
+    ipv6_addr_t address;
+    ipv6_addr_t next_hop;
+    uint32_t expires;       /* time of the routing table, see rpl_routing.h */
+    uint16_t hash_next;     /* index + 1 of the next entry in the bucket or the free list */
+    uint16_t heap_pos;      /* position + 1 in the expiry heap, 0 if it does not expire */
+    uint8_t used;
+    uint8_t prefix_len;
+    uint8_t dao_flags;      /* announcement state towards the parent */
+    uint8_t dao_seq;        /* DAO the entry was last announced in */
+} rpl_routing_entry_t;
+
 typedef struct {
     uint8_t id;
     uint8_t used;
     uint8_t joined;
-
+    /* the routing table, indices + 1 so that a cleared table is empty */
+    uint32_t rt_time;                           /* seconds */
+    uint16_t rt_end;                            /* entries behind it were never used */
+    uint16_t rt_free;                           /* first freed entry */
+    uint16_t rt_prefixes;                       /* entries for less than an address */
+    uint16_t rt_heap_len;
+    uint16_t rt_hash[RPL_ROUTING_HASH_SIZE];    /* first entry of each bucket */
+    uint16_t rt_heap[RPL_MAX_ROUTING_ENTRIES];  /* the earliest expiry first */
+    rpl_routing_entry_t routing_table[RPL_MAX_ROUTING_ENTRIES];
 } rpl_instance_t;
 
 //Node-internal representation of a DODAG, with nodespecific information
@@ -147,7 +171,8 @@ typedef struct rpl_dodag_t {
     uint8_t dio_min;
     uint8_t dio_redundancy;
     uint16_t maxrankincrease;
-    uint16_t minhoprankincrease;
+    uint16_t minhoprankincrease;    /* set with rpl_set_min_hop_rank_increase() */
+    uint8_t minhoprank_shift;       /* log2(minhoprankincrease) + 1 for a power of two, 0 otherwise */
     uint8_t default_lifetime;
     uint16_t lifetime_unit;
     uint8_t version;
@@ -158,7 +183,28 @@ typedef struct rpl_dodag_t {
     uint16_t min_rank;
     uint8_t joined;
     rpl_parent_t *my_preferred_parent;
+    rpl_parent_t *best_parent;      /* the parent of the lowest cost */
+    uint16_t parent_hold;           /* seconds until the next switch to a better parent */
+    uint16_t parent_switches;
+    uint16_t parent_switches_held;  /* better parents kept out by the hysteresis */
+    rpl_parent_t *parent_held;      /* the better parent held back now, if any */
     struct rpl_of_t *of;
+    trickle_t trickle;
+    uint8_t dao_scheduled;
+    uint8_t dao_counter;
+    vtimer_t dao_timer;
+    /* the target announced for the node itself, its address or a prefix */
+    ipv6_addr_t dao_target;
+    uint8_t dao_target_len;
+    uint8_t dao_target_flags;
+    uint8_t dao_target_seq;
+    uint16_t dao_refresh;   /* seconds until all targets are announced again */
+    /* the previous target, withdrawn in the next DAO */
+    ipv6_addr_t dao_old_target;
+    uint8_t dao_old_target_len;
+    uint8_t dao_aggregate_len;
+    uint16_t daos_sent;
+    uint32_t dao_bytes_sent;    /* ICMPv6 header, DAO base object and options */
 } rpl_dodag_t;
 
 typedef struct rpl_of_t {
@@ -172,11 +218,4 @@ typedef struct rpl_of_t {
     void (*process_dio)(void);  //DIO processing callback (acc. to OF0 spec, chpt 5)
 } rpl_of_t;
 
-typedef struct {
-    ipv6_addr_t address;
-    ipv6_addr_t next_hop;
-    uint16_t lifetime;
-    uint8_t used;
-} rpl_routing_entry_t;
-
 #endif
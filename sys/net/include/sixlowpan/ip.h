@@ -51,6 +51,11 @@
  */
 #define IPV6_MAX_ADDR_STR_LEN   (40)
 
+/**
+ * @brief   Protocol number for the IPv6 hop-by-hop options header.
+ */
+#define IPV6_PROTO_NUM_HOP_BY_HOP   (0)
+
 /**
  * @brief   L4 protocol number for TCP.
  */
@@ -61,6 +66,11 @@
  */
 #define IPV6_PROTO_NUM_UDP          (17)
 
+/**
+ * @brief   Protocol number for the IPv6 routing header.
+ */
+#define IPV6_PROTO_NUM_ROUTING      (43)
+
 /**
  * @brief   L4 protocol number for ICMPv6.
  */
@@ -76,6 +86,72 @@
  */
 #define IPV6_PROTO_NUM_IPV6_OPTS    (60)
 
+/**
+ * @brief   Routing type of the RPL source routing header.
+ *
+ * @see <a href="http://tools.ietf.org/html/rfc6554">
+ *          RFC 6554
+ *      </a>
+ */
+#define IPV6_SRH_ROUTING_TYPE       (3)
+
+/**
+ * @brief   Option type of the RPL option in the hop-by-hop options header.
+ *
+ * @see <a href="http://tools.ietf.org/html/rfc6553">
+ *          RFC 6553
+ *      </a>
+ */
+#define IPV6_OPT_TYPE_RPL           (0x63)
+
+/**
+ * @brief   Option data length of the RPL option.
+ */
+#define IPV6_OPT_RPL_LEN            (4)
+
+/**
+ * @brief   RPL option flag: the packet travels down the DODAG.
+ */
+#define IPV6_OPT_RPL_FLAG_O         (0x80)
+
+/**
+ * @brief   RPL option flag: a rank error was detected on the way.
+ */
+#define IPV6_OPT_RPL_FLAG_R         (0x40)
+
+/**
+ * @brief   RPL option flag: a node could not forward the packet.
+ */
+#define IPV6_OPT_RPL_FLAG_F         (0x20)
+
+/**
+ * @brief   Option type of the MPL option in the hop-by-hop options header.
+ *
+ * @see <a href="http://tools.ietf.org/html/rfc7731">
+ *          RFC 7731
+ *      </a>
+ */
+#define IPV6_OPT_TYPE_MPL           (0x6d)
+
+/**
+ * @brief   Option data length of the MPL option with a seed id of
+ *          length 0, the seed is the source of the packet.
+ */
+#define IPV6_OPT_MPL_LEN            (2)
+
+/**
+ * @brief   MPL option flag: the sequence is the largest one the sender
+ *          has of the seed.
+ */
+#define IPV6_OPT_MPL_FLAG_M         (0x20)
+
+/**
+ * @brief   Maximum number of hops a source route may have.
+ */
+#ifndef IPV6_SRH_MAX_HOPS
+#define IPV6_SRH_MAX_HOPS           (16)
+#endif
+
 /**
  * @brief message type for notification
  *
@@ -83,6 +159,21 @@
  */
 #define IPV6_PACKET_RECEIVED        (UPPER_LAYER_2)
 
+/**
+ * @brief   message type of packets with the MPL option
+ *
+ * @see ipv6_register_mpl_handler()
+ */
+#define IPV6_MPL_PACKET_RECEIVED    (UPPER_LAYER_3)
+
+/**
+ * @brief   message type of packets this node originates to a realm-local
+ *          multicast address, the scope of MPL domains
+ *
+ * @see ipv6_register_mpl_handler()
+ */
+#define IPV6_MPL_PACKET_SEND        (UPPER_LAYER_4)
+
 /**
  * @brief   Get IPv6 send/receive buffer.
  *
@@ -170,6 +261,24 @@ void ipv6_register_next_header_handler(uint8_t next_header, kernel_pid_t pid);
  */
 void ipv6_register_rpl_handler(kernel_pid_t pid);
 
+/**
+ * @brief   Registers the handler thread of packets with the MPL option.
+ *
+ * The thread gets a message of type IPV6_MPL_PACKET_RECEIVED with the
+ * packet as content.ptr and replies with content.value 1 if the packet
+ * is new and to be delivered locally, 0 if it is to be dropped. Packets
+ * with the MPL option are dropped if no thread is registered, and are
+ * never routed like unicast packets.
+ *
+ * Packets this node sends to a realm-local multicast address are handed
+ * to the thread with a message of type IPV6_MPL_PACKET_SEND instead of
+ * being sent, the thread replies with content.value 1 if it takes care
+ * of the packet and 0 on failure.
+ *
+ * @param[in] pid   PID of the handler thread.
+ */
+void ipv6_register_mpl_handler(kernel_pid_t pid);
+
 /**
  * @brief   Sets the first 64 bit of *ipv6_addr* to link local prefix.
  *
@@ -527,6 +636,45 @@ void ipv6_net_if_get_best_src_addr(ipv6_addr_t *src, const ipv6_addr_t *dest);
  */
 void ipv6_iface_set_routing_provider(ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest));
 
+/**
+ * @brief   Registers a function that returns source routes, e.g. on the
+ *          root of a non-storing RPL DODAG.
+ *          Packets this node sends or forwards to a destination with a
+ *          source route get an RFC 6554 source routing header and are
+ *          sent to the first hop of the route. The intermediate hops
+ *          forward the packet along the header without any state.
+ *          Such function shall write the hops between this node and
+ *          the destination to *hops*, the first hop first, and return
+ *          their number. It returns 0 if the destination is a neighbor
+ *          and -1 if it knows no source route to the destination.
+ *          *opt* is the RPL option of the packet, NULL if it has none.
+ *
+ * @param   source_route    function that returns the hops to reach dest
+ */
+void ipv6_iface_set_srh_provider(int (*source_route)(ipv6_addr_t *dest,
+                                 ipv6_rpl_opt_t *opt,
+                                 ipv6_addr_t *hops,
+                                 int max_hops));
+
+/**
+ * @brief   Registers the functions that handle the RPL option (RFC 6553)
+ *          of packets, which selects the RPL instance they are routed in.
+ *          *set_option* is called for every unicast packet this node
+ *          originates and shall fill *opt* and return 1 if the packet
+ *          is to carry the option, 0 otherwise.
+ *          *next_hop* replaces the routing provider for packets with
+ *          the option, it may update *opt* for the next hop and shall
+ *          return NULL if the packet is to be dropped.
+ *          The option is removed before a packet is delivered locally.
+ *
+ * @param   set_option  function that fills the option of a new packet
+ * @param   next_hop    function that returns the next hop to reach dest
+ */
+void ipv6_iface_set_rpl_option_provider(int (*set_option)(ipv6_hdr_t *packet,
+                                        ipv6_rpl_opt_t *opt),
+                                        ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest,
+                                                ipv6_rpl_opt_t *opt));
+
 /**
  * @brief Calculates the IPv6 upper-layer checksum.
  *
@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 
+#include "net_if.h"
 #include "transceiver.h"
 
 #include "sixlowpan/types.h"
@@ -33,6 +34,31 @@
  */
 #define IEEE_802154_MAX_ADDR_STR_LEN   (12)
 
+/**
+ * @brief   Link events the MAC layer reports to the link handler.
+ */
+typedef enum {
+    SIXLOWPAN_MAC_LINK_RX,          /**< a frame was received from the neighbor */
+    SIXLOWPAN_MAC_LINK_TX_OK,       /**< a unicast frame was sent to the neighbor */
+    SIXLOWPAN_MAC_LINK_TX_FAIL,     /**< the radio failed to send a unicast
+                                         frame to the neighbor */
+} sixlowpan_mac_link_event_t;
+
+/**
+ * @brief   Function that is told about the frames exchanged with a
+ *          neighbor, e.g. to estimate the quality of the link.
+ *
+ * @param[in]   event       What happened on the link.
+ * @param[in]   neighbor    The address of the neighbor.
+ * @param[in]   rssi        The RSSI of a received frame as the radio
+ *                          reports it, 0 for sent frames.
+ * @param[in]   lqi         The LQI of a received frame as the radio
+ *                          reports it, 0 for sent frames.
+ */
+typedef void (*sixlowpan_mac_link_handler_t)(sixlowpan_mac_link_event_t event,
+        const net_if_eui64_t *neighbor,
+        uint8_t rssi, uint8_t lqi);
+
 /**
  * @brief   Send an IEEE 802.15.4 frame to a long address.
  *
@@ -51,6 +77,14 @@
 int sixlowpan_mac_send_ieee802154_frame(int if_id, const void *dest,
                                         uint8_t dest_len, const void *payload, uint8_t length, uint8_t mcast);
 
+/**
+ * @brief   Registers the function the MAC layer reports link events to,
+ *          NULL to stop reporting.
+ *
+ * @param[in]   handler     The link handler.
+ */
+void sixlowpan_mac_set_link_handler(sixlowpan_mac_link_handler_t handler);
+
 /**
  * @brief   Initialise 6LoWPAN MAC layer and register it to interface layer
  *
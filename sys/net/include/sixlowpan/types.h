@@ -80,11 +80,45 @@ typedef struct __attribute__((packed)) {
     uint8_t hdrextlen;              /**< length of header in 8-octet units. */
     uint8_t routing_type;           /**< identify srh-variant. */
     uint8_t segments_left;          /**< remaining route segments before reaching destination. */
-    unsigned int cmpri:4, cmpre:4;  /**< 4+4 bit, expressing prefix octets from each/last segment. */
-    unsigned long pad:4;            /**< number of octets used for padding after adresses. */
-    unsigned long reserved:20;      /**< reserved. Set to 0. */
+    uint8_t cmpri_cmpre;            /**< 4+4 bit, expressing prefix octets from each/last segment. */
+    uint8_t pad_reserved;           /**< 4 bit number of octets used for padding after adresses, 4 bit reserved. */
+    uint16_t reserved;              /**< reserved. Set to 0. */
+    uint8_t addresses[];            /**< the compressed addresses and the padding. */
 } ipv6_srh_t;
 
+/**
+ * @brief   Data type to represent a hop-by-hop options header that
+ *          carries only the RPL option
+ *
+ * @see [RFC 6553](http://tools.ietf.org/html/rfc6553)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t nextheader;             /**< type of next header in this packet. */
+    uint8_t hdrextlen;              /**< length of header in 8-octet units, not counting the first 8 octets. */
+    uint8_t type;                   /**< option type, IPV6_OPT_TYPE_RPL. */
+    uint8_t length;                 /**< option data length, IPV6_OPT_RPL_LEN. */
+    uint8_t flags;                  /**< down, rank error and forwarding error flags. */
+    uint8_t instance_id;            /**< RPL instance the packet is routed in. */
+    uint16_t sender_rank;           /**< rank of the last hop, network byte order. */
+} ipv6_rpl_opt_t;
+
+/**
+ * @brief   Data type to represent a hop-by-hop options header that
+ *          carries only the MPL option with a seed id of length 0
+ *
+ * @see [RFC 7731](http://tools.ietf.org/html/rfc7731)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t nextheader;             /**< type of next header in this packet. */
+    uint8_t hdrextlen;              /**< length of header in 8-octet units, not counting the first 8 octets. */
+    uint8_t type;                   /**< option type, IPV6_OPT_TYPE_MPL. */
+    uint8_t length;                 /**< option data length, IPV6_OPT_MPL_LEN. */
+    uint8_t flags;                  /**< seed id length, M and V flags. */
+    uint8_t sequence;               /**< sequence of the message at its seed. */
+    uint8_t pad_type;               /**< PadN option to fill the header to 8 octets. */
+    uint8_t pad_length;             /**< length of the PadN option, 0. */
+} ipv6_mpl_opt_t;
+
 /**
  * @brief   Data type to represent an ICMPv6 packet header.
  *
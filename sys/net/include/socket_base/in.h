@@ -147,6 +147,11 @@
 
 #define IPPROTO_DONE            (257)             ///< last return value of *_input(), meaning "all job for this pkt is done".
 
+/*
+ * Options for level IPPROTO_TCP
+ */
+#define TCP_NODELAY             (1)               ///<  don't coalesce small writes
+
 #define IN_LOOPBACKNET          (127)             ///< official!
 
 #endif /* SOCKET_BASE_IN_H */
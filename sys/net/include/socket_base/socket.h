@@ -243,6 +243,42 @@ int32_t socket_base_recv(int s, void *buf, uint32_t len, int flags);
 int32_t socket_base_recvfrom(int s, void *buf, uint32_t len, int flags,
                                 sockaddr6_t *from, socklen_t *fromlen);
 
+/**
+ * Receives data through socket *s* without copying it into an application
+ * buffer. On success *buf* points to the received payload inside the network
+ * stack's buffer. The buffer stays valid until socket_base_recv_release() is
+ * called. For datagram sockets *buf* is the received packet itself and
+ * further packets for this protocol are held back until then, so release it
+ * as soon as possible. For stream sockets *buf* is the socket's receive
+ * buffer: every segment is still copied into it once, which keeps the TCP
+ * thread from waiting for the release. Segments arriving meanwhile are
+ * buffered behind it, but the loaned bytes stay out of the receive window
+ * until released.
+ *
+ * @param[in] s         The ID of the socket to receive from.
+ * @param[out] buf      Set to the received payload.
+ * @param[in] flags     Flags for possible later implementations (currently
+ *                      unused).
+ * @param[out] from     IPv6 Address of the data's sender, may be NULL for
+ *                      stream sockets.
+ * @param[out] fromlen  Length of address in *from* in byte (always 16), may
+ *                      be NULL for stream sockets.
+ *
+ * @return Number of bytes available in *buf*, -1 on error.
+ */
+int32_t socket_base_recvfrom_loan(int s, uint8_t **buf, int flags,
+                                  sockaddr6_t *from, socklen_t *fromlen);
+
+/**
+ * Hands the buffer obtained by socket_base_recvfrom_loan() on socket *s*
+ * back to the network stack.
+ *
+ * @param[in] s         The ID of the socket.
+ *
+ * @return 0 on success, -1 if nothing was loaned.
+ */
+int socket_base_recv_release(int s);
+
 /**
  * Sends data *buf* through socket *s*. Roughly identical to POSIX's
  * <a href="http://man.he.net/man2/send">send(2)</a>.
@@ -300,7 +336,8 @@ int socket_base_bind(int s, sockaddr6_t *addr, int addrlen);
  * Roughly identical to POSIX's <a href="http://man.he.net/man2/listen">listen(2)</a>.
  *
  * @param[in] s         The ID of the socket.
- * @param[in] backlog   Not implemented yet, may be 0.
+ * @param[in] backlog   Number of connection requests that may be pending
+ *                      until accepted, see TCP_MAX_BACKLOG.
  *
  * @return 0 on success, -1 otherwise.
  */
@@ -312,14 +349,33 @@ int socket_base_listen(int s, int backlog);
  * <a href="http://man.he.net/man2/accept">accept(2)</a>.
  *
  * @param[in] s         The ID of the socket.
- * @param[in] addr      The IPv6 address of the peer socket, or NULL if not
- *                      needed (not implemented yet).
+ * @param[out] addr     The IPv6 address of the peer socket, or NULL if not
+ *                      needed.
  * @param[in] addrlen   The length of *addr*, or NULL if not needed.
  *
  * @return New socket ID for communication. -1 on error.
  */
 int socket_base_accept(int s, sockaddr6_t *addr, socklen_t *addrlen);
 
+/**
+ * Sets the option *option_name* of socket *s*. Roughly identical to POSIX's
+ * <a href="http://man.he.net/man2/setsockopt">setsockopt(2)</a>.
+ *
+ * Supported are TCP_NODELAY on level IPPROTO_TCP, taking an int. If non-zero
+ * every call of socket_base_send() on a TCP socket goes out as segment of its
+ * own instead of being coalesced with further small writes.
+ *
+ * @param[in] s             The ID of the socket.
+ * @param[in] level         Protocol level of the option.
+ * @param[in] option_name   The option to set.
+ * @param[in] option_value  The value of the option.
+ * @param[in] option_len    Length of *option_value* in byte.
+ *
+ * @return 0 on success, -1 otherwise.
+ */
+int socket_base_setsockopt(int s, int level, int option_name,
+                           const void *option_value, socklen_t option_len);
+
 /**
  * Outputs a list of all open sockets to stdout. Information includes its
  * creation parameters, local and foreign address and ports, it's ID and the
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup tcp
+ * @{
+ * @file
+ * @brief   Always-on TCP connection statistics
+ */
+
+#ifndef TCP_STATS_H
+#define TCP_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Number of buckets of the RTT and RTO histograms.
+ */
+#define TCP_STATS_HIST_LEN      (8)
+
+/**
+ * Upper bound of the first histogram bucket in microseconds, every further
+ * bucket doubles the bound, the last one is open ended.
+ */
+#define TCP_STATS_HIST_BASE_US  (64 * 1000)
+
+/**
+ * Counters kept per connection and summed up for all connections.
+ */
+typedef struct {
+    uint32_t    segs_in;                        ///< segments received
+    uint32_t    segs_out;                       ///< segments sent
+    uint32_t    retransmissions;                ///< segments sent again
+    uint32_t    out_of_order;                   ///< segments with unexpected sequence number
+    uint32_t    zero_window;                    ///< zero windows advertised or received
+    uint32_t    handshakes;                     ///< completed three way handshakes
+    uint32_t    handshake_time;                 ///< time spent in handshakes in microseconds
+    uint32_t    syn_cookies;                    ///< SYN-ACKs answered statelessly by a listener
+    uint16_t    rtt_hist[TCP_STATS_HIST_LEN];   ///< measured round trip times
+    uint16_t    rto_hist[TCP_STATS_HIST_LEN];   ///< calculated retransmission timeouts
+} tcp_stats_t;
+
+/**
+ * Copies the statistics of socket *s* into *stats*.
+ *
+ * @param[in] s         The ID of a TCP socket or 0 for the totals of all
+ *                      connections.
+ * @param[out] stats    Statistics to fill.
+ *
+ * @return 0 on success, -1 if *s* is no TCP socket.
+ */
+int tcp_stats_get(int s, tcp_stats_t *stats);
+
+/**
+ * Prints the statistics of socket *s*, or of all connections if *s* is 0.
+ */
+void tcp_stats_print(int s);
+
+/**
+ * @}
+ */
+#endif /* TCP_STATS_H */
@@ -132,6 +132,10 @@ int net_if_iter_interfaces(int start)
         start++;
     }
 
+    if (start >= NET_IF_MAX) {
+        return -1;
+    }
+
     return start;
 }
 
@@ -313,7 +317,7 @@ int net_if_send_packet(int if_id, uint16_t target, const void *payload,
 {
     DEBUG("net_if_send_packet: if_id = %d, target = %d, payload = %p, "
           "payload_len = %d\n", if_id, target, payload, payload_len);
-    uint32_t response;
+    int32_t response;
 
     if (if_id < 0 || if_id > NET_IF_MAX || !interfaces[if_id].initialized) {
         DEBUG("Send packet: No interface initialized with ID %d.\n", if_id);
@@ -336,7 +340,7 @@ int net_if_send_packet(int if_id, uint16_t target, const void *payload,
 
         p.frame.dest_pan_id = net_if_get_pan_id(if_id);
         memcpy(p.frame.dest_addr, &target, 2);
-        response = net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
+        response = (int32_t) net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
     }
     else {
         radio_packet_t p;
@@ -344,11 +348,12 @@ int net_if_send_packet(int if_id, uint16_t target, const void *payload,
         p.data = (uint8_t *) payload;
         p.length = payload_len;
         p.dst = target;
-        response = net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
+        response = (int32_t) net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
     }
 
 
-    return (response > payload_len) ? (int)payload_len : (int)response;
+    /* the transceiver reports errors as negative values */
+    return (response > (int32_t) payload_len) ? (int)payload_len : (int)response;
 }
 
 int net_if_send_packet_long(int if_id, net_if_eui64_t *target,
@@ -357,7 +362,7 @@ int net_if_send_packet_long(int if_id, net_if_eui64_t *target,
     DEBUG("net_if_send_packet: if_id = %d, target = %016" PRIx64 ", "
           "payload = %p, payload_len = %d\n", if_id, NTOHLL(target->uint64), payload,
           payload_len);
-    uint32_t response;
+    int32_t response;
 
     if (if_id < 0 || if_id > NET_IF_MAX || !interfaces[if_id].initialized) {
         DEBUG("Send packet: No interface initialized with ID %d.\n", if_id);
@@ -379,7 +384,7 @@ int net_if_send_packet_long(int if_id, net_if_eui64_t *target,
         p.frame.fcf.frame_pend = 0;
         p.frame.dest_pan_id = net_if_get_pan_id(if_id);
         memcpy(p.frame.dest_addr, target, 8);
-        response = net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
+        response = (int32_t) net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
     }
     else {
         radio_packet_t p;
@@ -387,11 +392,12 @@ int net_if_send_packet_long(int if_id, net_if_eui64_t *target,
         p.data = (uint8_t *) payload;
         p.length = payload_len;
         p.dst = NTOHS(target->uint16[3]);
-        response = net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
+        response = (int32_t) net_if_transceiver_get_set_handler(if_id, SND_PKT, (void *)&p);
     }
 
 
-    return (response > payload_len) ? (int)payload_len : (int)response;
+    /* the transceiver reports errors as negative values */
+    return (response > (int32_t) payload_len) ? (int)payload_len : (int)response;
 }
 
 int net_if_register(int if_id, kernel_pid_t pid)
@@ -55,7 +55,11 @@ uint8_t *nextheader;
 kernel_pid_t udp_packet_handler_pid = KERNEL_PID_UNDEF;
 kernel_pid_t tcp_packet_handler_pid = KERNEL_PID_UNDEF;
 static volatile  kernel_pid_t _rpl_process_pid = KERNEL_PID_UNDEF;
+static volatile kernel_pid_t _mpl_process_pid = KERNEL_PID_UNDEF;
 ipv6_addr_t *(*ip_get_next_hop)(ipv6_addr_t *) = 0;
+int (*ip_get_source_route)(ipv6_addr_t *, ipv6_rpl_opt_t *, ipv6_addr_t *, int) = 0;
+int (*ip_set_rpl_option)(ipv6_hdr_t *, ipv6_rpl_opt_t *) = 0;
+ipv6_addr_t *(*ip_get_rpl_next_hop)(ipv6_addr_t *, ipv6_rpl_opt_t *) = 0;
 
 static ipv6_net_if_ext_t ipv6_net_if_ext[NET_IF_MAX];
 static ipv6_net_if_addr_t ipv6_net_if_addr_buffer[IPV6_NET_IF_ADDR_BUFFER_LEN];
@@ -64,17 +68,275 @@ static uint8_t ipv6_net_if_addr_buffer_count = 0;
 
 static uint8_t default_hop_limit = MULTIHOP_HOPLIMIT;
 
+/* hops of the source route of the packet in transmission */
+static ipv6_addr_t srh_hops[IPV6_SRH_MAX_HOPS];
+static mutex_t srh_mutex = MUTEX_INIT;
+
 /* registered upper layer threads */
 kernel_pid_t sixlowip_reg[SIXLOWIP_MAX_REGISTERED];
 
+/* the RPL option is the only hop-by-hop option this node adds or reads */
+static ipv6_rpl_opt_t *ipv6_get_rpl_opt(ipv6_hdr_t *packet)
+{
+    ipv6_rpl_opt_t *opt = (ipv6_rpl_opt_t *)((uint8_t *) packet + IPV6_HDR_LEN);
+
+    if (packet->nextheader != IPV6_PROTO_NUM_HOP_BY_HOP ||
+        opt->type != IPV6_OPT_TYPE_RPL) {
+        return NULL;
+    }
+
+    return opt;
+}
+
+/* the next header field of the header the source routing header follows */
+static uint8_t *ipv6_srh_prev_nextheader(ipv6_hdr_t *packet)
+{
+    ipv6_rpl_opt_t *opt = ipv6_get_rpl_opt(packet);
+
+    return (opt != NULL) ? &opt->nextheader : &packet->nextheader;
+}
+
+static uint16_t ipv6_rpl_opt_len(ipv6_hdr_t *packet)
+{
+    return (ipv6_get_rpl_opt(packet) != NULL) ? sizeof(ipv6_rpl_opt_t) : 0;
+}
+
+static ipv6_srh_t *ipv6_get_srh(ipv6_hdr_t *packet)
+{
+    return (ipv6_srh_t *)((uint8_t *) packet + IPV6_HDR_LEN +
+                          ipv6_rpl_opt_len(packet));
+}
+
+int ipv6_rpl_opt_insert(ipv6_hdr_t *packet)
+{
+    ipv6_rpl_opt_t *opt = (ipv6_rpl_opt_t *)((uint8_t *) packet + IPV6_HDR_LEN);
+    ipv6_rpl_opt_t new_opt;
+    uint16_t length = NTOHS(packet->length);
+
+    if (ip_set_rpl_option == NULL || ipv6_addr_is_multicast(&packet->destaddr) ||
+        ipv6_get_rpl_opt(packet) != NULL) {
+        return 0;
+    }
+
+    memset(&new_opt, 0, sizeof(new_opt));
+
+    if (ip_set_rpl_option(packet, &new_opt) <= 0) {
+        return 0;
+    }
+
+    if (IPV6_HDR_LEN + length + sizeof(ipv6_rpl_opt_t) > IPV6_MTU) {
+        DEBUG("ERROR: no room for the RPL option\n");
+        return -1;
+    }
+
+    memmove((uint8_t *) opt + sizeof(ipv6_rpl_opt_t), opt, length);
+    memcpy(opt, &new_opt, sizeof(ipv6_rpl_opt_t));
+    opt->nextheader = packet->nextheader;
+    opt->hdrextlen = 0;
+    opt->type = IPV6_OPT_TYPE_RPL;
+    opt->length = IPV6_OPT_RPL_LEN;
+
+    packet->nextheader = IPV6_PROTO_NUM_HOP_BY_HOP;
+    packet->length = HTONS(length + sizeof(ipv6_rpl_opt_t));
+
+    return sizeof(ipv6_rpl_opt_t);
+}
+
+void ipv6_rpl_opt_remove(ipv6_hdr_t *packet)
+{
+    ipv6_rpl_opt_t *opt = ipv6_get_rpl_opt(packet);
+    uint16_t length = NTOHS(packet->length);
+
+    if (opt == NULL || length < sizeof(ipv6_rpl_opt_t)) {
+        return;
+    }
+
+    packet->nextheader = opt->nextheader;
+    memmove(opt, (uint8_t *) opt + sizeof(ipv6_rpl_opt_t),
+            length - sizeof(ipv6_rpl_opt_t));
+    packet->length = HTONS(length - sizeof(ipv6_rpl_opt_t));
+}
+
+/* next hop towards the destination of packet, the routing provider must be set */
+static ipv6_addr_t *ipv6_get_next_hop(ipv6_hdr_t *packet)
+{
+    ipv6_rpl_opt_t *opt = ipv6_get_rpl_opt(packet);
+
+    if (opt != NULL && ip_get_rpl_next_hop != NULL) {
+        return ip_get_rpl_next_hop(&packet->destaddr, opt);
+    }
+
+    return ip_get_next_hop(&packet->destaddr);
+}
+
+/* number of leading octets of a and b that can be elided, at most 15 */
+static uint8_t srh_common_prefix(const ipv6_addr_t *a, const ipv6_addr_t *b)
+{
+    uint8_t n = 0;
+
+    while (n < IPV6_ADDR_LEN - 1 && a->uint8[n] == b->uint8[n]) {
+        n++;
+    }
+
+    return n;
+}
+
+int ipv6_srh_insert(ipv6_hdr_t *packet)
+{
+    ipv6_srh_t *srh = ipv6_get_srh(packet);
+    uint16_t length = NTOHS(packet->length);
+    uint16_t opt_len = ipv6_rpl_opt_len(packet);
+    uint8_t cmpri = IPV6_ADDR_LEN - 1, cmpre, pad, *addr;
+    uint8_t *prev_nextheader = ipv6_srh_prev_nextheader(packet);
+    int n, size;
+
+    /* a packet that is source routed already follows its route */
+    if (ip_get_source_route == NULL || ipv6_addr_is_multicast(&packet->destaddr) ||
+        *prev_nextheader == IPV6_PROTO_NUM_ROUTING) {
+        return 0;
+    }
+
+    mutex_lock(&srh_mutex);
+    n = ip_get_source_route(&packet->destaddr, ipv6_get_rpl_opt(packet),
+                            srh_hops, IPV6_SRH_MAX_HOPS);
+
+    if (n <= 0) {
+        mutex_unlock(&srh_mutex);
+        return 0;
+    }
+
+    /* every hop decompresses the next address with its own one */
+    for (int i = 1; i < n; i++) {
+        uint8_t common = srh_common_prefix(&srh_hops[i - 1], &srh_hops[i]);
+
+        if (common < cmpri) {
+            cmpri = common;
+        }
+    }
+
+    cmpre = srh_common_prefix(&srh_hops[n - 1], &packet->destaddr);
+    size = sizeof(ipv6_srh_t) + (n - 1) * (IPV6_ADDR_LEN - cmpri) +
+           IPV6_ADDR_LEN - cmpre;
+    pad = (8 - (size % 8)) % 8;
+    size += pad;
+
+    if (IPV6_HDR_LEN + length + size > IPV6_MTU) {
+        DEBUG("ERROR: no room for a source routing header of %d bytes\n", size);
+        mutex_unlock(&srh_mutex);
+        return -1;
+    }
+
+    memmove((uint8_t *) srh + size, srh, length - opt_len);
+    srh->nextheader = *prev_nextheader;
+    srh->hdrextlen = (size / 8) - 1;
+    srh->routing_type = IPV6_SRH_ROUTING_TYPE;
+    srh->segments_left = n;
+    srh->cmpri_cmpre = (cmpri << 4) | cmpre;
+    srh->pad_reserved = pad << 4;
+    srh->reserved = 0;
+
+    addr = srh->addresses;
+
+    for (int i = 1; i < n; i++) {
+        memcpy(addr, &srh_hops[i].uint8[cmpri], IPV6_ADDR_LEN - cmpri);
+        addr += IPV6_ADDR_LEN - cmpri;
+    }
+
+    memcpy(addr, &packet->destaddr.uint8[cmpre], IPV6_ADDR_LEN - cmpre);
+    memset(addr + IPV6_ADDR_LEN - cmpre, 0, pad);
+
+    *prev_nextheader = IPV6_PROTO_NUM_ROUTING;
+    packet->length = HTONS(length + size);
+    memcpy(&packet->destaddr, &srh_hops[0], sizeof(ipv6_addr_t));
+    mutex_unlock(&srh_mutex);
+
+    return size;
+}
+
+static ipv6_mpl_opt_t *ipv6_get_mpl_opt(ipv6_hdr_t *packet)
+{
+    ipv6_mpl_opt_t *opt = (ipv6_mpl_opt_t *)((uint8_t *) packet + IPV6_HDR_LEN);
+
+    if (packet->nextheader != IPV6_PROTO_NUM_HOP_BY_HOP ||
+        opt->type != IPV6_OPT_TYPE_MPL) {
+        return NULL;
+    }
+
+    return opt;
+}
+
+/* realm-local multicast is the scope of MPL domains */
+static int ipv6_addr_is_mpl_domain(const ipv6_addr_t *addr)
+{
+    return ipv6_addr_is_multicast(addr) && (addr->uint8[1] & 0x0f) == 0x03;
+}
+
+/**
+ * @brief   Hands a packet with the MPL option to the MPL thread, which
+ *          forwards it, and removes the option if the packet is new.
+ *
+ * @return  1 if the packet is new, 0 if it is to be dropped.
+ */
+static int ipv6_mpl_process(ipv6_hdr_t *packet)
+{
+    ipv6_mpl_opt_t *opt = ipv6_get_mpl_opt(packet);
+    uint16_t length = NTOHS(packet->length);
+    msg_t m_send, m_recv;
+
+    if (_mpl_process_pid == KERNEL_PID_UNDEF || length < sizeof(ipv6_mpl_opt_t) ||
+        !ipv6_addr_is_mpl_domain(&packet->destaddr)) {
+        return 0;
+    }
+
+    m_send.type = IPV6_MPL_PACKET_RECEIVED;
+    m_send.content.ptr = (char *) packet;
+    msg_send_receive(&m_send, &m_recv, _mpl_process_pid);
+
+    if (m_recv.content.value == 0) {
+        return 0;
+    }
+
+    packet->nextheader = opt->nextheader;
+    memmove(opt, (uint8_t *) opt + sizeof(ipv6_mpl_opt_t),
+            length - sizeof(ipv6_mpl_opt_t));
+    packet->length = HTONS(length - sizeof(ipv6_mpl_opt_t));
+
+    return 1;
+}
+
 int ipv6_send_packet(ipv6_hdr_t *packet)
 {
     uint16_t length = IPV6_HDR_LEN + NTOHS(packet->length);
     ndp_neighbor_cache_t *nce;
+    int opt_len, srh_len;
 
     DEBUGF("Got a packet to send to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &packet->destaddr));
     ipv6_net_if_get_best_src_addr(&packet->srcaddr, &packet->destaddr);
 
+    /* MPL disseminates the packet to its domain */
+    if (_mpl_process_pid != KERNEL_PID_UNDEF && ipv6_addr_is_mpl_domain(&packet->destaddr) &&
+        ipv6_get_mpl_opt(packet) == NULL) {
+        msg_t m_send, m_recv;
+
+        m_send.type = IPV6_MPL_PACKET_SEND;
+        m_send.content.ptr = (char *) packet;
+        msg_send_receive(&m_send, &m_recv, _mpl_process_pid);
+
+        return m_recv.content.value ? length : -1;
+    }
+
+    /* the RPL option selects the instance the packet is routed in */
+    if ((opt_len = ipv6_rpl_opt_insert(packet)) < 0) {
+        return -1;
+    }
+
+    /* source routed packets go to the first hop of the route */
+    if ((srh_len = ipv6_srh_insert(packet)) < 0) {
+        return -1;
+    }
+
+    length += opt_len + srh_len;
+
     if (!ipv6_addr_is_multicast(&packet->destaddr) &&
         ndp_addr_is_on_link(&packet->destaddr)) {
         /* not multicast, on-link */
@@ -107,7 +369,7 @@ int ipv6_send_packet(ipv6_hdr_t *packet)
         }
 
         DEBUG("Trying to find the next hop for %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &packet->destaddr));
-        ipv6_addr_t *dest = ip_get_next_hop(&packet->destaddr);
+        ipv6_addr_t *dest = ipv6_get_next_hop(packet);
 
         if (dest == NULL) {
             return -1;
@@ -261,6 +523,7 @@ int icmpv6_demultiplex(const icmpv6_hdr_t *hdr)
 
             if (_rpl_process_pid != KERNEL_PID_UNDEF) {
                 msg_t m_send;
+                m_send.type = IPV6_PACKET_RECEIVED;
                 m_send.content.ptr = (char *) &hdr->code;
                 msg_send(&m_send, _rpl_process_pid, 1);
             }
@@ -340,11 +603,99 @@ static int is_our_address(ipv6_addr_t *addr)
         }
     }
 
-    if (!counter) {
-        counter = -1;
-    }
     /* return negative value if no address is configured so far */
-    return counter;
+    return counter ? 0 : -1;
+}
+
+int ipv6_srh_process(ipv6_hdr_t *packet)
+{
+    ipv6_srh_t *srh = ipv6_get_srh(packet);
+    uint16_t length = NTOHS(packet->length) - ipv6_rpl_opt_len(packet);
+    uint8_t cmpri = srh->cmpri_cmpre >> 4;
+    uint8_t cmpre = srh->cmpri_cmpre & 0x0f;
+    uint8_t pad = srh->pad_reserved >> 4;
+    int size = (srh->hdrextlen + 1) * 8, n, i, elided;
+    uint8_t *addr;
+    ipv6_addr_t next;
+
+    if (size > length) {
+        return -1;
+    }
+
+    if (srh->segments_left == 0) {
+        *ipv6_srh_prev_nextheader(packet) = srh->nextheader;
+        memmove(srh, (uint8_t *) srh + size, length - size);
+        packet->length = HTONS(NTOHS(packet->length) - size);
+        return 0;
+    }
+
+    if (srh->routing_type != IPV6_SRH_ROUTING_TYPE) {
+        DEBUG("ERROR: unknown routing header type %u\n", srh->routing_type);
+        return -1;
+    }
+
+    /* number of addresses in the header */
+    n = size - sizeof(ipv6_srh_t) - pad - (IPV6_ADDR_LEN - cmpre);
+
+    if (n < 0 || (n % (IPV6_ADDR_LEN - cmpri)) != 0) {
+        return -1;
+    }
+
+    n = n / (IPV6_ADDR_LEN - cmpri) + 1;
+
+    if (srh->segments_left > n) {
+        return -1;
+    }
+
+    srh->segments_left--;
+    i = n - srh->segments_left;
+    elided = (i < n) ? cmpri : cmpre;
+    addr = srh->addresses + (i - 1) * (IPV6_ADDR_LEN - cmpri);
+
+    memcpy(&next, &packet->destaddr, elided);
+    memcpy(&next.uint8[elided], addr, IPV6_ADDR_LEN - elided);
+
+    /* the route must not lead to a group or back to us */
+    if (ipv6_addr_is_multicast(&next) || is_our_address(&next) == 1) {
+        DEBUG("ERROR: invalid hop in source routing header\n");
+        return -1;
+    }
+
+    memcpy(addr, &packet->destaddr.uint8[elided], IPV6_ADDR_LEN - elided);
+    memcpy(&packet->destaddr, &next, sizeof(ipv6_addr_t));
+
+    return 1;
+}
+
+/* forwards the received packet to the neighbor dest */
+static void ipv6_forward(ipv6_addr_t *dest)
+{
+    uint16_t packet_length = IPV6_HDR_LEN + NTOHS(ipv6_buf->length);
+    ndp_neighbor_cache_t *nce;
+
+    if ((dest == NULL) || ((--ipv6_buf->hoplimit) == 0)) {
+        DEBUG("!!! Packet not for me, routing handler is set, but I "\
+              " have no idea where to send or the hop limit is exceeded.\n");
+        return;
+    }
+
+    nce = ndp_get_ll_address(dest);
+
+    /* copy received packet to send buffer */
+    memcpy(ipv6_get_buf_send(), ipv6_get_buf(), packet_length);
+
+    /* send packet to node ID derived from dest IP */
+    if (nce != NULL) {
+        sixlowpan_lowpan_sendto(nce->if_id, &nce->lladdr,
+                                nce->lladdr_len,
+                                (uint8_t *)ipv6_get_buf_send(),
+                                packet_length);
+    } else {
+        /* XXX: this is wrong, but until ND does work correctly,
+         *      this is the only way (aka the old way)*/
+        uint16_t raddr = dest->uint16[7];
+        sixlowpan_lowpan_sendto(0, &raddr, 2, (uint8_t *)ipv6_get_buf_send(), packet_length);
+    }
 }
 
 void *ipv6_process(void *arg)
@@ -354,7 +705,7 @@ void *ipv6_process(void *arg)
     msg_t m_recv_lowpan, m_send_lowpan;
     msg_t m_recv, m_send;
     uint8_t i;
-    uint16_t packet_length;
+    int srh_len;
 
     msg_init_queue(ip_msg_queue, IP_PKT_RECV_BUF_SIZE);
 
@@ -375,15 +726,35 @@ void *ipv6_process(void *arg)
             }
         }
 
+        /* MPL forwards the packet, only new ones are delivered */
+        if (ipv6_get_mpl_opt(ipv6_buf) != NULL &&
+            (!ipv6_mpl_process(ipv6_buf) || is_our_address(&ipv6_buf->destaddr) != 1)) {
+            msg_reply(&m_recv_lowpan, &m_send_lowpan);
+            continue;
+        }
+
         int addr_match = is_our_address(&ipv6_buf->destaddr);
 
         /* no address configured for this node so far, exit early */
-        if (addr_match < 1) {
+        if (addr_match < 0) {
             msg_reply(&m_recv_lowpan, &m_send_lowpan);
             continue;
         }
         /* destination is our address */
         else if (addr_match) {
+            /* we are a hop of a source route */
+            if (*ipv6_srh_prev_nextheader(ipv6_buf) == IPV6_PROTO_NUM_ROUTING
+                && (srh_len = ipv6_srh_process(ipv6_buf)) != 0) {
+                if (srh_len > 0) {
+                    ipv6_forward(&ipv6_buf->destaddr);
+                }
+
+                msg_reply(&m_recv_lowpan, &m_send_lowpan);
+                continue;
+            }
+
+            ipv6_rpl_opt_remove(ipv6_buf);
+
             switch (*nextheader) {
                 case (IPV6_PROTO_NUM_ICMPV6): {
                     icmp_buf = get_icmpv6_buf(ipv6_ext_hdr_len);
@@ -435,42 +806,27 @@ void *ipv6_process(void *arg)
         /* destination is foreign address */
         else {
             DEBUG("That's not for me, destination is %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_buf->destaddr));
-            packet_length = IPV6_HDR_LEN + NTOHS(ipv6_buf->length);
-            ndp_neighbor_cache_t *nce;
-
             ipv6_addr_t *dest;
 
-            if (ip_get_next_hop == NULL) {
-                dest = &ipv6_buf->destaddr;
-            }
-            else {
-                dest = ip_get_next_hop(&ipv6_buf->destaddr);
-            }
-
-            if ((dest == NULL) || ((--ipv6_buf->hoplimit) == 0)) {
-                DEBUG("!!! Packet not for me, routing handler is set, but I "\
-                      " have no idea where to send or the hop limit is exceeded.\n");
+            /* groups this node has not joined and link-local
+             * destinations are never routed */
+            if (ipv6_addr_is_multicast(&ipv6_buf->destaddr) ||
+                ipv6_addr_is_link_local(&ipv6_buf->destaddr)) {
                 msg_reply(&m_recv_lowpan, &m_send_lowpan);
                 continue;
             }
 
-            nce = ndp_get_ll_address(dest);
-
-            /* copy received packet to send buffer */
-            memcpy(ipv6_get_buf_send(), ipv6_get_buf(), packet_length);
-
-            /* send packet to node ID derived from dest IP */
-            if (nce != NULL) {
-                sixlowpan_lowpan_sendto(nce->if_id, &nce->lladdr,
-                                        nce->lladdr_len,
-                                        (uint8_t *)ipv6_get_buf_send(),
-                                        packet_length);
-            } else {
-                /* XXX: this is wrong, but until ND does work correctly,
-                 *      this is the only way (aka the old way)*/
-                uint16_t raddr = dest->uint16[7];
-                sixlowpan_lowpan_sendto(0, &raddr, 2, (uint8_t *)ipv6_get_buf_send(), packet_length);
+            if ((srh_len = ipv6_srh_insert(ipv6_buf)) < 0) {
+                dest = NULL;
+            }
+            else if (srh_len > 0 || ip_get_next_hop == NULL) {
+                dest = &ipv6_buf->destaddr;
+            }
+            else {
+                dest = ipv6_get_next_hop(ipv6_buf);
             }
+
+            ipv6_forward(dest);
         }
 
         msg_reply(&m_recv_lowpan, &m_send_lowpan);
@@ -803,11 +1159,33 @@ void ipv6_iface_set_routing_provider(ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest)
     ip_get_next_hop = next_hop;
 }
 
+void ipv6_iface_set_srh_provider(int (*source_route)(ipv6_addr_t *dest,
+                                 ipv6_rpl_opt_t *opt,
+                                 ipv6_addr_t *hops,
+                                 int max_hops))
+{
+    ip_get_source_route = source_route;
+}
+
+void ipv6_iface_set_rpl_option_provider(int (*set_option)(ipv6_hdr_t *packet,
+                                        ipv6_rpl_opt_t *opt),
+                                        ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest,
+                                                ipv6_rpl_opt_t *opt))
+{
+    ip_set_rpl_option = set_option;
+    ip_get_rpl_next_hop = next_hop;
+}
+
 void ipv6_register_rpl_handler(kernel_pid_t pid)
 {
     _rpl_process_pid = pid;
 }
 
+void ipv6_register_mpl_handler(kernel_pid_t pid)
+{
+    _mpl_process_pid = pid;
+}
+
 uint16_t ipv6_csum(ipv6_hdr_t *ipv6_header, uint8_t *buf, uint16_t len, uint8_t proto)
 {
     uint16_t sum = 0;
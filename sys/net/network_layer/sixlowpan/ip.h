@@ -94,6 +94,47 @@ uint8_t *get_payload_buf_send(uint8_t ext_len);
 int icmpv6_demultiplex(const icmpv6_hdr_t *hdr);
 int ipv6_init_as_router(void);
 void *ipv6_process(void *);
+
+/**
+ * @brief   Inserts a hop-by-hop options header with the RPL option right
+ *          after the IPv6 header if the RPL option provider maps *packet*
+ *          to an RPL instance. *packet* must have room for IPV6_MTU bytes.
+ *
+ * @return  length of the inserted header, 0 if no header is needed and
+ *          -1 if the packet would exceed IPV6_MTU.
+ */
+int ipv6_rpl_opt_insert(ipv6_hdr_t *packet);
+
+/**
+ * @brief   Removes the RPL option before the packet is delivered locally,
+ *          a packet without one is left alone.
+ */
+void ipv6_rpl_opt_remove(ipv6_hdr_t *packet);
+
+/**
+ * @brief   Inserts an RFC 6554 source routing header right after the
+ *          IPv6 header, or after the RPL option if the packet carries
+ *          one, if the source route provider knows a route to
+ *          the destination of *packet*, the destination becomes the
+ *          first hop of the route. A packet that carries a routing
+ *          header already is left alone. *packet* must have room for
+ *          IPV6_MTU bytes.
+ *
+ * @return  length of the inserted header, 0 if no header is needed and
+ *          -1 if the packet would exceed IPV6_MTU.
+ */
+int ipv6_srh_insert(ipv6_hdr_t *packet);
+
+/**
+ * @brief   Processes the source routing header of a packet addressed to
+ *          this node.
+ *
+ * @return  0 if this node is the final destination, the header is
+ *          removed from the packet then,
+ *          1 if the packet is to be forwarded to its new destination,
+ *          -1 if the packet is to be dropped.
+ */
+int ipv6_srh_process(ipv6_hdr_t *packet);
 ipv6_net_if_hit_t *ipv6_net_if_addr_prefix_eq(ipv6_net_if_hit_t *hit, ipv6_addr_t *addr);
 ipv6_net_if_hit_t *ipv6_net_if_addr_match(ipv6_net_if_hit_t *hit, const ipv6_addr_t *addr);
 uint32_t get_remaining_time(timex_t *t);
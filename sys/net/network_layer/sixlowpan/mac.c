@@ -53,6 +53,7 @@ msg_t msg_q[RADIO_RCV_BUF_SIZE];
 
 uint8_t lowpan_mac_buf[PAYLOAD_SIZE];
 static uint8_t macdsn;
+static sixlowpan_mac_link_handler_t link_handler;
 
 static inline void mac_frame_short_to_eui64(net_if_eui64_t *eui64,
                                             uint8_t *frame_short)
@@ -63,6 +64,33 @@ static inline void mac_frame_short_to_eui64(net_if_eui64_t *eui64,
     eui64->uint8[7] = frame_short[0];
 }
 
+static void mac_report_tx(const void *dest, uint8_t dest_len, uint8_t mcast,
+                          int res)
+{
+    net_if_eui64_t neighbor;
+
+    if (link_handler == NULL || mcast) {
+        return;
+    }
+
+    if (dest_len == 8) {
+        memcpy(&neighbor, dest, 8);
+    }
+    else if (dest_len == 2) {
+        /* the short address as sixlowpan_mac_send_data() hands it on */
+        uint16_t target = NTOHS((*((net_if_eui64_t *)dest)).uint16[0]);
+        uint8_t frame_short[2] = { target & 0xff, target >> 8 };
+
+        mac_frame_short_to_eui64(&neighbor, frame_short);
+    }
+    else {
+        return;
+    }
+
+    link_handler((res > 0) ? SIXLOWPAN_MAC_LINK_TX_OK : SIXLOWPAN_MAC_LINK_TX_FAIL,
+                 &neighbor, 0, 0);
+}
+
 static void *recv_ieee802154_frame(void *arg)
 {
     (void) arg;
@@ -154,6 +182,11 @@ static void *recv_ieee802154_frame(void *arg)
                 continue;
             }
 
+            if (link_handler != NULL) {
+                link_handler(SIXLOWPAN_MAC_LINK_RX, &src, (uint8_t) p->rssi,
+                             p->lqi);
+            }
+
             /* deliver packet to network(6lowpan)-layer */
             lowpan_read(frame.payload, length, &src, &dst);
             /* TODO: get interface ID somehow */
@@ -298,10 +331,14 @@ int sixlowpan_mac_send_ieee802154_frame(int if_id,
                                         const void *payload,
                                         uint8_t payload_len, uint8_t mcast)
 {
+    int res;
+
     if (net_if_get_interface(if_id) &&
         net_if_get_interface(if_id)->transceivers & IEEE802154_TRANSCEIVER) {
-        return sixlowpan_mac_send_data(if_id, dest, dest_len, payload,
-                                       payload_len, mcast);
+        res = sixlowpan_mac_send_data(if_id, dest, dest_len, payload,
+                                      payload_len, mcast);
+        mac_report_tx(dest, dest_len, mcast, res);
+        return res;
     }
     else {
         ieee802154_frame_t frame;
@@ -318,11 +355,18 @@ int sixlowpan_mac_send_ieee802154_frame(int if_id,
 
         length = hdrlen + frame.payload_len + IEEE_802154_FCS_LEN;
 
-        return sixlowpan_mac_send_data(if_id, dest, dest_len, lowpan_mac_buf,
-                                       length, mcast);
+        res = sixlowpan_mac_send_data(if_id, dest, dest_len, lowpan_mac_buf,
+                                      length, mcast);
+        mac_report_tx(dest, dest_len, mcast, res);
+        return res;
     }
 }
 
+void sixlowpan_mac_set_link_handler(sixlowpan_mac_link_handler_t handler)
+{
+    link_handler = handler;
+}
+
 kernel_pid_t sixlowpan_mac_init(void)
 {
     kernel_pid_t recv_pid = thread_create(radio_stack_buffer, RADIO_STACK_SIZE,
@@ -0,0 +1,183 @@
+/**
+ * Passive link estimator implementation
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file
+ * @brief   ETX estimation from the frames the MAC layer exchanges anyway
+ * @}
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "mutex.h"
+#include "vtimer.h"
+
+#include "sixlowpan/lowpan.h"
+#include "sixlowpan/mac.h"
+#include "link_estimator.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static link_estimator_neighbor_t neighbors[LINK_ESTIMATOR_MAX_NEIGHBORS];
+static mutex_t link_estimator_mutex = MUTEX_INIT;
+
+static uint32_t link_estimator_now(void)
+{
+    timex_t now;
+
+    vtimer_now(&now);
+    return now.seconds;
+}
+
+uint16_t link_estimator_ewma(uint16_t value, uint16_t sample)
+{
+    int32_t diff = (int32_t) sample - value;
+    int32_t step = diff / (1 << LINK_ESTIMATOR_ALPHA_SHIFT);
+
+    /* the estimate still reaches the sample in the end */
+    if (step == 0 && diff != 0) {
+        step = (diff > 0) ? 1 : -1;
+    }
+
+    return value + step;
+}
+
+static link_estimator_neighbor_t *link_estimator_find(const net_if_eui64_t *addr)
+{
+    for (int i = 0; i < LINK_ESTIMATOR_MAX_NEIGHBORS; i++) {
+        if (neighbors[i].used && neighbors[i].addr.uint64 == addr->uint64) {
+            return &neighbors[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* a free entry or the one heard from longest ago */
+static link_estimator_neighbor_t *link_estimator_add(const net_if_eui64_t *addr)
+{
+    link_estimator_neighbor_t *n = &neighbors[0];
+
+    for (int i = 0; i < LINK_ESTIMATOR_MAX_NEIGHBORS; i++) {
+        if (!neighbors[i].used) {
+            n = &neighbors[i];
+            break;
+        }
+
+        if (neighbors[i].last_heard < n->last_heard) {
+            n = &neighbors[i];
+        }
+    }
+
+    memset(n, 0, sizeof(*n));
+    n->addr.uint64 = addr->uint64;
+    n->etx = LINK_ESTIMATOR_ETX_INIT;
+    n->used = 1;
+    n->last_heard = link_estimator_now();
+    return n;
+}
+
+static void link_estimator_tx(link_estimator_neighbor_t *n, bool success)
+{
+    if (success) {
+        n->etx = link_estimator_ewma(n->etx, (n->tx_fail + 1) * LINK_ESTIMATOR_ETX_ONE);
+        n->tx_fail = 0;
+    }
+    else if (++n->tx_fail == LINK_ESTIMATOR_MAX_TX) {
+        n->etx = link_estimator_ewma(n->etx, LINK_ESTIMATOR_ETX_MAX);
+        n->tx_fail = 0;
+    }
+}
+
+void link_estimator_handler(sixlowpan_mac_link_event_t event,
+                            const net_if_eui64_t *neighbor,
+                            uint8_t rssi, uint8_t lqi)
+{
+    link_estimator_neighbor_t *n;
+    bool heard;
+
+    mutex_lock(&link_estimator_mutex);
+
+    if ((n = link_estimator_find(neighbor)) == NULL) {
+        n = link_estimator_add(neighbor);
+    }
+
+    switch (event) {
+        case SIXLOWPAN_MAC_LINK_RX:
+            heard = n->heard;
+            n->rssi = heard ? link_estimator_ewma(n->rssi, rssi) : rssi;
+            n->lqi = heard ? link_estimator_ewma(n->lqi, lqi) : lqi;
+            n->heard = 1;
+            n->last_heard = link_estimator_now();
+            break;
+
+        case SIXLOWPAN_MAC_LINK_TX_OK:
+        case SIXLOWPAN_MAC_LINK_TX_FAIL:
+            link_estimator_tx(n, event == SIXLOWPAN_MAC_LINK_TX_OK);
+            DEBUG("link estimator: etx %u for %04x\n", n->etx,
+                  sixlowpan_lowpan_eui64_to_short_addr(&n->addr));
+            break;
+    }
+
+    mutex_unlock(&link_estimator_mutex);
+}
+
+void link_estimator_init(void)
+{
+    memset(neighbors, 0, sizeof(neighbors));
+    sixlowpan_mac_set_link_handler(link_estimator_handler);
+}
+
+uint16_t link_estimator_get_etx(ipv6_addr_t *addr)
+{
+    link_estimator_neighbor_t *n;
+    net_if_eui64_t iid;
+    uint16_t etx = 0;
+
+    /* undo what ipv6_addr_set_by_eui64() does to the interface identifier */
+    memcpy(&iid, &addr->uint8[8], sizeof(iid));
+
+    if (!sixlowpan_lowpan_eui64_to_short_addr(&iid)) {
+        iid.uint8[0] ^= 0x02;
+    }
+
+    mutex_lock(&link_estimator_mutex);
+
+    if ((n = link_estimator_find(&iid)) != NULL) {
+        etx = n->etx;
+    }
+
+    mutex_unlock(&link_estimator_mutex);
+    return etx;
+}
+
+void link_estimator_show_neighbors(void)
+{
+    uint32_t now = link_estimator_now();
+
+    for (int i = 0; i < LINK_ESTIMATOR_MAX_NEIGHBORS; i++) {
+        link_estimator_neighbor_t *n = &neighbors[i];
+
+        if (!n->used) {
+            continue;
+        }
+
+        printf("%02x%02x:%02x%02x:%02x%02x:%02x%02x etx %u.%02u rssi %u lqi %u, "
+               "heard %lu s ago\n",
+               n->addr.uint8[0], n->addr.uint8[1], n->addr.uint8[2],
+               n->addr.uint8[3], n->addr.uint8[4], n->addr.uint8[5],
+               n->addr.uint8[6], n->addr.uint8[7],
+               n->etx / LINK_ESTIMATOR_ETX_ONE,
+               (n->etx % LINK_ESTIMATOR_ETX_ONE) * 100 / LINK_ESTIMATOR_ETX_ONE,
+               n->rssi, n->lqi, (unsigned long)(now - n->last_heard));
+    }
+}
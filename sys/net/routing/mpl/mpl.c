@@ -0,0 +1,443 @@
+/**
+ * MPL forwarder
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup net_mpl
+ * @{
+ * @file    mpl.c
+ * @brief   MPL data messages with seed sets and trickle retransmission
+ * @}
+ */
+
+#include <string.h>
+
+#include "thread.h"
+#include "msg.h"
+#include "vtimer.h"
+#include "trickle.h"
+
+#include "mpl.h"
+#include "sixlowpan.h"
+
+#define ENABLE_DEBUG    (0)
+#if ENABLE_DEBUG
+static char addr_str[IPV6_MAX_ADDR_STR_LEN];
+#endif
+#include "debug.h"
+
+/* seed id length 0, the M flag and the V flag, which must be 0 */
+#define MPL_FLAGS_S             (0xc0)
+#define MPL_FLAGS_V             (0x10)
+
+typedef struct {
+    ipv6_addr_t id;                 /* source address of the messages */
+    uint8_t min_sequence;           /* messages before it are old */
+    uint8_t used;
+    uint32_t expires;               /* seconds */
+} mpl_seed_t;
+
+typedef struct {
+    mpl_seed_t *seed;               /* NULL if the slot is free */
+    uint8_t sequence;
+    uint8_t expirations;            /* trickle intervals that ended */
+    uint16_t length;                /* of the packet with the MPL option */
+    trickle_t trickle;
+    uint8_t packet[IPV6_MTU];
+} mpl_message_t;
+
+static mpl_seed_t seeds[MPL_SEED_SET_SIZE];
+static mpl_message_t messages[MPL_BUFFERED_MESSAGES];
+static mpl_stats_t stats;
+
+/* sequence of the next message this node originates */
+static uint8_t next_sequence;
+
+static kernel_pid_t mpl_process_pid = KERNEL_PID_UNDEF;
+static msg_t mpl_msg_queue[MPL_PKT_RECV_BUF_SIZE];
+static char mpl_process_buf[MPL_PROCESS_STACKSIZE];
+static uint8_t mpl_send_buffer[IPV6_MTU];
+
+/* 8 bit serial number arithmetic of RFC 1982 */
+static int sequence_before(uint8_t a, uint8_t b)
+{
+    return (int8_t)(a - b) < 0;
+}
+
+static uint32_t mpl_now(void)
+{
+    timex_t now;
+
+    vtimer_now(&now);
+    return now.seconds;
+}
+
+static mpl_seed_t *mpl_seed_find(const ipv6_addr_t *id)
+{
+    for (int i = 0; i < MPL_SEED_SET_SIZE; i++) {
+        if (seeds[i].used && ipv6_addr_is_equal(&seeds[i].id, id)) {
+            return &seeds[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int mpl_seed_buffered(mpl_seed_t *seed)
+{
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        if (messages[i].seed == seed) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* a free entry or one that expired and has no buffered messages */
+static mpl_seed_t *mpl_seed_new(const ipv6_addr_t *id, uint8_t min_sequence)
+{
+    uint32_t now = mpl_now();
+
+    for (int i = 0; i < MPL_SEED_SET_SIZE; i++) {
+        mpl_seed_t *seed = &seeds[i];
+
+        if (!seed->used || (seed->expires <= now && !mpl_seed_buffered(seed))) {
+            memcpy(&seed->id, id, sizeof(ipv6_addr_t));
+            seed->min_sequence = min_sequence;
+            seed->used = 1;
+            seed->expires = now + MPL_SEED_SET_ENTRY_LIFETIME;
+            return seed;
+        }
+    }
+
+    DEBUG("mpl: seed set full\n");
+    return NULL;
+}
+
+static mpl_message_t *mpl_message_find(mpl_seed_t *seed, uint8_t sequence)
+{
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        if (messages[i].seed == seed && messages[i].sequence == sequence) {
+            return &messages[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* 1 if no message of the seed that is buffered is newer than msg */
+static int mpl_message_is_newest(mpl_message_t *msg)
+{
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        if (messages[i].seed == msg->seed &&
+            sequence_before(msg->sequence, messages[i].sequence)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* 1 if no message of the seed that is buffered is older than msg */
+static int mpl_message_is_oldest(mpl_message_t *msg)
+{
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        if (messages[i].seed == msg->seed &&
+            sequence_before(messages[i].sequence, msg->sequence)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void mpl_message_free(mpl_message_t *msg)
+{
+    trickle_stop(&msg->trickle);
+
+    /* duplicates of the message are old from now on */
+    msg->seed->min_sequence = msg->sequence + 1;
+    msg->seed = NULL;
+}
+
+/**
+ * @brief   A free slot for a message, or the slot of the oldest message
+ *          of a seed that is no longer retransmitted.
+ */
+static mpl_message_t *mpl_message_new(mpl_seed_t *seed, uint8_t sequence)
+{
+    mpl_message_t *victim = NULL;
+
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        mpl_message_t *msg = &messages[i];
+
+        if (msg->seed == NULL) {
+            victim = msg;
+            break;
+        }
+
+        if (victim == NULL && msg->trickle.I == 0 && mpl_message_is_oldest(msg)) {
+            victim = msg;
+        }
+    }
+
+    if (victim == NULL) {
+        DEBUG("mpl: no room for a message\n");
+        return NULL;
+    }
+
+    if (victim->seed != NULL) {
+        mpl_message_free(victim);
+    }
+
+    victim->seed = seed;
+    victim->sequence = sequence;
+    victim->expirations = 0;
+    return victim;
+}
+
+static void mpl_transmit(void *arg)
+{
+    mpl_message_t *msg = arg;
+    ipv6_mpl_opt_t *opt = (ipv6_mpl_opt_t *)(msg->packet + IPV6_HDR_LEN);
+    uint16_t bcast = 0xffff;
+
+    /* tells the neighbors whether they miss newer messages */
+    opt->flags = mpl_message_is_newest(msg) ? IPV6_OPT_MPL_FLAG_M : 0;
+
+    /* the packet may be manipulated by 6LoWPAN */
+    memcpy(mpl_send_buffer, msg->packet, msg->length);
+    sixlowpan_lowpan_sendto(0, &bcast, 2, mpl_send_buffer, msg->length);
+    stats.transmitted++;
+}
+
+static void mpl_message_start(mpl_message_t *msg)
+{
+    msg->expirations = 0;
+    trickle_start(mpl_process_pid, &msg->trickle, mpl_transmit, msg,
+                  MPL_DATA_MESSAGE_IMIN, MPL_DATA_MESSAGE_IMAX, MPL_DATA_MESSAGE_K);
+}
+
+static void mpl_timer(trickle_t *trickle)
+{
+    mpl_message_t *msg = trickle->arg;
+    int interval_end = (trickle->I != 0) && trickle->interval_end;
+
+    trickle_callback(trickle);
+
+    if (interval_end && ++msg->expirations >= MPL_DATA_MESSAGE_TIMER_EXPIRATIONS) {
+        trickle_stop(trickle);
+    }
+}
+
+/* the sender of an older message misses the newer ones */
+static void mpl_reset_newer(mpl_seed_t *seed, uint8_t sequence)
+{
+    for (int i = 0; i < MPL_BUFFERED_MESSAGES; i++) {
+        mpl_message_t *msg = &messages[i];
+
+        if (msg->seed != seed || !sequence_before(sequence, msg->sequence)) {
+            continue;
+        }
+
+        if (msg->trickle.I == 0) {
+            mpl_message_start(msg);
+        }
+        else {
+            msg->expirations = 0;
+            trickle_reset_timer(&msg->trickle);
+        }
+    }
+}
+
+/**
+ * @brief   Buffers a received data message if it is new.
+ *
+ * @return  1 if the message is new, 0 otherwise.
+ */
+static int mpl_receive(ipv6_hdr_t *packet)
+{
+    ipv6_mpl_opt_t *opt = (ipv6_mpl_opt_t *)((uint8_t *) packet + IPV6_HDR_LEN);
+    uint16_t length = IPV6_HDR_LEN + NTOHS(packet->length);
+    mpl_seed_t *seed;
+    mpl_message_t *msg;
+
+    if (opt->hdrextlen != 0 || opt->length != IPV6_OPT_MPL_LEN ||
+        (opt->flags & (MPL_FLAGS_S | MPL_FLAGS_V)) != 0 || length > IPV6_MTU) {
+        DEBUG("mpl: unsupported MPL option\n");
+        return 0;
+    }
+
+    seed = mpl_seed_find(&packet->srcaddr);
+
+    if (seed != NULL && sequence_before(opt->sequence, seed->min_sequence)) {
+        stats.duplicates++;
+        return 0;
+    }
+
+    if (seed != NULL && (msg = mpl_message_find(seed, opt->sequence)) != NULL) {
+        stats.duplicates++;
+
+        if (msg->trickle.I != 0) {
+            trickle_increment_counter(&msg->trickle);
+        }
+
+        if (opt->flags & IPV6_OPT_MPL_FLAG_M) {
+            mpl_reset_newer(seed, opt->sequence);
+        }
+
+        return 0;
+    }
+
+    if ((seed == NULL && (seed = mpl_seed_new(&packet->srcaddr, opt->sequence)) == NULL) ||
+        (msg = mpl_message_new(seed, opt->sequence)) == NULL) {
+        stats.dropped++;
+        return 0;
+    }
+
+    DEBUG("mpl: message %u of %s\n", opt->sequence,
+          ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &packet->srcaddr));
+
+    seed->expires = mpl_now() + MPL_SEED_SET_ENTRY_LIFETIME;
+    memcpy(msg->packet, packet, length);
+    msg->length = length;
+
+    /* a message at the end of its hop limit is only kept to detect duplicates */
+    if (--((ipv6_hdr_t *) msg->packet)->hoplimit > 0) {
+        mpl_message_start(msg);
+    }
+
+    stats.received++;
+    return 1;
+}
+
+/**
+ * @brief   Originates a data message with this node as its seed.
+ *
+ * @return  1 on success, 0 on failure.
+ */
+static int mpl_originate(ipv6_hdr_t *packet)
+{
+    uint16_t length = NTOHS(packet->length);
+    mpl_seed_t *seed;
+    mpl_message_t *msg;
+    ipv6_mpl_opt_t *opt;
+    ipv6_hdr_t *hdr;
+
+    if (IPV6_HDR_LEN + sizeof(ipv6_mpl_opt_t) + length > IPV6_MTU) {
+        DEBUG("mpl: message too long\n");
+        return 0;
+    }
+
+    if ((seed = mpl_seed_find(&packet->srcaddr)) == NULL &&
+        (seed = mpl_seed_new(&packet->srcaddr, next_sequence)) == NULL) {
+        return 0;
+    }
+
+    if ((msg = mpl_message_new(seed, next_sequence)) == NULL) {
+        return 0;
+    }
+
+    hdr = (ipv6_hdr_t *) msg->packet;
+    opt = (ipv6_mpl_opt_t *)(msg->packet + IPV6_HDR_LEN);
+
+    memcpy(hdr, packet, IPV6_HDR_LEN);
+    memcpy(msg->packet + IPV6_HDR_LEN + sizeof(ipv6_mpl_opt_t),
+           (uint8_t *) packet + IPV6_HDR_LEN, length);
+
+    opt->nextheader = hdr->nextheader;
+    opt->hdrextlen = 0;
+    opt->type = IPV6_OPT_TYPE_MPL;
+    opt->length = IPV6_OPT_MPL_LEN;
+    opt->flags = 0;
+    opt->sequence = next_sequence++;
+    opt->pad_type = 1;
+    opt->pad_length = 0;
+
+    hdr->nextheader = IPV6_PROTO_NUM_HOP_BY_HOP;
+    hdr->length = HTONS(length + sizeof(ipv6_mpl_opt_t));
+
+    msg->length = IPV6_HDR_LEN + sizeof(ipv6_mpl_opt_t) + length;
+    seed->expires = mpl_now() + MPL_SEED_SET_ENTRY_LIFETIME;
+    mpl_message_start(msg);
+
+    stats.originated++;
+    return 1;
+}
+
+static void *mpl_process(void *arg)
+{
+    (void) arg;
+
+    msg_t m_recv, m_send;
+
+    msg_init_queue(mpl_msg_queue, MPL_PKT_RECV_BUF_SIZE);
+
+    while (1) {
+        msg_receive(&m_recv);
+
+        switch (m_recv.type) {
+            case MSG_TIMER:
+                mpl_timer((trickle_t *) m_recv.content.ptr);
+                break;
+
+            case IPV6_MPL_PACKET_RECEIVED:
+                m_send.content.value = mpl_receive((ipv6_hdr_t *) m_recv.content.ptr);
+                msg_reply(&m_recv, &m_send);
+                break;
+
+            case IPV6_MPL_PACKET_SEND:
+                m_send.content.value = mpl_originate((ipv6_hdr_t *) m_recv.content.ptr);
+                msg_reply(&m_recv, &m_send);
+                break;
+
+            default:
+                DEBUG("mpl: unknown message type %u\n", m_recv.type);
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+int mpl_init(int if_id)
+{
+    ipv6_addr_t addr;
+
+    memset(seeds, 0, sizeof(seeds));
+    memset(messages, 0, sizeof(messages));
+    memset(&stats, 0, sizeof(stats));
+
+    mpl_addr_set_all_forwarders(&addr);
+
+    if (!ipv6_net_if_add_addr(if_id, &addr, NDP_ADDR_STATE_PREFERRED, 0, 0, 0)) {
+        DEBUG("mpl: could not subscribe to ff03::fc\n");
+        return -1;
+    }
+
+    mpl_process_pid = thread_create(mpl_process_buf, MPL_PROCESS_STACKSIZE,
+                                    PRIORITY_MAIN - 1, CREATE_STACKTEST,
+                                    mpl_process, NULL, "mpl_process");
+
+    if (mpl_process_pid == KERNEL_PID_UNDEF) {
+        return -1;
+    }
+
+    ipv6_register_mpl_handler(mpl_process_pid);
+    return 0;
+}
+
+void mpl_addr_set_all_forwarders(ipv6_addr_t *addr)
+{
+    ipv6_addr_init(addr, 0xff03, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x00fc);
+}
+
+void mpl_get_stats(mpl_stats_t *stats_out)
+{
+    memcpy(stats_out, &stats, sizeof(mpl_stats_t));
+}
@@ -18,20 +18,25 @@
 #include <stdio.h>
 #include "of_mrhof.h"
 
-#include "etx_beaconing.h"
+#include "link_estimator.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+/* the rank of a link, the ETX of the link estimator and the rank of MRHOF
+ * both have the ETX 1 as 128, so no scaling is needed */
+#if ETX_RANK_MULTIPLIER == LINK_ESTIMATOR_ETX_ONE
+#define ETX_TO_RANK(etx)    ((uint32_t) (etx))
+#else
+#define ETX_TO_RANK(etx)    ((uint32_t) (etx) * ETX_RANK_MULTIPLIER / LINK_ESTIMATOR_ETX_ONE)
+#endif
+
 // Function Prototypes
 static uint16_t calc_rank(rpl_parent_t *, uint16_t);
 static rpl_parent_t *which_parent(rpl_parent_t *, rpl_parent_t *);
 static rpl_dodag_t *which_dodag(rpl_dodag_t *, rpl_dodag_t *);
 static void reset(rpl_dodag_t *);
-static uint16_t calc_path_cost(rpl_parent_t *parent);
-
-uint16_t cur_min_path_cost = MAX_PATH_COST;
-rpl_parent_t *cur_preferred_parent = NULL;
+static uint16_t calc_path_cost(uint16_t etx, uint16_t parent_rank);
 
 rpl_of_t rpl_of_mrhof = {
     0x1,
@@ -54,24 +59,16 @@ void reset(rpl_dodag_t *dodag)
     (void) dodag;
 }
 
-static uint16_t calc_path_cost(rpl_parent_t *parent)
+static uint16_t calc_path_cost(uint16_t etx, uint16_t parent_rank)
 {
     DEBUGF("calc_pathcost\n");
 
     /*
      * Calculates the path cost through the parent, for now, only for ETX
      */
-    if (parent == NULL) {
-        // Shouldn't ever happen since this function is supposed to be always
-        // run with a parent. If it does happen, we can assume a root called it.
-        DEBUGF("[WARNING] calc_path_cost called without parent!\n");
-        return DEFAULT_MIN_HOP_RANK_INCREASE;
-    }
+    if (etx != 0) {
+        uint32_t link_metric = ETX_TO_RANK(etx);
 
-    double etx_value = etx_get_metric(&(parent->addr));
-    DEBUGF("Metric for parent returned: %f\n", etx_value);
-
-    if (etx_value != 0) {
         /*
          * (ETX_for_link_to_neighbor * 128) + Rank_of_that_neighbor
          *
@@ -81,29 +78,48 @@ static uint16_t calc_path_cost(rpl_parent_t *parent)
          * from me to that neighbor
          *
          */
-        if (etx_value * ETX_RANK_MULTIPLIER > MAX_LINK_METRIC) {
+        if (link_metric > MAX_LINK_METRIC) {
             // Disallow links with an estimated ETX of 4 or higher
             return MAX_PATH_COST;
         }
 
-        if (etx_value * ETX_RANK_MULTIPLIER + parent->rank
-            < parent->rank) {
-            //Overflow
+        if (link_metric + parent_rank >= MAX_PATH_COST) {
             return MAX_PATH_COST;
         }
 
-        //TODO runden
-        return etx_value * ETX_RANK_MULTIPLIER
-               + parent->rank;
+        return link_metric + parent_rank;
     }
     else {
         // IMPLEMENT HANDLING OF OTHER METRICS HERE
-        // if it is 0, it hasn't been computed, thus we cannot compute a path
-        // cost
+        // if it is 0, the neighbor is unknown, thus we cannot compute a
+        // path cost
         return MAX_PATH_COST;
     }
 }
 
+uint16_t of_mrhof_rank(uint16_t etx, uint16_t parent_rank, uint16_t minhoprankincrease)
+{
+    /*
+     * Calculate the path cost for the parent and choose the maximum of that
+     * value and the advertised rank of the parent + minhoprankincrease for
+     * our rank.
+     */
+    uint16_t calculated_pcost = calc_path_cost(etx, parent_rank);
+
+    if (calculated_pcost < MAX_PATH_COST) {
+        if ((uint32_t) parent_rank + minhoprankincrease > calculated_pcost) {
+            return parent_rank + minhoprankincrease;
+        }
+        else {
+            return calculated_pcost;
+        }
+    }
+    else {
+        //Path costs are greater than allowed
+        return INFINITE_RANK;
+    }
+}
+
 static uint16_t calc_rank(rpl_parent_t *parent, uint16_t base_rank)
 {
     DEBUGF("calc_rank\n");
@@ -129,64 +145,29 @@ static uint16_t calc_rank(rpl_parent_t *parent, uint16_t base_rank)
          */
         return DEFAULT_MIN_HOP_RANK_INCREASE;
     }
-    else {
-        /*
-         * We have a parent and are a non-root node, calculate the path cost for
-         * the parent and choose the maximum of that value and the advertised
-         * rank of the parent + minhoprankincrease for our rank.
-         */
-        uint16_t calculated_pcost = calc_path_cost(parent);
-
-        if (calculated_pcost < MAX_PATH_COST) {
-            if ((parent->rank + parent->dodag->minhoprankincrease)
-                > calculated_pcost) {
-                return parent->rank + parent->dodag->minhoprankincrease;
-            }
-            else {
-                return calculated_pcost;
-            }
-        }
-        else {
-            //Path costs are greater than allowed
-            return INFINITE_RANK;
-        }
-    }
+
+    /* the metric the rank of the parent was computed with */
+    parent->link_metric = link_estimator_get_etx(&(parent->addr));
+    parent->link_metric_type = METRIC_ETX;
+    DEBUGF("Metric for parent returned: %u\n", parent->link_metric);
+
+    return of_mrhof_rank(parent->link_metric, parent->rank,
+                         parent->dodag->minhoprankincrease);
 }
 
 static rpl_parent_t *which_parent(rpl_parent_t *p1, rpl_parent_t *p2)
 {
     DEBUGF("which_parent\n");
+
     /*
-     * Return the parent with the lowest path cost.
-     * Before returning any of the two given parents, make sure that a switch is
-     * desirable.
-     *
+     * Return the parent with the lowest path cost. The hysteresis of
+     * parent switches is up to rpl_find_preferred_parent().
      */
-    uint16_t path_p1    = calc_path_cost(p1);
-    uint16_t path_p2    = calc_path_cost(p2);
-
-    if (cur_preferred_parent != NULL) {
-        //test if the parent from which we got this path is still active
-        if (cur_preferred_parent->used != 0) {
-            // Test, if the current best path is better than both parents given
-            if (cur_min_path_cost < path_p1 + PARENT_SWITCH_THRESHOLD
-                && cur_min_path_cost < path_p2 + PARENT_SWITCH_THRESHOLD) {
-                return cur_preferred_parent;
-            }
-        }
-    }
-
-    if (path_p1 < path_p2) {
-        /*
-         * Return the current best parent, and set it as current best parent
-         */
-        cur_min_path_cost = path_p1;
-        cur_preferred_parent = p1;
+    if (calc_path_cost(link_estimator_get_etx(&p1->addr), p1->rank) <
+        calc_path_cost(link_estimator_get_etx(&p2->addr), p2->rank)) {
         return p1;
     }
 
-    cur_min_path_cost = path_p2;
-    cur_preferred_parent = p2;
     return p2;
 }
 
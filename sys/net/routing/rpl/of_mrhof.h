@@ -29,7 +29,7 @@
  * expected to require at least 1.5 fewer transmissions than the
  * current path.
  */
-#define PARENT_SWITCH_THRESHOLD (192)
+#define PARENT_SWITCH_THRESHOLD (RPL_PARENT_SWITCH_THRESHOLD)
 
 /**
  *  Do not allow a node to become a floating root.
@@ -46,4 +46,12 @@
 
 rpl_of_t *rpl_get_of_mrhof(void);
 
+/**
+ * Rank of a node through a parent of rank parent_rank over a link with the
+ * ETX etx, in the fixed point representation of the link estimator
+ * (LINK_ESTIMATOR_ETX_ONE is 1), INFINITE_RANK if the path is not allowed.
+ * An ETX of 0 stands for an unknown link.
+ */
+uint16_t of_mrhof_rank(uint16_t etx, uint16_t parent_rank, uint16_t minhoprankincrease);
+
 #endif /* OF_MRHOF_H */
@@ -23,32 +23,28 @@
 
 #include "msg.h"
 #include "rpl.h"
-#include "etx_beaconing.h"
+#include "link_estimator.h"
 #include "of0.h"
 #include "of_mrhof.h"
-#include "trickle.h"
+#include "rpl_timers.h"
+#include "rpl_dao.h"
 
 #include "sixlowpan.h"
 #include "net_help.h"
 
-/* You can only run Storing Mode by now. Other unsupported modes lead to default (Storing Mode) */
-#if RPL_DEFAULT_MOP == RPL_STORING_MODE_NO_MC
+/* Storing and non-storing mode share the mode functions, the MOP of the DODAG decides
+ * how DAOs are handled. Other unsupported modes lead to default (Storing Mode) */
 #include "rpl/rpl_storing.h"
-#else
-#include "rpl/rpl_storing.h"
-#endif
+#include "rpl/rpl_nonstoring.h"
 
 #define ENABLE_DEBUG (0)
 #if ENABLE_DEBUG
-#undef TRICKLE_TIMER_STACKSIZE
-#define TRICKLE_TIMER_STACKSIZE (KERNEL_CONF_STACKSIZE_MAIN)
 char addr_str[IPV6_MAX_ADDR_STR_LEN];
 #endif
 #include "debug.h"
 
 /* global variables */
 rpl_of_t *rpl_objective_functions[NUMBER_IMPLEMENTED_OFS];
-rpl_routing_entry_t rpl_routing_table[RPL_MAX_ROUTING_ENTRIES];
 kernel_pid_t rpl_process_pid = KERNEL_PID_UNDEF;
 mutex_t rpl_recv_mutex = MUTEX_INIT;
 mutex_t rpl_send_mutex = MUTEX_INIT;
@@ -56,6 +52,13 @@ msg_t rpl_msg_queue[RPL_PKT_RECV_BUF_SIZE];
 char rpl_process_buf[RPL_PROCESS_STACKSIZE];
 uint8_t rpl_buffer[BUFFER_SIZE - LL_HDR_LEN];
 
+/* destination ports mapped to an instance other than the default one */
+static struct {
+    uint16_t port;
+    uint8_t instanceid;
+    uint8_t used;
+} port_mappings[RPL_MAX_PORT_MAPPINGS];
+
 /* IPv6 message buffer */
 ipv6_hdr_t *ipv6_buf;
 
@@ -73,14 +76,14 @@ rpl_of_t *rpl_get_of_for_ocp(uint16_t ocp)
 
 uint8_t rpl_init(int if_id)
 {
+    /* the routing tables are part of the instances */
     rpl_instances_init();
+    memset(port_mappings, 0, sizeof(port_mappings));
 
-    /* initialize routing table */
-    rpl_clear_routing_table();
-    init_trickle();
     rpl_process_pid = thread_create(rpl_process_buf, RPL_PROCESS_STACKSIZE,
                                     PRIORITY_MAIN - 1, CREATE_STACKTEST,
                                     rpl_process, NULL, "rpl_process");
+    rpl_timers_init();
 
     /* INSERT NEW OBJECTIVE FUNCTIONS HERE */
     rpl_objective_functions[0] = rpl_get_of0();
@@ -93,12 +96,11 @@ uint8_t rpl_init(int if_id)
     ipv6_addr_set_link_local_prefix(&ll_address);
     ipv6_net_if_get_best_src_addr(&my_address, &ll_address);
     ipv6_register_rpl_handler(rpl_process_pid);
+    ipv6_iface_set_rpl_option_provider(rpl_set_option, rpl_get_next_hop_for_option);
 
-    /* initialize ETX-calculation if needed */
-    if (RPL_DEFAULT_OCP == 1) {
-        DEBUGF("INIT ETX BEACONING\n");
-        etx_init_beaconing(&my_address);
-    }
+    /* any instance may use MRHOF, which needs the link estimates */
+    DEBUGF("INIT LINK ESTIMATOR\n");
+    link_estimator_init();
 
     rpl_init_mode(&my_address);
 
@@ -107,7 +109,48 @@ uint8_t rpl_init(int if_id)
 
 void rpl_init_root(void)
 {
-    rpl_init_root_mode();
+    rpl_init_root_instance(RPL_DEFAULT_INSTANCE, RPL_DEFAULT_OCP);
+}
+
+void rpl_init_root_instance(uint8_t instanceid, uint16_t ocp)
+{
+    mutex_lock(&rpl_recv_mutex);
+    rpl_init_root_mode(instanceid, ocp);
+    mutex_unlock(&rpl_recv_mutex);
+}
+
+int rpl_map_port(uint16_t port, uint8_t instanceid)
+{
+    int free = -1;
+
+    for (int i = 0; i < RPL_MAX_PORT_MAPPINGS; i++) {
+        if (port_mappings[i].used && port_mappings[i].port == port) {
+            port_mappings[i].instanceid = instanceid;
+            return 0;
+        }
+
+        if (!port_mappings[i].used && free < 0) {
+            free = i;
+        }
+    }
+
+    if (free < 0) {
+        return -1;
+    }
+
+    port_mappings[free].port = port;
+    port_mappings[free].instanceid = instanceid;
+    port_mappings[free].used = 1;
+    return 0;
+}
+
+void rpl_unmap_port(uint16_t port)
+{
+    for (int i = 0; i < RPL_MAX_PORT_MAPPINGS; i++) {
+        if (port_mappings[i].used && port_mappings[i].port == port) {
+            port_mappings[i].used = 0;
+        }
+    }
 }
 
 void *rpl_process(void *arg)
@@ -120,6 +163,13 @@ void *rpl_process(void *arg)
     while (1) {
         msg_receive(&m_recv);
         mutex_lock(&rpl_recv_mutex);
+
+        if (m_recv.type == MSG_TIMER) {
+            rpl_timers_handle(&m_recv);
+            mutex_unlock(&rpl_recv_mutex);
+            continue;
+        }
+
         uint8_t *code;
         code = ((uint8_t *)m_recv.content.ptr);
         /* differentiate packet types */
@@ -163,21 +213,21 @@ void *rpl_process(void *arg)
 /* General RPL-send & -receive functions. Call mode-functions */
 /**************************************************************/
 
-void send_DIO(ipv6_addr_t *destination)
+void send_DIO(rpl_dodag_t *dodag, ipv6_addr_t *destination)
 {
     DEBUGF("Send DIO to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, destination));
 
     mutex_lock(&rpl_send_mutex);
-    send_DIO_mode(destination);
+    send_DIO_mode(dodag, destination);
     mutex_unlock(&rpl_send_mutex);
 }
 
-void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index)
+void send_DAO(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime)
 {
     DEBUG("Send DAO to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, destination));
 
     mutex_lock(&rpl_send_mutex);
-    send_DAO_mode(destination, lifetime, default_lifetime, start_index);
+    send_DAO_mode(dodag, destination, lifetime, default_lifetime);
     mutex_unlock(&rpl_send_mutex);
 }
 
@@ -190,12 +240,12 @@ void send_DIS(ipv6_addr_t *destination)
     mutex_unlock(&rpl_send_mutex);
 }
 
-void send_DAO_ACK(ipv6_addr_t *destination)
+void send_DAO_ACK(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t sequence)
 {
     DEBUGF("Send DAO ACK to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, destination));
 
     mutex_lock(&rpl_send_mutex);
-    send_DAO_ACK_mode(destination);
+    send_DAO_ACK_mode(dodag, destination, sequence);
     mutex_unlock(&rpl_send_mutex);
 }
 
@@ -237,72 +287,117 @@ void recv_rpl_DAO_ACK(void)
 
 ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr)
 {
-    DEBUGF("looking up the next hop to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used) {
-            DEBUGF("checking %d: %s\n", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_routing_table[i].address));
-        }
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            DEBUGF("found %d: %s\n", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_routing_table[i].next_hop));
-            return &rpl_routing_table[i].next_hop;
-        }
+    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+
+    if (my_dodag == NULL) {
+        return NULL;
     }
 
-    return (rpl_get_my_preferred_parent());
+    return rpl_get_instance_next_hop(my_dodag, addr);
 }
 
-void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime)
+/* the entry of the routing table of dodag, NULL if packets to addr go up */
+static ipv6_addr_t *get_downward_next_hop(rpl_dodag_t *dodag, ipv6_addr_t *addr)
 {
-    rpl_routing_entry_t *entry = rpl_find_routing_entry(addr);
+    rpl_routing_entry_t *entry;
 
-    if (entry != NULL) {
-        entry->lifetime = lifetime;
-        return;
+    /* only the root of a non-storing DODAG knows routes */
+    if (dodag->mop == RPL_NON_STORING_MODE && dodag->node_status == ROOT_NODE) {
+        return rpl_ns_get_next_hop(dodag, addr);
     }
 
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (!rpl_routing_table[i].used) {
-            memcpy(&rpl_routing_table[i].address, addr, sizeof(ipv6_addr_t));
-            memcpy(&rpl_routing_table[i].next_hop, next_hop, sizeof(ipv6_addr_t));
-            rpl_routing_table[i].lifetime = lifetime;
-            rpl_routing_table[i].used = 1;
-            break;
-        }
+    DEBUGF("looking up the next hop to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
+
+    /* children may announce the prefix of their sub-DODAG */
+    if ((entry = rpl_dao_lookup(dodag->instance, addr)) == NULL) {
+        return NULL;
     }
+
+    DEBUGF("found %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &entry->next_hop));
+    return &entry->next_hop;
 }
 
-void rpl_del_routing_entry(ipv6_addr_t *addr)
+ipv6_addr_t *rpl_get_instance_next_hop(rpl_dodag_t *dodag, ipv6_addr_t *addr)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            memset(&rpl_routing_table[i], 0, sizeof(rpl_routing_table[i]));
-            return;
-        }
+    ipv6_addr_t *next_hop = get_downward_next_hop(dodag, addr);
+
+    if (next_hop == NULL && dodag->my_preferred_parent != NULL) {
+        next_hop = &dodag->my_preferred_parent->addr;
     }
+
+    return next_hop;
 }
 
-rpl_routing_entry_t *rpl_find_routing_entry(ipv6_addr_t *addr)
+int rpl_set_option(ipv6_hdr_t *packet, ipv6_rpl_opt_t *opt)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            return &rpl_routing_table[i];
+    uint16_t port;
+
+    if (packet->nextheader != IPV6_PROTO_NUM_UDP && packet->nextheader != IPV6_PROTO_NUM_TCP) {
+        return 0;
+    }
+
+    /* UDP and TCP both start with the source and the destination port */
+    port = NTOHS(*((uint16_t *)((uint8_t *) packet + IPV6_HDR_LEN + 2)));
+
+    for (int i = 0; i < RPL_MAX_PORT_MAPPINGS; i++) {
+        if (port_mappings[i].used && port_mappings[i].port == port) {
+            rpl_dodag_t *dodag = rpl_get_joined_dodag(port_mappings[i].instanceid);
+
+            if (dodag == NULL) {
+                DEBUGF("port %u is mapped to an instance not joined\n", port);
+                return 0;
+            }
+
+            opt->flags = 0;
+            opt->instance_id = dodag->instance->id;
+            opt->sender_rank = HTONS(dodag->my_rank);
+            return 1;
         }
     }
 
-    return NULL;
+    return 0;
 }
 
-void rpl_clear_routing_table(void)
+ipv6_addr_t *rpl_get_next_hop_for_option(ipv6_addr_t *addr, ipv6_rpl_opt_t *opt)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        memset(&rpl_routing_table[i], 0, sizeof(rpl_routing_table[i]));
+    rpl_dodag_t *dodag = rpl_get_joined_dodag(opt->instance_id);
+    ipv6_addr_t *next_hop;
+    uint16_t sender_rank, my_rank;
+
+    if (dodag == NULL) {
+        DEBUGF("[Error] packet for instance %u, which is not joined\n", opt->instance_id);
+        return NULL;
     }
 
-}
+    /* a packet going up must come from a deeper node and vice versa,
+     * the first inconsistency is marked, the second one drops the packet */
+    sender_rank = rpl_dag_rank(dodag, NTOHS(opt->sender_rank));
+    my_rank = rpl_dag_rank(dodag, dodag->my_rank);
 
-rpl_routing_entry_t *rpl_get_routing_table(void)
-{
-    return rpl_routing_table;
+    if (((opt->flags & IPV6_OPT_RPL_FLAG_O) && sender_rank > my_rank) ||
+        (!(opt->flags & IPV6_OPT_RPL_FLAG_O) && sender_rank < my_rank)) {
+        if (opt->flags & IPV6_OPT_RPL_FLAG_R) {
+            DEBUGF("[Error] second rank error, dropping packet\n");
+            return NULL;
+        }
+
+        opt->flags |= IPV6_OPT_RPL_FLAG_R;
+    }
+
+    if ((next_hop = get_downward_next_hop(dodag, addr)) != NULL) {
+        opt->flags |= IPV6_OPT_RPL_FLAG_O;
+    }
+    else if (dodag->my_preferred_parent != NULL) {
+        next_hop = &dodag->my_preferred_parent->addr;
+        opt->flags &= ~IPV6_OPT_RPL_FLAG_O;
+    }
+    else {
+        /* the root of the instance has no route to addr */
+        return NULL;
+    }
+
+    opt->sender_rank = HTONS(dodag->my_rank);
+    return next_hop;
 }
 
 /******************************************************************************/
@@ -0,0 +1,604 @@
+/**
+ * RPL DAO target bookkeeping
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_dao.c
+ * @brief   Incremental DAOs, only new, withdrawn and expiring targets
+ * @}
+ */
+
+#include <string.h>
+
+#include "rpl.h"
+#include "rpl/rpl_nonstoring.h"
+#include "rpl_dao.h"
+#include "rpl_routing.h"
+
+#define ENABLE_DEBUG    (0)
+#if ENABLE_DEBUG
+#define DEBUG_ENABLED
+static char addr_str[IPV6_MAX_ADDR_STR_LEN];
+#endif
+#include "debug.h"
+
+/* octets a prefix of len bits takes in a Target option */
+#define PREFIX_BYTES(len)   (((len) + 7) / 8)
+
+enum {
+    ITEM_NONE,
+    ITEM_ANNOUNCE,
+    ITEM_WITHDRAW,
+};
+
+/* number of leading bits a and b have in common, at most max */
+static uint8_t common_bits(ipv6_addr_t *a, ipv6_addr_t *b, uint8_t max)
+{
+    uint8_t n = 0;
+
+    while (n < max && n < IPV6_ADDR_BIT_LEN) {
+        uint8_t xor = a->uint8[n / 8] ^ b->uint8[n / 8];
+
+        if (xor == 0) {
+            n += 8;
+            continue;
+        }
+
+        while (!(xor & (0x80 >> (n % 8)))) {
+            n++;
+        }
+
+        break;
+    }
+
+    return (n < max) ? n : max;
+}
+
+static void prefix_mask(ipv6_addr_t *prefix, uint8_t len)
+{
+    for (uint8_t i = len; i < IPV6_ADDR_BIT_LEN; i++) {
+        prefix->uint8[i / 8] &= ~(0x80 >> (i % 8));
+    }
+}
+
+/* seconds until the targets are announced again */
+static uint16_t refresh_time(rpl_dodag_t *dodag)
+{
+    uint32_t lifetime = (uint32_t) dodag->default_lifetime * dodag->lifetime_unit;
+    uint32_t retries = DEFAULT_DAO_DELAY + DAO_SEND_RETRIES * DEFAULT_WAIT_FOR_DAO_ACK;
+
+    /* a quarter of the lifetime at the parent is left for the retries,
+     * short lifetimes are refreshed when half of them is over */
+    if (lifetime / 4 >= retries) {
+        lifetime -= lifetime / 4;
+    }
+    else {
+        lifetime /= 2;
+    }
+
+    if (lifetime > UINT16_MAX) {
+        return UINT16_MAX;
+    }
+
+    return (lifetime > 0) ? lifetime : 1;
+}
+
+static bool is_aggregated(rpl_dodag_t *dodag)
+{
+    return dodag->dao_target_len < IPV6_ADDR_BIT_LEN;
+}
+
+/* the target of the node itself, its address or the prefix of its sub-DODAG */
+static void update_target(rpl_dodag_t *dodag, ipv6_addr_t *own)
+{
+    rpl_routing_entry_t *rt = dodag->instance->routing_table;
+    ipv6_addr_t target;
+    uint8_t len = IPV6_ADDR_BIT_LEN;
+
+    memcpy(&target, own, sizeof(ipv6_addr_t));
+
+    /* the root of a non-storing DODAG needs every node with its parent */
+    if (dodag->dao_aggregate_len > 0 && dodag->mop != RPL_NON_STORING_MODE) {
+        for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+            if (rt[i].used && !(rt[i].dao_flags & RPL_DAO_NO_PATH)) {
+                len = common_bits(own, &rt[i].address, (len < rt[i].prefix_len) ? len : rt[i].prefix_len);
+            }
+        }
+
+        if (len < dodag->dao_aggregate_len) {
+            len = IPV6_ADDR_BIT_LEN;
+        }
+
+        prefix_mask(&target, len);
+    }
+
+    if (len == dodag->dao_target_len && rpl_equal_id(&target, &dodag->dao_target)) {
+        return;
+    }
+
+    /* the parent may know the previous target already */
+    if (dodag->dao_target_len != 0) {
+        memcpy(&dodag->dao_old_target, &dodag->dao_target, sizeof(ipv6_addr_t));
+        dodag->dao_old_target_len = dodag->dao_target_len;
+    }
+
+    memcpy(&dodag->dao_target, &target, sizeof(ipv6_addr_t));
+    dodag->dao_target_len = len;
+    dodag->dao_target_flags = RPL_DAO_PENDING;
+
+    DEBUG("announcing %s/%u for myself\n",
+          ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &target), len);
+
+    /* an aggregate covers the single targets, without one they are announced again */
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (rt[i].used && !(rt[i].dao_flags & RPL_DAO_NO_PATH)) {
+            rt[i].dao_flags = is_aggregated(dodag) ? 0 : RPL_DAO_PENDING;
+        }
+    }
+}
+
+/* withdrawn routes below an aggregate need not be announced */
+static void drop_covered(rpl_dodag_t *dodag)
+{
+    rpl_routing_entry_t *rt = dodag->instance->routing_table;
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (!rt[i].used) {
+            continue;
+        }
+
+        if (rt[i].dao_flags & RPL_DAO_NO_PATH) {
+            rpl_rt_free(dodag->instance, &rt[i]);
+        }
+        else {
+            rt[i].dao_flags = 0;
+        }
+    }
+}
+
+/* what item i of the next DAO announces, lifetime 0 withdraws everything */
+static uint8_t get_item(rpl_dodag_t *dodag, uint16_t i, uint8_t lifetime,
+                        ipv6_addr_t **prefix, uint8_t *len)
+{
+    rpl_routing_entry_t *entry;
+    uint8_t flags;
+
+    if (i == 0) {
+        if (dodag->dao_target_len == 0) {
+            return ITEM_NONE;
+        }
+
+        *prefix = &dodag->dao_target;
+        *len = dodag->dao_target_len;
+        flags = dodag->dao_target_flags;
+    }
+    else if (i == 1) {
+        if (lifetime == 0 || dodag->dao_old_target_len == 0) {
+            return ITEM_NONE;
+        }
+
+        *prefix = &dodag->dao_old_target;
+        *len = dodag->dao_old_target_len;
+        return ITEM_WITHDRAW;
+    }
+    else {
+        entry = &dodag->instance->routing_table[i - 2];
+
+        if (!entry->used || is_aggregated(dodag)) {
+            return ITEM_NONE;
+        }
+
+        *prefix = &entry->address;
+        *len = entry->prefix_len;
+        flags = entry->dao_flags;
+    }
+
+    if (lifetime == 0) {
+        return (flags & RPL_DAO_NO_PATH) ? ITEM_NONE : ITEM_WITHDRAW;
+    }
+
+    if (!(flags & RPL_DAO_PENDING)) {
+        return ITEM_NONE;
+    }
+
+    return (flags & RPL_DAO_NO_PATH) ? ITEM_WITHDRAW : ITEM_ANNOUNCE;
+}
+
+static void mark_sent(rpl_dodag_t *dodag, uint16_t i, uint8_t seq)
+{
+    if (i == 0) {
+        dodag->dao_target_flags |= RPL_DAO_SENT;
+        dodag->dao_target_seq = seq;
+    }
+    else if (i == 1) {
+        /* the old target expires at the parent anyway */
+        dodag->dao_old_target_len = 0;
+    }
+    else {
+        dodag->instance->routing_table[i - 2].dao_flags |= RPL_DAO_SENT;
+        dodag->instance->routing_table[i - 2].dao_seq = seq;
+    }
+}
+
+static uint8_t *put_target(uint8_t *p, ipv6_addr_t *prefix, uint8_t len)
+{
+    rpl_opt_target_t *opt = (rpl_opt_target_t *) p;
+
+    opt->type = RPL_OPT_TARGET;
+    opt->length = 2 + PREFIX_BYTES(len);
+    opt->flags = 0;
+    opt->prefix_length = len;
+    memcpy(&opt->target, prefix, PREFIX_BYTES(len));
+
+    return p + RPL_OPT_LEN + opt->length;
+}
+
+static uint8_t *put_transit(uint8_t *p, uint8_t lifetime, ipv6_addr_t *parent)
+{
+    rpl_opt_transit_t *opt = (rpl_opt_transit_t *) p;
+
+    opt->type = RPL_OPT_TRANSIT;
+    opt->length = (parent != NULL) ? RPL_OPT_TRANSIT_PARENT_LEN : RPL_OPT_TRANSIT_LEN;
+    opt->e_flags = 0x00;
+    opt->path_control = 0x00;   /* not used */
+    opt->path_sequence = 0x00;  /* not used */
+    opt->path_lifetime = lifetime;
+
+    if (parent != NULL) {
+        memcpy(&opt->parent, parent, sizeof(ipv6_addr_t));
+    }
+
+    return p + RPL_OPT_LEN + opt->length;
+}
+
+void rpl_dao_refresh_all(rpl_dodag_t *dodag)
+{
+    rpl_routing_entry_t *rt = dodag->instance->routing_table;
+
+    /* the new parent knows nothing, the old one got a No-Path for everything */
+    dodag->dao_target_flags = RPL_DAO_PENDING;
+    dodag->dao_old_target_len = 0;
+    dodag->dao_refresh = refresh_time(dodag);
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (!rt[i].used) {
+            continue;
+        }
+
+        if (rt[i].dao_flags & RPL_DAO_NO_PATH) {
+            rpl_rt_free(dodag->instance, &rt[i]);
+        }
+        else {
+            rt[i].dao_flags = is_aggregated(dodag) ? 0 : RPL_DAO_PENDING;
+        }
+    }
+}
+
+bool rpl_dao_pending(rpl_dodag_t *dodag)
+{
+    rpl_routing_entry_t *rt = dodag->instance->routing_table;
+
+    if ((dodag->dao_target_flags & RPL_DAO_PENDING) || dodag->dao_old_target_len != 0) {
+        return true;
+    }
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (rt[i].used && (rt[i].dao_flags & RPL_DAO_PENDING)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool rpl_dao_tick(rpl_dodag_t *dodag)
+{
+    rpl_instance_t *inst = dodag->instance;
+    rpl_routing_entry_t *rt = inst->routing_table;
+    rpl_routing_entry_t *entry;
+    bool root = (dodag->node_status == ROOT_NODE);
+    bool pending = false;
+
+    rpl_rt_tick(inst);
+
+    while ((entry = rpl_rt_next_expired(inst)) != NULL) {
+        if (root || dodag->mop == RPL_NON_STORING_MODE) {
+            rpl_rt_free(inst, entry);
+            continue;
+        }
+
+        /* the parent learns about expired routes, too */
+        entry->dao_flags = RPL_DAO_NO_PATH | RPL_DAO_PENDING;
+        pending = true;
+    }
+
+    if (root || dodag->dao_target_len == 0) {
+        return pending;
+    }
+
+    if (dodag->dao_refresh > 1) {
+        dodag->dao_refresh--;
+        return pending;
+    }
+
+    /* all targets are refreshed at once, so they share the DAOs */
+    dodag->dao_refresh = refresh_time(dodag);
+    dodag->dao_target_flags = RPL_DAO_PENDING;
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (rt[i].used && !(rt[i].dao_flags & RPL_DAO_NO_PATH) && !is_aggregated(dodag)) {
+            rt[i].dao_flags = RPL_DAO_PENDING;
+        }
+    }
+
+    return true;
+}
+
+uint16_t rpl_dao_build(rpl_dodag_t *dodag, ipv6_addr_t *own, ipv6_addr_t *parent,
+                       uint8_t lifetime, uint8_t *buf, uint16_t max_len,
+                       uint8_t seq, uint16_t *cursor)
+{
+    uint16_t announce = 0, withdraw = 0, end;
+    uint16_t transit = RPL_OPT_LEN + ((parent != NULL) ? RPL_OPT_TRANSIT_PARENT_LEN : RPL_OPT_TRANSIT_LEN);
+    ipv6_addr_t *prefix;
+    uint8_t len, *p = buf;
+
+    if (*cursor == 0) {
+        update_target(dodag, own);
+
+        if (is_aggregated(dodag) && lifetime != 0) {
+            drop_covered(dodag);
+        }
+    }
+
+    /* find the items that fit, each group needs a Transit option */
+    for (end = *cursor; end < RPL_DAO_ITEMS; end++) {
+        uint8_t item = get_item(dodag, end, lifetime, &prefix, &len);
+        uint16_t size = RPL_OPT_LEN + 2 + PREFIX_BYTES(len);
+
+        if (item == ITEM_NONE) {
+            continue;
+        }
+
+        if (announce + withdraw + size + 2 * transit > max_len) {
+            break;
+        }
+
+        if (item == ITEM_ANNOUNCE) {
+            announce += size;
+        }
+        else {
+            withdraw += size;
+        }
+    }
+
+    /* the targets with a lifetime, then the withdrawn ones */
+    if (announce > 0) {
+        for (uint16_t i = *cursor; i < end; i++) {
+            if (get_item(dodag, i, lifetime, &prefix, &len) == ITEM_ANNOUNCE) {
+                p = put_target(p, prefix, len);
+            }
+        }
+
+        p = put_transit(p, lifetime, parent);
+    }
+
+    if (withdraw > 0) {
+        for (uint16_t i = *cursor; i < end; i++) {
+            if (get_item(dodag, i, lifetime, &prefix, &len) == ITEM_WITHDRAW) {
+                p = put_target(p, prefix, len);
+            }
+        }
+
+        p = put_transit(p, 0, parent);
+    }
+
+    if (lifetime != 0) {
+        for (uint16_t i = *cursor; i < end; i++) {
+            if (get_item(dodag, i, lifetime, &prefix, &len) != ITEM_NONE) {
+                mark_sent(dodag, i, seq);
+            }
+        }
+    }
+
+    *cursor = end;
+    return p - buf;
+}
+
+void rpl_dao_acked(rpl_dodag_t *dodag, uint8_t seq)
+{
+    rpl_routing_entry_t *rt = dodag->instance->routing_table;
+
+    if ((dodag->dao_target_flags & RPL_DAO_SENT) && dodag->dao_target_seq == seq) {
+        dodag->dao_target_flags = 0;
+    }
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (!rt[i].used || !(rt[i].dao_flags & RPL_DAO_SENT) || rt[i].dao_seq != seq) {
+            continue;
+        }
+
+        if (rt[i].dao_flags & RPL_DAO_NO_PATH) {
+            rpl_rt_free(dodag->instance, &rt[i]);
+        }
+        else {
+            rt[i].dao_flags = 0;
+        }
+    }
+}
+
+/* stores a route of a storing DODAG, returns 1 if the parent has to learn about it */
+static int add_route(rpl_dodag_t *dodag, ipv6_addr_t *prefix, uint8_t len,
+                     ipv6_addr_t *from, uint16_t lifetime)
+{
+    rpl_routing_entry_t *entry = rpl_rt_find(dodag->instance, prefix, len);
+    bool changed = false;
+
+    if (lifetime == 0) {
+        /* a No-Path for a parent the node has left already is stale */
+        if (entry == NULL || (entry->dao_flags & RPL_DAO_NO_PATH) ||
+            !rpl_equal_id(&entry->next_hop, from)) {
+            return 0;
+        }
+
+        DEBUG("No-Path for %s/%u\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, prefix), len);
+
+        if (dodag->node_status == ROOT_NODE) {
+            rpl_rt_free(dodag->instance, entry);
+        }
+        else {
+            /* kept until the parent acknowledges the No-Path */
+            rpl_rt_keep(dodag->instance, entry);
+            entry->dao_flags = RPL_DAO_NO_PATH | RPL_DAO_PENDING;
+        }
+
+        return 1;
+    }
+
+    if (entry == NULL) {
+        if ((entry = rpl_rt_new(dodag->instance, prefix, len)) == NULL) {
+            return 0;
+        }
+
+        changed = true;
+    }
+    else if ((entry->dao_flags & RPL_DAO_NO_PATH) || !rpl_equal_id(&entry->next_hop, from)) {
+        changed = true;
+    }
+
+    memcpy(&entry->next_hop, from, sizeof(ipv6_addr_t));
+    rpl_rt_set_lifetime(dodag->instance, entry, lifetime);
+
+    /* a refresh from the same child stays with this hop */
+    if (changed) {
+        entry->dao_flags = RPL_DAO_PENDING;
+    }
+
+    return changed ? 1 : 0;
+}
+
+/* applies the Transit option to the targets before it */
+static int process_group(rpl_dodag_t *dodag, ipv6_addr_t *from, uint8_t *opts,
+                         uint16_t len, rpl_opt_transit_t *transit)
+{
+    uint16_t lifetime = transit->path_lifetime * dodag->lifetime_unit;
+    uint16_t pos = 0;
+    int changes = 0;
+
+    while (pos < len) {
+        rpl_opt_target_t *target = (rpl_opt_target_t *)(opts + pos);
+        ipv6_addr_t prefix;
+
+        if (target->type == RPL_OPT_PAD1) {
+            pos++;
+            continue;
+        }
+
+        pos += RPL_OPT_LEN + target->length;
+
+        if (target->type != RPL_OPT_TARGET) {
+            continue;
+        }
+
+        if (target->prefix_length > IPV6_ADDR_BIT_LEN ||
+            target->length < 2 + PREFIX_BYTES(target->prefix_length)) {
+            DEBUG("[Error] malformed target option\n");
+            continue;
+        }
+
+        memset(&prefix, 0, sizeof(prefix));
+        memcpy(&prefix, &target->target, PREFIX_BYTES(target->prefix_length));
+        prefix_mask(&prefix, target->prefix_length);
+
+        DEBUG("Target %s/%u, lifetime %u\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &prefix),
+              target->prefix_length, lifetime);
+
+        if (dodag->mop == RPL_NON_STORING_MODE) {
+            if (transit->length < RPL_OPT_TRANSIT_PARENT_LEN ||
+                target->prefix_length != IPV6_ADDR_BIT_LEN) {
+                DEBUG("[Error] - no parent address in transit option\n");
+                continue;
+            }
+
+            rpl_ns_add_route(dodag, &prefix, &transit->parent, lifetime);
+            changes++;
+        }
+        else {
+            changes += add_route(dodag, &prefix, target->prefix_length, from, lifetime);
+        }
+    }
+
+    return changes;
+}
+
+int rpl_dao_process(rpl_dodag_t *dodag, ipv6_addr_t *from, uint8_t *opts, uint16_t len)
+{
+    uint16_t pos = 0, group = 0;
+    bool in_group = false;
+    int changes = 0;
+
+    while (pos < len) {
+        rpl_opt_t *opt = (rpl_opt_t *)(opts + pos);
+
+        if (opt->type == RPL_OPT_PAD1) {
+            pos++;
+            continue;
+        }
+
+        if (pos + RPL_OPT_LEN > len || pos + RPL_OPT_LEN + opt->length > len) {
+            DEBUG("[Error] truncated DAO option\n");
+            return -1;
+        }
+
+        /* one Transit option applies to all the targets before it */
+        if (opt->type == RPL_OPT_TARGET && !in_group) {
+            group = pos;
+            in_group = true;
+        }
+        else if (opt->type == RPL_OPT_TRANSIT && in_group) {
+            changes += process_group(dodag, from, opts + group, pos - group,
+                                     (rpl_opt_transit_t *) opt);
+            in_group = false;
+        }
+
+        pos += RPL_OPT_LEN + opt->length;
+    }
+
+    return changes;
+}
+
+rpl_routing_entry_t *rpl_dao_lookup(rpl_instance_t *inst, ipv6_addr_t *addr)
+{
+    rpl_routing_entry_t *best = rpl_rt_find(inst, addr, IPV6_ADDR_BIT_LEN);
+
+    /* withdrawn routes are not used any more */
+    if (best != NULL && (best->dao_flags & RPL_DAO_NO_PATH)) {
+        best = NULL;
+    }
+
+    if (best != NULL || inst->rt_prefixes == 0) {
+        return best;
+    }
+
+    /* longest prefix match */
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        rpl_routing_entry_t *entry = &inst->routing_table[i];
+
+        if (!entry->used || (entry->dao_flags & RPL_DAO_NO_PATH)) {
+            continue;
+        }
+
+        if (common_bits(&entry->address, addr, entry->prefix_len) == entry->prefix_len &&
+            (best == NULL || entry->prefix_len > best->prefix_len)) {
+            best = entry;
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,55 @@
+/**
+ * RPL DAO target bookkeeping prototypes
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_dao.h
+ * @brief   Incremental DAOs, only new, withdrawn and expiring targets
+ *
+ * A node announces every target once and repeats it only when three
+ * quarters of its lifetime at the parent are over, on a parent change or
+ * when the parent asks for it by a new DTSN. All targets are refreshed
+ * at the same time, so they share the DAOs. Withdrawn and expired
+ * routes are announced with a No-Path. Targets with the same lifetime
+ * share one Transit option and prefixes are sent in as few bytes as
+ * their length needs.
+ *
+ * If the addresses of a sub-DODAG share a prefix of at least
+ * dao_aggregate_len bits, its root announces the prefix instead of the
+ * single targets. This is only correct if addresses are assigned along
+ * the DODAG, so it is disabled by default (RPL_DAO_AGGREGATE_LEN).
+ * @}
+ */
+
+#ifndef __RPL_DAO_H
+#define __RPL_DAO_H
+
+#include <stdbool.h>
+
+#include "rpl/rpl_structs.h"
+
+/* announcement state of a target, dao_flags of the routing entries */
+#define RPL_DAO_PENDING     (0x01)  /* to be announced in the next DAO */
+#define RPL_DAO_SENT        (0x02)  /* announced in the DAO dao_seq, not acknowledged yet */
+#define RPL_DAO_NO_PATH     (0x04)  /* withdrawn, freed once the No-Path is acknowledged */
+
+/* the own target, a withdrawn aggregate and every routing entry */
+#define RPL_DAO_ITEMS       (RPL_MAX_ROUTING_ENTRIES + 2)
+
+void rpl_dao_refresh_all(rpl_dodag_t *dodag);
+bool rpl_dao_pending(rpl_dodag_t *dodag);
+bool rpl_dao_tick(rpl_dodag_t *dodag);
+uint16_t rpl_dao_build(rpl_dodag_t *dodag, ipv6_addr_t *own, ipv6_addr_t *parent,
+                       uint8_t lifetime, uint8_t *buf, uint16_t max_len,
+                       uint8_t seq, uint16_t *cursor);
+void rpl_dao_acked(rpl_dodag_t *dodag, uint8_t seq);
+int rpl_dao_process(rpl_dodag_t *dodag, ipv6_addr_t *from, uint8_t *opts, uint16_t len);
+rpl_routing_entry_t *rpl_dao_lookup(rpl_instance_t *inst, ipv6_addr_t *addr);
+
+#endif /* __RPL_DAO_H */
@@ -21,6 +21,8 @@
 
 #include "rpl/rpl_dodag.h"
 #include "trickle.h"
+#include "rpl_timers.h"
+#include "rpl_dao.h"
 #include "rpl.h"
 
 #define ENABLE_DEBUG (0)
@@ -96,6 +98,7 @@ rpl_dodag_t *rpl_new_dodag(uint8_t instanceid, ipv6_addr_t *dodagid)
             dodag->instance = inst;
             dodag->my_rank = INFINITE_RANK;
             dodag->used = 1;
+            dodag->dao_aggregate_len = RPL_DAO_AGGREGATE_LEN;
             memcpy(&dodag->dodag_id, dodagid, sizeof(*dodagid));
             return dodag;
         }
@@ -105,36 +108,69 @@ rpl_dodag_t *rpl_new_dodag(uint8_t instanceid, ipv6_addr_t *dodagid)
 
 }
 
-rpl_dodag_t *rpl_get_dodag(ipv6_addr_t *id)
+rpl_dodag_t *rpl_get_dodag(uint8_t instanceid, ipv6_addr_t *id)
 {
     for (int i = 0; i < RPL_MAX_DODAGS; i++) {
-        if (dodags[i].used && (rpl_equal_id(&dodags[i].dodag_id, id))) {
+        if (dodags[i].used && (dodags[i].instance->id == instanceid) &&
+            (rpl_equal_id(&dodags[i].dodag_id, id))) {
             return &dodags[i];
         }
     }
 
     return NULL;
 }
+
+/* the DODAG of the default instance, the first one joined */
 rpl_dodag_t *rpl_get_my_dodag(void)
+{
+    rpl_instance_t *inst = rpl_get_my_instance();
+
+    if (inst == NULL) {
+        return NULL;
+    }
+
+    return rpl_get_joined_dodag(inst->id);
+}
+
+rpl_dodag_t *rpl_get_joined_dodag(uint8_t instanceid)
 {
     for (int i = 0; i < RPL_MAX_DODAGS; i++) {
-        if (dodags[i].joined) {
+        if (dodags[i].joined && (dodags[i].instance->id == instanceid)) {
             return &dodags[i];
         }
     }
 
     return NULL;
 }
+
+/* the joined DODAG after dodag, the first one if dodag is NULL */
+rpl_dodag_t *rpl_next_joined_dodag(rpl_dodag_t *dodag)
+{
+    dodag = (dodag == NULL) ? &dodags[0] : dodag + 1;
+
+    for (; dodag < &dodags[RPL_MAX_DODAGS]; dodag++) {
+        if (dodag->joined) {
+            return dodag;
+        }
+    }
+
+    return NULL;
+}
+
 void rpl_del_dodag(rpl_dodag_t *dodag)
 {
+    trickle_stop(&dodag->trickle);
+    vtimer_remove(&dodag->dao_timer);
     memset(dodag, 0, sizeof(*dodag));
 }
 
 void rpl_leave_dodag(rpl_dodag_t *dodag)
 {
+    rpl_delete_all_parents(dodag);
     dodag->joined = 0;
-    dodag->my_preferred_parent = NULL;
-    rpl_delete_all_parents();
+    dodag->instance->joined = 0;
+    trickle_stop(&dodag->trickle);
+    vtimer_remove(&dodag->dao_timer);
 }
 
 bool rpl_equal_id(ipv6_addr_t *id1, ipv6_addr_t *id2)
@@ -149,6 +185,69 @@ bool rpl_equal_id(ipv6_addr_t *id1, ipv6_addr_t *id2)
 
 }
 
+/* the parent of the highest cost, except for the preferred one */
+static bool delete_worst_parent(rpl_dodag_t *dodag)
+{
+    rpl_parent_t *worst = NULL;
+
+    for (int i = 0; i < RPL_MAX_PARENTS; i++) {
+        if (parents[i].used && (parents[i].dodag == dodag) &&
+            (&parents[i] != dodag->my_preferred_parent) &&
+            ((worst == NULL) || (parents[i].cost >= worst->cost))) {
+            worst = &parents[i];
+        }
+    }
+
+    if (worst == NULL) {
+        return false;
+    }
+
+    rpl_delete_parent(worst);
+    return true;
+}
+
+/* finds the parent of the lowest cost again, from the cached costs */
+static void rank_parents(rpl_dodag_t *dodag)
+{
+    dodag->best_parent = NULL;
+
+    for (int i = 0; i < RPL_MAX_PARENTS; i++) {
+        if (parents[i].used && (parents[i].dodag == dodag) &&
+            (parents[i].cost != INFINITE_RANK) &&
+            ((dodag->best_parent == NULL) || (parents[i].cost < dodag->best_parent->cost))) {
+            dodag->best_parent = &parents[i];
+        }
+    }
+}
+
+/*
+ * Asks the objective function for the rank through the parent after its
+ * rank or lifetime changed. Only if the best parent got worse all parents
+ * are compared again.
+ */
+static void rate_parent(rpl_dodag_t *dodag, rpl_parent_t *parent)
+{
+    uint16_t old_cost = parent->cost;
+
+    if ((parent->rank == INFINITE_RANK) || (parent->lifetime <= 1)) {
+        DEBUG("Infinite rank, bad parent\n");
+        parent->cost = INFINITE_RANK;
+    }
+    else {
+        parent->cost = dodag->of->calc_rank(parent, 0);
+    }
+
+    if (parent == dodag->best_parent) {
+        if (parent->cost > old_cost) {
+            rank_parents(dodag);
+        }
+    }
+    else if ((parent->cost != INFINITE_RANK) &&
+             ((dodag->best_parent == NULL) || (parent->cost < dodag->best_parent->cost))) {
+        dodag->best_parent = parent;
+    }
+}
+
 rpl_parent_t *rpl_new_parent(rpl_dodag_t *dodag, ipv6_addr_t *address, uint16_t rank)
 {
     rpl_parent_t *parent;
@@ -162,23 +261,30 @@ rpl_parent_t *rpl_new_parent(rpl_dodag_t *dodag, ipv6_addr_t *address, uint16_t
             parent->rank = rank;
             parent->dodag = dodag;
             parent->lifetime = dodag->default_lifetime * dodag->lifetime_unit;
+            /* rated with its first rpl_parent_update() */
+            parent->cost = INFINITE_RANK;
             /* dtsn is set at the end of recv_dio function */
             parent->dtsn = 0;
             return parent;
         }
     }
 
-    rpl_delete_worst_parent();
+    /* the DODAGs of the other instances keep their parents */
+    if (!delete_worst_parent(dodag)) {
+        return NULL;
+    }
+
     return rpl_new_parent(dodag, address, rank);
 }
 
-rpl_parent_t *rpl_find_parent(ipv6_addr_t *address)
+rpl_parent_t *rpl_find_parent(rpl_dodag_t *dodag, ipv6_addr_t *address)
 {
     rpl_parent_t *parent;
     rpl_parent_t *end;
 
     for (parent = &parents[0], end = parents + RPL_MAX_PARENTS; parent < end; parent++) {
-        if ((parent->used) && (rpl_equal_id(address, &parent->addr))) {
+        if ((parent->used) && (parent->dodag == dodag) &&
+            (rpl_equal_id(address, &parent->addr))) {
             return parent;
         }
     }
@@ -186,132 +292,145 @@ rpl_parent_t *rpl_find_parent(ipv6_addr_t *address)
     return NULL;
 }
 
-void rpl_delete_parent(rpl_parent_t *parent)
+/* the parent of dodag after parent, the first one if parent is NULL */
+rpl_parent_t *rpl_next_parent(rpl_dodag_t *dodag, rpl_parent_t *parent)
 {
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+    parent = (parent == NULL) ? &parents[0] : parent + 1;
 
-    if ((my_dodag != NULL) && rpl_equal_id(&my_dodag->my_preferred_parent->addr,
-                                           &parent->addr)) {
-        my_dodag->my_preferred_parent = NULL;
+    for (; parent < &parents[RPL_MAX_PARENTS]; parent++) {
+        if (parent->used && (parent->dodag == dodag)) {
+            return parent;
+        }
     }
 
-    memset(parent, 0, sizeof(*parent));
+    return NULL;
 }
 
-void rpl_delete_worst_parent(void)
+void rpl_delete_parent(rpl_parent_t *parent)
 {
-    uint8_t worst = 0xFF;
-    uint16_t max_rank = 0x0000;
+    rpl_dodag_t *dodag = parent->dodag;
 
-    for (int i = 0; i < RPL_MAX_PARENTS; i++) {
-        if (parents[i].rank > max_rank) {
-            worst = i;
-            max_rank = parents[i].rank;
-        }
-    }
+    memset(parent, 0, sizeof(*parent));
 
-    if (worst == 0xFF) {
-        /* Fehler, keine parents -> sollte nicht passieren */
+    if (dodag == NULL) {
         return;
     }
 
-    rpl_delete_parent(&parents[worst]);
+    if (dodag->my_preferred_parent == parent) {
+        dodag->my_preferred_parent = NULL;
+    }
+
+    if (dodag->parent_held == parent) {
+        dodag->parent_held = NULL;
+    }
 
+    if (dodag->best_parent == parent) {
+        rank_parents(dodag);
+    }
 }
 
-void rpl_delete_all_parents(void)
+void rpl_delete_worst_parent(rpl_dodag_t *dodag)
 {
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+    delete_worst_parent(dodag);
+}
 
-    if (my_dodag != NULL) {
-        my_dodag->my_preferred_parent = NULL;
-    }
+void rpl_delete_all_parents(rpl_dodag_t *dodag)
+{
+    dodag->my_preferred_parent = NULL;
+    dodag->best_parent = NULL;
+    dodag->parent_held = NULL;
 
     for (int i = 0; i < RPL_MAX_PARENTS; i++) {
-        memset(&parents[i], 0, sizeof(parents[i]));
+        if (parents[i].used && (parents[i].dodag == dodag)) {
+            memset(&parents[i], 0, sizeof(parents[i]));
+        }
     }
 }
 
-rpl_parent_t *rpl_find_preferred_parent(void)
+/*
+ * Another parent than the current one is only taken if it is better by
+ * RPL_PARENT_SWITCH_THRESHOLD and the last switch is RPL_PARENT_SWITCH_HOLD
+ * seconds ago, unless the current parent is unusable. Every switch costs
+ * a No-Path DAO, DAOs for all targets and a trickle reset.
+ */
+rpl_parent_t *rpl_find_preferred_parent(rpl_dodag_t *my_dodag)
 {
-    rpl_parent_t *best = NULL;
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+    rpl_parent_t *best = my_dodag->best_parent;
+    rpl_parent_t *current = my_dodag->my_preferred_parent;
 
-    if (my_dodag == NULL) {
-        DEBUG("Not part of a dodag\n");
+    if (best == NULL) {
         return NULL;
     }
 
-    for (uint8_t i = 0; i < RPL_MAX_PARENTS; i++) {
-        if (parents[i].used) {
-            if ((parents[i].rank == INFINITE_RANK) || (parents[i].lifetime <= 1)) {
-                DEBUG("Infinite rank, bad parent\n");
-                continue;
-            }
-            else if (best == NULL) {
-                DEBUG("possible parent\n");
-                best = &parents[i];
-            }
-            else {
-                best = my_dodag->of->which_parent(best, &parents[i]);
-            }
+    if ((current != NULL) && (current != best) && (current->cost != INFINITE_RANK) &&
+        ((my_dodag->parent_hold > 0) ||
+         ((uint32_t) best->cost + RPL_PARENT_SWITCH_THRESHOLD > current->cost))) {
+        /* counted once while the same better parent is kept out */
+        if (best->cost < current->cost && best != my_dodag->parent_held) {
+            my_dodag->parent_switches_held++;
+            my_dodag->parent_held = best;
         }
-    }
 
-    if (best == NULL) {
-        return NULL;
+        best = current;
     }
-
-    if (my_dodag->my_preferred_parent == NULL) {
-        my_dodag->my_preferred_parent = best;
+    else {
+        my_dodag->parent_held = NULL;
     }
 
-    if (!rpl_equal_id(&my_dodag->my_preferred_parent->addr, &best->addr)) {
+    if ((current != NULL) && (current != best)) {
+        DEBUGF("switching to parent %s\n",
+               ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &best->addr));
+
         if (my_dodag->mop != RPL_NO_DOWNWARD_ROUTES) {
             /* send DAO with ZERO_LIFETIME to old parent */
-            send_DAO(&my_dodag->my_preferred_parent->addr, 0, false, 0);
+            send_DAO(my_dodag, &current->addr, 0, false);
         }
 
         my_dodag->my_preferred_parent = best;
+        my_dodag->parent_switches++;
+        my_dodag->parent_hold = RPL_PARENT_SWITCH_HOLD;
 
         if (my_dodag->mop != RPL_NO_DOWNWARD_ROUTES) {
-            delay_dao();
+            /* the new parent knows none of the targets */
+            rpl_dao_refresh_all(my_dodag);
+            delay_dao(my_dodag);
         }
 
-        reset_trickletimer();
+        trickle_reset_timer(&my_dodag->trickle);
     }
 
+    my_dodag->my_preferred_parent = best;
+    my_dodag->my_rank = best->cost;
+
     return best;
 }
 
-void rpl_parent_update(rpl_parent_t *parent)
+void rpl_parent_update(rpl_dodag_t *my_dodag, rpl_parent_t *parent)
 {
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
     uint16_t old_rank;
 
-    if (my_dodag == NULL) {
-        DEBUG("Not part of a dodag - this should not happen");
-        return;
-    }
-
     old_rank = my_dodag->my_rank;
 
     /* update Parent lifetime */
     if (parent != NULL) {
         parent->lifetime = my_dodag->default_lifetime * my_dodag->lifetime_unit;
+        rate_parent(my_dodag, parent);
+    }
+    else if (my_dodag->my_preferred_parent != NULL) {
+        /* the lifetime of the preferred parent is over */
+        rate_parent(my_dodag, my_dodag->my_preferred_parent);
     }
 
-    if (rpl_find_preferred_parent() == NULL) {
-        rpl_local_repair();
+    if (rpl_find_preferred_parent(my_dodag) == NULL) {
+        rpl_local_repair(my_dodag);
     }
 
-    if (rpl_calc_rank(old_rank, my_dodag->minhoprankincrease) !=
-        rpl_calc_rank(my_dodag->my_rank, my_dodag->minhoprankincrease)) {
+    if (rpl_dag_rank(my_dodag, old_rank) != rpl_dag_rank(my_dodag, my_dodag->my_rank)) {
         if (my_dodag->my_rank < my_dodag->min_rank) {
             my_dodag->min_rank = my_dodag->my_rank;
         }
 
-        reset_trickletimer();
+        trickle_reset_timer(&my_dodag->trickle);
     }
 }
 
@@ -325,7 +444,10 @@ void rpl_join_dodag(rpl_dodag_t *dodag, ipv6_addr_t *parent, uint16_t parent_ran
         return;
     }
 
-    preferred_parent = rpl_new_parent(dodag, parent, parent_rank);
+    /* the parent lifetime needs the configuration of the DODAG */
+    my_dodag->default_lifetime = dodag->default_lifetime;
+    my_dodag->lifetime_unit = dodag->lifetime_unit;
+    preferred_parent = rpl_new_parent(my_dodag, parent, parent_rank);
 
     if (preferred_parent == NULL) {
         rpl_del_dodag(my_dodag);
@@ -341,14 +463,13 @@ void rpl_join_dodag(rpl_dodag_t *dodag, ipv6_addr_t *parent, uint16_t parent_ran
     my_dodag->dio_min = dodag->dio_min;
     my_dodag->dio_redundancy = dodag->dio_redundancy;
     my_dodag->maxrankincrease = dodag->maxrankincrease;
-    my_dodag->minhoprankincrease = dodag->minhoprankincrease;
-    my_dodag->default_lifetime = dodag->default_lifetime;
-    my_dodag->lifetime_unit = dodag->lifetime_unit;
+    rpl_set_min_hop_rank_increase(my_dodag, dodag->minhoprankincrease);
     my_dodag->version = dodag->version;
     my_dodag->grounded = dodag->grounded;
     my_dodag->joined = 1;
     my_dodag->my_preferred_parent = preferred_parent;
     my_dodag->node_status = (uint8_t) NORMAL_NODE;
+    rate_parent(my_dodag, preferred_parent);
     my_dodag->my_rank = dodag->of->calc_rank(preferred_parent, dodag->my_rank);
     my_dodag->dao_seq = RPL_COUNTER_INIT;
     my_dodag->min_rank = my_dodag->my_rank;
@@ -363,21 +484,22 @@ void rpl_join_dodag(rpl_dodag_t *dodag, ipv6_addr_t *parent, uint16_t parent_ran
     DEBUG("\tmy_preferred_parent rank\t%02X\n", my_dodag->my_preferred_parent->rank);
     DEBUG("\tmy_preferred_parent lifetime\t%04X\n", my_dodag->my_preferred_parent->lifetime);
 
-    start_trickle(my_dodag->dio_min, my_dodag->dio_interval_doubling, my_dodag->dio_redundancy);
-    delay_dao();
+    rpl_dio_timer_start(my_dodag);
+    rpl_dao_refresh_all(my_dodag);
+    delay_dao(my_dodag);
 }
 
 void rpl_global_repair(rpl_dodag_t *dodag, ipv6_addr_t *p_addr, uint16_t rank)
 {
     DEBUGF("[INFO] Global repair started\n");
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+    rpl_dodag_t *my_dodag = rpl_get_joined_dodag(dodag->instance->id);
 
     if (my_dodag == NULL) {
         DEBUGF("[Error] - no global repair possible, if not part of a DODAG\n");
         return;
     }
 
-    rpl_delete_all_parents();
+    rpl_delete_all_parents(my_dodag);
     my_dodag->version = dodag->version;
     my_dodag->dtsn++;
     my_dodag->my_preferred_parent = rpl_new_parent(my_dodag, p_addr, rank);
@@ -387,32 +509,28 @@ void rpl_global_repair(rpl_dodag_t *dodag, ipv6_addr_t *p_addr, uint16_t rank)
         my_dodag->my_rank = INFINITE_RANK;
     }
     else {
+        rate_parent(my_dodag, my_dodag->my_preferred_parent);
         /* Calc new Rank */
         my_dodag->my_rank = my_dodag->of->calc_rank(my_dodag->my_preferred_parent,
                             my_dodag->my_rank);
         my_dodag->min_rank = my_dodag->my_rank;
-        reset_trickletimer();
-        delay_dao();
+        trickle_reset_timer(&my_dodag->trickle);
+        rpl_dao_refresh_all(my_dodag);
+        delay_dao(my_dodag);
     }
 
     DEBUGF("Migrated to DODAG Version %d. My new Rank: %d\n", my_dodag->version,
            my_dodag->my_rank);
 }
 
-void rpl_local_repair(void)
+void rpl_local_repair(rpl_dodag_t *my_dodag)
 {
     DEBUGF("[INFO] Local Repair started\n");
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
-
-    if (my_dodag == NULL) {
-        DEBUGF("[Error] - no local repair possible, if not part of a DODAG\n");
-        return;
-    }
 
     my_dodag->my_rank = INFINITE_RANK;
     my_dodag->dtsn++;
-    rpl_delete_all_parents();
-    reset_trickletimer();
+    rpl_delete_all_parents(my_dodag);
+    trickle_reset_timer(&my_dodag->trickle);
 
 }
 
@@ -420,7 +538,7 @@ ipv6_addr_t *rpl_get_my_preferred_parent(void)
 {
     rpl_dodag_t *my_dodag = rpl_get_my_dodag();
 
-    if (my_dodag == NULL) {
+    if (my_dodag == NULL || my_dodag->my_preferred_parent == NULL) {
         return NULL;
     }
 
@@ -431,3 +549,37 @@ uint16_t rpl_calc_rank(uint16_t abs_rank, uint16_t minhoprankincrease)
 {
     return abs_rank / minhoprankincrease;
 }
+
+void rpl_set_min_hop_rank_increase(rpl_dodag_t *dodag, uint16_t minhoprankincrease)
+{
+    uint8_t shift = 0;
+
+    if (minhoprankincrease == 0) {
+        /* joined from a DIO without a DODAG configuration option, DAGRank()
+         * divides by it */
+        minhoprankincrease = DEFAULT_MIN_HOP_RANK_INCREASE;
+    }
+
+    dodag->minhoprankincrease = minhoprankincrease;
+    dodag->minhoprank_shift = 0;
+
+    if (minhoprankincrease & (minhoprankincrease - 1)) {
+        return;
+    }
+
+    while ((1u << shift) < minhoprankincrease) {
+        shift++;
+    }
+
+    dodag->minhoprank_shift = shift + 1;
+}
+
+/* DAGRank() of RFC 6550, a shift for the usual MinHopRankIncrease of a power of two */
+uint16_t rpl_dag_rank(rpl_dodag_t *dodag, uint16_t rank)
+{
+    if (dodag->minhoprank_shift != 0) {
+        return rank >> (dodag->minhoprank_shift - 1);
+    }
+
+    return rpl_calc_rank(rank, dodag->minhoprankincrease);
+}
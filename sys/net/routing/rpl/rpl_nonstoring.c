@@ -0,0 +1,120 @@
+/**
+ * RPL non-storing mode implementation
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_nonstoring.c
+ * @brief   RPL non-storing mode functions of the root
+ * @}
+ */
+
+#include <string.h>
+
+#include "rpl/rpl_nonstoring.h"
+
+#include "sixlowpan.h"
+#include "net_help.h"
+
+#define ENABLE_DEBUG    (0)
+#if ENABLE_DEBUG
+#define DEBUG_ENABLED
+static char addr_str[IPV6_MAX_ADDR_STR_LEN];
+#endif
+#include "debug.h"
+
+static bool is_root(rpl_dodag_t *dodag, ipv6_addr_t *addr)
+{
+    return rpl_equal_id(addr, &dodag->dodag_id);
+}
+
+void rpl_ns_init_root(void)
+{
+    ipv6_iface_set_srh_provider(rpl_ns_get_source_route);
+}
+
+void rpl_ns_add_route(rpl_dodag_t *dodag, ipv6_addr_t *target, ipv6_addr_t *parent, uint16_t lifetime)
+{
+    rpl_routing_entry_t *entry = rpl_find_routing_entry(dodag->instance, target);
+
+    if (lifetime == 0) {
+        /* a No-Path for a parent the node has left already is stale */
+        if (entry != NULL && rpl_equal_id(&entry->next_hop, parent)) {
+            DEBUG("No-Path for %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, target));
+            rpl_del_routing_entry(dodag->instance, target);
+        }
+
+        return;
+    }
+
+    rpl_add_routing_entry(dodag->instance, target, parent, lifetime);
+}
+
+ipv6_addr_t *rpl_ns_get_next_hop(rpl_dodag_t *dodag, ipv6_addr_t *addr)
+{
+    rpl_routing_entry_t *entry;
+
+    /* a path has at most as many hops as there are entries */
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if ((entry = rpl_find_routing_entry(dodag->instance, addr)) == NULL) {
+            return NULL;
+        }
+
+        if (is_root(dodag, &entry->next_hop)) {
+            return &entry->address;
+        }
+
+        addr = &entry->next_hop;
+    }
+
+    DEBUG("routing loop towards %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
+    return NULL;
+}
+
+int rpl_ns_get_source_route(ipv6_addr_t *dest, ipv6_rpl_opt_t *opt, ipv6_addr_t *hops, int max_hops)
+{
+    rpl_dodag_t *dodag;
+    rpl_routing_entry_t *entry;
+    int n = 0;
+
+    dodag = (opt != NULL) ? rpl_get_joined_dodag(opt->instance_id) : rpl_get_my_dodag();
+
+    if (dodag == NULL || dodag->mop != RPL_NON_STORING_MODE || dodag->node_status != ROOT_NODE) {
+        return -1;
+    }
+
+    if ((entry = rpl_find_routing_entry(dodag->instance, dest)) == NULL) {
+        return -1;
+    }
+
+    /* collect the parents from the destination upwards */
+    while (!is_root(dodag, &entry->next_hop)) {
+        if (n == max_hops) {
+            DEBUG("no source route to %s, too many hops\n",
+                  ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, dest));
+            return -1;
+        }
+
+        memcpy(&hops[n++], &entry->next_hop, sizeof(ipv6_addr_t));
+
+        if ((entry = rpl_find_routing_entry(dodag->instance, &entry->next_hop)) == NULL) {
+            return -1;
+        }
+    }
+
+    /* the first hop first */
+    for (int i = 0; i < n / 2; i++) {
+        ipv6_addr_t tmp;
+
+        memcpy(&tmp, &hops[i], sizeof(ipv6_addr_t));
+        memcpy(&hops[i], &hops[n - 1 - i], sizeof(ipv6_addr_t));
+        memcpy(&hops[n - 1 - i], &tmp, sizeof(ipv6_addr_t));
+    }
+
+    return n;
+}
@@ -0,0 +1,279 @@
+/**
+ * RPL routing table
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_routing.c
+ * @brief   Routing table of an instance with a hash and an expiry heap
+ * @}
+ */
+
+#include <string.h>
+
+#include "rpl.h"
+#include "rpl_routing.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static uint16_t bucket(ipv6_addr_t *prefix, uint8_t len)
+{
+    uint32_t h = prefix->uint32[0] ^ prefix->uint32[1] ^ prefix->uint32[2] ^
+                 prefix->uint32[3] ^ len;
+
+    h ^= h >> 16;
+    h ^= h >> 8;
+    return h % RPL_ROUTING_HASH_SIZE;
+}
+
+static uint16_t index_of(rpl_instance_t *inst, rpl_routing_entry_t *entry)
+{
+    return entry - inst->routing_table;
+}
+
+static bool expires_before(rpl_instance_t *inst, uint16_t a, uint16_t b)
+{
+    return inst->routing_table[a].expires < inst->routing_table[b].expires;
+}
+
+static void heap_put(rpl_instance_t *inst, uint16_t pos, uint16_t i)
+{
+    inst->rt_heap[pos] = i;
+    inst->routing_table[i].heap_pos = pos + 1;
+}
+
+static void sift_up(rpl_instance_t *inst, uint16_t pos)
+{
+    uint16_t i = inst->rt_heap[pos];
+
+    while (pos > 0 && expires_before(inst, i, inst->rt_heap[(pos - 1) / 2])) {
+        heap_put(inst, pos, inst->rt_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+
+    heap_put(inst, pos, i);
+}
+
+static void sift_down(rpl_instance_t *inst, uint16_t pos)
+{
+    uint16_t i = inst->rt_heap[pos];
+
+    for (;;) {
+        uint32_t c = 2 * (uint32_t) pos + 1;
+
+        if (c >= inst->rt_heap_len) {
+            break;
+        }
+
+        if (c + 1 < inst->rt_heap_len &&
+            expires_before(inst, inst->rt_heap[c + 1], inst->rt_heap[c])) {
+            c++;
+        }
+
+        if (!expires_before(inst, inst->rt_heap[c], i)) {
+            break;
+        }
+
+        heap_put(inst, pos, inst->rt_heap[c]);
+        pos = c;
+    }
+
+    heap_put(inst, pos, i);
+}
+
+rpl_routing_entry_t *rpl_rt_find(rpl_instance_t *inst, ipv6_addr_t *prefix, uint8_t len)
+{
+    uint16_t n = inst->rt_hash[bucket(prefix, len)];
+
+    while (n != 0) {
+        rpl_routing_entry_t *entry = &inst->routing_table[n - 1];
+
+        if (entry->prefix_len == len && rpl_equal_id(&entry->address, prefix)) {
+            return entry;
+        }
+
+        n = entry->hash_next;
+    }
+
+    return NULL;
+}
+
+/* a route to prefix that does not expire yet */
+rpl_routing_entry_t *rpl_rt_new(rpl_instance_t *inst, ipv6_addr_t *prefix, uint8_t len)
+{
+    rpl_routing_entry_t *entry;
+    uint16_t b = bucket(prefix, len);
+
+    if (inst->rt_free != 0) {
+        entry = &inst->routing_table[inst->rt_free - 1];
+        inst->rt_free = entry->hash_next;
+    }
+    else if (inst->rt_end < RPL_MAX_ROUTING_ENTRIES) {
+        entry = &inst->routing_table[inst->rt_end++];
+    }
+    else {
+        DEBUG("[Error] routing table full\n");
+        return NULL;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    memcpy(&entry->address, prefix, sizeof(ipv6_addr_t));
+    entry->prefix_len = len;
+    entry->used = 1;
+    entry->hash_next = inst->rt_hash[b];
+    inst->rt_hash[b] = index_of(inst, entry) + 1;
+
+    if (len < IPV6_ADDR_BIT_LEN) {
+        inst->rt_prefixes++;
+    }
+
+    return entry;
+}
+
+void rpl_rt_free(rpl_instance_t *inst, rpl_routing_entry_t *entry)
+{
+    uint16_t *n = &inst->rt_hash[bucket(&entry->address, entry->prefix_len)];
+
+    rpl_rt_keep(inst, entry);
+
+    while (*n != index_of(inst, entry) + 1) {
+        n = &inst->routing_table[*n - 1].hash_next;
+    }
+
+    *n = entry->hash_next;
+
+    if (entry->prefix_len < IPV6_ADDR_BIT_LEN) {
+        inst->rt_prefixes--;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->hash_next = inst->rt_free;
+    inst->rt_free = index_of(inst, entry) + 1;
+}
+
+/* the entry expires lifetime ticks from now */
+void rpl_rt_set_lifetime(rpl_instance_t *inst, rpl_routing_entry_t *entry, uint16_t lifetime)
+{
+    uint32_t old = entry->expires;
+
+    entry->expires = inst->rt_time + lifetime;
+
+    if (entry->heap_pos == 0) {
+        inst->rt_heap[inst->rt_heap_len] = index_of(inst, entry);
+        sift_up(inst, inst->rt_heap_len++);
+    }
+    else if (entry->expires < old) {
+        sift_up(inst, entry->heap_pos - 1);
+    }
+    else {
+        sift_down(inst, entry->heap_pos - 1);
+    }
+}
+
+/* the entry does not expire any more */
+void rpl_rt_keep(rpl_instance_t *inst, rpl_routing_entry_t *entry)
+{
+    uint16_t pos = entry->heap_pos;
+    uint16_t last;
+
+    if (pos-- == 0) {
+        return;
+    }
+
+    entry->heap_pos = 0;
+    last = inst->rt_heap[--inst->rt_heap_len];
+
+    if (pos == inst->rt_heap_len) {
+        return;
+    }
+
+    heap_put(inst, pos, last);
+
+    if (pos > 0 && expires_before(inst, last, inst->rt_heap[(pos - 1) / 2])) {
+        sift_up(inst, pos);
+    }
+    else {
+        sift_down(inst, pos);
+    }
+}
+
+void rpl_rt_tick(rpl_instance_t *inst)
+{
+    inst->rt_time++;
+}
+
+/* takes the next entry that has expired by now out of the heap, NULL if none */
+rpl_routing_entry_t *rpl_rt_next_expired(rpl_instance_t *inst)
+{
+    rpl_routing_entry_t *entry;
+
+    if (inst->rt_heap_len == 0) {
+        return NULL;
+    }
+
+    entry = &inst->routing_table[inst->rt_heap[0]];
+
+    if (entry->expires > inst->rt_time) {
+        return NULL;
+    }
+
+    rpl_rt_keep(inst, entry);
+    return entry;
+}
+
+void rpl_add_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime)
+{
+    rpl_routing_entry_t *entry = rpl_find_routing_entry(inst, addr);
+
+    if (entry == NULL && (entry = rpl_rt_new(inst, addr, IPV6_ADDR_BIT_LEN)) == NULL) {
+        return;
+    }
+
+    /* the node may have moved to another parent */
+    memcpy(&entry->next_hop, next_hop, sizeof(ipv6_addr_t));
+    rpl_rt_set_lifetime(inst, entry, lifetime);
+}
+
+void rpl_del_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr)
+{
+    rpl_routing_entry_t *entry = rpl_find_routing_entry(inst, addr);
+
+    if (entry != NULL) {
+        rpl_rt_free(inst, entry);
+    }
+}
+
+rpl_routing_entry_t *rpl_find_routing_entry(rpl_instance_t *inst, ipv6_addr_t *addr)
+{
+    return rpl_rt_find(inst, addr, IPV6_ADDR_BIT_LEN);
+}
+
+void rpl_clear_routing_table(rpl_instance_t *inst)
+{
+    memset(inst->routing_table, 0, sizeof(inst->routing_table));
+    memset(inst->rt_hash, 0, sizeof(inst->rt_hash));
+    inst->rt_end = 0;
+    inst->rt_free = 0;
+    inst->rt_prefixes = 0;
+    inst->rt_heap_len = 0;
+}
+
+rpl_routing_entry_t *rpl_get_routing_table(rpl_instance_t *inst)
+{
+    return inst->routing_table;
+}
+
+uint16_t rpl_get_routing_entry_lifetime(rpl_instance_t *inst, rpl_routing_entry_t *entry)
+{
+    if (entry->heap_pos == 0 || entry->expires <= inst->rt_time) {
+        return 0;
+    }
+
+    return entry->expires - inst->rt_time;
+}
@@ -0,0 +1,36 @@
+/**
+ * RPL routing table prototypes
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_routing.h
+ * @brief   Routing table of an instance with a hash and an expiry heap
+ *
+ * Entries are found by their prefix in a hash table. Entries that expire
+ * are kept in a binary heap, the one that expires first on top, so a
+ * refresh and an expiry take O(log n) and the routing table clock does
+ * not have to visit all entries every second. Withdrawn routes do not
+ * expire, they wait for the acknowledgement of their No-Path.
+ * @}
+ */
+
+#ifndef __RPL_ROUTING_H
+#define __RPL_ROUTING_H
+
+#include "rpl/rpl_structs.h"
+
+rpl_routing_entry_t *rpl_rt_find(rpl_instance_t *inst, ipv6_addr_t *prefix, uint8_t len);
+rpl_routing_entry_t *rpl_rt_new(rpl_instance_t *inst, ipv6_addr_t *prefix, uint8_t len);
+void rpl_rt_free(rpl_instance_t *inst, rpl_routing_entry_t *entry);
+void rpl_rt_set_lifetime(rpl_instance_t *inst, rpl_routing_entry_t *entry, uint16_t lifetime);
+void rpl_rt_keep(rpl_instance_t *inst, rpl_routing_entry_t *entry);
+void rpl_rt_tick(rpl_instance_t *inst);
+rpl_routing_entry_t *rpl_rt_next_expired(rpl_instance_t *inst);
+
+#endif /* __RPL_ROUTING_H */
@@ -16,8 +16,11 @@
  */
 
 #include "rpl/rpl_storing.h"
+#include "rpl/rpl_nonstoring.h"
 #include "msg.h"
 #include "trickle.h"
+#include "rpl_timers.h"
+#include "rpl_dao.h"
 
 #include "sixlowpan.h"
 #include "net_help.h"
@@ -31,7 +34,6 @@ char addr_str[IPV6_MAX_ADDR_STR_LEN];
 #include "debug.h"
 
 /* global variables */
-char i_am_root = 0;
 ipv6_addr_t my_address;
 
 /* in send buffer we need space fpr LL_HDR */
@@ -45,8 +47,6 @@ static ipv6_hdr_t *ipv6_send_buf;
 static struct rpl_dio_t *rpl_send_dio_buf;
 static struct rpl_dao_t *rpl_send_dao_buf;
 static rpl_opt_dodag_conf_t *rpl_send_opt_dodag_conf_buf;
-static rpl_opt_target_t *rpl_send_opt_target_buf;
-static rpl_opt_transit_t *rpl_send_opt_transit_buf;
 
 /* RECEIVE BUFFERS */
 ipv6_hdr_t *ipv6_buf;
@@ -54,8 +54,6 @@ static struct rpl_dio_t *rpl_dio_buf;
 static struct rpl_dao_t *rpl_dao_buf;
 static struct rpl_dao_ack_t *rpl_dao_ack_buf;
 static rpl_opt_dodag_conf_t *rpl_opt_dodag_conf_buf;
-static rpl_opt_target_t *rpl_opt_target_buf;
-static rpl_opt_transit_t *rpl_opt_transit_buf;
 static struct rpl_dis_t *rpl_dis_buf;
 static rpl_opt_t *rpl_opt_buf;
 static rpl_opt_solicited_t *rpl_opt_solicited_buf;
@@ -106,11 +104,6 @@ static rpl_opt_target_t *get_rpl_send_opt_target_buf(uint8_t rpl_msg_len)
     return ((rpl_opt_target_t *) & (rpl_send_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN + rpl_msg_len]));
 }
 
-static rpl_opt_transit_t *get_rpl_send_opt_transit_buf(uint8_t rpl_msg_len)
-{
-    return ((rpl_opt_transit_t *) & (rpl_send_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN + rpl_msg_len]));
-}
-
 
 /* RECEIVE BUFFERS */
 static ipv6_hdr_t *get_rpl_ipv6_buf(void)
@@ -118,16 +111,6 @@ static ipv6_hdr_t *get_rpl_ipv6_buf(void)
     return ((ipv6_hdr_t *) & (rpl_buffer[0]));
 }
 
-static rpl_opt_target_t *get_rpl_opt_target_buf(uint8_t rpl_msg_len)
-{
-    return ((rpl_opt_target_t *) & (rpl_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN + rpl_msg_len]));
-}
-
-static rpl_opt_transit_t *get_rpl_opt_transit_buf(uint8_t rpl_msg_len)
-{
-    return ((rpl_opt_transit_t *) & (rpl_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN + rpl_msg_len]));
-}
-
 static rpl_opt_dodag_conf_t *get_rpl_opt_dodag_conf_buf(uint8_t rpl_msg_len)
 {
     return ((rpl_opt_dodag_conf_t *) & (rpl_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN + rpl_msg_len]));
@@ -145,7 +128,7 @@ static struct rpl_dao_t *get_rpl_dao_buf(void)
 
 static struct rpl_dao_ack_t *get_rpl_dao_ack_buf(void)
 {
-    return ((struct rpl_dao_ack_t *) & (buffer[(LL_HDR_LEN + IPV6_HDR_LEN + ICMPV6_HDR_LEN)]));
+    return ((struct rpl_dao_ack_t *) & (rpl_buffer[IPV6_HDR_LEN + ICMPV6_HDR_LEN]));
 }
 
 static struct rpl_dis_t *get_rpl_dis_buf(void)
@@ -168,25 +151,37 @@ void rpl_init_mode(ipv6_addr_t *init_address)
     memcpy(&my_address, init_address, sizeof(ipv6_addr_t));
 }
 
-void rpl_init_root_mode(void)
+void rpl_init_root_mode(uint8_t instanceid, uint16_t ocp)
 {
     rpl_instance_t *inst;
     rpl_dodag_t *dodag;
+    rpl_of_t *of = rpl_get_of_for_ocp(ocp);
 
-    inst = rpl_new_instance(RPL_DEFAULT_INSTANCE);
+    if (of == NULL) {
+        DEBUGF("Error - objective function %u not supported\n", ocp);
+        return;
+    }
+
+    if (rpl_get_joined_dodag(instanceid) != NULL) {
+        DEBUGF("Error - already part of instance %u\n", instanceid);
+        return;
+    }
+
+    if ((inst = rpl_get_instance(instanceid)) == NULL) {
+        inst = rpl_new_instance(instanceid);
+    }
 
     if (inst == NULL) {
         DEBUGF("Error - No memory for another RPL instance\n");
         return;
     }
 
-    inst->id = RPL_DEFAULT_INSTANCE;
     inst->joined = 1;
 
-    dodag = rpl_new_dodag(RPL_DEFAULT_INSTANCE, &my_address);
+    dodag = rpl_new_dodag(instanceid, &my_address);
 
     if (dodag != NULL) {
-        dodag->of = (struct rpl_of_t *) rpl_get_of_for_ocp(RPL_DEFAULT_OCP);
+        dodag->of = (struct rpl_of_t *) of;
         dodag->instance = inst;
         dodag->mop = RPL_DEFAULT_MOP;
         dodag->dtsn = 1;
@@ -195,7 +190,7 @@ void rpl_init_root_mode(void)
         dodag->dio_min = DEFAULT_DIO_INTERVAL_MIN;
         dodag->dio_redundancy = DEFAULT_DIO_REDUNDANCY_CONSTANT;
         dodag->maxrankincrease = 0;
-        dodag->minhoprankincrease = (uint16_t)DEFAULT_MIN_HOP_RANK_INCREASE;
+        rpl_set_min_hop_rank_increase(dodag, DEFAULT_MIN_HOP_RANK_INCREASE);
         dodag->default_lifetime = (uint8_t)RPL_DEFAULT_LIFETIME;
         dodag->lifetime_unit = RPL_LIFETIME_UNIT;
         dodag->version = RPL_COUNTER_INIT;
@@ -207,22 +202,23 @@ void rpl_init_root_mode(void)
     }
     else {
         DEBUGF("Error - could not generate DODAG\n");
+        inst->joined = 0;
         return;
     }
 
-    i_am_root = 1;
-    start_trickle(dodag->dio_min, dodag->dio_interval_doubling, dodag->dio_redundancy);
+    if (dodag->mop == RPL_NON_STORING_MODE) {
+        rpl_ns_init_root();
+    }
+
+    rpl_dio_timer_start(dodag);
     DEBUGF("ROOT INIT FINISHED\n");
 
 }
 
-void send_DIO_mode(ipv6_addr_t *destination)
+void send_DIO_mode(rpl_dodag_t *mydodag, ipv6_addr_t *destination)
 {
-    rpl_dodag_t *mydodag;
     icmp_send_buf = get_rpl_send_icmpv6_buf(ipv6_ext_hdr_len);
 
-    mydodag = rpl_get_my_dodag();
-
     if (mydodag == NULL) {
         DEBUGF("Error - trying to send DIO without being part of a dodag.\n");
         return;
@@ -265,19 +261,17 @@ void send_DIO_mode(ipv6_addr_t *destination)
     opt_hdr_len += RPL_OPT_LEN + RPL_OPT_DODAG_CONF_LEN;
 
     uint16_t plen = ICMPV6_HDR_LEN + DIO_BASE_LEN + opt_hdr_len;
-    rpl_send(destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
+    rpl_send(mydodag, destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
 }
 
-void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index)
+void send_DAO_mode(rpl_dodag_t *my_dodag, ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime)
 {
-    if (i_am_root) {
+    if (my_dodag == NULL) {
+        DEBUGF("send_DAO: I have no my_dodag\n");
         return;
     }
 
-    rpl_dodag_t *my_dodag;
-
-    if ((my_dodag = rpl_get_my_dodag()) == NULL) {
-        DEBUGF("send_DAO: I have no my_dodag\n");
+    if (my_dodag->node_status == ROOT_NODE) {
         return;
     }
 
@@ -290,76 +284,48 @@ void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_life
         destination = &my_dodag->my_preferred_parent->addr;
     }
 
+    /* in non-storing mode the DAO names the parent and goes to the root */
+    ipv6_addr_t *parent = NULL;
+
+    if (my_dodag->mop == RPL_NON_STORING_MODE) {
+        parent = destination;
+        destination = &my_dodag->dodag_id;
+    }
+
     if (default_lifetime) {
         lifetime = my_dodag->default_lifetime;
     }
 
-    icmp_send_buf  = get_rpl_send_icmpv6_buf(ipv6_ext_hdr_len);
+    /* only the targets the parent does not know yet, split into DAOs of
+     * at most RPL_DAO_MAX_LEN bytes of options */
+    uint16_t cursor = 0;
 
-    icmp_send_buf->type = ICMPV6_TYPE_RPL_CONTROL;
-    icmp_send_buf->code = ICMP_CODE_DAO;
-
-    rpl_send_dao_buf = get_rpl_send_dao_buf();
-    memset(rpl_send_dao_buf, 0, sizeof(*rpl_send_dao_buf));
-    rpl_send_dao_buf->rpl_instanceid = my_dodag->instance->id;
-    rpl_send_dao_buf->k_d_flags = 0x00;
-    rpl_send_dao_buf->dao_sequence = my_dodag->dao_seq;
-    uint16_t opt_len = 0;
-    rpl_send_opt_target_buf = get_rpl_send_opt_target_buf(DAO_BASE_LEN);
-    /* add all targets from routing table as targets */
-    uint8_t entries = 0;
-    uint8_t continue_index = 0;
-
-    for (uint8_t i = start_index; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_get_routing_table()[i].used) {
-            rpl_send_opt_target_buf->type = RPL_OPT_TARGET;
-            rpl_send_opt_target_buf->length = RPL_OPT_TARGET_LEN;
-            rpl_send_opt_target_buf->flags = 0x00;
-            rpl_send_opt_target_buf->prefix_length = RPL_DODAG_ID_LEN;
-            memcpy(&rpl_send_opt_target_buf->target, &rpl_get_routing_table()[i].address, sizeof(ipv6_addr_t));
-            opt_len += RPL_OPT_TARGET_LEN + 2;
-            rpl_send_opt_transit_buf = get_rpl_send_opt_transit_buf(DAO_BASE_LEN + opt_len);
-            rpl_send_opt_transit_buf->type = RPL_OPT_TRANSIT;
-            rpl_send_opt_transit_buf->length = RPL_OPT_TRANSIT_LEN;
-            rpl_send_opt_transit_buf->e_flags = 0x00;
-            rpl_send_opt_transit_buf->path_control = 0x00; /* not used */
-            rpl_send_opt_transit_buf->path_sequence = 0x00; /* not used */
-            rpl_send_opt_transit_buf->path_lifetime = lifetime;
-            opt_len += RPL_OPT_TRANSIT_LEN + 2;
-            rpl_send_opt_target_buf = get_rpl_send_opt_target_buf(DAO_BASE_LEN + opt_len);
-            entries++;
-        }
+    while (cursor < RPL_DAO_ITEMS) {
+        icmp_send_buf = get_rpl_send_icmpv6_buf(ipv6_ext_hdr_len);
 
-        /* Split DAO, so packages don't get too big.
-         * The value 5 is based on experience. */
-        if (entries >= 5) {
-            continue_index = i + 1;
-            break;
-        }
-    }
+        icmp_send_buf->type = ICMPV6_TYPE_RPL_CONTROL;
+        icmp_send_buf->code = ICMP_CODE_DAO;
 
-    /* add own address */
-    rpl_send_opt_target_buf->type = RPL_OPT_TARGET;
-    rpl_send_opt_target_buf->length = RPL_OPT_TARGET_LEN;
-    rpl_send_opt_target_buf->flags = 0x00;
-    rpl_send_opt_target_buf->prefix_length = RPL_DODAG_ID_LEN;
-    memcpy(&rpl_send_opt_target_buf->target, &my_address, sizeof(ipv6_addr_t));
-    opt_len += RPL_OPT_TARGET_LEN + 2;
+        rpl_send_dao_buf = get_rpl_send_dao_buf();
+        memset(rpl_send_dao_buf, 0, sizeof(*rpl_send_dao_buf));
+        rpl_send_dao_buf->rpl_instanceid = my_dodag->instance->id;
+        rpl_send_dao_buf->k_d_flags = (lifetime != 0) ? RPL_DAO_K_FLAG : 0x00;
+        rpl_send_dao_buf->dao_sequence = my_dodag->dao_seq;
 
-    rpl_send_opt_transit_buf = get_rpl_send_opt_transit_buf(DAO_BASE_LEN + opt_len);
-    rpl_send_opt_transit_buf->type = RPL_OPT_TRANSIT;
-    rpl_send_opt_transit_buf->length = RPL_OPT_TRANSIT_LEN;
-    rpl_send_opt_transit_buf->e_flags = 0x00;
-    rpl_send_opt_transit_buf->path_control = 0x00;
-    rpl_send_opt_transit_buf->path_sequence = 0x00;
-    rpl_send_opt_transit_buf->path_lifetime = lifetime;
-    opt_len += RPL_OPT_TRANSIT_LEN + 2;
+        uint16_t opt_len = rpl_dao_build(my_dodag, &my_address, parent, lifetime,
+                                         (uint8_t *) get_rpl_send_opt_target_buf(DAO_BASE_LEN),
+                                         RPL_DAO_MAX_LEN, my_dodag->dao_seq, &cursor);
 
-    uint16_t plen = ICMPV6_HDR_LEN + DAO_BASE_LEN + opt_len;
-    rpl_send(destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
+        if (opt_len == 0) {
+            break;
+        }
 
-    if (continue_index > 1) {
-        send_DAO(destination, lifetime, default_lifetime, continue_index);
+        my_dodag->dao_seq = RPL_COUNTER_INCREMENT(my_dodag->dao_seq);
+
+        uint16_t plen = ICMPV6_HDR_LEN + DAO_BASE_LEN + opt_len;
+        my_dodag->daos_sent++;
+        my_dodag->dao_bytes_sent += plen;
+        rpl_send(my_dodag, destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
     }
 }
 
@@ -373,14 +339,11 @@ void send_DIS_mode(ipv6_addr_t *destination)
     rpl_send_dis_buf = get_rpl_send_dis_buf();
 
     uint16_t plen = ICMPV6_HDR_LEN + DIS_BASE_LEN;
-    rpl_send(destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
+    rpl_send(NULL, destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
 }
 
-void send_DAO_ACK_mode(ipv6_addr_t *destination)
+void send_DAO_ACK_mode(rpl_dodag_t *my_dodag, ipv6_addr_t *destination, uint8_t sequence)
 {
-    rpl_dodag_t *my_dodag;
-    my_dodag = rpl_get_my_dodag();
-
     if (my_dodag == NULL) {
         return;
     }
@@ -393,11 +356,11 @@ void send_DAO_ACK_mode(ipv6_addr_t *destination)
     rpl_send_dao_ack_buf = get_rpl_send_dao_ack_buf();
     rpl_send_dao_ack_buf->rpl_instanceid = my_dodag->instance->id;
     rpl_send_dao_ack_buf->d_reserved = 0;
-    rpl_send_dao_ack_buf->dao_sequence = my_dodag->dao_seq;
+    rpl_send_dao_ack_buf->dao_sequence = sequence;
     rpl_send_dao_ack_buf->status = 0;
 
     uint16_t plen = ICMPV6_HDR_LEN + DAO_ACK_LEN;
-    rpl_send(destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
+    rpl_send(my_dodag, destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
 }
 
 void recv_rpl_DIO_mode(void)
@@ -410,35 +373,16 @@ void recv_rpl_DIO_mode(void)
     int len = DIO_BASE_LEN;
 
     rpl_instance_t *dio_inst = rpl_get_instance(rpl_dio_buf->rpl_instanceid);
-    rpl_instance_t *my_inst = rpl_get_my_instance();
 
+    /* every instance is joined independently, up to RPL_MAX_INSTANCES */
     if (dio_inst == NULL) {
-        if (my_inst != NULL) {
-            /* already part of a DODAG -> impossible to join other instance */
-            DEBUGF("Not joining another DODAG!\n");
-            return;
-        }
-
         dio_inst = rpl_new_instance(rpl_dio_buf->rpl_instanceid);
 
         if (dio_inst == NULL) {
-            DEBUGF("Failed to create a new RPL instance!\n");
+            DEBUGF("Ignoring instance %d, no memory for another one\n", rpl_dio_buf->rpl_instanceid);
             return;
         }
     }
-    else if (my_inst == NULL) {
-        DEBUGF("Not joined an instance yet\n");
-    }
-    else if (my_inst->id != dio_inst->id) {
-        /* TODO: Add support support for several instances.  */
-
-        /* At the moment, nodes can only join one instance, this is
-        * the instance they join first.
-        * Instances cannot be switched later on.  */
-
-        DEBUGF("Ignoring instance - we are %d and got %d\n", my_inst->id, dio_inst->id);
-        return;
-    }
 
     rpl_dodag_t dio_dodag;
     memset(&dio_dodag, 0, sizeof(dio_dodag));
@@ -522,7 +466,7 @@ void recv_rpl_DIO_mode(void)
     }
 
     /* handle packet content... */
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+    rpl_dodag_t *my_dodag = rpl_get_joined_dodag(dio_inst->id);
 
     if (my_dodag == NULL) {
         if (!has_dodag_conf_opt) {
@@ -534,7 +478,7 @@ void recv_rpl_DIO_mode(void)
             DEBUGF("DIO with Rank < ROOT_RANK\n");
         }
 
-        if (dio_dodag.mop != RPL_DEFAULT_MOP) {
+        if (dio_dodag.mop != RPL_STORING_MODE_NO_MC && dio_dodag.mop != RPL_NON_STORING_MODE) {
             DEBUGF("Required MOP not supported\n");
         }
 
@@ -559,7 +503,7 @@ void recv_rpl_DIO_mode(void)
             if (my_dodag->my_rank == ROOT_RANK) {
                 DEBUGF("[Warning] Inconsistent Dodag Version\n");
                 my_dodag->version = RPL_COUNTER_INCREMENT(dio_dodag.version);
-                reset_trickletimer();
+                trickle_reset_timer(&my_dodag->trickle);
             }
             else {
                 DEBUGF("my dodag has no preferred_parent yet - seems to be odd since I have a parent...\n");
@@ -570,20 +514,20 @@ void recv_rpl_DIO_mode(void)
         }
         else if (RPL_COUNTER_GREATER_THAN(my_dodag->version, dio_dodag.version)) {
             /* ein Knoten hat noch eine kleinere Versionsnummer -> mehr DIOs senden */
-            reset_trickletimer();
+            trickle_reset_timer(&my_dodag->trickle);
             return;
         }
     }
 
     /* version matches, DODAG matches */
     if (rpl_dio_buf->rank == INFINITE_RANK) {
-        reset_trickletimer();
+        trickle_reset_timer(&my_dodag->trickle);
     }
 
     /* We are root, all done!*/
     if (my_dodag->my_rank == ROOT_RANK) {
         if (rpl_dio_buf->rank != INFINITE_RANK) {
-            trickle_increment_counter();
+            trickle_increment_counter(&my_dodag->trickle);
         }
 
         return;
@@ -592,7 +536,7 @@ void recv_rpl_DIO_mode(void)
     /*********************  Parent Handling *********************/
 
     rpl_parent_t *parent;
-    parent = rpl_find_parent(&ipv6_buf->srcaddr);
+    parent = rpl_find_parent(my_dodag, &ipv6_buf->srcaddr);
 
     if (parent == NULL) {
         /* add new parent candidate */
@@ -604,18 +548,20 @@ void recv_rpl_DIO_mode(void)
     }
     else {
         /* DIO OK */
-        trickle_increment_counter();
+        trickle_increment_counter(&my_dodag->trickle);
     }
 
     /* update parent rank */
     parent->rank = rpl_dio_buf->rank;
-    rpl_parent_update(parent);
+    rpl_parent_update(my_dodag, parent);
 
     if (my_dodag->my_preferred_parent == NULL) {
         DEBUG("%s, %d: my dodag has no preferred_parent yet - seems to be odd since I have a parent...\n", __FILE__, __LINE__);
     }
     else if (rpl_equal_id(&parent->addr, &my_dodag->my_preferred_parent->addr) && (parent->dtsn != rpl_dio_buf->dtsn)) {
-        delay_dao();
+        /* a new DTSN asks for all targets again */
+        rpl_dao_refresh_all(my_dodag);
+        delay_dao(my_dodag);
     }
 
     parent->dtsn = rpl_dio_buf->dtsn;
@@ -624,102 +570,48 @@ void recv_rpl_DIO_mode(void)
 
 void recv_rpl_DAO_mode(void)
 {
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
-
-    if (my_dodag == NULL) {
-        DEBUG("[Error] got DAO although not a DODAG\n");
-        return;
-    }
-
     ipv6_buf = get_rpl_ipv6_buf();
     rpl_dao_buf = get_rpl_dao_buf();
     DEBUG("instance %04X ", rpl_dao_buf->rpl_instanceid);
     DEBUG("sequence %04X\n", rpl_dao_buf->dao_sequence);
 
-    int len = DAO_BASE_LEN;
-    uint8_t increment_seq = 0;
-
-    while (len < (NTOHS(ipv6_buf->length) - ICMPV6_HDR_LEN)) {
-        rpl_opt_buf = get_rpl_opt_buf(len);
-
-        switch (rpl_opt_buf->type) {
-
-            case (RPL_OPT_PAD1): {
-                len += 1;
-                break;
-            }
-
-            case (RPL_OPT_PADN): {
-                len += rpl_opt_buf->length + 2;
-                break;
-            }
-
-            case (RPL_OPT_DAG_METRIC_CONTAINER): {
-                len += rpl_opt_buf->length + 2;
-                break;
-            }
-
-            case (RPL_OPT_TARGET): {
-                rpl_opt_target_buf = get_rpl_opt_target_buf(len);
-
-                if (rpl_opt_target_buf->prefix_length != RPL_DODAG_ID_LEN) {
-                    DEBUGF("prefixes are not supported yet\n");
-                    break;
-                }
+    rpl_dodag_t *my_dodag = rpl_get_joined_dodag(rpl_dao_buf->rpl_instanceid);
 
-                len += rpl_opt_target_buf->length + 2;
-                rpl_opt_transit_buf = get_rpl_opt_transit_buf(len);
-
-                if (rpl_opt_transit_buf->type != RPL_OPT_TRANSIT) {
-                    DEBUGF("[Error] - no transit information for target option type = %d\n", rpl_opt_transit_buf->type);
-                    break;
-                }
-
-                len += rpl_opt_transit_buf->length + 2;
-                /* route lifetime seconds = (DAO lifetime) * (Unit Lifetime) */
+    if (my_dodag == NULL) {
+        DEBUG("[Error] got DAO although not a DODAG\n");
+        return;
+    }
 
-                DEBUG("Adding routing information: Target: %s, Source: %s, Lifetime: %u\n",
-                      ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_opt_target_buf->target),
-                      ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_buf->srcaddr),
-                      (rpl_opt_transit_buf->path_lifetime * my_dodag->lifetime_unit));
-                rpl_add_routing_entry(&rpl_opt_target_buf->target, &ipv6_buf->srcaddr, rpl_opt_transit_buf->path_lifetime * my_dodag->lifetime_unit);
-                increment_seq = 1;
-                break;
-            }
+    if (my_dodag->mop == RPL_NON_STORING_MODE && my_dodag->node_status != ROOT_NODE) {
+        DEBUG("[Error] got DAO although not root of a non-storing DODAG\n");
+        return;
+    }
 
-            case (RPL_OPT_TRANSIT): {
-                len += rpl_opt_buf->length + 2;
-                break;
-            }
+    uint16_t len = NTOHS(ipv6_buf->length) - ICMPV6_HDR_LEN - DAO_BASE_LEN;
+    int changes = rpl_dao_process(my_dodag, &ipv6_buf->srcaddr,
+                                  (uint8_t *) get_rpl_opt_buf(DAO_BASE_LEN), len);
 
-            case (RPL_OPT_TARGET_DESC): {
-                len += rpl_opt_buf->length + 2;
-                break;
-            }
-
-            default:
-                return;
-        }
+    if (changes < 0) {
+        return;
     }
 
-    send_DAO_ACK(&ipv6_buf->srcaddr);
+    if (rpl_dao_buf->k_d_flags & RPL_DAO_K_FLAG) {
+        send_DAO_ACK(my_dodag, &ipv6_buf->srcaddr, rpl_dao_buf->dao_sequence);
+    }
 
-    if (increment_seq) {
-        RPL_COUNTER_INCREMENT(my_dodag->dao_seq);
-        delay_dao();
+    /* the parent only learns about what changed below this node */
+    if (changes > 0 && my_dodag->node_status != ROOT_NODE) {
+        delay_dao(my_dodag);
     }
 }
 
 void recv_rpl_DIS_mode(void)
 {
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
-
-    if (my_dodag == NULL) {
-        return;
-    }
+    rpl_dodag_t *my_dodag = NULL;
 
     ipv6_buf = get_rpl_ipv6_buf();
     rpl_dis_buf = get_rpl_dis_buf();
+    rpl_opt_solicited_buf = NULL;
     int len = DIS_BASE_LEN;
 
     while (len < (NTOHS(ipv6_buf->length) - ICMPV6_HDR_LEN)) {
@@ -737,8 +629,6 @@ void recv_rpl_DIS_mode(void)
             }
 
             case (RPL_OPT_SOLICITED_INFO): {
-                len += RPL_OPT_SOLICITED_INFO_LEN + 2;
-
                 /* extract and check */
                 if (rpl_opt_buf->length != RPL_OPT_SOLICITED_INFO_LEN) {
                     /* error malformed */
@@ -746,25 +636,7 @@ void recv_rpl_DIS_mode(void)
                 }
 
                 rpl_opt_solicited_buf = get_rpl_opt_solicited_buf(len);
-
-                if (rpl_opt_solicited_buf->VID_Flags & RPL_DIS_I_MASK) {
-                    if (my_dodag->instance->id != rpl_opt_solicited_buf->rplinstanceid) {
-                        return;
-                    }
-                }
-
-                if (rpl_opt_solicited_buf->VID_Flags & RPL_DIS_D_MASK) {
-                    if (!rpl_equal_id(&my_dodag->dodag_id, &rpl_opt_solicited_buf->dodagid)) {
-                        return;
-                    }
-                }
-
-                if (rpl_opt_solicited_buf->VID_Flags & RPL_DIS_V_MASK) {
-                    if (my_dodag->version != rpl_opt_solicited_buf->version) {
-                        return;
-                    }
-                }
-
+                len += RPL_OPT_SOLICITED_INFO_LEN + 2;
                 break;
             }
 
@@ -773,21 +645,36 @@ void recv_rpl_DIS_mode(void)
         }
     }
 
-    send_DIO(&ipv6_buf->srcaddr);
+    /* every joined DODAG the solicitation matches answers */
+    while ((my_dodag = rpl_next_joined_dodag(my_dodag)) != NULL) {
+        if (rpl_opt_solicited_buf != NULL) {
+            if ((rpl_opt_solicited_buf->VID_Flags & RPL_DIS_I_MASK) &&
+                (my_dodag->instance->id != rpl_opt_solicited_buf->rplinstanceid)) {
+                continue;
+            }
 
-}
+            if ((rpl_opt_solicited_buf->VID_Flags & RPL_DIS_D_MASK) &&
+                !rpl_equal_id(&my_dodag->dodag_id, &rpl_opt_solicited_buf->dodagid)) {
+                continue;
+            }
 
-void recv_rpl_dao_ack_mode(void)
-{
-    rpl_dodag_t *my_dodag = rpl_get_my_dodag();
+            if ((rpl_opt_solicited_buf->VID_Flags & RPL_DIS_V_MASK) &&
+                (my_dodag->version != rpl_opt_solicited_buf->version)) {
+                continue;
+            }
+        }
 
-    if (my_dodag == NULL) {
-        return;
+        send_DIO(my_dodag, &ipv6_buf->srcaddr);
     }
+}
 
+void recv_rpl_dao_ack_mode(void)
+{
     rpl_dao_ack_buf = get_rpl_dao_ack_buf();
 
-    if (rpl_dao_ack_buf->rpl_instanceid != my_dodag->instance->id) {
+    rpl_dodag_t *my_dodag = rpl_get_joined_dodag(rpl_dao_ack_buf->rpl_instanceid);
+
+    if (my_dodag == NULL) {
         return;
     }
 
@@ -795,12 +682,32 @@ void recv_rpl_dao_ack_mode(void)
         return;
     }
 
-    dao_ack_received();
+    dao_ack_received(my_dodag, rpl_dao_ack_buf->dao_sequence);
 
 }
 
+/* control messages of an instance other than the default one are routed in their
+ * instance, like the packets mapped to it */
+static void rpl_add_option(rpl_dodag_t *dodag)
+{
+    ipv6_rpl_opt_t *opt = (ipv6_rpl_opt_t *) get_rpl_send_payload_buf(0);
+    uint16_t length = NTOHS(ipv6_send_buf->length);
+
+    memmove((uint8_t *) opt + sizeof(ipv6_rpl_opt_t), opt, length);
+    opt->nextheader = ipv6_send_buf->nextheader;
+    opt->hdrextlen = 0;
+    opt->type = IPV6_OPT_TYPE_RPL;
+    opt->length = IPV6_OPT_RPL_LEN;
+    opt->flags = 0;
+    opt->instance_id = dodag->instance->id;
+    opt->sender_rank = HTONS(dodag->my_rank);
+
+    ipv6_send_buf->nextheader = IPV6_PROTO_NUM_HOP_BY_HOP;
+    ipv6_send_buf->length = HTONS(length + sizeof(ipv6_rpl_opt_t));
+}
+
 /* obligatory for each mode. normally not modified */
-void rpl_send(ipv6_addr_t *destination, uint8_t *payload, uint16_t p_len, uint8_t next_header)
+void rpl_send(rpl_dodag_t *dodag, ipv6_addr_t *destination, uint8_t *payload, uint16_t p_len, uint8_t next_header)
 {
     uint8_t *p_ptr;
     ipv6_send_buf = get_rpl_send_ipv6_buf();
@@ -831,22 +738,23 @@ void rpl_send(ipv6_addr_t *destination, uint8_t *payload, uint16_t p_len, uint8_
         ipv6_send_packet(ipv6_send_buf);
     }
     else {
-        /* find appropriate next hop before sending */
-        ipv6_addr_t *next_hop = rpl_get_next_hop(&ipv6_send_buf->destaddr);
+        /* find appropriate next hop before sending, the preferred parent if there is no route */
+        ipv6_addr_t *next_hop;
+
+        if (dodag != NULL) {
+            next_hop = rpl_get_instance_next_hop(dodag, &ipv6_send_buf->destaddr);
+        }
+        else {
+            next_hop = rpl_get_next_hop(&ipv6_send_buf->destaddr);
+        }
 
         if (next_hop == NULL) {
-            if (i_am_root) {
-                DEBUGF("[Error] destination unknown: %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_send_buf->destaddr));
-                return;
-            }
-            else {
-                next_hop = rpl_get_my_preferred_parent();
+            DEBUGF("[Error] destination unknown: %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_send_buf->destaddr));
+            return;
+        }
 
-                if (next_hop == NULL) {
-                    DEBUGF("[Error] no preferred parent, dropping package\n");
-                    return;
-                }
-            }
+        if (dodag != NULL && dodag != rpl_get_my_dodag()) {
+            rpl_add_option(dodag);
         }
 
         ipv6_send_packet(ipv6_send_buf);
@@ -0,0 +1,164 @@
+/**
+ * RPL timer implementation
+ *
+ * Copyright (C) 2013  INRIA.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_timers.c
+ * @brief   DIO trickle timers, DAO delay and routing table lifetimes
+ * @author  Eric Engel <eric.engel@fu-berlin.de>
+ * @}
+ */
+
+#include <stdbool.h>
+
+#include "vtimer.h"
+#include "trickle.h"
+#include "rpl.h"
+#include "rpl_timers.h"
+#include "rpl_dao.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static vtimer_t rt_timer;
+
+static void rt_timer_set(void)
+{
+    /* Wake up every second */
+    vtimer_remove(&rt_timer);
+    vtimer_set_msg(&rt_timer, timex_set(1, 0), rpl_process_pid, &rt_timer);
+}
+
+static void dao_timer_set(rpl_dodag_t *dodag, uint32_t seconds)
+{
+    vtimer_remove(&dodag->dao_timer);
+    vtimer_set_msg(&dodag->dao_timer, timex_set(seconds, 0), rpl_process_pid,
+                   &dodag->dao_timer);
+}
+
+static void send_DIO_multicast(void *arg)
+{
+    ipv6_addr_t mcast;
+    ipv6_addr_set_all_nodes_addr(&mcast);
+    send_DIO((rpl_dodag_t *) arg, &mcast);
+}
+
+void rpl_timers_init(void)
+{
+    rt_timer_set();
+}
+
+void rpl_dio_timer_start(rpl_dodag_t *dodag)
+{
+    trickle_start(rpl_process_pid, &dodag->trickle, send_DIO_multicast, dodag,
+                  (uint32_t) 1 << dodag->dio_min, dodag->dio_interval_doubling,
+                  dodag->dio_redundancy);
+    /* a new DODAG is an inconsistency, the first DIO goes out within Imin */
+    trickle_reset_timer(&dodag->trickle);
+}
+
+void delay_dao(rpl_dodag_t *dodag)
+{
+    dodag->dao_counter = 0;
+    dodag->dao_scheduled = true;
+    dao_timer_set(dodag, DEFAULT_DAO_DELAY);
+}
+
+/* a DAO that is scheduled already carries the new targets, too */
+static void trigger_dao(rpl_dodag_t *dodag)
+{
+    if (!dodag->dao_scheduled) {
+        delay_dao(dodag);
+    }
+}
+
+static void dao_delay_over(rpl_dodag_t *dodag)
+{
+    dodag->dao_scheduled = false;
+
+    /* targets are refreshed on their own, see rpl_dao_tick() */
+    if (!rpl_dao_pending(dodag)) {
+        return;
+    }
+
+    if (dodag->dao_counter < DAO_SEND_RETRIES) {
+        dodag->dao_counter++;
+        dodag->dao_scheduled = true;
+        send_DAO(dodag, NULL, 0, true);
+        dao_timer_set(dodag, DEFAULT_WAIT_FOR_DAO_ACK);
+    }
+    else {
+        /* the parent does not answer, try again later */
+        dodag->dao_counter = 0;
+        dodag->dao_scheduled = true;
+        dao_timer_set(dodag, REGULAR_DAO_INTERVAL);
+    }
+}
+
+void dao_ack_received(rpl_dodag_t *dodag, uint8_t sequence)
+{
+    rpl_dao_acked(dodag, sequence);
+
+    if (!rpl_dao_pending(dodag)) {
+        vtimer_remove(&dodag->dao_timer);
+        dodag->dao_scheduled = false;
+    }
+}
+
+static void rt_timer_over(void)
+{
+    rpl_dodag_t *my_dodag = NULL;
+
+    while ((my_dodag = rpl_next_joined_dodag(my_dodag)) != NULL) {
+        /* routing table lifetimes and refreshes of the targets */
+        if (rpl_dao_tick(my_dodag) && my_dodag->mop != RPL_NO_DOWNWARD_ROUTES) {
+            trigger_dao(my_dodag);
+        }
+
+        if (my_dodag->parent_hold > 0) {
+            my_dodag->parent_hold--;
+        }
+
+        /* Parent is NULL for root too */
+        if (my_dodag->my_preferred_parent != NULL) {
+            if (my_dodag->my_preferred_parent->lifetime <= 1) {
+                DEBUGF("parent lifetime timeout\n");
+                rpl_parent_update(my_dodag, NULL);
+            }
+            else {
+                my_dodag->my_preferred_parent->lifetime--;
+            }
+        }
+    }
+
+    rt_timer_set();
+}
+
+void rpl_timers_handle(msg_t *m)
+{
+    rpl_dodag_t *my_dodag = NULL;
+
+    if (m->content.ptr == (char *) &rt_timer) {
+        rt_timer_over();
+        return;
+    }
+
+    /* the timers of a DODAG that was left meanwhile are stale */
+    while ((my_dodag = rpl_next_joined_dodag(my_dodag)) != NULL) {
+        if (m->content.ptr == (char *) &my_dodag->dao_timer) {
+            dao_delay_over(my_dodag);
+            return;
+        }
+
+        if (m->content.ptr == (char *) &my_dodag->trickle) {
+            trickle_callback(&my_dodag->trickle);
+            return;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * RPL timer prototypes
+ *
+ * Copyright (C) 2013  INRIA.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup rpl
+ * @{
+ * @file    rpl_timers.h
+ * @brief   DIO trickle timers, DAO delay and routing table lifetimes
+ *
+ * All timers send their messages to the RPL process, which handles them
+ * between the packets it receives.
+ *
+ * @author  Eric Engel <eric.engel@fu-berlin.de>
+ * @}
+ */
+
+#ifndef __RPL_TIMERS_H
+#define __RPL_TIMERS_H
+
+#include "msg.h"
+#include "rpl/rpl_structs.h"
+
+void rpl_timers_init(void);
+void rpl_timers_handle(msg_t *m);
+void rpl_dio_timer_start(rpl_dodag_t *dodag);
+void delay_dao(rpl_dodag_t *dodag);
+void dao_ack_received(rpl_dodag_t *dodag, uint8_t sequence);
+
+#endif /* __RPL_TIMERS_H */
@@ -36,6 +36,7 @@
 #define EPHEMERAL_PORTS     49152
 
 socket_internal_t socket_base_sockets[MAX_SOCKETS];
+socket_base_stats_t socket_base_stats;
 
 int __attribute__((weak)) tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 {
@@ -96,6 +97,41 @@ int32_t __attribute__((weak)) udp_recvfrom(int s, void *buf, uint32_t len, int f
     return -1;
 }
 
+int32_t __attribute__((weak)) udp_recvfrom_loan(int s, uint8_t **buf, int flags,
+                                              sockaddr6_t *from, uint32_t *fromlen)
+{
+    (void) s;
+    (void) buf;
+    (void) flags;
+    (void) from;
+    (void) fromlen;
+
+    return -1;
+}
+
+int __attribute__((weak)) udp_recv_release(int s)
+{
+    (void) s;
+
+    return -1;
+}
+
+int32_t __attribute__((weak)) tcp_recv_loan(int s, uint8_t **buf, int flags)
+{
+    (void) s;
+    (void) buf;
+    (void) flags;
+
+    return -1;
+}
+
+int __attribute__((weak)) tcp_recv_release(int s)
+{
+    (void) s;
+
+    return -1;
+}
+
 int32_t __attribute__((weak)) udp_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
@@ -150,6 +186,18 @@ int __attribute__((weak)) tcp_teardown(socket_internal_t *current_socket)
     return -1;
 }
 
+int __attribute__((weak)) tcp_setsockopt(int s, int option_name,
+                                         const void *option_value,
+                                         socklen_t option_len)
+{
+    (void) s;
+    (void) option_name;
+    (void) option_value;
+    (void) option_len;
+
+    return -1;
+}
+
 void socket_base_print_socket(socket_t *current_socket)
 {
     char addr_str[IPV6_MAX_ADDR_STR_LEN];
@@ -181,7 +229,8 @@ void socket_base_print_internal_socket(socket_internal_t *current_socket_interna
 
 int socket_base_exists_socket(int socket)
 {
-    if (socket_base_sockets[socket - 1].socket_id == 0) {
+    if ((socket < 1) || (socket > MAX_SOCKETS) ||
+        (socket_base_sockets[socket - 1].socket_id == 0)) {
         return false;
     }
     else {
@@ -247,11 +296,11 @@ int socket_base_socket(int domain, int type, int protocol)
 {
     int i = 1;
 
-    while (socket_base_get_socket(i) != NULL) {
+    while ((i <= MAX_SOCKETS) && (socket_base_get_socket(i) != NULL)) {
         i++;
     }
 
-    if (i > MAX_SOCKETS + 1) {
+    if (i > MAX_SOCKETS) {
         return -1;
     }
     else {
@@ -299,6 +348,17 @@ int socket_base_listen(int s, int backlog)
     return -1;
 }
 
+int socket_base_setsockopt(int s, int level, int option_name,
+                           const void *option_value, socklen_t option_len)
+{
+    if ((level == IPPROTO_TCP) && tcp_socket_compliancy(s)) {
+        return tcp_setsockopt(s, option_name, option_value, option_len);
+    }
+
+    printf("Socket option not supported!\n");
+    return -1;
+}
+
 int32_t socket_base_recv(int s, void *buf, uint32_t len, int flags)
 {
     if (tcp_socket_compliancy(s)) {
@@ -323,6 +383,33 @@ int32_t socket_base_recvfrom(int s, void *buf, uint32_t len, int flags,
     return -1;
 }
 
+int32_t socket_base_recvfrom_loan(int s, uint8_t **buf, int flags,
+                                  sockaddr6_t *from, uint32_t *fromlen)
+{
+    if (udp_socket_compliancy(s)) {
+        return udp_recvfrom_loan(s, buf, flags, from, fromlen);
+    }
+    else if (tcp_socket_compliancy(s)) {
+        return tcp_recv_loan(s, buf, flags);
+    }
+
+    printf("Socket Type not supported!\n");
+    return -1;
+}
+
+int socket_base_recv_release(int s)
+{
+    if (udp_socket_compliancy(s)) {
+        return udp_recv_release(s);
+    }
+    else if (tcp_socket_compliancy(s)) {
+        return tcp_recv_release(s);
+    }
+
+    printf("Socket Type not supported!\n");
+    return -1;
+}
+
 int32_t socket_base_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
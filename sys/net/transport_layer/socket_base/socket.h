@@ -10,15 +10,12 @@
 #define _SOCKET_BASE_SOCKET
 
 #include "cpu.h"
+#include "msg.h"
 
 #include "socket_base/socket.h"
 
-#ifdef MODULE_UDP
-#include "udp.h"
-#endif
-
 #ifdef MODULE_TCP
-#include "tcp.h"
+#include "tcp_stats.h"
 #endif
 
 #define MAX_SOCKETS         5
@@ -27,7 +24,33 @@
 #define INC_PACKET          0
 #define OUT_PACKET          1
 
+/* Kinds of receive buffers loaned out to the application */
+#define SOCKET_LOAN_NONE    0   /* nothing loaned */
+#define SOCKET_LOAN_MSG     1   /* network buffer, released by replying to recv_loan */
+#define SOCKET_LOAN_BUFFER  2   /* head of tcp_input_buffer, kept until released */
+
+/* Receive path accounting, bytes copied per delivered byte show the cost of
+ * the copying API against the loaning API */
+typedef struct {
+    uint32_t            rx_delivered;   /* payload bytes handed to applications */
+    uint32_t            rx_copied;      /* payload bytes copied on the way */
+} socket_base_stats_t;
+
 #ifdef MODULE_TCP
+/* Connections a listening socket can hold ready for tcp_accept(), every one
+ * of them occupies an entry of the socket table */
+#define TCP_MAX_BACKLOG     (MAX_SOCKETS - 1)
+
+/* Backlog of a listening socket */
+typedef struct {
+    uint8_t             backlog;        /* limit of half-open plus queued connections */
+    uint8_t             syn_count;      /* half-open connections in the SYN queue */
+    uint8_t             accept_head;    /* oldest established connection */
+    uint8_t             accept_count;   /* established connections not yet accepted */
+    uint8_t             accept_waiting; /* recv_pid is about to wait for one */
+    uint8_t             accept_queue[TCP_MAX_BACKLOG];  /* socket IDs */
+} tcp_listen_queue_t;
+
 typedef struct __attribute__((packed)) {
     uint16_t        context_id;
     uint32_t        seq_rcv; // Last received packet values
@@ -39,6 +62,9 @@ typedef struct __attribute__((packed)) {
     uint8_t         hc_type;
 } tcp_hc_context_t;
 
+/* Options of a TCP connection */
+#define TCP_CB_NODELAY      (0x01)  /* send small writes at once, no coalescing */
+
 typedef struct __attribute__((packed)) {
     uint32_t            send_una;
     uint32_t            send_nxt;
@@ -54,11 +80,15 @@ typedef struct __attribute__((packed)) {
     uint16_t            mss;
 
     uint8_t             state;
+    uint8_t             options;
+    uint8_t             ack_pending;    /* received segments not acknowledged yet */
 
     double              srtt;
     double              rttvar;
     double              rto;
 
+    tcp_stats_t         stats;
+
 #ifdef TCP_HC
     tcp_hc_context_t    tcp_context;
 #endif
@@ -81,14 +111,34 @@ typedef struct {
     uint8_t             recv_pid;
     uint8_t             send_pid;
     socket_t            socket_values;
+    msg_t               recv_loan;
+    uint8_t             recv_loan_type;
 #ifdef MODULE_TCP
+    tcp_listen_queue_t  tcp_listen_queue;
     uint8_t             tcp_input_buffer_end;
+    uint8_t             tcp_input_buffer_loaned;    /* bytes at the start loaned out */
     mutex_t             tcp_buffer_mutex;
     uint8_t             tcp_input_buffer[TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER];
+    /* small writes coalesced while earlier ones are unacknowledged */
+    uint8_t             tcp_output_buffer_end;
+    uint8_t             tcp_output_in_flight;   /* sent, not acknowledged */
+    uint8_t             tcp_output_waiting;     /* send_pid waits for the buffer to drain */
+    mutex_t             tcp_output_mutex;
+    uint8_t             tcp_output_buffer[TRANSPORT_LAYER_SOCKET_STATIC_MSS];
 #endif
 } socket_internal_t;
 
+/* the protocol headers use the types above */
+#ifdef MODULE_UDP
+#include "udp.h"
+#endif
+
+#ifdef MODULE_TCP
+#include "tcp.h"
+#endif
+
 extern socket_internal_t socket_base_sockets[MAX_SOCKETS];
+extern socket_base_stats_t socket_base_stats;
 
 socket_internal_t *socket_base_get_socket(int s);
 uint16_t socket_base_get_free_source_port(uint8_t protocol);
@@ -47,6 +47,16 @@ uint32_t            global_sequence_counter;
 char tcp_stack_buffer[TCP_STACK_SIZE];
 char tcp_timer_stack[TCP_TIMER_STACKSIZE];
 
+static kernel_pid_t tcp_packet_handler_pid;
+
+/* Wakes the packet handler for delayed ACKs and for retransmissions of
+ * coalesced writes */
+static vtimer_t tcp_output_vtimer;
+static mutex_t tcp_output_vtimer_mutex;
+static bool tcp_output_vtimer_armed;
+
+void calculate_rto(tcp_cb_t *tcp_control, timex_t current_time);
+
 void set_socket_address(sockaddr6_t *sockaddr, uint8_t sin6_family,
                         uint16_t sin6_port, uint32_t sin6_flowinfo, ipv6_addr_t *sin6_addr)
 {
@@ -282,6 +292,17 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
 
     current_tcp_packet->checksum = ~tcp_csum(temp_ipv6_header, current_tcp_packet);
 
+    TCP_STATS_INC(&current_tcp_socket->tcp_control, segs_out);
+
+    if (IS_TCP_ACK(flags)) {
+        /* acknowledges everything received so far */
+        current_tcp_socket->tcp_control.ack_pending = 0;
+    }
+
+    if (current_tcp_socket->tcp_control.rcv_wnd == 0) {
+        TCP_STATS_INC(&current_tcp_socket->tcp_control, zero_window);
+    }
+
 #ifdef TCP_HC
     uint16_t compressed_size;
 
@@ -317,84 +338,6 @@ bool is_four_touple(socket_internal_t *current_socket, ipv6_hdr_t *ipv6_header,
             (current_socket->socket_values.foreign_address.sin6_port == tcp_header->src_port));
 }
 
-socket_internal_t *get_waiting_connection_socket(int socket,
-        ipv6_hdr_t *ipv6_header,
-        tcp_hdr_t *tcp_header)
-{
-    int i;
-    socket_internal_t *listening_socket = socket_base_get_socket(socket);
-
-    for (i = 1; i < MAX_SOCKETS + 1; i++) {
-        socket_internal_t *current_socket = socket_base_get_socket(i);
-
-        if (!current_socket) {
-            continue;
-        }
-
-        /* Connection establishment ACK, Check for 4 touple and state */
-        if ((ipv6_header != NULL) && (tcp_header != NULL)) {
-            if (is_four_touple(current_socket, ipv6_header, tcp_header) &&
-                (current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD)) {
-                return current_socket;
-            }
-        }
-        /* Connection establishment SYN ACK, check only for port and state */
-        else {
-            if ((current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD) &&
-                (current_socket->socket_values.local_address.sin6_port ==
-                 listening_socket->socket_values.local_address.sin6_port)) {
-                return current_socket;
-            }
-        }
-    }
-
-    return NULL;
-}
-
-socket_internal_t *new_tcp_queued_socket(ipv6_hdr_t *ipv6_header,
-        tcp_hdr_t *tcp_header)
-{
-    int queued_socket_id;
-
-    queued_socket_id = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
-    socket_internal_t *current_queued_socket = socket_base_get_socket(queued_socket_id);
-
-    /* Foreign address */
-    set_socket_address(&current_queued_socket->socket_values.foreign_address,
-                       AF_INET6, tcp_header->src_port, ipv6_header->flowlabel,
-                       &ipv6_header->srcaddr);
-
-    /* Local address */
-    set_socket_address(&current_queued_socket->socket_values.local_address,
-                       AF_INET6, tcp_header->dst_port, 0,
-                       &ipv6_header->destaddr);
-
-    /* Foreign TCP information */
-    if ((tcp_header->data_offset * 4 > TCP_HDR_LEN) &&
-        (*(((uint8_t *)tcp_header) + TCP_HDR_LEN) == TCP_MSS_OPTION)) {
-        current_queued_socket->socket_values.tcp_control.mss =
-            *((uint16_t *)(((uint8_t *)tcp_header) + TCP_HDR_LEN + 2));
-    }
-    else {
-        current_queued_socket->socket_values.tcp_control.mss = TRANSPORT_LAYER_SOCKET_STATIC_MSS;
-    }
-
-    current_queued_socket->socket_values.tcp_control.rcv_irs =
-        tcp_header->seq_nr;
-    mutex_lock(&global_sequence_counter_mutex);
-    current_queued_socket->socket_values.tcp_control.send_iss =
-        global_sequence_counter;
-    mutex_unlock(&global_sequence_counter_mutex);
-    current_queued_socket->socket_values.tcp_control.state = TCP_SYN_RCVD;
-    set_tcp_cb(&current_queued_socket->socket_values.tcp_control,
-               tcp_header->seq_nr + 1, TRANSPORT_LAYER_SOCKET_STATIC_WINDOW,
-               current_queued_socket->socket_values.tcp_control.send_iss + 1,
-               current_queued_socket->socket_values.tcp_control.send_iss,
-               tcp_header->window);
-
-    return current_queued_socket;
-}
-
 socket_internal_t *get_tcp_socket(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header)
 {
     uint8_t i = 1;
@@ -441,27 +384,25 @@ uint8_t handle_payload(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
     uint8_t tcp_payload_len = NTOHS(ipv6_header->length) - TCP_HDR_LEN;
     uint8_t acknowledged_bytes = 0;
 
+    /* Append behind the data already buffered, which may be loaned out to
+     * the receiver, the window keeps it from overflowing the buffer */
+    mutex_lock(&tcp_socket->tcp_buffer_mutex);
+
     if (tcp_payload_len > tcp_socket->socket_values.tcp_control.rcv_wnd) {
-        mutex_lock(&tcp_socket->tcp_buffer_mutex);
-        memcpy(tcp_socket->tcp_input_buffer, payload,
-               tcp_socket->socket_values.tcp_control.rcv_wnd);
         acknowledged_bytes = tcp_socket->socket_values.tcp_control.rcv_wnd;
-        tcp_socket->socket_values.tcp_control.rcv_wnd = 0;
-        tcp_socket->tcp_input_buffer_end = tcp_socket->tcp_input_buffer_end +
-                                           tcp_socket->socket_values.tcp_control.rcv_wnd;
-        mutex_unlock(&tcp_socket->tcp_buffer_mutex);
     }
     else {
-        mutex_lock(&tcp_socket->tcp_buffer_mutex);
-        memcpy(tcp_socket->tcp_input_buffer, payload, tcp_payload_len);
-        tcp_socket->socket_values.tcp_control.rcv_wnd =
-            tcp_socket->socket_values.tcp_control.rcv_wnd - tcp_payload_len;
         acknowledged_bytes = tcp_payload_len;
-        tcp_socket->tcp_input_buffer_end = tcp_socket->tcp_input_buffer_end +
-                                           tcp_payload_len;
-        mutex_unlock(&tcp_socket->tcp_buffer_mutex);
     }
 
+    memcpy(tcp_socket->tcp_input_buffer + tcp_socket->tcp_input_buffer_end, payload,
+           acknowledged_bytes);
+    tcp_socket->socket_values.tcp_control.rcv_wnd -= acknowledged_bytes;
+    tcp_socket->tcp_input_buffer_end += acknowledged_bytes;
+    mutex_unlock(&tcp_socket->tcp_buffer_mutex);
+
+    socket_base_stats.rx_copied += acknowledged_bytes;
+
     if (thread_getstatus(tcp_socket->recv_pid) == STATUS_RECEIVE_BLOCKED) {
         socket_base_net_msg_send_recv(&m_send_tcp, &m_recv_tcp, tcp_socket->recv_pid, UNDEFINED);
     }
@@ -469,13 +410,230 @@ uint8_t handle_payload(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
     return acknowledged_bytes;
 }
 
+static void tcp_output_timer_arm(void)
+{
+    mutex_lock(&tcp_output_vtimer_mutex);
+
+    if (!tcp_output_vtimer_armed) {
+        tcp_output_vtimer_armed = true;
+        vtimer_set_msg(&tcp_output_vtimer,
+                       timex_set(0, TCP_OUTPUT_TIMER_INTERVAL),
+                       tcp_packet_handler_pid, &tcp_output_vtimer);
+    }
+
+    mutex_unlock(&tcp_output_vtimer_mutex);
+}
+
+static void tcp_send_ack(socket_internal_t *tcp_socket)
+{
+    uint8_t send_buffer[BUFFER_SIZE];
+    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
+    tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+
+#ifdef TCP_HC
+    tcp_socket->socket_values.tcp_control.tcp_context.hc_type = COMPRESSED_HEADER;
+#endif
+    send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
+}
+
+/* Sends the coalesced writes as one segment, tcp_output_mutex must be held */
+static int tcp_output_send(socket_internal_t *tcp_socket)
+{
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+    uint8_t send_buffer[BUFFER_SIZE];
+    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
+    tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+    uint8_t len = tcp_socket->tcp_output_buffer_end;
+
+    memcpy(&send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN], tcp_socket->tcp_output_buffer,
+           len);
+    tcp_socket->tcp_output_in_flight = len;
+    tcp_control->send_nxt = tcp_control->send_una + len;
+    vtimer_now(&tcp_control->last_packet_time);
+#ifdef TCP_HC
+    tcp_control->tcp_context.hc_type = (tcp_control->no_of_retries == 0) ?
+                                       COMPRESSED_HEADER : MOSTLY_COMPRESSED_HEADER;
+#endif
+
+    int res = send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header,
+                       TCP_ACK, len);
+    tcp_output_timer_arm();
+
+    return res;
+}
+
+/* Wakes a sender waiting in tcp_output_drain(), tcp_output_mutex must be held */
+static void tcp_output_drained(socket_internal_t *tcp_socket)
+{
+    if (tcp_socket->tcp_output_waiting) {
+        tcp_socket->tcp_output_waiting = 0;
+        thread_wakeup(tcp_socket->send_pid);
+    }
+}
+
+/* Drops the coalesced writes of a connection that was reset, closed or
+ * timed out, tcp_output_mutex must be held */
+static void tcp_output_flush(socket_internal_t *tcp_socket)
+{
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+
+    if (tcp_socket->tcp_output_buffer_end > 0) {
+        printf("Dropped %u coalesced bytes!\n", tcp_socket->tcp_output_buffer_end);
+        tcp_control->send_nxt = tcp_control->send_una;
+    }
+
+    tcp_socket->tcp_output_buffer_end = 0;
+    tcp_socket->tcp_output_in_flight = 0;
+    tcp_output_drained(tcp_socket);
+}
+
+/* Blocks until all coalesced writes of *tcp_socket* are acknowledged,
+ * returns -1 if the connection is no longer established */
+static int tcp_output_drain(socket_internal_t *tcp_socket)
+{
+    int res;
+
+    mutex_lock(&tcp_socket->tcp_output_mutex);
+
+    while (tcp_socket->tcp_output_buffer_end > 0) {
+        tcp_socket->tcp_output_waiting = 1;
+        tcp_socket->send_pid = thread_getpid();
+        /* the sender sleeps instead of receiving, so messages sent to it
+         * meanwhile are left to the msg queue or to their senders */
+        mutex_unlock_and_sleep(&tcp_socket->tcp_output_mutex);
+        mutex_lock(&tcp_socket->tcp_output_mutex);
+    }
+
+    res = (tcp_socket->socket_values.tcp_control.state == TCP_ESTABLISHED) ? 0 : -1;
+    mutex_unlock(&tcp_socket->tcp_output_mutex);
+
+    return res;
+}
+
+/* Handles an acknowledgment of coalesced writes, returns false if
+ * *tcp_header* acknowledges something else */
+static bool tcp_output_ack(socket_internal_t *tcp_socket, tcp_hdr_t *tcp_header)
+{
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+    uint8_t acked;
+
+    mutex_lock(&tcp_socket->tcp_output_mutex);
+
+    acked = tcp_socket->tcp_output_in_flight;
+
+    if ((acked == 0) || (tcp_header->ack_nr != tcp_control->send_una + acked)) {
+        mutex_unlock(&tcp_socket->tcp_output_mutex);
+        return false;
+    }
+
+    if (tcp_control->no_of_retries == 0) {
+        timex_t now;
+        vtimer_now(&now);
+        calculate_rto(tcp_control, now);
+    }
+
+    memmove(tcp_socket->tcp_output_buffer, tcp_socket->tcp_output_buffer + acked,
+            tcp_socket->tcp_output_buffer_end - acked);
+    tcp_socket->tcp_output_buffer_end -= acked;
+    tcp_socket->tcp_output_in_flight = 0;
+    tcp_control->send_una = tcp_header->ack_nr;
+    tcp_control->send_nxt = tcp_header->ack_nr;
+    tcp_control->send_wnd = tcp_header->window;
+    tcp_control->no_of_retries = 0;
+
+    if (tcp_socket->tcp_output_buffer_end > 0) {
+        /* everything written meanwhile goes out as one segment */
+        tcp_output_send(tcp_socket);
+    }
+    else {
+        tcp_output_drained(tcp_socket);
+    }
+
+    mutex_unlock(&tcp_socket->tcp_output_mutex);
+
+    return true;
+}
+
+/* Retransmits unacknowledged coalesced writes once the RTO expired,
+ * tcp_output_mutex must be held. Like handle_established() it gives up
+ * once the backoff exceeds TCP_ACK_MAX_TIMEOUT: the writes were reported
+ * as sent, so the connection is closed rather than left with a gap. */
+static void tcp_output_retransmit(socket_internal_t *tcp_socket)
+{
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+    double current_timeout = tcp_control->rto;
+    timex_t now;
+
+    if (current_timeout < SECOND) {
+        current_timeout = SECOND;
+    }
+
+    for (uint8_t i = 0; i < tcp_control->no_of_retries; i++) {
+        current_timeout *= 2;
+    }
+
+    if (current_timeout > TCP_ACK_MAX_TIMEOUT) {
+        tcp_control->state = TCP_CLOSED;
+        tcp_output_flush(tcp_socket);
+        return;
+    }
+
+    vtimer_now(&now);
+
+    if (timex_uint64(timex_sub(now, tcp_control->last_packet_time)) > current_timeout) {
+        tcp_control->no_of_retries++;
+        TCP_STATS_INC(tcp_control, retransmissions);
+        tcp_output_send(tcp_socket);
+    }
+}
+
+/* Runs in the packet handler whenever tcp_output_vtimer fired */
+static void tcp_output_timeout(void)
+{
+    bool pending = false;
+
+    mutex_lock(&tcp_output_vtimer_mutex);
+    tcp_output_vtimer_armed = false;
+    mutex_unlock(&tcp_output_vtimer_mutex);
+
+    for (int i = 1; i < MAX_SOCKETS + 1; i++) {
+        socket_internal_t *tcp_socket = socket_base_get_socket(i);
+
+        if (!tcp_socket_compliancy(i)) {
+            continue;
+        }
+
+        if ((tcp_socket->socket_values.tcp_control.state == TCP_ESTABLISHED) &&
+            (tcp_socket->socket_values.tcp_control.ack_pending > 0)) {
+            /* delayed ACK, nothing to piggyback it on */
+            tcp_send_ack(tcp_socket);
+        }
+
+        mutex_lock(&tcp_socket->tcp_output_mutex);
+
+        if (tcp_socket->tcp_output_in_flight > 0) {
+            tcp_output_retransmit(tcp_socket);
+            pending = true;
+        }
+
+        mutex_unlock(&tcp_socket->tcp_output_mutex);
+    }
+
+    if (pending) {
+        tcp_output_timer_arm();
+    }
+}
+
 void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
                            socket_internal_t *tcp_socket)
 {
-    msg_t m_recv_tcp, m_send_tcp;
+    msg_t m_send_tcp;
 
     if (tcp_socket->socket_values.tcp_control.state == TCP_LAST_ACK) {
         uint8_t target_pid = tcp_socket->recv_pid;
+#ifdef TCP_HC
+        tcp_hc_context_remove(tcp_socket);
+#endif
         memset(tcp_socket, 0, sizeof(socket_internal_t));
         msg_send(&m_send_tcp, target_pid, 0);
         return;
@@ -485,13 +643,16 @@ void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
         msg_send(&m_send_tcp, tcp_socket->send_pid, 0);
         return;
     }
-    else if (get_waiting_connection_socket(tcp_socket->socket_id, ipv6_header,
-                                           tcp_header) != NULL) {
-        m_send_tcp.content.ptr = (char *)tcp_header;
-        socket_base_net_msg_send_recv(&m_send_tcp, &m_recv_tcp, tcp_socket->recv_pid, TCP_ACK);
+    else if (tcp_socket->socket_values.tcp_control.state == TCP_LISTEN) {
+        /* last step of a three way handshake */
+        tcp_listen_handle_ack(ipv6_header, tcp_header, tcp_socket);
         return;
     }
     else if (tcp_socket->socket_values.tcp_control.state == TCP_ESTABLISHED) {
+        if (tcp_output_ack(tcp_socket, tcp_header)) {
+            return;
+        }
+
         if (check_tcp_consistency(&tcp_socket->socket_values, tcp_header, 0) == PACKET_OK) {
             m_send_tcp.content.ptr = (char *)tcp_header;
             socket_base_net_msg_send(&m_send_tcp, tcp_socket->send_pid, 0, TCP_ACK);
@@ -506,35 +667,28 @@ void handle_tcp_rst_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
                            socket_internal_t *tcp_socket)
 {
     (void) ipv6_header;
-    (void) tcp_header;
-    (void) tcp_socket;
 
-    /* TODO: Reset connection */
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+
+    /* only a RST inside the receive window resets a connection */
+    if ((tcp_control->state == TCP_CLOSED) || (tcp_control->state == TCP_LISTEN) ||
+        (tcp_header->seq_nr - tcp_control->rcv_nxt > tcp_control->rcv_wnd)) {
+        return;
+    }
+
+    mutex_lock(&tcp_socket->tcp_output_mutex);
+    tcp_control->state = TCP_CLOSED;
+    tcp_output_flush(tcp_socket);
+    mutex_unlock(&tcp_socket->tcp_output_mutex);
+
+    /* TODO: Wake up a thread waiting in tcp_recv() */
 }
 
 void handle_tcp_syn_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
                            socket_internal_t *tcp_socket)
 {
-    msg_t m_send_tcp;
-
     if (tcp_socket->socket_values.tcp_control.state == TCP_LISTEN) {
-        socket_internal_t *new_socket = new_tcp_queued_socket(ipv6_header,
-                                        tcp_header);
-
-        if (new_socket != NULL) {
-#ifdef TCP_HC
-            update_tcp_hc_context(true, new_socket, tcp_header);
-#endif
-            /* notify socket function tcp_accept(..) that a new
-             * connection request has arrived. No need to wait for an answer
-             * because the server tcp_accept() function isnt reading
-             * from anything other than the queued sockets */
-            socket_base_net_msg_send(&m_send_tcp, tcp_socket->recv_pid, 0, TCP_SYN);
-        }
-        else {
-            printf("Dropped TCP SYN Message because an error occured while "\
-                   "requesting a new queued socket!\n");
-        }
+        tcp_listen_handle_syn(ipv6_header, tcp_header, tcp_socket);
     }
     else {
         printf("Dropped TCP SYN Message because socket was not in state TCP_LISTEN!");
@@ -568,6 +722,11 @@ void handle_tcp_fin_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
     ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
     tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
 
+    /* the FIN is answered at once, coalesced writes cannot follow it */
+    mutex_lock(&tcp_socket->tcp_output_mutex);
+    tcp_output_flush(tcp_socket);
+    mutex_unlock(&tcp_socket->tcp_output_mutex);
+
     set_tcp_cb(&current_tcp_socket->tcp_control, tcp_header->seq_nr + 1,
                current_tcp_socket->tcp_control.send_wnd, tcp_header->ack_nr + 1,
                tcp_header->ack_nr, tcp_header->window);
@@ -638,15 +797,26 @@ void handle_tcp_no_flags_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
                    current_tcp_socket->tcp_control.send_una,
                    current_tcp_socket->tcp_control.send_wnd);
 
-        /* Send packet */
-        //  block_continue_thread();
-#ifdef TCP_HC
-        current_tcp_socket->tcp_control.tcp_context.hc_type = COMPRESSED_HEADER;
-#endif
-        send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
+        current_tcp_socket->tcp_control.ack_pending++;
+
+        /* the segment may acknowledge coalesced writes, the ACK of the
+         * segment is piggybacked on the writes queued meanwhile */
+        tcp_output_ack(tcp_socket, tcp_header);
+
+        /* Delayed ACK (RFC 1122): every second segment is acknowledged
+         * right away, single segments with the next data sent or when
+         * tcp_output_vtimer fires, TCP_OUTPUT_TIMER_INTERVAL at the latest */
+        if ((current_tcp_socket->tcp_control.ack_pending >= TCP_DELAYED_ACK_SEGMENTS) ||
+            (current_tcp_socket->tcp_control.rcv_wnd == 0)) {
+            tcp_send_ack(tcp_socket);
+        }
+        else if (current_tcp_socket->tcp_control.ack_pending > 0) {
+            tcp_output_timer_arm();
+        }
     }
     /* ACK packet probably got lost */
     else {
+        TCP_STATS_INC(&current_tcp_socket->tcp_control, out_of_order);
         //      block_continue_thread();
 #ifdef TCP_HC
         current_tcp_socket->tcp_control.tcp_context.hc_type = FULL_HEADER;
@@ -666,6 +836,12 @@ void *tcp_packet_handler(void *arg)
     while (1) {
         msg_receive(&m_recv_ip);
 
+        if (m_recv_ip.type == MSG_TIMER) {
+            /* tcp_output_vtimer, nobody waits for a reply */
+            tcp_output_timeout();
+            continue;
+        }
+
         ipv6_hdr_t *ipv6_header = ((ipv6_hdr_t *)m_recv_ip.content.ptr);
         tcp_header = ((tcp_hdr_t *)(m_recv_ip.content.ptr + IPV6_HDR_LEN));
 #ifdef TCP_HC
@@ -682,6 +858,8 @@ void *tcp_packet_handler(void *arg)
 #ifdef TCP_HC
             update_tcp_hc_context(true, tcp_socket, tcp_header);
 #endif
+            TCP_STATS_INC(&tcp_socket->socket_values.tcp_control, segs_in);
+
             /* Remove reserved bits from tcp flags field */
             uint8_t tcp_flags = tcp_header->reserved_flags;
 
@@ -696,7 +874,7 @@ void *tcp_packet_handler(void *arg)
                         handle_tcp_no_flags_packet(ipv6_header, tcp_header, tcp_socket, payload, tcp_payload_len);
                     }
                     else if (tcp_payload_len == 0
-                            && (state == TCP_ESTABLISHED || state == TCP_SYN_RCVD
+                            && (state == TCP_ESTABLISHED || state == TCP_LISTEN
                                 || state == TCP_CLOSING || state == TCP_LAST_ACK)) {
                         /* no payload, acknowledging data only */
                         handle_tcp_ack_packet(ipv6_header, tcp_header, tcp_socket);
@@ -805,7 +983,8 @@ int tcp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid)
 
 void calculate_rto(tcp_cb_t *tcp_control, timex_t current_time)
 {
-    double rtt = (double) timex_uint64(timex_sub(current_time, tcp_control->last_packet_time));
+    uint32_t rtt_us = timex_uint64(timex_sub(current_time, tcp_control->last_packet_time));
+    double rtt = (double) rtt_us;
     double srtt = tcp_control->srtt;
     double rttvar = tcp_control->rttvar;
     double rto = tcp_control->rto;
@@ -832,93 +1011,8 @@ void calculate_rto(tcp_cb_t *tcp_control, timex_t current_time)
     tcp_control->srtt = srtt;
     tcp_control->rttvar = rttvar;
     tcp_control->rto = rto;
-}
 
-int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
-                              socket_internal_t *server_socket, uint8_t pid)
-{
-    (void) pid;
-
-    msg_t msg_recv_client_ack, msg_send_client_ack;
-    socket_t *current_queued_socket = &current_queued_int_socket->socket_values;
-    uint8_t send_buffer[BUFFER_SIZE];
-    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
-    tcp_hdr_t *syn_ack_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
-
-    current_queued_int_socket->recv_pid = thread_getpid();
-#ifdef TCP_HC
-    current_queued_int_socket->socket_values.tcp_control.tcp_context.hc_type =
-        FULL_HEADER;
-    memcpy(&current_queued_int_socket->socket_values.tcp_control.tcp_context.context_id,
-           &server_socket->socket_values.tcp_control.tcp_context.context_id,
-           sizeof(server_socket->socket_values.tcp_control.tcp_context.context_id));
-#endif
-    /* Remember current time */
-    timex_t now;
-    vtimer_now(&now);
-    current_queued_int_socket->socket_values.tcp_control.last_packet_time = now;
-
-    current_queued_int_socket->socket_values.tcp_control.no_of_retries = 0;
-
-    /* Set message type to Retry for while loop */
-    msg_recv_client_ack.type = TCP_RETRY;
-
-    while (msg_recv_client_ack.type == TCP_RETRY) {
-        /* Send packet */
-        send_tcp(current_queued_int_socket, syn_ack_packet, temp_ipv6_header,
-                 TCP_SYN_ACK, 0);
-
-        /* wait for ACK from Client */
-        msg_receive(&msg_recv_client_ack);
-
-        if (msg_recv_client_ack.type == TCP_TIMEOUT) {
-            /* Set status of internal socket back to TCP_LISTEN */
-            server_socket->socket_values.tcp_control.state = TCP_LISTEN;
-            memset(current_queued_int_socket, 0, sizeof(socket_internal_t));
-            return -1;
-        }
-    }
-
-    tcp_hdr_t *tcp_header;
-
-    tcp_header = ((tcp_hdr_t *)(msg_recv_client_ack.content.ptr));
-
-    /* Check for consistency */
-    if (tcp_header->ack_nr != current_queued_socket->tcp_control.send_nxt) {
-        printf("TCP packets not consistent!\n");
-    }
-
-    /* Got ack, connection established, refresh local and foreign tcp socket
-     * status */
-    set_tcp_cb(&current_queued_socket->tcp_control, tcp_header->seq_nr,
-               current_queued_socket->tcp_control.rcv_wnd, tcp_header->ack_nr,
-               tcp_header->ack_nr, tcp_header->window);
-
-#ifdef TCP_HC
-    /* Copy TCP context information into new socket */
-    memset(&server_socket->socket_values.tcp_control.tcp_context, 0,
-           sizeof(tcp_hc_context_t));
-#endif
-
-    /* Update connection status information */
-    current_queued_socket->tcp_control.state = TCP_ESTABLISHED;
-
-    /* Set status of internal socket back to TCP_LISTEN */
-    server_socket->socket_values.tcp_control.state = TCP_LISTEN;
-
-    /* send a reply to the TCP handler after processing every information from
-     * the TCP ACK packet */
-    msg_reply(&msg_recv_client_ack, &msg_send_client_ack);
-
-    /* Reset PID to an unlikely value */
-    current_queued_int_socket->recv_pid = 255;
-
-    /* Waiting for Clients ACK waiting period to time out */
-    vtimer_usleep(TCP_SYN_INITIAL_TIMEOUT / 2);
-
-    socket_base_print_sockets();
-
-    return current_queued_int_socket->socket_id;
+    tcp_stats_rtt(tcp_control, rtt_us, (uint32_t) rto);
 }
 
 int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
@@ -949,6 +1043,50 @@ int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
         return -1;
     }
 
+    if (!(current_tcp_socket->tcp_control.options & TCP_CB_NODELAY) &&
+        (len < current_tcp_socket->tcp_control.mss)) {
+        /* Nagle: small writes are coalesced while data is unacknowledged */
+        uint16_t limit = current_tcp_socket->tcp_control.mss;
+
+        if (limit > sizeof(current_int_tcp_socket->tcp_output_buffer)) {
+            limit = sizeof(current_int_tcp_socket->tcp_output_buffer);
+        }
+
+        if (limit > current_tcp_socket->tcp_control.send_wnd) {
+            limit = current_tcp_socket->tcp_control.send_wnd;
+        }
+
+        while (len <= limit) {
+            mutex_lock(&current_int_tcp_socket->tcp_output_mutex);
+
+            if (current_int_tcp_socket->tcp_output_buffer_end + len <= limit) {
+                memcpy(current_int_tcp_socket->tcp_output_buffer +
+                       current_int_tcp_socket->tcp_output_buffer_end, buf, len);
+                current_int_tcp_socket->tcp_output_buffer_end += len;
+
+                if (current_int_tcp_socket->tcp_output_in_flight == 0) {
+                    current_tcp_socket->tcp_control.no_of_retries = 0;
+                    tcp_output_send(current_int_tcp_socket);
+                }
+
+                mutex_unlock(&current_int_tcp_socket->tcp_output_mutex);
+                return len;
+            }
+
+            mutex_unlock(&current_int_tcp_socket->tcp_output_mutex);
+
+            /* buffer full, wait for the next ACK */
+            if (tcp_output_drain(current_int_tcp_socket) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    /* keep the byte stream in order */
+    if (tcp_output_drain(current_int_tcp_socket) < 0) {
+        return -1;
+    }
+
     /* Add thread PID */
     current_int_tcp_socket->send_pid = thread_getpid();
 
@@ -1024,12 +1162,17 @@ int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
             switch (recv_msg.type) {
                 case TCP_ACK: {
                     if (current_tcp_socket->tcp_control.no_of_retries == 0) {
-                        calculate_rto(&current_tcp_socket->tcp_control,
-                                      current_tcp_socket->tcp_control.last_packet_time);
+                        timex_t now;
+                        vtimer_now(&now);
+                        calculate_rto(&current_tcp_socket->tcp_control, now);
                     }
 
                     tcp_hdr_t *tcp_header = ((tcp_hdr_t *)(recv_msg.content.ptr));
 
+                    if (tcp_header->window == 0) {
+                        TCP_STATS_INC(&current_tcp_socket->tcp_control, zero_window);
+                    }
+
                     if ((current_tcp_socket->tcp_control.send_nxt ==
                          tcp_header->ack_nr) && (total_sent_bytes == len)) {
                         current_tcp_socket->tcp_control.send_una = tcp_header->ack_nr;
@@ -1065,12 +1208,13 @@ int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
                 }
 
                 case TCP_RETRY: {
+                    TCP_STATS_INC(&current_tcp_socket->tcp_control, retransmissions);
                     current_tcp_socket->tcp_control.send_nxt -= sent_bytes;
                     current_tcp_socket->tcp_control.send_wnd += sent_bytes;
                     total_sent_bytes -= sent_bytes;
 #ifdef TCP_HC
                     memcpy(&current_tcp_socket->tcp_control.tcp_context,
-                           $&saved_tcp_context, sizeof(tcp_hc_context_t));
+                           &saved_tcp_context, sizeof(tcp_hc_context_t));
                     current_tcp_socket->tcp_control.tcp_context.hc_type =
                         MOSTLY_COMPRESSED_HEADER;
 #endif
@@ -1097,37 +1241,41 @@ int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
 
 int tcp_accept(int s, sockaddr6_t *addr, uint32_t *addrlen)
 {
-    (void) addr;
-    (void) addrlen;
-
     socket_internal_t *server_socket = socket_base_get_socket(s);
 
-    if (tcp_socket_compliancy(s) && (server_socket->socket_values.tcp_control.state == TCP_LISTEN)) {
-        socket_internal_t *current_queued_socket =
-            get_waiting_connection_socket(s, NULL, NULL);
+    if (!tcp_socket_compliancy(s) ||
+        (server_socket->socket_values.tcp_control.state != TCP_LISTEN)) {
+        return -1;
+    }
 
-        if (current_queued_socket != NULL) {
-            return handle_new_tcp_connection(current_queued_socket,
-                                             server_socket, thread_getpid());
-        }
-        else {
-            /* No waiting connections, waiting for message from TCP Layer */
-            msg_t msg_recv_client_syn;
-            msg_recv_client_syn.type = UNDEFINED;
+    server_socket->recv_pid = thread_getpid();
 
-            while (msg_recv_client_syn.type != TCP_SYN) {
-                msg_receive(&msg_recv_client_syn);
-            }
+    socket_internal_t *current_queued_socket = tcp_listen_pop(server_socket);
 
-            current_queued_socket = get_waiting_connection_socket(s, NULL, NULL);
+    while (current_queued_socket == NULL) {
+        /* No established connections, waiting for message from TCP Layer */
+        msg_t msg_recv_client_syn;
 
-            return handle_new_tcp_connection(current_queued_socket,
-                                             server_socket, thread_getpid());
+        msg_receive(&msg_recv_client_syn);
+
+        /* The listener was closed meanwhile, CLOSE_CONN has the value of
+         * TCP_SYN, so only the socket tells */
+        if (!tcp_socket_compliancy(s) ||
+            (server_socket->socket_values.tcp_control.state != TCP_LISTEN)) {
+            return -1;
+        }
+
+        if (msg_recv_client_syn.type == TCP_SYN) {
+            current_queued_socket = tcp_listen_pop(server_socket);
         }
     }
-    else {
-        return -1;
+
+    if ((addr != NULL) && (addrlen != NULL)) {
+        *addr = current_queued_socket->socket_values.foreign_address;
+        *addrlen = sizeof(sockaddr6_t);
     }
+
+    return current_queued_socket->socket_id;
 }
 
 int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
@@ -1179,6 +1327,7 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
     mutex_unlock(&global_context_counter_mutex);
 
     current_tcp_socket->tcp_control.tcp_context.hc_type = FULL_HEADER;
+    tcp_hc_context_add(current_int_tcp_socket);
 
     /* Remember TCP Context for possible TCP_RETRY */
     tcp_hc_context_t saved_tcp_context;
@@ -1191,8 +1340,9 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
                current_tcp_socket->tcp_control.send_iss, 0);
 
     /* Remember current time */
-    timex_t now;
+    timex_t now, handshake_start;
     vtimer_now(&now);
+    handshake_start = now;
     current_tcp_socket->tcp_control.last_packet_time = now;
     current_tcp_socket->tcp_control.no_of_retries = 0;
 
@@ -1214,15 +1364,14 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 #endif
             return -1;
         }
-
-#ifdef TCP_HC
         else if (msg_from_server.type == TCP_RETRY) {
+            TCP_STATS_INC(&current_tcp_socket->tcp_control, retransmissions);
+#ifdef TCP_HC
             /* We retry sending a packet so set everything to last values again */
             memcpy(&current_tcp_socket->tcp_control.tcp_context,
                    &saved_tcp_context, sizeof(tcp_hc_context_t));
-        }
-
 #endif
+        }
     }
 
     /* Read packet content */
@@ -1255,6 +1404,8 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 
     /* Remember current time */
     vtimer_now(&now);
+    tcp_stats_handshake(&current_tcp_socket->tcp_control,
+                        timex_uint64(timex_sub(now, handshake_start)));
     current_tcp_socket->tcp_control.last_packet_time = now;
     current_tcp_socket->tcp_control.no_of_retries = 0;
 
@@ -1271,19 +1422,21 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
                  TCP_ACK, 0);
 
         msg_receive(&msg_from_server);
-#ifdef TCP_HC
 
         if (msg_from_server.type == TCP_SYN_ACK) {
             /* TCP_SYN_ACK from server arrived again, copy old context and
              * send TCP_ACK again */
+            TCP_STATS_INC(&current_tcp_socket->tcp_control, retransmissions);
+#ifdef TCP_HC
             memcpy(&current_tcp_socket->tcp_control.tcp_context,
                    &saved_tcp_context, sizeof(tcp_hc_context_t));
+#endif
         }
+#ifdef TCP_HC
         else if (msg_from_server.type == TCP_RETRY) {
             /* We waited for RTT, no TCP_SYN_ACK received, so we assume the
              * TCP_ACK packet arrived safely */
         }
-
 #endif
     }
 
@@ -1306,6 +1459,8 @@ uint8_t read_from_socket(socket_internal_t *current_int_tcp_socket,
         current_int_tcp_socket->tcp_input_buffer_end = 0;
         current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += read_bytes;
         mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
+        socket_base_stats.rx_delivered += read_bytes;
+        socket_base_stats.rx_copied += read_bytes;
         return read_bytes;
     }
     else {
@@ -1318,6 +1473,8 @@ uint8_t read_from_socket(socket_internal_t *current_int_tcp_socket,
             current_int_tcp_socket->tcp_input_buffer_end - len;
         current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += len;
         mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
+        socket_base_stats.rx_delivered += len;
+        socket_base_stats.rx_copied += len;
         return len;
     }
 }
@@ -1338,6 +1495,11 @@ int32_t tcp_recv(int s, void *buf, uint32_t len, int flags)
 
     current_int_tcp_socket = socket_base_get_socket(s);
 
+    if (current_int_tcp_socket->recv_loan_type != SOCKET_LOAN_NONE) {
+        /* the head of the buffer is loaned out */
+        return -1;
+    }
+
     /* Setting Thread PID */
     current_int_tcp_socket->recv_pid = thread_getpid();
 
@@ -1365,12 +1527,124 @@ int32_t tcp_recv(int s, void *buf, uint32_t len, int flags)
     return -1;
 }
 
-int tcp_listen(int s, int backlog)
+/* Loans out the data buffered in tcp_input_buffer, segments received
+ * meanwhile are appended behind it until tcp_recv_release(). handle_payload()
+ * copied the data there, so a loan saves only the copy into the caller's
+ * buffer. */
+static int32_t loan_from_socket(socket_internal_t *current_int_tcp_socket,
+                                uint8_t **buf)
 {
-    (void) backlog;
+    mutex_lock(&current_int_tcp_socket->tcp_buffer_mutex);
+    current_int_tcp_socket->recv_loan_type = SOCKET_LOAN_BUFFER;
+    current_int_tcp_socket->tcp_input_buffer_loaned =
+        current_int_tcp_socket->tcp_input_buffer_end;
+    *buf = current_int_tcp_socket->tcp_input_buffer;
+    socket_base_stats.rx_delivered += current_int_tcp_socket->tcp_input_buffer_loaned;
+    mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
+    return current_int_tcp_socket->tcp_input_buffer_loaned;
+}
+
+int32_t tcp_recv_loan(int s, uint8_t **buf, int flags)
+{
+    (void) flags;
+
+    msg_t m_recv, m_send;
+    socket_internal_t *current_int_tcp_socket;
+
+    /* Check if socket exists */
+    if (!tcp_socket_compliancy(s)) {
+        printf("INFO: NO TCP SOCKET!\n");
+        return -1;
+    }
+
+    current_int_tcp_socket = socket_base_get_socket(s);
+
+    if (current_int_tcp_socket->recv_loan_type != SOCKET_LOAN_NONE) {
+        /* previous buffer not released yet */
+        return -1;
+    }
+
+    /* Setting Thread PID */
+    current_int_tcp_socket->recv_pid = thread_getpid();
+
+    if (current_int_tcp_socket->tcp_input_buffer_end > 0) {
+        return loan_from_socket(current_int_tcp_socket, buf);
+    }
+
+    msg_receive(&m_recv);
+
+    if ((socket_base_exists_socket(s)) && (current_int_tcp_socket->tcp_input_buffer_end > 0)) {
+        /* the packet handler only waits for the wake up to be taken */
+        socket_base_net_msg_reply(&m_recv, &m_send, UNDEFINED);
+        return loan_from_socket(current_int_tcp_socket, buf);
+    }
 
+    /* Received FIN */
+    if (m_recv.type == CLOSE_CONN) {
+        /* Sent FIN_ACK, wait for ACK */
+        msg_receive(&m_recv);
+    }
+
+    return -1;
+}
+
+int tcp_recv_release(int s)
+{
+    socket_internal_t *current_int_tcp_socket = socket_base_get_socket(s);
+
+    if ((current_int_tcp_socket == NULL) ||
+        (current_int_tcp_socket->recv_loan_type != SOCKET_LOAN_BUFFER)) {
+        return -1;
+    }
+
+    /* Move what arrived during the loan to the front */
+    mutex_lock(&current_int_tcp_socket->tcp_buffer_mutex);
+    uint8_t loaned = current_int_tcp_socket->tcp_input_buffer_loaned;
+    memmove(current_int_tcp_socket->tcp_input_buffer,
+            current_int_tcp_socket->tcp_input_buffer + loaned,
+            current_int_tcp_socket->tcp_input_buffer_end - loaned);
+    current_int_tcp_socket->tcp_input_buffer_end -= loaned;
+    current_int_tcp_socket->tcp_input_buffer_loaned = 0;
+    current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += loaned;
+    current_int_tcp_socket->recv_loan_type = SOCKET_LOAN_NONE;
+    mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
+
+    return 0;
+}
+
+int tcp_setsockopt(int s, int option_name, const void *option_value,
+                   socklen_t option_len)
+{
+    if (!tcp_socket_compliancy(s) || (option_value == NULL) ||
+        (option_len < sizeof(int))) {
+        return -1;
+    }
+
+    tcp_cb_t *tcp_control = &socket_base_get_socket(s)->socket_values.tcp_control;
+
+    switch (option_name) {
+        case TCP_NODELAY: {
+            if (*((const int *) option_value)) {
+                tcp_control->options |= TCP_CB_NODELAY;
+            }
+            else {
+                tcp_control->options &= ~TCP_CB_NODELAY;
+            }
+
+            return 0;
+        }
+
+        default: {
+            return -1;
+        }
+    }
+}
+
+int tcp_listen(int s, int backlog)
+{
     if (tcp_socket_compliancy(s) && socket_base_get_socket(s)->socket_values.tcp_control.state == TCP_CLOSED) {
         socket_internal_t *current_socket = socket_base_get_socket(s);
+        tcp_listen_set_backlog(current_socket, backlog);
         current_socket->socket_values.tcp_control.state = TCP_LISTEN;
         return 0;
     }
@@ -1387,12 +1661,42 @@ int tcp_teardown(socket_internal_t *current_socket)
     ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
     tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
 
+#ifdef TCP_HC
+    tcp_hc_context_remove(current_socket);
+#endif
+
+    if (current_socket->socket_values.tcp_control.state == TCP_LISTEN) {
+        msg_t m_send;
+        kernel_pid_t accepting_pid = current_socket->recv_pid;
+
+        tcp_listen_flush(current_socket);
+        memset(current_socket, 0, sizeof(socket_internal_t));
+
+        /* Wake up a thread waiting in tcp_accept() */
+        if ((accepting_pid != thread_getpid()) &&
+            (thread_getstatus(accepting_pid) == STATUS_RECEIVE_BLOCKED)) {
+            socket_base_net_msg_send(&m_send, accepting_pid, 0, CLOSE_CONN);
+        }
+
+        return 0;
+    }
+
     /* Check for TCP_ESTABLISHED STATE */
     if (current_socket->socket_values.tcp_control.state != TCP_ESTABLISHED) {
+        mutex_lock(&current_socket->tcp_output_mutex);
+        tcp_output_flush(current_socket);
+        mutex_unlock(&current_socket->tcp_output_mutex);
         memset(current_socket, 0, sizeof(socket_internal_t));
         return 0;
     }
 
+    /* coalesced writes go out before the FIN */
+    if (tcp_output_drain(current_socket) < 0) {
+        /* reset or timed out meanwhile */
+        memset(current_socket, 0, sizeof(socket_internal_t));
+        return -1;
+    }
+
     current_socket->send_pid = thread_getpid();
 
     /* Refresh local TCP socket information */
@@ -1420,6 +1724,8 @@ int tcp_init_transport_layer(void)
     global_context_counter = rand();
 #endif
     global_sequence_counter = rand();
+    tcp_listen_init();
+    mutex_init(&tcp_output_vtimer_mutex);
 
     int tcp_thread_pid = thread_create(tcp_stack_buffer, TCP_STACK_SIZE,
                                        PRIORITY_MAIN, CREATE_STACKTEST, tcp_packet_handler, NULL, "tcp_packet_handler");
@@ -1428,6 +1734,7 @@ int tcp_init_transport_layer(void)
         return -1;
     }
 
+    tcp_packet_handler_pid = tcp_thread_pid;
     ipv6_register_next_header_handler(IPV6_PROTO_NUM_TCP, tcp_thread_pid);
 
     if (thread_create(tcp_timer_stack, TCP_TIMER_STACKSIZE, PRIORITY_MAIN + 1,
@@ -97,6 +97,15 @@ extern uint8_t             global_context_counter;
 extern mutex_t             global_sequence_counter_mutex;
 extern uint32_t            global_sequence_counter;
 
+extern tcp_stats_t         tcp_stats_global;
+
+/* Counts an event for the connection *tcp_control* and in the totals */
+#define TCP_STATS_INC(tcp_control, field) \
+    do { \
+        (tcp_control)->stats.field++; \
+        tcp_stats_global.field++; \
+    } while (0)
+
 /* methods usde by socket_base */
 int tcp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid);
 bool tcp_socket_compliancy(int s);
@@ -105,8 +114,49 @@ int tcp_accept(int s, sockaddr6_t *addr, socklen_t *addrlen);
 int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen);
 int tcp_listen(int s, int backlog);
 int32_t tcp_recv(int s, void *buf, uint32_t len, int flags);
+int32_t tcp_recv_loan(int s, uint8_t **buf, int flags);
+int tcp_recv_release(int s);
+int tcp_setsockopt(int s, int option_name, const void *option_value,
+                   socklen_t option_len);
 bool tcp_socket_compliancy(int s);
 int tcp_teardown(socket_internal_t *current_socket);
+uint8_t handle_payload(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                       socket_internal_t *tcp_socket, uint8_t *payload);
+void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *tcp_socket);
+void handle_tcp_rst_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *tcp_socket);
+void handle_tcp_no_flags_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                                socket_internal_t *tcp_socket, uint8_t *payload,
+                                uint8_t tcp_payload_len);
+
+/* methods used by tcp_listen */
+int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
+             ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint8_t payload_length);
+void set_socket_address(sockaddr6_t *sockaddr, uint8_t sin6_family,
+                        uint16_t sin6_port, uint32_t sin6_flowinfo,
+                        ipv6_addr_t *sin6_addr);
+void set_tcp_cb(tcp_cb_t *tcp_control, uint32_t rcv_nxt, uint16_t rcv_wnd,
+                uint32_t send_nxt, uint32_t send_una, uint16_t send_wnd);
+
+/* listen backlog, see tcp_listen.c */
+void tcp_listen_init(void);
+void tcp_listen_set_backlog(socket_internal_t *listener, int backlog);
+void tcp_listen_flush(socket_internal_t *listener);
+void tcp_listen_handle_syn(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *listener);
+void tcp_listen_handle_ack(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *listener);
+socket_internal_t *tcp_listen_pop(socket_internal_t *listener);
+uint32_t tcp_listen_syn_cookie(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header);
+
+/* methods used by tcp_stats */
+void tcp_stats_rtt(tcp_cb_t *tcp_control, uint32_t rtt, uint32_t rto);
+void tcp_stats_handshake(tcp_cb_t *tcp_control, uint32_t duration);
+
+/* methods used by tcp_hc */
+void switch_tcp_packet_byte_order(tcp_hdr_t *current_tcp_packet);
+socket_internal_t *get_tcp_socket(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header);
 
 /**
  * @}
@@ -16,6 +16,7 @@
  */
 
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -29,23 +30,305 @@
 
 #include "tcp_hc.h"
 
+/* LOWPAN_TCPHC dispatch bits: (1|0|0) for mostly compressed and (1|1|0) for
+ * compressed headers, the CID is always 16 bits (1) */
+#define TCP_HC_DISPATCH_MASK        (0xE000)
+#define TCP_HC_DISPATCH_MOSTLY      (0x8000)
+#define TCP_HC_DISPATCH_COMPRESSED  (0xC000)
+#define TCP_HC_CID_16BIT            (0x1000)
+#define TCP_HC_FIN                  (0x0008)
+
+#define TCP_HC_ACK_SHIFT            (8)
+
+#define TCP_HC_CONTEXT_EMPTY        (0)
+#define TCP_HC_CONTEXT_DELETED      (0xFF)
+
+/**
+ * Encoding of one two-bit field selector: *keep* are the bits taken from the
+ * context, *len* bytes starting at bit *shift* are carried inline.
+ */
+typedef struct {
+    uint32_t    keep;
+    uint8_t     shift;
+    uint8_t     len;
+} tcp_hc_mode_t;
+
+/**
+ * Position of a compressible field in the TCP header, the context and the
+ * LOWPAN_TCPHC header.
+ */
+typedef struct {
+    uint8_t             hdr_offset;
+    uint8_t             snd_offset;
+    uint8_t             rcv_offset;
+    uint8_t             size;
+    uint8_t             shift;
+    const tcp_hc_mode_t *modes;
+} tcp_hc_field_t;
+
+/* draft-aayadi-6lowpan-tcphc-01: 5.2. (0|0) elided, (0|1) 8 bits,
+ * (1|0) 16 bits, (1|1) inline */
+static const tcp_hc_mode_t tcp_hc_modes32[4] = {
+    { 0xFFFFFFFF, 0, 0 },
+    { 0xFFFFFF00, 0, 1 },
+    { 0xFFFF0000, 0, 2 },
+    { 0x00000000, 0, 4 },
+};
+
+/* (0|0) elided, (0|1) LSB, (1|0) MSB, (1|1) inline */
+static const tcp_hc_mode_t tcp_hc_modes16[4] = {
+    { 0xFFFF, 0, 0 },
+    { 0xFF00, 0, 1 },
+    { 0x00FF, 8, 1 },
+    { 0x0000, 0, 2 },
+};
+
+static const tcp_hc_field_t tcp_hc_fields[] = {
+    {
+        offsetof(tcp_hdr_t, seq_nr), offsetof(tcp_hc_context_t, seq_snd),
+        offsetof(tcp_hc_context_t, seq_rcv), 4, 10, tcp_hc_modes32
+    },
+    {
+        offsetof(tcp_hdr_t, ack_nr), offsetof(tcp_hc_context_t, ack_snd),
+        offsetof(tcp_hc_context_t, ack_rcv), 4, TCP_HC_ACK_SHIFT, tcp_hc_modes32
+    },
+    {
+        offsetof(tcp_hdr_t, window), offsetof(tcp_hc_context_t, wnd_snd),
+        offsetof(tcp_hc_context_t, wnd_rcv), 2, 6, tcp_hc_modes16
+    },
+};
+
+#define TCP_HC_FIELD_NUMOF  (sizeof(tcp_hc_fields) / sizeof(tcp_hc_fields[0]))
+
+static uint32_t tcp_hc_field_get(const void *base, uint8_t offset, uint8_t size)
+{
+    if (size == 4) {
+        uint32_t value;
+        memcpy(&value, ((const uint8_t *)base) + offset, 4);
+        return value;
+    }
+    else {
+        uint16_t value;
+        memcpy(&value, ((const uint8_t *)base) + offset, 2);
+        return value;
+    }
+}
+
+static void tcp_hc_field_set(void *base, uint8_t offset, uint8_t size,
+                             uint32_t value)
+{
+    if (size == 4) {
+        memcpy(((uint8_t *)base) + offset, &value, 4);
+    }
+    else {
+        uint16_t value16 = (uint16_t) value;
+        memcpy(((uint8_t *)base) + offset, &value16, 2);
+    }
+}
+
+uint16_t tcp_hc_compress_header(uint8_t *buf, const tcp_hdr_t *tcp_header,
+                                const tcp_hc_context_t *context,
+                                uint8_t hc_type)
+{
+    /* Position for first TCP header value, after TCP_HC_Header and Context ID */
+    uint8_t *pos = buf + 4;
+    uint16_t tcp_hc_header = TCP_HC_CID_16BIT;
+
+    if (hc_type == COMPRESSED_HEADER) {
+        tcp_hc_header |= TCP_HC_DISPATCH_COMPRESSED;
+    }
+    else {
+        tcp_hc_header |= TCP_HC_DISPATCH_MOSTLY;
+    }
+
+    for (unsigned i = 0; i < TCP_HC_FIELD_NUMOF; i++) {
+        const tcp_hc_field_t *field = &tcp_hc_fields[i];
+        uint32_t value = tcp_hc_field_get(tcp_header, field->hdr_offset, field->size);
+        uint32_t last = tcp_hc_field_get(context, field->snd_offset, field->size);
+        uint8_t mode = 3;
+
+        /* Pick the shortest encoding whose elided bits match the context */
+        if (hc_type == COMPRESSED_HEADER) {
+            for (mode = 0; mode < 3; mode++) {
+                if ((value & field->modes[mode].keep) ==
+                    (last & field->modes[mode].keep)) {
+                    break;
+                }
+            }
+        }
+
+        tcp_hc_header |= mode << field->shift;
+
+        /* Inline bits go out in network byte order */
+        for (int j = field->modes[mode].len - 1; j >= 0; j--) {
+            *pos++ = (uint8_t)(value >> (field->modes[mode].shift + 8 * j));
+        }
+    }
+
+    if (IS_TCP_FIN(tcp_header->reserved_flags)) {
+        /* F = (1) */
+        tcp_hc_header |= TCP_HC_FIN;
+    }
+
+    /* Copy checksum into buffer */
+    uint16_t cur_chk_sum = HTONS(tcp_header->checksum);
+    memcpy(pos, &cur_chk_sum, 2);
+    pos += 2;
+
+    /* Copy TCP_HC Bytes into buffer */
+    uint16_t cur_tcp_hc_header = HTONS(tcp_hc_header);
+    memcpy(buf, &cur_tcp_hc_header, 2);
+
+    /* Copy TCP_HC Context ID into buffer */
+    uint16_t cur_context_id = HTONS(context->context_id);
+    memcpy(buf + 2, &cur_context_id, 2);
+
+    return pos - buf;
+}
+
+uint16_t tcp_hc_decompress_header(tcp_hdr_t *tcp_header, const uint8_t *buf,
+                                  const tcp_hc_context_t *context)
+{
+    const uint8_t *pos = buf + 4;
+    uint16_t tcp_hc_header;
+
+    /* Copy TCP_HC header into local variable */
+    memcpy(&tcp_hc_header, buf, 2);
+    tcp_hc_header = NTOHS(tcp_hc_header);
+
+    for (unsigned i = 0; i < TCP_HC_FIELD_NUMOF; i++) {
+        const tcp_hc_field_t *field = &tcp_hc_fields[i];
+        uint8_t mode = (tcp_hc_header >> field->shift) & 0x03;
+        uint32_t inline_bits = 0;
+
+        for (unsigned j = 0; j < field->modes[mode].len; j++) {
+            inline_bits = (inline_bits << 8) | *pos++;
+        }
+
+        uint32_t last = tcp_hc_field_get(context, field->rcv_offset, field->size);
+        tcp_hc_field_set(tcp_header, field->hdr_offset, field->size,
+                         (last & field->modes[mode].keep) |
+                         (inline_bits << field->modes[mode].shift));
+    }
+
+    /* A transmitted acknowledgment number implies the ACK flag, mostly
+     * compressed headers carry it always */
+    uint8_t ack_mode = (tcp_hc_header >> TCP_HC_ACK_SHIFT) & 0x03;
+
+    if (((ack_mode == 1) || (ack_mode == 2)) ||
+        ((ack_mode == 3) && ((tcp_hc_header & TCP_HC_DISPATCH_MASK) ==
+                             TCP_HC_DISPATCH_COMPRESSED))) {
+        SET_TCP_ACK(tcp_header->reserved_flags);
+    }
+
+    /* FIN flag */
+    if (tcp_hc_header & TCP_HC_FIN) {
+        /* F = (1) */
+        if (IS_TCP_ACK(tcp_header->reserved_flags)) {
+            SET_TCP_FIN_ACK(tcp_header->reserved_flags);
+        }
+        else {
+            SET_TCP_FIN(tcp_header->reserved_flags);
+        }
+    }
+
+    /* Copy checksum into into tcp header */
+    memcpy(&tcp_header->checksum, pos, 2);
+    tcp_header->checksum = NTOHS(tcp_header->checksum);
+    pos += 2;
+
+    return pos - buf;
+}
+
 #ifdef TCP_HC
 
+/* socket IDs indexed by context ID, probed linearly */
+static uint8_t tcp_hc_context_table[TCP_HC_CONTEXT_TABLE_SIZE];
+
+static bool tcp_hc_context_matches(socket_internal_t *temp_socket,
+                                   ipv6_hdr_t *current_ipv6_header,
+                                   uint16_t current_context)
+{
+    return ((temp_socket != NULL) &&
+            ipv6_addr_is_equal(&temp_socket->socket_values.foreign_address.sin6_addr,
+                               &current_ipv6_header->srcaddr) &&
+            ipv6_addr_is_equal(&temp_socket->socket_values.local_address.sin6_addr,
+                               &current_ipv6_header->destaddr) &&
+            (temp_socket->socket_values.tcp_control.tcp_context.context_id ==
+             current_context));
+}
+
+void tcp_hc_context_add(socket_internal_t *current_socket)
+{
+    uint16_t context_id = current_socket->socket_values.tcp_control.tcp_context.context_id;
+    int free_slot = -1;
+
+    for (int i = 0; i < TCP_HC_CONTEXT_TABLE_SIZE; i++) {
+        int slot = (context_id + i) & (TCP_HC_CONTEXT_TABLE_SIZE - 1);
+
+        if (tcp_hc_context_table[slot] == current_socket->socket_id) {
+            return;
+        }
+
+        if ((tcp_hc_context_table[slot] == TCP_HC_CONTEXT_DELETED) &&
+            (free_slot < 0)) {
+            free_slot = slot;
+        }
+        else if (tcp_hc_context_table[slot] == TCP_HC_CONTEXT_EMPTY) {
+            if (free_slot < 0) {
+                free_slot = slot;
+            }
+
+            break;
+        }
+    }
+
+    if (free_slot >= 0) {
+        tcp_hc_context_table[free_slot] = current_socket->socket_id;
+    }
+}
+
+void tcp_hc_context_remove(socket_internal_t *current_socket)
+{
+    for (int i = 0; i < TCP_HC_CONTEXT_TABLE_SIZE; i++) {
+        if (tcp_hc_context_table[i] == current_socket->socket_id) {
+            tcp_hc_context_table[i] = TCP_HC_CONTEXT_DELETED;
+        }
+    }
+}
+
 socket_internal_t *get_tcp_socket_by_context(ipv6_hdr_t *current_ipv6_header,
         uint16_t current_context)
 {
     socket_internal_t *temp_socket;
 
+    for (int i = 0; i < TCP_HC_CONTEXT_TABLE_SIZE; i++) {
+        int slot = (current_context + i) & (TCP_HC_CONTEXT_TABLE_SIZE - 1);
+
+        if (tcp_hc_context_table[slot] == TCP_HC_CONTEXT_EMPTY) {
+            break;
+        }
+
+        if (tcp_hc_context_table[slot] == TCP_HC_CONTEXT_DELETED) {
+            continue;
+        }
+
+        /* sockets are cleared without leaving the table, so verify the entry */
+        temp_socket = socket_base_get_socket(tcp_hc_context_table[slot]);
+
+        if (tcp_hc_context_matches(temp_socket, current_ipv6_header,
+                                   current_context)) {
+            return temp_socket;
+        }
+    }
+
+    /* Context not cached yet, fall back to scanning the sockets */
     for (int i = 1; i < MAX_SOCKETS + 1; i++) {
         temp_socket = socket_base_get_socket(i);
 
-        if ((temp_socket != NULL) &&
-            ipv6_addr_is_equal(&temp_socket->socket_values.foreign_address.sin6_addr,
-                               &current_ipv6_header->srcaddr) &&
-            ipv6_addr_is_equal(&temp_socket->socket_values.local_address.sin6_addr,
-                               &current_ipv6_header->destaddr) &&
-            (temp_socket->socket_values.tcp_control.tcp_context.context_id ==
-             current_context)) {
+        if (tcp_hc_context_matches(temp_socket, current_ipv6_header,
+                                   current_context)) {
+            tcp_hc_context_add(temp_socket);
             return temp_socket;
         }
     }
@@ -77,9 +360,11 @@ uint16_t compress_tcp_packet(socket_internal_t *current_socket,
                              uint8_t flags,
                              uint8_t payload_length)
 {
+    (void) temp_ipv6_header;
+    (void) flags;
+
     socket_t *current_tcp_socket = &current_socket->socket_values;
     tcp_hc_context_t *tcp_context = &current_tcp_socket->tcp_control.tcp_context;
-    tcp_cb_t *tcp_cb = &current_tcp_socket->tcp_control;
     tcp_hdr_t full_tcp_header;
     uint16_t packet_size = 0;
 
@@ -113,191 +398,28 @@ uint16_t compress_tcp_packet(socket_internal_t *current_socket,
 
         return packet_size;
     }
-    /* Check for header compression type: COMPRESSED_HEADER */
-    else if (tcp_context->hc_type == COMPRESSED_HEADER) {
-        /* draft-aayadi-6lowpan-tcphc-01: 5.1 Compressed header TCP segment. */
-
-        /* Temporary variable for TCP_HC_Header Bytes */
-        uint16_t tcp_hc_header = 0x0000;
-
+    /* draft-aayadi-6lowpan-tcphc-01: 5.1 Compressed header TCP segment. */
+    else if ((tcp_context->hc_type == COMPRESSED_HEADER) ||
+             (tcp_context->hc_type == MOSTLY_COMPRESSED_HEADER)) {
         /* Save TCP_Header to refresh TCP Context values after compressing the
          * packet */
         memcpy(&full_tcp_header, current_tcp_packet, TCP_HDR_LEN);
 
-        /* Temporary variable for storing TCP header beginning */
-        uint8_t *tcp_packet_begin = current_tcp_packet;
-
-        /* Position for first TCP header value, TCP_HC_Header and Context ID */
-        current_tcp_packet += 4;
-
-        /* Packet size value */
-        packet_size += 4;
-
-        /* 5.2.  LOWPAN_TCPHC Format */
-
-        /* First 3 bits of TCP_HC_Header are not exactly specified. In this
-         * implementation they are (1|1|0) * for compressed headers and the
-         * CID is always 16 bits (1) */
-        /* (1|1|0|1) = D */
-        tcp_hc_header |= 0xD000;
-
-        /*----------------------------------*/
-        /*|     Sequence number handling   |*/
-        /*----------------------------------*/
-        if (full_tcp_header.seq_nr == tcp_context->seq_snd) {
-            /* Nothing to do, Seq = (0|0) */
-        }
-        /* If the 24 most significant bits haven't changed from previous
-         * packet, don't transmit them */
-        else if ((full_tcp_header.seq_nr & 0xFFFFFF00) == (tcp_context->seq_snd &
-                 0xFFFFFF00)) {
-            /* Seq = (0|1) */
-            tcp_hc_header |= 0x0400;
-
-            /* Copy first 8 less significant bits of sequence number into
-             * buffer */
-            *current_tcp_packet = (uint8_t)(full_tcp_header.seq_nr & 0x000000FF);
-            current_tcp_packet += 1;
-            packet_size += 1;
-        }
-        /* If the 16 most significant bits haven't changed from previous packet,
-         * don't transmit them */
-        else if ((full_tcp_header.seq_nr & 0xFFFF0000) == (tcp_context->seq_snd & 0xFFFF0000)) {
-            /* Seq = (1|0) */
-            tcp_hc_header |= 0x0800;
-
-            /* Copy first 16 less significant bits of sequence number into buffer */
-            *((uint16_t *)current_tcp_packet) =
-                HTONS((uint16_t)(full_tcp_header.seq_nr & 0x0000FFFF));
-            current_tcp_packet += 2;
-            packet_size += 2;
-        }
-        /* Sending uncompressed sequence number */
-        else {
-            /* Seq = (1|1) */
-            tcp_hc_header |= 0x0C00;
-
-            /* Copy all bits of sequence number into buffer */
-            uint32_t cur_seq_no = HTONL(full_tcp_header.seq_nr);
-            memcpy(current_tcp_packet, &cur_seq_no, 4);
-            current_tcp_packet += 4;
-            packet_size += 4;
-        }
-
-        /*----------------------------------*/
-        /*| Acknowledgment number handling |*/
-        /*----------------------------------*/
-        if ((IS_TCP_ACK(full_tcp_header.reserved_flags) &&
-             (tcp_cb->tcp_context.ack_snd == full_tcp_header.ack_nr))) {
+        if ((tcp_context->hc_type == COMPRESSED_HEADER) &&
+            IS_TCP_ACK(full_tcp_header.reserved_flags) &&
+            (tcp_context->ack_snd == full_tcp_header.ack_nr)) {
             tcp_context->ack_snd = tcp_context->seq_rcv;
         }
 
-        if (full_tcp_header.ack_nr == tcp_context->ack_snd) {
-            /* Nothing to do, Ack = (0|0) */
-        }
-        /* If the 24 most significant bits haven't changed from previous packet,
-         * don't transmit them */
-        else if ((full_tcp_header.ack_nr & 0xFFFFFF00) == (tcp_context->ack_snd &
-                 0xFFFFFF00)) {
-            /* Ack = (0|1) */
-            tcp_hc_header |= 0x0100;
-
-            /* Copy first 8 less significant bits of acknowledgment number into
-             * buffer */
-            *current_tcp_packet = (uint8_t)(full_tcp_header.ack_nr & 0x000000FF);
-            current_tcp_packet += 1;
-            packet_size += 1;
-        }
-        /* If the 16 most significant bits haven't changed from previous packet,
-         * don't transmit them */
-        else if ((full_tcp_header.ack_nr & 0xFFFF0000) == (tcp_context->ack_snd &
-                 0xFFFF0000)) {
-            /* Ack = (1|0) */
-            tcp_hc_header |= 0x0200;
-
-            /* Copy first 16 less significant bits of acknowledgment number
-             * into buffer */
-            *((uint16_t *)current_tcp_packet) =
-                HTONS((uint16_t)(full_tcp_header.ack_nr & 0x0000FFFF));
-            current_tcp_packet += 2;
-            packet_size += 2;
-        }
-        /* Sending uncompressed acknowledgment number */
-        else {
-            /* Ack = (1|1) */
-            tcp_hc_header |= 0x0300;
-
-            /* Copy all bits of acknowledgment number into buffer */
-            uint32_t cur_ack_nr = HTONL(full_tcp_header.ack_nr);
-            memcpy(current_tcp_packet, &cur_ack_nr, 4);
-            current_tcp_packet += 4;
-            packet_size += 4;
-        }
-
-        /*----------------------------------*/
-        /*|         Window handling        |*/
-        /*----------------------------------*/
-        if (full_tcp_header.window == tcp_context->wnd_snd) {
-            /* Nothing to do, Wnd = (0|0) */
-        }
-        /* If the 8 most significant bits haven't changed from previous packet,
-         * don't transmit them */
-        else if ((full_tcp_header.window & 0xFF00) == (tcp_context->wnd_snd & 0xFF00)) {
-            /* Wnd = (0|1) */
-            tcp_hc_header |= 0x0040;
-
-            /* Copy first 8 less significant bits of window size into buffer */
-            *current_tcp_packet = (uint8_t)(full_tcp_header.window & 0x00FF);
-            current_tcp_packet += 1;
-            packet_size += 1;
-        }
-        /* If the 8 less significant bits haven't changed from previous packet,
-         * don't transmit them */
-        else if ((full_tcp_header.window & 0x00FF) == (tcp_context->wnd_snd &
-                 0x00FF)) {
-            /* Wnd = (1|0) */
-            tcp_hc_header |= 0x0080;
-
-            /* Copy first 8 most significant bits of window size into buffer */
-            *current_tcp_packet = (uint8_t)(full_tcp_header.window & 0xFF00);
-            current_tcp_packet += 1;
-            packet_size += 1;
-        }
-        /* Sending uncompressed window */
-        else {
-            /* Wnd = (1|1) */
-            tcp_hc_header |= 0x00C0;
-
-            /* Copy all bits of window size into buffer */
-            uint16_t cur_window = HTONS(full_tcp_header.window);
-            memcpy(current_tcp_packet, &cur_window, 2);
-            current_tcp_packet += 2;
-            packet_size += 2;
-        }
-
-        /* FIN flag */
-        if (IS_TCP_FIN(full_tcp_header.reserved_flags)) {
-            /* F = (1) */
-            tcp_hc_header |= 0x0008;
-        }
-
-        /* Copy checksum into buffer */
-        uint16_t cur_chk_sum = HTONS(full_tcp_header.checksum);
-        memcpy(current_tcp_packet, &cur_chk_sum, 2);
-        current_tcp_packet += 2;
-        packet_size += 2;
-
-        /* Copy TCP_HC Bytes into buffer */
-        uint16_t cur_tcp_hc_header = HTONS(tcp_hc_header);
-        memcpy(tcp_packet_begin, &cur_tcp_hc_header, 2);
-
-        /* Copy TCP_HC Context ID into buffer */
-        uint16_t cur_context_id = HTONS(tcp_context->context_id);
-        memcpy(tcp_packet_begin + 2, &cur_context_id, 2);
+        /* The compressed header is never longer than the TCP header it
+         * replaces, so the payload is only moved towards the front */
+        packet_size = tcp_hc_compress_header(current_tcp_packet,
+                                             &full_tcp_header, tcp_context,
+                                             tcp_context->hc_type);
 
         /* Move payload to end of tcp header */
-        memmove(current_tcp_packet, tcp_packet_begin + TCP_HDR_LEN,
-                payload_length);
+        memmove(current_tcp_packet + packet_size,
+                current_tcp_packet + TCP_HDR_LEN, payload_length);
 
         /* Adding TCP payload length to TCP_HC header length */
         packet_size += payload_length;
@@ -306,101 +428,6 @@ uint16_t compress_tcp_packet(socket_internal_t *current_socket,
 
         return packet_size;
     }
-    /* Check for header compression type: MOSTLY_COMPRESSED_HEADER */
-    else if (tcp_context->hc_type == MOSTLY_COMPRESSED_HEADER) {
-        /* draft-aayadi-6lowpan-tcphc-01: 5.1 Compressed header TCP segment. */
-
-        /* Temporary variable for TCP_HC_Header Bytes */
-        uint16_t tcp_hc_header = 0x0000;
-
-        /* Save TCP_Header to refresh TCP Context values after compressing the
-         * packet */
-        memcpy(&full_tcp_header, current_tcp_packet, TCP_HDR_LEN);
-
-        /* Temporary variable for storing TCP header beginning */
-        uint8_t *tcp_packet_begin = current_tcp_packet;
-
-        /* Position for first TCP header value, TCP_HC_Header and Context ID */
-        current_tcp_packet += 4;
-
-        /* Packet size value */
-        packet_size += 4;
-
-        /* 5.2.  LOWPAN_TCPHC Format */
-
-        /* First 3 bits of TCP_HC_Header are not exactly specified. In this
-         * implementation they are (1|0|0) for mostly compressed headers and
-         * the CID is always 16 bits (1) */
-        /* (1|0|0|1) = 9 */
-        tcp_hc_header |= 0x9000;
-
-        /*----------------------------------*/
-        /*|     Sequence number handling   |*/
-        /*----------------------------------*/
-        /* Sending uncompressed sequence number */
-        /* Seq = (1|1) */
-        tcp_hc_header |= 0x0C00;
-
-        /* Copy all bits of sequence number into buffer */
-        uint32_t cur_seq_no = HTONL(full_tcp_header.seq_nr);
-        memcpy(current_tcp_packet, &cur_seq_no, 4);
-        current_tcp_packet += 4;
-        packet_size += 4;
-
-        /*----------------------------------*/
-        /*| Acknowledgment number handling |*/
-        /*----------------------------------*/
-        /* Ack = (1|1) */
-        tcp_hc_header |= 0x0300;
-
-        /* Copy all bits of acknowledgment number into buffer */
-        uint32_t cur_ack_nr = HTONL(full_tcp_header.ack_nr);
-        memcpy(current_tcp_packet, &cur_ack_nr, 4);
-        current_tcp_packet += 4;
-        packet_size += 4;
-
-        /*----------------------------------*/
-        /*|         Window handling        |*/
-        /*----------------------------------*/
-        /* Wnd = (1|1) */
-        tcp_hc_header |= 0x00C0;
-
-        /* Copy all bits of window size into buffer */
-        uint16_t cur_window = HTONS(full_tcp_header.window);
-        memcpy(current_tcp_packet, &cur_window, 2);
-        current_tcp_packet += 2;
-        packet_size += 2;
-
-        /* FIN flag */
-        if (IS_TCP_FIN(full_tcp_header.reserved_flags)) {
-            /* F = (1) */
-            tcp_hc_header |= 0x0008;
-        }
-
-        /* Copy checksum into buffer */
-        uint16_t cur_chk_sum = HTONS(full_tcp_header.checksum);
-        memcpy(current_tcp_packet, &cur_chk_sum, 2);
-        current_tcp_packet += 2;
-        packet_size += 2;
-
-        /* Copy TCP_HC Bytes into buffer */
-        uint16_t cur_tcp_hc_header = HTONS(tcp_hc_header);
-        memcpy(tcp_packet_begin, &cur_tcp_hc_header, 2);
-
-        /* Copy TCP_HC Context ID into buffer */
-        uint16_t cur_context_id = HTONS(tcp_context->context_id);
-        memcpy(tcp_packet_begin + 2, &cur_context_id, 2);
-
-        /* Move payload to end of tcp header */
-        memmove(current_tcp_packet, tcp_packet_begin + TCP_HDR_LEN,
-                payload_length);
-
-        /* Adding TCP payload length to TCP_HC header length */
-        packet_size += payload_length;
-
-        update_tcp_hc_context(false, current_socket, &full_tcp_header);
-        return packet_size;
-    }
 
     return 0;
 }
@@ -408,7 +435,6 @@ uint16_t compress_tcp_packet(socket_internal_t *current_socket,
 socket_internal_t *decompress_tcp_packet(ipv6_hdr_t *temp_ipv6_header)
 {
     uint8_t *packet_buffer = ((uint8_t *)temp_ipv6_header) + IPV6_HDR_LEN;
-    uint16_t tcp_hc_header;
     socket_internal_t *current_socket = NULL;
 
     /* Full header TCP segment */
@@ -420,7 +446,7 @@ socket_internal_t *decompress_tcp_packet(ipv6_hdr_t *temp_ipv6_header)
                                                 IPV6_HDR_LEN + 3)));
 
         if (current_socket != NULL) {
-            if (current_socket->socket_values.tcp_control.state == LISTEN) {
+            if (current_socket->socket_values.tcp_control.state == TCP_LISTEN) {
                 memcpy(&current_socket->socket_values.tcp_control.tcp_context.context_id,
                        ((uint8_t *)temp_ipv6_header) + IPV6_HDR_LEN + 1, 2);
                 current_socket->socket_values.tcp_control.tcp_context.context_id =
@@ -441,7 +467,7 @@ socket_internal_t *decompress_tcp_packet(ipv6_hdr_t *temp_ipv6_header)
     }
     /* Compressed header TCP segment */
     else {
-        uint16_t packet_size = 0;
+        uint16_t packet_size;
 
         /* Temporary TCP Header */
         tcp_hdr_t full_tcp_header;
@@ -452,163 +478,18 @@ socket_internal_t *decompress_tcp_packet(ipv6_hdr_t *temp_ipv6_header)
         memcpy(&current_context, (packet_buffer + 2), 2);
         current_context = NTOHS(current_context);
 
-        /* Copy TCP_HC header into local variable
-         * (1,0,0,1|SEQ,SEQ,0)(1,0,0,1|0,0,0,0) */
-        memcpy(&tcp_hc_header, packet_buffer, 2);
-        tcp_hc_header = NTOHS(tcp_hc_header);
-
-        uint8_t header_type = UNDEFINED;
-
-        if (BITSET(tcp_hc_header, 15) && !BITSET(tcp_hc_header, 14) &&
-            !BITSET(tcp_hc_header, 13)) {
-            header_type = MOSTLY_COMPRESSED_HEADER;
-        }
-        else if (BITSET(tcp_hc_header, 15) && BITSET(tcp_hc_header, 14) &&
-                 !BITSET(tcp_hc_header, 13)) {
-            header_type = COMPRESSED_HEADER;
-        }
-
-        /* Setting pointer to first tcp_hc field */
-        packet_buffer += 4;
-        packet_size += 4;
-
         /* Current socket */
-        socket_internal_t *current_socket =
-            get_tcp_socket_by_context(temp_ipv6_header, current_context);
+        current_socket = get_tcp_socket_by_context(temp_ipv6_header,
+                                                   current_context);
 
         if (current_socket == NULL) {
             printf("Current Socket == NULL!\n");
             return NULL;
         }
 
-        /* Current TCP Context values */
-        tcp_hc_context_t *current_tcp_context =
-            &current_socket->socket_values.tcp_control.tcp_context;
-
-        /*----------------------------------*/
-        /*|     Sequence number handling   |*/
-        /*----------------------------------*/
-        if (!BITSET(tcp_hc_header, 11) && !BITSET(tcp_hc_header, 10)) {
-            /* Seq = (0|0), sequence number didn't change, copy old value */
-            memcpy(&full_tcp_header.seq_nr, &current_tcp_context->seq_rcv, 4);
-        }
-        /* The 24 most significant bits haven't changed from previous packet */
-        else if (!BITSET(tcp_hc_header, 11) && BITSET(tcp_hc_header, 10)) {
-            /* Seq = (0|1), copy 1 byte of tcp_hc packet and 3 bytes from
-             * previous packet */
-            full_tcp_header.seq_nr |= *packet_buffer;
-            full_tcp_header.seq_nr |= ((current_tcp_context->seq_rcv) &
-                                       0xFFFFFF00);
-            packet_buffer += 1;
-            packet_size += 1;
-        }
-        /* If the 16 most significant bits haven't changed from previous packet */
-        else if (BITSET(tcp_hc_header, 11) && !BITSET(tcp_hc_header, 10)) {
-            /* Seq = (1|0), copy 2 bytes of tcp_hc packet and 2 bytes from
-             * previous packet */
-            full_tcp_header.seq_nr |= NTOHS(*((uint16_t *)packet_buffer));
-            full_tcp_header.seq_nr |= ((current_tcp_context->seq_rcv) & 0xFFFF0000);
-            packet_buffer += 2;
-            packet_size += 2;
-        }
-        /* Sending uncompressed sequence number */
-        else {
-            /* Seq = (1|1), copy 4 bytes of tcp_hc packet */
-            memcpy(&full_tcp_header.seq_nr, packet_buffer, 4);
-            full_tcp_header.seq_nr = NTOHL(full_tcp_header.seq_nr);
-            packet_buffer += 4;
-            packet_size += 4;
-        }
-
-        /*----------------------------------*/
-        /*| Acknowledgment number handling |*/
-        /*----------------------------------*/
-        if (!BITSET(tcp_hc_header, 9) && !BITSET(tcp_hc_header, 8)) {
-            /* Ack = (0|0), acknowledgment number didn't change, copy old value */
-            memcpy(&full_tcp_header.ack_nr, &current_tcp_context->ack_rcv, 4);
-        }
-        /* The 24 most significant bits haven't changed from previous packet */
-        else if (!BITSET(tcp_hc_header, 9) && BITSET(tcp_hc_header, 8)) {
-            /* Ack = (0|1), copy 1 byte of tcp_hc packet and 3 bytes from
-             * previous packet */
-            full_tcp_header.ack_nr |= *packet_buffer;
-            full_tcp_header.ack_nr |= ((current_tcp_context->ack_rcv) & 0xFFFFFF00);
-            packet_buffer += 1;
-            packet_size += 1;
-            SET_TCP_ACK(full_tcp_header.reserved_flags);
-        }
-        /* If the 16 most significant bits haven't changed from previous packet */
-        else if (BITSET(tcp_hc_header, 9) && !BITSET(tcp_hc_header, 8)) {
-            /* Ack = (1|0), copy 2 bytes of tcp_hc packet and 2 bytes from
-             * previous packet */
-            full_tcp_header.ack_nr |= NTOHS(*((uint16_t *)packet_buffer));
-            full_tcp_header.ack_nr |= ((current_tcp_context->ack_rcv) & 0xFFFF0000);
-            packet_buffer += 2;
-            packet_size += 2;
-            SET_TCP_ACK(full_tcp_header.reserved_flags);
-        }
-        /* Sending uncompressed acknowledgment number */
-        else {
-            /* Ack = (1|1), copy 4 bytes of tcp_hc packet */
-            memcpy(&full_tcp_header.ack_nr, packet_buffer, 4);
-            full_tcp_header.ack_nr = NTOHL(full_tcp_header.ack_nr);
-            packet_buffer += 4;
-            packet_size += 4;
-
-            if (header_type == COMPRESSED_HEADER) {
-                SET_TCP_ACK(full_tcp_header.reserved_flags);
-            }
-        }
-
-        /*----------------------------------*/
-        /*|         Window handling        |*/
-        /*----------------------------------*/
-        if (!BITSET(tcp_hc_header, 7) && !BITSET(tcp_hc_header, 6)) {
-            /* Wnd = (0|0), copy old value */
-            memcpy(&full_tcp_header.window, &current_tcp_context->wnd_rcv, 2);
-        }
-        /* The 8 most significant bits haven't changed from previous packet */
-        else if (!BITSET(tcp_hc_header, 7) && BITSET(tcp_hc_header, 6)) {
-            /* Wnd = (0|1), copy 1 byte of tcp_hc packet and 1 byte from
-             * previous packet */
-            full_tcp_header.window |= *packet_buffer;
-            full_tcp_header.window |= ((current_tcp_context->wnd_rcv) & 0xFF00);
-            packet_buffer += 1;
-            packet_size += 1;
-        }
-        /* If the 8 less significant bits haven't changed from previous packet */
-        else if (BITSET(tcp_hc_header, 7) && !BITSET(tcp_hc_header, 6)) {
-            /* Wnd = (1|0), copy 1 byte of tcp_hc packet and 1 byte from previous packet */
-            full_tcp_header.window |= ((*((uint16_t *)packet_buffer)) & 0xFF00);
-            full_tcp_header.window |= ((current_tcp_context->wnd_rcv) & 0x00FF);
-            packet_buffer += 1;
-            packet_size += 1;
-        }
-        /* Sending uncompressed window size */
-        else {
-            /* Wnd = (1|1), copy 2 bytes of tcp_hc packet */
-            memcpy(&full_tcp_header.window, packet_buffer, 2);
-            full_tcp_header.window = NTOHS(full_tcp_header.window);
-            packet_buffer += 2;
-            packet_size += 2;
-        }
-
-        /* FIN flag */
-        if (BITSET(tcp_hc_header, 3)) {
-            /* F = (1) */
-            if (IS_TCP_ACK(full_tcp_header.reserved_flags)) {
-                SET_TCP_FIN_ACK(full_tcp_header.reserved_flags);
-            }
-            else {
-                SET_TCP_FIN(full_tcp_header.reserved_flags);
-            }
-        }
-
-        /* Copy checksum into into tcp header */
-        memcpy(&full_tcp_header.checksum, packet_buffer, 2);
-        full_tcp_header.checksum = NTOHS(full_tcp_header.checksum);
-        packet_buffer += 2;
-        packet_size += 2;
+        packet_size = tcp_hc_decompress_header(&full_tcp_header, packet_buffer,
+                                               &current_socket->socket_values.tcp_control.tcp_context);
+        packet_buffer += packet_size;
 
         /* Copy dest. and src. port into tcp header */
         memcpy(&full_tcp_header.dst_port,
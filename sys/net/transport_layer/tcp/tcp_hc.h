@@ -20,15 +20,75 @@
 
 #include "tcp.h"
 
-#ifdef TCP_HC
-
 #define FULL_HEADER                 1
 #define MOSTLY_COMPRESSED_HEADER    2
 #define COMPRESSED_HEADER           3
 
+/* Size of the context ID indexed socket table, must be a power of 2 and
+ * bigger than MAX_SOCKETS */
+#ifndef TCP_HC_CONTEXT_TABLE_SIZE
+#define TCP_HC_CONTEXT_TABLE_SIZE   (8)
+#endif
+
+/* Maximum size of a LOWPAN_TCPHC header (dispatch, CID, seq, ack, window,
+ * checksum) */
+#define TCP_HC_MAX_HDR_LEN          (16)
+
+/**
+ * @brief   Writes the LOWPAN_TCPHC header for *tcp_header* into *buf*.
+ *
+ * Fields are encoded relative to the last sent values stored in *context*.
+ *
+ * @param[out] buf          Buffer of at least TCP_HC_MAX_HDR_LEN bytes.
+ * @param[in] tcp_header    Uncompressed TCP header in host byte order.
+ * @param[in] context       TCP_HC context of the connection.
+ * @param[in] hc_type       COMPRESSED_HEADER or MOSTLY_COMPRESSED_HEADER.
+ *
+ * @return  Length of the compressed header in bytes.
+ */
+uint16_t tcp_hc_compress_header(uint8_t *buf, const tcp_hdr_t *tcp_header,
+                                const tcp_hc_context_t *context,
+                                uint8_t hc_type);
+
+/**
+ * @brief   Restores sequence number, acknowledgment number, window, flags
+ *          and checksum of *tcp_header* from the LOWPAN_TCPHC header in *buf*.
+ *
+ * Elided fields are taken from the last received values stored in *context*.
+ *
+ * @param[out] tcp_header   TCP header to fill in host byte order.
+ * @param[in] buf           LOWPAN_TCPHC header.
+ * @param[in] context       TCP_HC context of the connection.
+ *
+ * @return  Number of bytes consumed from *buf*.
+ */
+uint16_t tcp_hc_decompress_header(tcp_hdr_t *tcp_header, const uint8_t *buf,
+                                  const tcp_hc_context_t *context);
+
+#ifdef TCP_HC
 void update_tcp_hc_context(bool incoming, socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet);
 uint16_t compress_tcp_packet(socket_internal_t *current_socket, uint8_t *current_tcp_packet, ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint8_t payload_length);
 socket_internal_t *decompress_tcp_packet(ipv6_hdr_t *temp_ipv6_header);
+void printf_tcp_context(tcp_hc_context_t *current_tcp_context);
+
+/**
+ * @brief   Enters *current_socket* into the context ID indexed socket table.
+ */
+void tcp_hc_context_add(socket_internal_t *current_socket);
+
+/**
+ * @brief   Removes *current_socket* from the context ID indexed socket table.
+ */
+void tcp_hc_context_remove(socket_internal_t *current_socket);
+
+/**
+ * @brief   Looks up the socket the compressed segment in *current_ipv6_header*
+ *          with context ID *current_context* belongs to.
+ *
+ * @return  The matching socket, NULL if there is none.
+ */
+socket_internal_t *get_tcp_socket_by_context(ipv6_hdr_t *current_ipv6_header,
+        uint16_t current_context);
 #endif
 #endif /* TCP_HC_H_ */
 /**
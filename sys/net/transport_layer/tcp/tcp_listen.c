@@ -0,0 +1,449 @@
+/**
+ * TCP listen backlog
+ *
+ * Copyright (C) 2014  Freie Universität Berlin.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup tcp
+ * @{
+ * @file    tcp_listen.c
+ * @brief   SYN queue, accept queue and SYN cookies of listening sockets
+ *
+ * Half-open connections are kept as small records in a SYN queue shared by
+ * all listeners, a socket is only taken from the socket table once the
+ * three way handshake completed. Such sockets wait in the accept queue of
+ * their listener until tcp_accept() picks them up. A listener whose backlog
+ * or the SYN queue is full answers with a SYN cookie instead, so a SYN
+ * flood cannot take up any state.
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "vtimer.h"
+
+#include "socket_base/in.h"
+
+#include "net_help.h"
+
+#include "msg_help.h"
+#include "socket.h"
+#include "tcp_hc.h"
+#include "tcp_timer.h"
+
+#include "tcp.h"
+
+/* Half-open connections of all listeners */
+#ifndef TCP_SYN_QUEUE_SIZE
+#define TCP_SYN_QUEUE_SIZE      (4)
+#endif
+
+/* Age after which a half-open connection may be dropped, the peer sends its
+ * SYN again and gets a new SYN-ACK until then */
+#define TCP_SYN_QUEUE_TIMEOUT   (TCP_SYN_TIMEOUT)
+
+/* SYN cookie layout: 5 bit time counter, 3 bit MSS index, 24 bit hash */
+#define TCP_SYN_COOKIE_PERIOD   (64)    /* seconds per counter step */
+#define TCP_SYN_COOKIE_COUNTER  (27)
+#define TCP_SYN_COOKIE_MSS      (24)
+#define TCP_SYN_COOKIE_HASH     (0x00FFFFFF)
+
+typedef struct {
+    uint8_t     listener;       /* socket ID of the listener, 0 if unused */
+    uint16_t    foreign_port;
+    ipv6_addr_t foreign_addr;
+    ipv6_addr_t local_addr;
+    uint32_t    irs;
+    uint32_t    iss;
+    uint16_t    mss;
+    timex_t     time;
+} tcp_syn_entry_t;
+
+static const uint16_t tcp_syn_cookie_mss[] = {
+    32, 48, 64, 96, 128, 256, 536, 1220
+};
+
+static tcp_syn_entry_t tcp_syn_queue[TCP_SYN_QUEUE_SIZE];
+static mutex_t tcp_listen_mutex;
+static uint32_t tcp_syn_cookie_secret;
+
+/* SYN-ACKs are sent for connections that have no socket yet */
+static socket_internal_t tcp_syn_ack_socket;
+
+void tcp_listen_init(void)
+{
+    mutex_init(&tcp_listen_mutex);
+    tcp_syn_cookie_secret = ((uint32_t) rand() << 16) ^ rand();
+}
+
+void tcp_listen_set_backlog(socket_internal_t *listener, int backlog)
+{
+    tcp_listen_queue_t *queue = &listener->tcp_listen_queue;
+
+    if (backlog < 1) {
+        backlog = 1;
+    }
+    else if (backlog > TCP_MAX_BACKLOG) {
+        backlog = TCP_MAX_BACKLOG;
+    }
+
+    memset(queue, 0, sizeof(tcp_listen_queue_t));
+    queue->backlog = backlog;
+}
+
+void tcp_listen_flush(socket_internal_t *listener)
+{
+    tcp_listen_queue_t *queue = &listener->tcp_listen_queue;
+
+    mutex_lock(&tcp_listen_mutex);
+
+    for (int i = 0; i < TCP_SYN_QUEUE_SIZE; i++) {
+        if (tcp_syn_queue[i].listener == listener->socket_id) {
+            tcp_syn_queue[i].listener = 0;
+        }
+    }
+
+    /* established connections nobody accepted */
+    while (queue->accept_count > 0) {
+        socket_internal_t *sock =
+            socket_base_get_socket(queue->accept_queue[queue->accept_head]);
+
+        if (sock != NULL) {
+#ifdef TCP_HC
+            tcp_hc_context_remove(sock);
+#endif
+            memset(sock, 0, sizeof(socket_internal_t));
+        }
+
+        queue->accept_head = (queue->accept_head + 1) % TCP_MAX_BACKLOG;
+        queue->accept_count--;
+    }
+
+    queue->syn_count = 0;
+
+    mutex_unlock(&tcp_listen_mutex);
+}
+
+static uint32_t tcp_syn_cookie_hash(ipv6_hdr_t *ipv6_header,
+                                    tcp_hdr_t *tcp_header, uint32_t irs,
+                                    uint8_t counter)
+{
+    /* Jenkins' one-at-a-time hash over the 4 touple, the peer's initial
+     * sequence number, the time counter and the secret */
+    uint32_t hash = tcp_syn_cookie_secret;
+    uint32_t words[4] = { tcp_header->src_port, tcp_header->dst_port, irs,
+                          counter
+                        };
+    uint8_t *parts[3] = { ipv6_header->srcaddr.uint8, ipv6_header->destaddr.uint8,
+                          (uint8_t *) words
+                        };
+    uint8_t lens[3] = { 16, 16, sizeof(words) };
+
+    for (int p = 0; p < 3; p++) {
+        for (int i = 0; i < lens[p]; i++) {
+            hash += parts[p][i];
+            hash += (hash << 10);
+            hash ^= (hash >> 6);
+        }
+    }
+
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+
+    return hash;
+}
+
+static uint8_t tcp_syn_cookie_counter(void)
+{
+    timex_t now;
+    vtimer_now(&now);
+
+    return (now.seconds / TCP_SYN_COOKIE_PERIOD) & 0x1F;
+}
+
+static uint16_t tcp_syn_peer_mss(tcp_hdr_t *tcp_header)
+{
+    if ((tcp_header->data_offset * 4 > TCP_HDR_LEN) &&
+        (*(((uint8_t *)tcp_header) + TCP_HDR_LEN) == TCP_MSS_OPTION)) {
+        return *((uint16_t *)(((uint8_t *)tcp_header) + TCP_HDR_LEN + 2));
+    }
+
+    return TRANSPORT_LAYER_SOCKET_STATIC_MSS;
+}
+
+uint32_t tcp_listen_syn_cookie(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header)
+{
+    uint8_t counter = tcp_syn_cookie_counter();
+    uint16_t mss = tcp_syn_peer_mss(tcp_header);
+    uint32_t mss_index = 0;
+
+    /* largest table entry the peer can take */
+    while ((mss_index + 1 < sizeof(tcp_syn_cookie_mss) / sizeof(uint16_t)) &&
+           (tcp_syn_cookie_mss[mss_index + 1] <= mss)) {
+        mss_index++;
+    }
+
+    return ((uint32_t) counter << TCP_SYN_COOKIE_COUNTER) |
+           (mss_index << TCP_SYN_COOKIE_MSS) |
+           (tcp_syn_cookie_hash(ipv6_header, tcp_header, tcp_header->seq_nr,
+                                counter) & TCP_SYN_COOKIE_HASH);
+}
+
+/* Returns the MSS encoded in the cookie acknowledged by *tcp_header*, 0 if
+ * the cookie is invalid or older than one counter step */
+static uint16_t tcp_syn_cookie_check(ipv6_hdr_t *ipv6_header,
+                                     tcp_hdr_t *tcp_header)
+{
+    uint32_t cookie = tcp_header->ack_nr - 1;
+    uint8_t counter = cookie >> TCP_SYN_COOKIE_COUNTER;
+    uint8_t age = (tcp_syn_cookie_counter() - counter) & 0x1F;
+
+    if (age > 1) {
+        return 0;
+    }
+
+    if ((tcp_syn_cookie_hash(ipv6_header, tcp_header, tcp_header->seq_nr - 1,
+                             counter) & TCP_SYN_COOKIE_HASH) !=
+        (cookie & TCP_SYN_COOKIE_HASH)) {
+        return 0;
+    }
+
+    return tcp_syn_cookie_mss[(cookie >> TCP_SYN_COOKIE_MSS) & 0x07];
+}
+
+static void tcp_syn_send_syn_ack(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                                 socket_internal_t *listener, uint32_t iss)
+{
+    socket_t *sock = &tcp_syn_ack_socket.socket_values;
+    uint8_t send_buffer[BUFFER_SIZE];
+    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
+    tcp_hdr_t *syn_ack_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+
+    memset(&tcp_syn_ack_socket, 0, sizeof(socket_internal_t));
+    set_socket_address(&sock->foreign_address, AF_INET6, tcp_header->src_port,
+                       ipv6_header->flowlabel, &ipv6_header->srcaddr);
+    set_socket_address(&sock->local_address, AF_INET6, tcp_header->dst_port, 0,
+                       &ipv6_header->destaddr);
+    set_tcp_cb(&sock->tcp_control, tcp_header->seq_nr + 1,
+               TRANSPORT_LAYER_SOCKET_STATIC_WINDOW, iss + 1, iss,
+               tcp_header->window);
+#ifdef TCP_HC
+    sock->tcp_control.tcp_context.context_id =
+        listener->socket_values.tcp_control.tcp_context.context_id;
+    sock->tcp_control.tcp_context.hc_type = FULL_HEADER;
+#else
+    (void) listener;
+#endif
+
+    send_tcp(&tcp_syn_ack_socket, syn_ack_packet, temp_ipv6_header,
+             TCP_SYN_ACK, 0);
+}
+
+static tcp_syn_entry_t *tcp_syn_find(ipv6_hdr_t *ipv6_header,
+                                     tcp_hdr_t *tcp_header,
+                                     socket_internal_t *listener)
+{
+    for (int i = 0; i < TCP_SYN_QUEUE_SIZE; i++) {
+        tcp_syn_entry_t *entry = &tcp_syn_queue[i];
+
+        if ((entry->listener == listener->socket_id) &&
+            (entry->foreign_port == tcp_header->src_port) &&
+            ipv6_addr_is_equal(&entry->foreign_addr, &ipv6_header->srcaddr) &&
+            ipv6_addr_is_equal(&entry->local_addr, &ipv6_header->destaddr)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static tcp_syn_entry_t *tcp_syn_alloc(void)
+{
+    timex_t now;
+    vtimer_now(&now);
+
+    for (int i = 0; i < TCP_SYN_QUEUE_SIZE; i++) {
+        tcp_syn_entry_t *entry = &tcp_syn_queue[i];
+
+        if ((entry->listener != 0) &&
+            (timex_uint64(timex_sub(now, entry->time)) > TCP_SYN_QUEUE_TIMEOUT)) {
+            /* the peer gave up on this one */
+            socket_internal_t *listener = socket_base_get_socket(entry->listener);
+
+            if (listener != NULL) {
+                listener->tcp_listen_queue.syn_count--;
+            }
+
+            entry->listener = 0;
+        }
+
+        if (entry->listener == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+void tcp_listen_handle_syn(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *listener)
+{
+    tcp_listen_queue_t *queue = &listener->tcp_listen_queue;
+    tcp_syn_entry_t *entry;
+    uint32_t iss;
+
+    mutex_lock(&tcp_listen_mutex);
+
+    entry = tcp_syn_find(ipv6_header, tcp_header, listener);
+
+    if ((entry == NULL) &&
+        ((queue->syn_count + queue->accept_count) < queue->backlog)) {
+        entry = tcp_syn_alloc();
+
+        if (entry != NULL) {
+            entry->listener = listener->socket_id;
+            entry->foreign_port = tcp_header->src_port;
+            entry->foreign_addr = ipv6_header->srcaddr;
+            entry->local_addr = ipv6_header->destaddr;
+            entry->mss = tcp_syn_peer_mss(tcp_header);
+            mutex_lock(&global_sequence_counter_mutex);
+            entry->iss = global_sequence_counter;
+            mutex_unlock(&global_sequence_counter_mutex);
+            queue->syn_count++;
+        }
+    }
+
+    if (entry != NULL) {
+        /* new connection or the peer did not get our SYN-ACK */
+        entry->irs = tcp_header->seq_nr;
+        vtimer_now(&entry->time);
+        iss = entry->iss;
+    }
+    else {
+        iss = tcp_listen_syn_cookie(ipv6_header, tcp_header);
+        TCP_STATS_INC(&listener->socket_values.tcp_control, syn_cookies);
+    }
+
+    mutex_unlock(&tcp_listen_mutex);
+
+    tcp_syn_send_syn_ack(ipv6_header, tcp_header, listener, iss);
+}
+
+void tcp_listen_handle_ack(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
+                           socket_internal_t *listener)
+{
+    tcp_listen_queue_t *queue = &listener->tcp_listen_queue;
+    tcp_syn_entry_t *entry;
+    uint16_t mss;
+    uint32_t handshake_time = 0;
+    bool accept_waiting;
+    msg_t m_send_tcp;
+
+    mutex_lock(&tcp_listen_mutex);
+
+    entry = tcp_syn_find(ipv6_header, tcp_header, listener);
+
+    if ((entry != NULL) && (tcp_header->ack_nr == entry->iss + 1) &&
+        (tcp_header->seq_nr == entry->irs + 1)) {
+        timex_t now;
+        vtimer_now(&now);
+        handshake_time = timex_uint64(timex_sub(now, entry->time));
+        mss = entry->mss;
+        entry->listener = 0;
+        queue->syn_count--;
+    }
+    else if ((mss = tcp_syn_cookie_check(ipv6_header, tcp_header)) == 0) {
+        mutex_unlock(&tcp_listen_mutex);
+        printf("Dropped TCP ACK for unknown connection request!\n");
+        return;
+    }
+
+    int s;
+
+    if ((queue->accept_count >= queue->backlog) ||
+        ((s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP)) < 0)) {
+        mutex_unlock(&tcp_listen_mutex);
+        printf("Dropped TCP connection because the accept queue is full!\n");
+        return;
+    }
+
+    socket_internal_t *new_socket = socket_base_get_socket(s);
+    tcp_cb_t *tcp_control = &new_socket->socket_values.tcp_control;
+
+    set_socket_address(&new_socket->socket_values.foreign_address, AF_INET6,
+                       tcp_header->src_port, ipv6_header->flowlabel,
+                       &ipv6_header->srcaddr);
+    set_socket_address(&new_socket->socket_values.local_address, AF_INET6,
+                       tcp_header->dst_port, 0, &ipv6_header->destaddr);
+
+    tcp_control->mss = mss;
+    tcp_control->rcv_irs = tcp_header->seq_nr - 1;
+    tcp_control->send_iss = tcp_header->ack_nr - 1;
+    tcp_control->rto = TCP_INITIAL_ACK_TIMEOUT;
+    tcp_control->state = TCP_ESTABLISHED;
+    set_tcp_cb(tcp_control, tcp_header->seq_nr,
+               TRANSPORT_LAYER_SOCKET_STATIC_WINDOW, tcp_header->ack_nr,
+               tcp_header->ack_nr, tcp_header->window);
+    tcp_stats_handshake(tcp_control, handshake_time);
+
+#ifdef TCP_HC
+    /* the connection continues the listener's context */
+    memcpy(&tcp_control->tcp_context,
+           &listener->socket_values.tcp_control.tcp_context,
+           sizeof(tcp_hc_context_t));
+    tcp_control->tcp_context.seq_snd = tcp_control->send_iss;
+    tcp_control->tcp_context.ack_snd = tcp_control->rcv_nxt;
+    tcp_control->tcp_context.wnd_snd = tcp_control->rcv_wnd;
+    tcp_control->tcp_context.hc_type = FULL_HEADER;
+    tcp_hc_context_add(new_socket);
+#endif
+
+    /* Reset PID to an unlikely value */
+    new_socket->recv_pid = 255;
+
+    queue->accept_queue[(queue->accept_head + queue->accept_count) %
+                        TCP_MAX_BACKLOG] = s;
+    queue->accept_count++;
+
+    accept_waiting = queue->accept_waiting;
+    queue->accept_waiting = 0;
+
+    mutex_unlock(&tcp_listen_mutex);
+
+    /* notify socket function tcp_accept(..) that a new connection is ready,
+     * it is in or on its way to msg_receive(), so the message must not be
+     * dropped. Without a waiting thread the next tcp_accept() finds the
+     * connection in the queue. */
+    if (accept_waiting) {
+        socket_base_net_msg_send(&m_send_tcp, listener->recv_pid, 1, TCP_SYN);
+    }
+}
+
+socket_internal_t *tcp_listen_pop(socket_internal_t *listener)
+{
+    tcp_listen_queue_t *queue = &listener->tcp_listen_queue;
+    socket_internal_t *sock = NULL;
+
+    mutex_lock(&tcp_listen_mutex);
+
+    if (queue->accept_count > 0) {
+        sock = socket_base_get_socket(queue->accept_queue[queue->accept_head]);
+        queue->accept_head = (queue->accept_head + 1) % TCP_MAX_BACKLOG;
+        queue->accept_count--;
+    }
+    else {
+        /* the caller waits for tcp_listen_handle_ack() to send TCP_SYN */
+        queue->accept_waiting = 1;
+    }
+
+    mutex_unlock(&tcp_listen_mutex);
+
+    return sock;
+}
@@ -0,0 +1,122 @@
+/**
+ * TCP connection statistics
+ *
+ * Copyright (C) 2014  Freie Universität Berlin.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup tcp
+ * @{
+ * @file    tcp_stats.c
+ * @brief   Per connection and global TCP counters and latency histograms
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "socket.h"
+
+#include "tcp.h"
+#include "tcp_stats.h"
+
+tcp_stats_t tcp_stats_global;
+
+static uint8_t tcp_stats_bucket(uint32_t us)
+{
+    uint32_t v = us / TCP_STATS_HIST_BASE_US;
+    uint8_t bucket = 0;
+
+    while ((v != 0) && (bucket < TCP_STATS_HIST_LEN - 1)) {
+        v >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/* tcp_cb_t is packed, so histograms are updated in place rather than through
+ * a pointer; buckets saturate instead of wrapping around */
+#define TCP_STATS_HIST_ADD(hist, bucket) \
+    do { \
+        if ((hist)[bucket] != UINT16_MAX) { \
+            (hist)[bucket]++; \
+        } \
+    } while (0)
+
+void tcp_stats_rtt(tcp_cb_t *tcp_control, uint32_t rtt, uint32_t rto)
+{
+    uint8_t rtt_bucket = tcp_stats_bucket(rtt);
+    uint8_t rto_bucket = tcp_stats_bucket(rto);
+
+    TCP_STATS_HIST_ADD(tcp_control->stats.rtt_hist, rtt_bucket);
+    TCP_STATS_HIST_ADD(tcp_control->stats.rto_hist, rto_bucket);
+    TCP_STATS_HIST_ADD(tcp_stats_global.rtt_hist, rtt_bucket);
+    TCP_STATS_HIST_ADD(tcp_stats_global.rto_hist, rto_bucket);
+}
+
+void tcp_stats_handshake(tcp_cb_t *tcp_control, uint32_t duration)
+{
+    TCP_STATS_INC(tcp_control, handshakes);
+    tcp_control->stats.handshake_time += duration;
+    tcp_stats_global.handshake_time += duration;
+}
+
+int tcp_stats_get(int s, tcp_stats_t *stats)
+{
+    if (s == 0) {
+        memcpy(stats, &tcp_stats_global, sizeof(tcp_stats_t));
+        return 0;
+    }
+
+    if (!tcp_socket_compliancy(s)) {
+        return -1;
+    }
+
+    memcpy(stats, &socket_base_get_socket(s)->socket_values.tcp_control.stats,
+           sizeof(tcp_stats_t));
+    return 0;
+}
+
+static void tcp_stats_print_hist(const char *name, const uint16_t *hist)
+{
+    printf("%s:", name);
+
+    for (int i = 0; i < TCP_STATS_HIST_LEN - 1; i++) {
+        printf(" <%" PRIu32 "ms:%u",
+               ((uint32_t) TCP_STATS_HIST_BASE_US << i) / 1000, hist[i]);
+    }
+
+    printf(" more:%u\n", hist[TCP_STATS_HIST_LEN - 1]);
+}
+
+void tcp_stats_print(int s)
+{
+    tcp_stats_t stats;
+
+    if (tcp_stats_get(s, &stats) < 0) {
+        printf("No TCP socket: %i\n", s);
+        return;
+    }
+
+    if (s == 0) {
+        puts("TCP totals");
+    }
+    else {
+        printf("TCP socket %i\n", s);
+    }
+
+    printf("segments in: %" PRIu32 " out: %" PRIu32 " retransmitted: %" PRIu32 "\n",
+           stats.segs_in, stats.segs_out, stats.retransmissions);
+    printf("out of order: %" PRIu32 " zero window: %" PRIu32 "\n",
+           stats.out_of_order, stats.zero_window);
+    printf("handshakes: %" PRIu32 " avg. time: %" PRIu32 " us syn cookies: %" PRIu32 "\n",
+           stats.handshakes,
+           (stats.handshakes == 0) ? 0 : stats.handshake_time / stats.handshakes,
+           stats.syn_cookies);
+    tcp_stats_print_hist("RTT", stats.rtt_hist);
+    tcp_stats_print_hist("RTO", stats.rto_hist);
+}
@@ -69,7 +69,9 @@ void handle_established(socket_internal_t *current_socket)
     }
 
 
-    if ((current_socket->socket_values.tcp_control.send_nxt >
+    /* coalesced writes are retransmitted by the packet handler */
+    if ((current_socket->tcp_output_in_flight == 0) &&
+        (current_socket->socket_values.tcp_control.send_nxt >
          current_socket->socket_values.tcp_control.send_una) &&
         (thread_getstatus(current_socket->send_pid) == STATUS_RECEIVE_BLOCKED)) {
         for (uint8_t i = 0; i < current_socket->socket_values.tcp_control.no_of_retries;
@@ -24,6 +24,8 @@
 #define TCP_MAX_SYN_RETRIES         3
 #define TCP_INITIAL_ACK_TIMEOUT     3.0f*SECOND     // still static, should be calculated via RTT
 #define TCP_ACK_MAX_TIMEOUT         30*SECOND   // TODO: Set back to 90 Seconds
+#define TCP_OUTPUT_TIMER_INTERVAL   (200*1000)  // delayed ACKs and retransmissions of coalesced writes, RFC 1122 allows 500 ms
+#define TCP_DELAYED_ACK_SEGMENTS    (2)         // segments acknowledged at once
 
 #define TCP_ALPHA                   1.0f/8.0f
 #define TCP_BETA                    1.0f/4.0f
@@ -158,10 +158,66 @@ int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *fro
     from->sin6_port = NTOHS(udp_header->src_port);
     *fromlen = sizeof(sockaddr6_t);
 
+    socket_base_stats.rx_delivered += NTOHS(udp_header->length) - UDP_HDR_LEN;
+    socket_base_stats.rx_copied += NTOHS(udp_header->length) - UDP_HDR_LEN;
+
     msg_reply(&m_recv, &m_send);
     return NTOHS(udp_header->length) - UDP_HDR_LEN;
 }
 
+int32_t udp_recvfrom_loan(int s, uint8_t **buf, int flags, sockaddr6_t *from, uint32_t *fromlen)
+{
+    (void) flags;
+
+    socket_internal_t *current_socket = socket_base_get_socket(s);
+    ipv6_hdr_t *ipv6_header;
+    udp_hdr_t *udp_header;
+
+    if (current_socket->recv_loan_type != SOCKET_LOAN_NONE) {
+        /* previous buffer not released yet */
+        return -1;
+    }
+
+    current_socket->recv_pid = thread_getpid();
+
+    /* the UDP packet handler stays blocked until udp_recv_release() replies */
+    msg_receive(&current_socket->recv_loan);
+    current_socket->recv_loan_type = SOCKET_LOAN_MSG;
+
+    ipv6_header = ((ipv6_hdr_t *)current_socket->recv_loan.content.ptr);
+    udp_header = ((udp_hdr_t *)(current_socket->recv_loan.content.ptr + IPV6_HDR_LEN));
+    *buf = (uint8_t *)(current_socket->recv_loan.content.ptr + IPV6_HDR_LEN + UDP_HDR_LEN);
+
+    if (from != NULL) {
+        memcpy(&from->sin6_addr, &ipv6_header->srcaddr, 16);
+        from->sin6_family = AF_INET6;
+        from->sin6_flowinfo = 0;
+        from->sin6_port = NTOHS(udp_header->src_port);
+    }
+
+    if (fromlen != NULL) {
+        *fromlen = sizeof(sockaddr6_t);
+    }
+
+    socket_base_stats.rx_delivered += NTOHS(udp_header->length) - UDP_HDR_LEN;
+
+    return NTOHS(udp_header->length) - UDP_HDR_LEN;
+}
+
+int udp_recv_release(int s)
+{
+    socket_internal_t *current_socket = socket_base_get_socket(s);
+    msg_t m_send;
+
+    if (current_socket->recv_loan_type != SOCKET_LOAN_MSG) {
+        return -1;
+    }
+
+    current_socket->recv_loan_type = SOCKET_LOAN_NONE;
+    msg_reply(&current_socket->recv_loan, &m_send);
+    return 0;
+}
+
 int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
@@ -28,6 +28,9 @@ int udp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid);
 int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen);
 int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags, sockaddr6_t *to, uint32_t tolen);
 bool udp_socket_compliancy(int s);
+int32_t udp_recvfrom_loan(int s, uint8_t **buf, int flags, sockaddr6_t *from, uint32_t *fromlen);
+int udp_recv_release(int s);
+socket_internal_t *get_udp_socket(udp_hdr_t *udp_header);
 int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen);
 int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags, sockaddr6_t *to, socklen_t tolen);
 
@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  pnet
+ * @{
+ */
+
+/**
+ * @file    netinet/tcp.h
+ * @brief   Definitions for the Internet Transmission Control Protocol (TCP)
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/netinet_tcp.h.html">
+ *              The Open Group Base Specifications Issue 7, <netinet/tcp.h>
+ *          </a>
+ */
+#ifndef _NETINET_TCP_H
+#define _NETINET_TCP_H
+
+/* provides TCP_NODELAY, an option of setsockopt() on level IPPROTO_TCP */
+#include "socket_base/in.h"
+
+/**
+ * @}
+ */
+#endif /* _NETINET_TCP_H */
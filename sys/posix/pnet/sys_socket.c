@@ -185,14 +185,16 @@ ssize_t sendto(int socket, const void *message, size_t length, int flags,
 int setsockopt(int socket, int level, int option_name, const void *option_value,
                socklen_t option_len)
 {
-    // TODO
-    (void) socket;
-    (void) level;
-    (void) option_name;
-    (void) option_value;
-    (void) option_len;
+    int res = sock_func_wrapper(socket_base_setsockopt, socket, level,
+                                option_name, option_value, option_len);
 
-    return -1;
+    if (res < 0) {
+        // transport_layer needs more granular error handling
+        errno = ENOPROTOOPT;
+        return -1;
+    }
+
+    return res;
 }
 
 /**
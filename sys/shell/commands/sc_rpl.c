@@ -19,6 +19,7 @@
 #include <stdint.h>
 
 #include "rpl.h"
+#include "rpl/rpl_dodag.h"
 
 static char addr_str[IPV6_MAX_ADDR_STR_LEN];
 
@@ -28,26 +29,61 @@ void _rpl_route_handler(int argc, char **argv)
     (void) argv;
 
     rpl_routing_entry_t *rtable;
-    rtable = rpl_get_routing_table();
+    rpl_dodag_t *dodag = NULL;
     unsigned c = 0;
-    puts("--------------------------------------------------------------------");
-    puts("Routing table");
-    printf(" %-3s  %-18s  %-18s  %s\n", "#", "target", "next hop", "lifetime");
-    puts("--------------------------------------------------------------------");
 
-    for (int i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rtable[i].used) {
-            c++;
-            printf(" %03d: %-18s  ", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                                            (&rtable[i].address)));
-            printf("%-18s  ", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                                            (&rtable[i].next_hop)));
-            printf("%d\n", rtable[i].lifetime);
+    /* every instance has a routing table of its own */
+    while ((dodag = rpl_next_joined_dodag(dodag)) != NULL) {
+        rtable = rpl_get_routing_table(dodag->instance);
+        puts("--------------------------------------------------------------------");
+        printf("Routing table of instance %u\n", dodag->instance->id);
+        printf(" %-3s  %-22s  %-18s  %s\n", "#", "target", "next hop", "lifetime");
+        puts("--------------------------------------------------------------------");
+
+        for (int i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+            if (rtable[i].used) {
+                c++;
+                printf(" %03d: %-18s/%-3u  ", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
+                                                (&rtable[i].address)), rtable[i].prefix_len);
+                printf("%-18s  ", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
+                                                (&rtable[i].next_hop)));
+                printf("%u\n", rpl_get_routing_entry_lifetime(dodag->instance, &rtable[i]));
 
+            }
         }
     }
+
     puts("--------------------------------------------------------------------");
     printf(" %u routing table entries\n", c);
 
     puts("$");
 }
+
+void _rpl_parents_handler(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+
+    rpl_dodag_t *dodag = NULL;
+    rpl_parent_t *parent;
+
+    while ((dodag = rpl_next_joined_dodag(dodag)) != NULL) {
+        puts("--------------------------------------------------------------------");
+        printf("Parents of instance %u, rank %u\n", dodag->instance->id, dodag->my_rank);
+        printf(" %-22s  %-6s  %-6s  %s\n", "parent", "rank", "cost", "lifetime");
+        puts("--------------------------------------------------------------------");
+
+        for (parent = rpl_next_parent(dodag, NULL); parent != NULL;
+             parent = rpl_next_parent(dodag, parent)) {
+            printf("%c%-22s  %-6u  %-6u  %u\n",
+                   (parent == dodag->my_preferred_parent) ? '*' : ' ',
+                   ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &parent->addr),
+                   parent->rank, parent->cost, parent->lifetime);
+        }
+
+        printf(" %u parent switches, %u better parents held back\n",
+               dodag->parent_switches, dodag->parent_switches_held);
+    }
+
+    puts("$");
+}
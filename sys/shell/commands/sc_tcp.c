@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup shell_commands
+ * @{
+ * @file    sc_tcp.c
+ * @brief   provides shell commands to query TCP connection statistics
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tcp_stats.h"
+
+void _tcp_stats_handler(int argc, char **argv)
+{
+    if (argc > 2) {
+        printf("usage: %s [socket]\n", argv[0]);
+        return;
+    }
+
+    tcp_stats_print((argc == 2) ? atoi(argv[1]) : 0);
+}
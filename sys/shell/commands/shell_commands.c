@@ -110,6 +110,11 @@ extern void _net_if_ifconfig(int argc, char **argv);
 
 #ifdef MODULE_RPL
 extern void _rpl_route_handler(int argc, char **argv);
+extern void _rpl_parents_handler(int argc, char **argv);
+#endif
+
+#ifdef MODULE_TCP
+extern void _tcp_stats_handler(int argc, char **argv);
 #endif
 
 #ifdef MODULE_MCI
@@ -182,6 +187,10 @@ const shell_command_t _shell_command_list[] = {
 #endif
 #ifdef MODULE_RPL
     {"route", "Shows the routing table", _rpl_route_handler},
+    {"parents", "Shows the RPL parents and parent switches", _rpl_parents_handler},
+#endif
+#ifdef MODULE_TCP
+    {"tcpstat", "Shows TCP statistics of all connections or the given socket", _tcp_stats_handler},
 #endif
 #ifdef MODULE_MCI
     {DISK_READ_SECTOR_CMD, "Reads the specified sector of inserted memory card", _read_sector},
@@ -0,0 +1,134 @@
+/**
+ * Trickle implementation
+ *
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup sys_trickle
+ * @{
+ * @file    trickle.c
+ * @brief   Trickle timers without threads of their own
+ * @}
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "trickle.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/* random number in [0, range), RAND_MAX may be as small as 2^15 - 1 */
+static uint32_t trickle_rand(uint32_t range)
+{
+    uint32_t r = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+
+    return r % range;
+}
+
+static uint32_t trickle_max_interval(trickle_t *trickle)
+{
+    if (trickle->Imax >= 32 || trickle->Imin > (UINT32_MAX >> trickle->Imax)) {
+        return UINT32_MAX;
+    }
+
+    return trickle->Imin << trickle->Imax;
+}
+
+static void trickle_set_timer(trickle_t *trickle, uint32_t ms)
+{
+    timex_t time = timex_set(ms / 1000, (ms % 1000) * 1000);
+
+    vtimer_remove(&trickle->timer);
+
+    if (vtimer_set_msg(&trickle->timer, time, trickle->pid, trickle) != 0) {
+        DEBUG("trickle: [ERROR] setting timer\n");
+    }
+}
+
+/* starts an interval of size I, the timer runs to t */
+static void trickle_new_interval(trickle_t *trickle)
+{
+    trickle->c = 0;
+    trickle->t = (trickle->I / 2) + trickle_rand(trickle->I - (trickle->I / 2));
+    trickle->interval_end = 0;
+    trickle_set_timer(trickle, trickle->t);
+}
+
+void trickle_start(kernel_pid_t pid, trickle_t *trickle,
+                   trickle_callback_t callback, void *arg,
+                   uint32_t Imin, uint8_t Imax, uint8_t k)
+{
+    uint32_t max;
+
+    trickle->pid = pid;
+    trickle->callback = callback;
+    trickle->arg = arg;
+    trickle->Imin = (Imin > 0) ? Imin : 1;
+    trickle->Imax = Imax;
+    trickle->k = k;
+
+    max = trickle_max_interval(trickle);
+    trickle->I = trickle->Imin + trickle_rand(max - trickle->Imin + 1);
+
+    /* the range is all of uint32_t */
+    if (trickle->I == 0) {
+        trickle->I = max;
+    }
+
+    trickle_new_interval(trickle);
+}
+
+void trickle_stop(trickle_t *trickle)
+{
+    vtimer_remove(&trickle->timer);
+    trickle->I = 0;
+}
+
+void trickle_reset_timer(trickle_t *trickle)
+{
+    if (trickle->I == 0 || trickle->I == trickle->Imin) {
+        return;
+    }
+
+    trickle->I = trickle->Imin;
+    trickle_new_interval(trickle);
+}
+
+void trickle_increment_counter(trickle_t *trickle)
+{
+    if (trickle->c < UINT16_MAX) {
+        trickle->c++;
+    }
+}
+
+void trickle_callback(trickle_t *trickle)
+{
+    uint32_t max;
+
+    /* stopped while the message was queued */
+    if (trickle->I == 0) {
+        return;
+    }
+
+    if (!trickle->interval_end) {
+        /* Handle k=0 like k=infinity (according to RFC6206, section 6.5) */
+        if ((trickle->c < trickle->k) || (trickle->k == 0)) {
+            trickle->callback(trickle->arg);
+        }
+
+        trickle->interval_end = 1;
+        trickle_set_timer(trickle, trickle->I - trickle->t);
+        return;
+    }
+
+    max = trickle_max_interval(trickle);
+    trickle->I = (trickle->I > max / 2) ? max : trickle->I * 2;
+    DEBUG("trickle: new interval %" PRIu32 "\n", trickle->I);
+
+    trickle_new_interval(trickle);
+}
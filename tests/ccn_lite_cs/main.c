@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Interest satisfaction latency of the CCN-lite content store
+ *          with 10k cached chunks, compared to a linear search
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vtimer.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+
+#define CHUNKS      (10 * 1000)
+#define CHUNK_SIZE  (64)
+#define LOOKUPS     (1000)
+
+static struct ccnl_relay_s relay;
+
+/* builds the name /riot/bench/<chunk> */
+static struct ccnl_prefix_s *prefix_new(int chunk)
+{
+    char num[12];
+    const char *comps[] = { "riot", "bench", num };
+    int len = 0;
+    struct ccnl_prefix_s *p = ccnl_prefix_new(3);
+
+    snprintf(num, sizeof(num), "%d", chunk);
+
+    p->compcnt = 3;
+    p->path = ccnl_malloc(sizeof("riotbench") + sizeof(num));
+
+    for (int i = 0; i < p->compcnt; i++) {
+        p->complen[i] = strlen(comps[i]);
+        p->comp[i] = p->path + len;
+        memcpy(p->comp[i], comps[i], p->complen[i]);
+        len += p->complen[i];
+    }
+
+    return p;
+}
+
+static int populate(void)
+{
+    for (int i = 0; i < CHUNKS; i++) {
+        struct ccnl_prefix_s *p = prefix_new(i);
+        struct ccnl_buf_s *pkt = ccnl_buf_new(NULL, CHUNK_SIZE);
+        struct ccnl_content_s *c;
+
+        memset(pkt->data, i, CHUNK_SIZE);
+        c = ccnl_content_new(&relay, &pkt, &p, NULL, pkt->data, CHUNK_SIZE);
+
+        if (!c || !ccnl_content_add2cache(&relay, c)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static struct ccnl_content_s *linear_lookup(struct ccnl_prefix_s *p)
+{
+    for (struct ccnl_content_s *c = relay.contents; c; c = c->next) {
+        if (ccnl_i_prefixof_c(p, NULL, 0, CCNL_MAX_NAME_COMP, c)) {
+            return c;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t measure(int linear)
+{
+    timex_t start, end;
+    uint32_t hits = 0;
+
+    srand(1);
+    vtimer_now(&start);
+
+    for (int i = 0; i < LOOKUPS; i++) {
+        struct ccnl_prefix_s *p = prefix_new(rand() % CHUNKS);
+        struct ccnl_content_s *c;
+
+        if (linear) {
+            c = linear_lookup(p);
+        }
+        else {
+            c = ccnl_content_lookup(&relay, p, NULL, 0, CCNL_MAX_NAME_COMP);
+        }
+
+        hits += (c != NULL);
+        free_prefix(p);
+    }
+
+    vtimer_now(&end);
+
+    if (hits != LOOKUPS) {
+        printf("ERROR: %" PRIu32 " of %d interests satisfied\n", hits, LOOKUPS);
+    }
+
+    return timex_uint64(timex_sub(end, start)) * 1000 / LOOKUPS;
+}
+
+int main(void)
+{
+    relay.max_cache_entries = -1;
+
+    if (populate() < 0) {
+        puts("ERROR: could not populate the content store");
+        return 1;
+    }
+
+    printf("%d chunks cached, %d bytes\n", relay.contentcnt, relay.contentbytes);
+    printf("content store: %" PRIu32 " ns per interest\n", measure(0));
+    printf("linear search: %" PRIu32 " ns per interest\n", measure(1));
+
+    /* the budget evicts the least recently used chunks */
+    relay.max_cache_bytes = (CHUNKS / 2) * CHUNK_SIZE;
+    struct ccnl_prefix_s *p = prefix_new(CHUNKS);
+    struct ccnl_buf_s *pkt = ccnl_buf_new(NULL, CHUNK_SIZE);
+    ccnl_content_add2cache(&relay, ccnl_content_new(&relay, &pkt, &p, NULL,
+                                                   pkt->data, CHUNK_SIZE));
+    printf("budget of %d bytes: %d chunks cached\n", relay.max_cache_bytes,
+           relay.contentcnt);
+
+    ccnl_content_cleanup(&relay);
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Measures the goodput of fetching a chunked object over CCN-lite
+ *          with growing windows of outstanding interests
+ *
+ * Start two native instances on a bridged tap pair, the producer first:
+ *
+ *     R_ADDR=2 make term PORT=tap1
+ *     R_ADDR=1 make term PORT=tap0
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thread.h"
+#include "msg.h"
+#include "vtimer.h"
+#include "transceiver.h"
+
+#include "ccn_lite/ccnl-riot.h"
+#include "ccn_lite/util/ccnl-riot-client.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+#include "ccnl-riot-compat.h"
+
+#ifndef R_ADDR
+#define R_ADDR          (1)
+#endif
+
+#define PRODUCER_ADDR   "2"
+#define PREFIX          "/riot/bench"
+#define OBJECT_SIZE     (4 * 1024)
+
+static char relay_stack[KERNEL_CONF_STACKSIZE_MAIN];
+static kernel_pid_t relay_pid;
+static unsigned char reply_buf[PAYLOAD_SIZE];
+
+static void start_transceiver(void)
+{
+    msg_t mesg;
+    transceiver_command_t tcmd;
+    uint16_t addr = R_ADDR;
+    int32_t channel = CCNL_DEFAULT_CHANNEL;
+
+    transceiver_init(TRANSCEIVER);
+    transceiver_start();
+    transceiver_register(TRANSCEIVER, relay_pid);
+
+    tcmd.transceivers = TRANSCEIVER;
+    mesg.content.ptr = (char *) &tcmd;
+
+    tcmd.data = &addr;
+    mesg.type = SET_ADDRESS;
+    msg_send_receive(&mesg, &mesg, transceiver_pid);
+
+    tcmd.data = &channel;
+    mesg.type = SET_CHANNEL;
+    msg_send_receive(&mesg, &mesg, transceiver_pid);
+}
+
+#if R_ADDR == 1
+static unsigned char object[OBJECT_SIZE + CCNL_RIOT_CHUNK_SIZE];
+
+static void fetch(int window)
+{
+    char name[] = PREFIX;
+    ccnl_riot_client_stats_t stats;
+    timex_t start, end;
+
+    vtimer_now(&start);
+    int len = ccnl_riot_client_fetch(relay_pid, name, object, sizeof(object),
+                                     window, &stats);
+    vtimer_now(&end);
+
+    uint32_t us = (uint32_t) timex_uint64(timex_sub(end, start));
+
+    if (len != OBJECT_SIZE) {
+        printf("window %2d: ERROR: fetched %d of %d bytes\n", window, len,
+               OBJECT_SIZE);
+        return;
+    }
+
+    for (int i = 0; i < OBJECT_SIZE; i++) {
+        if (object[i] != (unsigned char) i) {
+            printf("window %2d: ERROR: byte %d corrupted\n", window, i);
+            return;
+        }
+    }
+
+    if (stats.drained > 0) {
+        printf("window %2d: ERROR: %u interests past the final block\n", window,
+               stats.drained);
+    }
+
+    printf("window %2d: %6" PRIu32 " byte/s, %u interests, %u timeouts, "
+           "%u retransmissions, window reached %u\n", window,
+           (uint32_t)((uint64_t) OBJECT_SIZE * 1000 * 1000 / us),
+           stats.interests, stats.timeouts, stats.retransmissions,
+           stats.window_max);
+}
+
+static void run(void)
+{
+    char prefix[] = PREFIX;
+    char type[] = "newTRANSface";
+    char faceid[] = PRODUCER_ADDR;
+
+    ccnl_riot_client_publish(relay_pid, prefix, faceid, type, reply_buf);
+
+    for (int window = 1; window <= 8; window *= 2) {
+        fetch(window);
+    }
+}
+#else
+static msg_t msg_buffer[16];
+static unsigned char content_pkg[PAYLOAD_SIZE];
+
+/* answers an interest for chunk k of the object, named PREFIX/k */
+static void produce(kernel_pid_t from, riot_ccnl_msg_t *m)
+{
+    unsigned char *data = m->payload + 2;   /* behind the Interest tag */
+    int datalen = m->size - 2, contlen, len;
+    struct ccnl_buf_s *buf, *nonce = NULL, *ppkd = NULL;
+    struct ccnl_prefix_s *p = NULL;
+    unsigned char *content;
+    char names[CCNL_MAX_NAME_COMP][16];
+    char *prefix[CCNL_MAX_NAME_COMP + 1];
+    char chunk_data[CCNL_RIOT_CHUNK_SIZE];
+    char final[16];
+
+    buf = ccnl_extract_prefix_nonce_ppkd(&data, &datalen, NULL, NULL, NULL, NULL,
+                                         &p, &nonce, &ppkd, &content, &contlen);
+
+    if (!buf || p->compcnt < 1) {
+        goto Done;
+    }
+
+    for (int k = 0; k < p->compcnt; k++) {
+        len = (p->complen[k] < 15) ? p->complen[k] : 15;
+        memcpy(names[k], p->comp[k], len);
+        names[k][len] = '\0';
+        prefix[k] = names[k];
+    }
+
+    prefix[p->compcnt] = NULL;
+
+    int chunk = atoi(names[p->compcnt - 1]);
+
+    if (chunk * CCNL_RIOT_CHUNK_SIZE >= OBJECT_SIZE) {
+        goto Done;
+    }
+
+    len = OBJECT_SIZE - chunk * CCNL_RIOT_CHUNK_SIZE;
+    len = (len < CCNL_RIOT_CHUNK_SIZE) ? len : CCNL_RIOT_CHUNK_SIZE;
+
+    for (int i = 0; i < len; i++) {
+        chunk_data[i] = (char)(chunk * CCNL_RIOT_CHUNK_SIZE + i);
+    }
+
+    riot_ccnl_msg_t rmsg;
+    msg_t reply;
+
+    rmsg.payload = content_pkg;
+    snprintf(final, sizeof(final), "%d", (OBJECT_SIZE - 1) / CCNL_RIOT_CHUNK_SIZE);
+    rmsg.size = mkChunk(prefix, final, chunk_data, len, content_pkg);
+    reply.type = CCNL_RIOT_MSG;
+    reply.content.ptr = (char *) &rmsg;
+    msg_send(&reply, from, 1);
+
+Done:
+    free_prefix(p);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(nonce);
+    ccnl_buf_free(ppkd);
+}
+
+static void run(void)
+{
+    char prefix[] = PREFIX;
+    char type[] = "newMSGface";
+    char faceid[8];
+    msg_t in;
+
+    msg_init_queue(msg_buffer, sizeof(msg_buffer) / sizeof(msg_buffer[0]));
+    snprintf(faceid, sizeof(faceid), "%" PRIkernel_pid, thread_getpid());
+    ccnl_riot_client_publish(relay_pid, prefix, faceid, type, reply_buf);
+    puts("producing " PREFIX);
+
+    while (1) {
+        msg_receive(&in);
+
+        if (in.type == CCNL_RIOT_MSG) {
+            riot_ccnl_msg_t *m = (riot_ccnl_msg_t *) in.content.ptr;
+            produce(in.sender_pid, m);
+            free(m);
+        }
+    }
+}
+#endif
+
+int main(void)
+{
+    relay_pid = thread_create(relay_stack, sizeof(relay_stack),
+                              PRIORITY_MAIN - 2, CREATE_STACKTEST,
+                              ccnl_riot_relay_start, NULL, "relay");
+    start_transceiver();
+
+    run();
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Delivery of fragmented CCN-lite packets over a link with
+ *          injected loss, with the sliding window and selective
+ *          retransmission of CCNx2013 fragments and without
+ *
+ * Both ends of the link run in this process, a round passes the
+ * fragments the window allows and the acknowledgement of the receiver,
+ * a round without traffic counts as a retransmission timeout. Without
+ * retransmission the same loop runs and the link drops every fragment
+ * sent again. At last either end restarts in the middle of a transfer
+ * and the link has to recover.
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vtimer.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-pdu.h"
+#include "ccnx.h"
+
+#define PACKETS     (200)
+#define PACKET_SIZE (400)
+#define MTU         (120)
+#define MAX_ROUNDS  (100 * PACKETS)
+
+static const unsigned loss_percent[] = { 0, 5, 10, 20 };
+
+static struct ccnl_relay_s relay;
+static struct ccnl_face_s sender, receiver;
+static unsigned loss, delivered, corrupt;
+
+static int deliver(struct ccnl_relay_s *r, struct ccnl_face_s *from,
+                   unsigned char **data, int *datalen)
+{
+    (void) r;
+    (void) from;
+
+    if (*datalen != PACKET_SIZE || (*data)[0] != (*data)[PACKET_SIZE - 1]) {
+        corrupt++;
+    }
+
+    delivered++;
+    *data += *datalen;
+    *datalen = 0;
+    return 0;
+}
+
+static int lost(void)
+{
+    return (unsigned)(rand() % 100) < loss;
+}
+
+/* passes a fragment or an acknowledgement over the link */
+static void transmit(struct ccnl_face_s *to, struct ccnl_buf_s *buf)
+{
+    unsigned char *data = buf->data;
+    int datalen = buf->datalen, num, typ;
+
+    if (!lost() && dehead(&data, &datalen, &num, &typ) == 0
+        && typ == CCN_TT_DTAG && num == CCNL_DTAG_FRAGMENT) {
+        ccnl_frag_RX_CCNx2013(deliver, &relay, to, &data, &datalen);
+    }
+
+    ccnl_buf_free(buf);
+}
+
+static struct ccnl_buf_s *packet_new(int k)
+{
+    struct ccnl_buf_s *buf = ccnl_buf_new(NULL, PACKET_SIZE);
+
+    if (buf) {
+        memset(buf->data, k, PACKET_SIZE);
+    }
+
+    return buf;
+}
+
+/* sends the packets up to *last*, returns the number of timeouts */
+static int send_packets(int *next, int last, int retransmit)
+{
+    int rounds = 0, timeouts = 0;
+
+    while (rounds++ < MAX_ROUNDS) {
+        struct ccnl_buf_s *buf;
+        int moved = 0;
+
+        /* as ccnl_face_CTS does */
+        for (;;) {
+            unsigned resent = sender.frag->stat.txretrans;
+
+            buf = ccnl_frag_getnext(sender.frag, NULL, NULL);
+
+            if (!buf && ccnl_frag_nomorefragments(sender.frag)
+                && *next < last && ccnl_frag_winfree(sender.frag)) {
+                ccnl_frag_reset(sender.frag, packet_new((*next)++), 0, &sender.peer);
+                continue;
+            }
+
+            if (!buf) {
+                break;
+            }
+
+            if (!retransmit && sender.frag->stat.txretrans != resent) {
+                ccnl_buf_free(buf);
+                continue;
+            }
+
+            transmit(&receiver, buf);
+            moved = 1;
+        }
+
+        if ((buf = ccnl_frag_getack(receiver.frag))) {
+            transmit(&sender, buf);
+            moved = 1;
+        }
+
+        if (*next == last && ccnl_frag_nomorefragments(sender.frag)
+            && !ccnl_frag_inflight(sender.frag)) {
+            break;
+        }
+
+        if (!moved) {
+            ccnl_frag_timeout(sender.frag);
+            timeouts++;
+        }
+    }
+
+    return timeouts;
+}
+
+static void run(int retransmit)
+{
+    struct ccnl_frag_stat_s *st;
+    timex_t start, end;
+    int next = 0, timeouts;
+
+    delivered = corrupt = 0;
+    sender.frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, MTU);
+    receiver.frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, MTU);
+    srand(1);
+    vtimer_now(&start);
+
+    timeouts = send_packets(&next, PACKETS, retransmit);
+
+    vtimer_now(&end);
+    st = &sender.frag->stat;
+
+    if (retransmit) {
+        printf("%3u%% loss: %3u/%d packets, %4u fragments %4u resent %3u lost, "
+               "%4u acks, %4d timeouts, %" PRIu32 " us\n", loss, delivered,
+               PACKETS, st->txfrags, st->txretrans, st->txlost,
+               receiver.frag->stat.txacks, timeouts,
+               (uint32_t) timex_uint64(timex_sub(end, start)));
+    }
+    else {
+        printf("%3u%% loss: %3u/%d packets without retransmission\n", loss,
+               delivered, PACKETS);
+    }
+
+    if (corrupt) {
+        printf("ERROR: %u packets reassembled wrongly\n", corrupt);
+    }
+
+    ccnl_frag_destroy(sender.frag);
+    ccnl_frag_destroy(receiver.frag);
+}
+
+/* one end forgets its sequence numbers half way through */
+static void run_restart(struct ccnl_face_s *restarting)
+{
+    int next = 0;
+
+    loss = 0;
+    delivered = corrupt = 0;
+    sender.frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, MTU);
+    receiver.frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, MTU);
+
+    send_packets(&next, PACKETS / 2, 1);
+
+    ccnl_frag_destroy(restarting->frag);
+    restarting->frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, MTU);
+
+    send_packets(&next, PACKETS, 1);
+
+    printf("%s restarts: %3u/%d packets, %u resyncs\n",
+           restarting == &sender ? "sender" : "receiver", delivered, PACKETS,
+           sender.frag->stat.resyncs + receiver.frag->stat.resyncs);
+
+    if (delivered != PACKETS || corrupt) {
+        printf("ERROR: the link did not recover from the restart\n");
+    }
+
+    ccnl_frag_destroy(sender.frag);
+    ccnl_frag_destroy(receiver.frag);
+}
+
+int main(void)
+{
+    relay.ifs[0].mtu = MTU;
+
+    printf("%d packets of %d bytes, mtu %d, window %d\n", PACKETS, PACKET_SIZE,
+           MTU, CCNL_FRAG_WINDOW);
+
+    for (unsigned k = 0; k < sizeof(loss_percent) / sizeof(loss_percent[0]); k++) {
+        loss = loss_percent[k];
+        run(1);
+        run(0);
+    }
+
+    run_restart(&sender);
+    run_restart(&receiver);
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   MPL dissemination on the simulated medium of nativesim
+ *
+ * Run with `make sim`. The nodes 1 and 100 are seeds, each sends a UDP
+ * datagram to ff03::fc every two seconds. At the end every node prints
+ * how many messages it got, the longest time a message took to reach it
+ * and how often its forwarder transmitted, in virtual time.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "config.h"
+#include "thread.h"
+#include "vtimer.h"
+#include "net_if.h"
+#include "sixlowpan.h"
+#include "socket_base/socket.h"
+#include "mpl.h"
+
+#define SEED_A          (1)
+#define SEED_B          (100)
+#define PORT            (0xf0b0)
+#define MESSAGES        (10)
+#define START           (5)     /* seconds */
+#define PERIOD          (2)
+#define END             (35)
+
+typedef struct {
+    uint16_t seed;
+    uint16_t sequence;
+    uint32_t seconds;
+    uint32_t microseconds;
+} message_t;
+
+static char receiver_stack[KERNEL_CONF_STACKSIZE_MAIN];
+static unsigned received;
+static uint32_t max_latency;    /* ms */
+
+static void *receiver(void *arg)
+{
+    (void) arg;
+
+    sockaddr6_t sa;
+    uint32_t fromlen = sizeof(sa);
+    message_t message;
+    timex_t now, sent;
+    int sock = socket_base_socket(PF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin6_family = AF_INET;
+    sa.sin6_port = HTONS(PORT);
+
+    if (socket_base_bind(sock, &sa, sizeof(sa)) < 0) {
+        puts("ERROR: bind");
+        return NULL;
+    }
+
+    while (1) {
+        if (socket_base_recvfrom(sock, &message, sizeof(message), 0, &sa, &fromlen) !=
+            sizeof(message)) {
+            continue;
+        }
+
+        vtimer_now(&now);
+        sent = timex_set(message.seconds, message.microseconds);
+        now = timex_sub(now, sent);
+
+        if (timex_uint64(now) / 1000 > max_latency) {
+            max_latency = timex_uint64(now) / 1000;
+        }
+
+        received++;
+    }
+
+    return NULL;
+}
+
+static void seed(uint16_t id, int sock, uint16_t sequence)
+{
+    sockaddr6_t sa;
+    message_t message;
+    timex_t now;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin6_family = AF_INET;
+    sa.sin6_port = HTONS(PORT);
+    mpl_addr_set_all_forwarders(&sa.sin6_addr);
+
+    vtimer_now(&now);
+    message.seed = id;
+    message.sequence = sequence;
+    message.seconds = now.seconds;
+    message.microseconds = now.microseconds;
+
+    if (socket_base_sendto(sock, &message, sizeof(message), 0, &sa, sizeof(sa)) < 0) {
+        printf("node %u: ERROR: message %u not sent\n", id, sequence);
+    }
+}
+
+int main(void)
+{
+    uint16_t id = sysconfig.id;
+    int is_seed = (id == SEED_A || id == SEED_B);
+    unsigned expected = (is_seed ? 1 : 2) * MESSAGES;
+    mpl_stats_t stats;
+    timex_t now;
+    int sock = -1;
+
+    net_if_set_hardware_address(0, id);
+    sixlowpan_lowpan_init_interface(0);
+
+    if (mpl_init(0) != 0) {
+        printf("node %u: ERROR: mpl_init\n", id);
+        return 1;
+    }
+
+    thread_create(receiver_stack, sizeof(receiver_stack), PRIORITY_MAIN - 1,
+                  CREATE_STACKTEST, receiver, NULL, "receiver");
+
+    if (is_seed) {
+        sock = socket_base_socket(PF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    }
+
+    /* the seeds take turns, one second apart */
+    vtimer_usleep(START * 1000 * 1000 + (id == SEED_B) * 1000 * 1000);
+
+    for (int i = 0; is_seed && i < MESSAGES; i++) {
+        seed(id, sock, i);
+        vtimer_usleep(PERIOD * 1000 * 1000);
+    }
+
+    vtimer_now(&now);
+    vtimer_sleep(timex_sub(timex_set(END, 0), now));
+
+    mpl_get_stats(&stats);
+    printf("node %u: %u of %u messages, latency %" PRIu32 " ms, %" PRIu32 " transmissions\n",
+           id, received, expected, max_latency, stats.transmitted);
+
+    if (received == expected) {
+        puts("done");
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   RPL DODAG formation on the simulated medium of nativesim
+ *
+ * Run with `make sim`. Node 1 is the root, every other node prints when
+ * it joins the DODAG and with which rank, in virtual time.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "config.h"
+#include "vtimer.h"
+#include "net_if.h"
+#include "ipv6.h"
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+
+#define ROOT_ID     (1)
+
+int main(void)
+{
+    ipv6_addr_t addr;
+    timex_t now;
+    uint16_t id = sysconfig.id;
+    uint16_t rank = 0;
+
+    net_if_set_src_address_mode(0, NET_IF_TRANS_ADDR_M_SHORT);
+    net_if_set_hardware_address(0, id);
+
+    if (rpl_init(0) != SIXLOWERROR_SUCCESS) {
+        printf("node %u: ERROR: rpl_init\n", id);
+        return 1;
+    }
+
+    if (id == ROOT_ID) {
+        rpl_init_root();
+    }
+
+    ipv6_iface_set_routing_provider(rpl_get_next_hop);
+
+    ipv6_addr_init(&addr, 0xabcd, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, id);
+    ipv6_addr_set_by_eui64(&addr, 0, &addr);
+    ipv6_net_if_add_addr(0, &addr, NDP_ADDR_STATE_PREFERRED, 0, 0, 0);
+    ipv6_init_as_router();
+
+    while (1) {
+        rpl_dodag_t *dodag = rpl_get_my_dodag();
+
+        if (dodag != NULL && dodag->my_rank != rank) {
+            vtimer_now(&now);
+            printf("node %u: rank %u at %" PRIu32 ".%06" PRIu32 " s\n",
+                   id, dodag->my_rank, now.seconds, now.microseconds);
+            rank = dodag->my_rank;
+        }
+
+        vtimer_usleep(100 * 1000);
+    }
+
+    return 0;
+}
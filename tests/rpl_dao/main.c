@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   DAO traffic of a storing DODAG on the simulated medium of
+ *          nativesim
+ *
+ * Run with `make sim`. Every node runs RPL, node 1 is the root. Every
+ * REPORT_INTERVAL of virtual time each node prints the DAOs it sent and
+ * their bytes, from the ICMPv6 header on, and the routes it has. The sim
+ * target sums them up over all nodes. Links of the topology lose frames,
+ * so nodes change their parents and routes expire during the run.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "config.h"
+#include "vtimer.h"
+#include "net_if.h"
+#include "ipv6.h"
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+
+#define ROOT_ID             (1)
+#define REPORT_INTERVAL     (600)   /* seconds */
+
+static unsigned routes(rpl_dodag_t *dodag)
+{
+    rpl_routing_entry_t *table = rpl_get_routing_table(dodag->instance);
+    unsigned n = 0;
+
+    for (int i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        n += table[i].used ? 1 : 0;
+    }
+
+    return n;
+}
+
+int main(void)
+{
+    ipv6_addr_t addr;
+    uint16_t id = sysconfig.id;
+
+    net_if_set_src_address_mode(0, NET_IF_TRANS_ADDR_M_SHORT);
+    net_if_set_hardware_address(0, id);
+
+    if (rpl_init(0) != SIXLOWERROR_SUCCESS) {
+        printf("node %u: ERROR: rpl_init\n", id);
+        return 1;
+    }
+
+    if (id == ROOT_ID) {
+        rpl_init_root();
+    }
+
+    ipv6_iface_set_routing_provider(rpl_get_next_hop);
+
+    ipv6_addr_init(&addr, 0xabcd, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, id);
+    ipv6_addr_set_by_eui64(&addr, 0, &addr);
+    ipv6_net_if_add_addr(0, &addr, NDP_ADDR_STATE_PREFERRED, 0, 0, 0);
+    ipv6_init_as_router();
+
+    for (uint32_t t = REPORT_INTERVAL;; t += REPORT_INTERVAL) {
+        rpl_dodag_t *dodag;
+
+        vtimer_sleep(timex_set(REPORT_INTERVAL, 0));
+
+        if ((dodag = rpl_get_my_dodag()) == NULL) {
+            printf("node %u at %" PRIu32 " s: not joined\n", id, t);
+            continue;
+        }
+
+        printf("node %u at %" PRIu32 " s: %u DAOs %" PRIu32 " bytes %u routes\n",
+               id, t, dodag->daos_sent, dodag->dao_bytes_sent, routes(dodag));
+    }
+
+    return 0;
+}
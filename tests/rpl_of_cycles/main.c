@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Cycles of the rank calculation with and without floating point
+ *
+ * Compares the MRHOF rank with the ETX in a double, as it was, against
+ * the fixed point rank, and DAGRank() as a division against the shift of
+ * rpl_dag_rank(). Both variants run over the same parents and the test
+ * checks that they agree. The native CPU has a floating point unit, so
+ * the cycles it reports say little about nodes without one, where every
+ * double operation is a call to soft-float. Run it on the board in
+ * question to compare the variants.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+#include "link_estimator.h"
+#include "of_mrhof.h"
+
+#define PARENTS     (1024)
+#define ROUNDS      (256)
+
+static uint16_t etx[PARENTS];
+static uint16_t rank[PARENTS];
+static rpl_dodag_t dodag;
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static inline uint64_t cycles(void)
+{
+    return __builtin_ia32_rdtsc();
+}
+
+/* MRHOF with the ETX in a double, as it was */
+static uint16_t __attribute__((noinline)) float_rank(double etx_value, uint16_t parent_rank,
+                                                     uint16_t minhoprankincrease)
+{
+    uint16_t pcost;
+
+    if (etx_value == 0 || etx_value * ETX_RANK_MULTIPLIER > MAX_LINK_METRIC) {
+        pcost = MAX_PATH_COST;
+    }
+    else {
+        pcost = etx_value * ETX_RANK_MULTIPLIER + parent_rank;
+    }
+
+    if (pcost < MAX_PATH_COST) {
+        if ((parent_rank + minhoprankincrease) > pcost) {
+            return parent_rank + minhoprankincrease;
+        }
+
+        return pcost;
+    }
+
+    return INFINITE_RANK;
+}
+
+static void report(const char *name, uint64_t c)
+{
+    printf("%-34s %6" PRIu32 ".%02" PRIu32 " cycles per call\n", name,
+           (uint32_t)(c / ((uint64_t) PARENTS * ROUNDS)),
+           (uint32_t)((c * 100 / ((uint64_t) PARENTS * ROUNDS)) % 100));
+}
+
+int main(void)
+{
+    volatile uint32_t sink = 0;
+    uint32_t sum_float = 0, sum_fixed = 0, sum_div = 0, sum_shift = 0;
+    uint64_t start, c_float, c_fixed, c_div, c_shift;
+
+    rpl_set_min_hop_rank_increase(&dodag, DEFAULT_MIN_HOP_RANK_INCREASE);
+
+    for (int i = 0; i < PARENTS; i++) {
+        etx[i] = LINK_ESTIMATOR_ETX_ONE + rng() % (4 * LINK_ESTIMATOR_ETX_ONE);
+        rank[i] = DEFAULT_MIN_HOP_RANK_INCREASE + rng() % (64 * DEFAULT_MIN_HOP_RANK_INCREASE);
+    }
+
+    start = cycles();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < PARENTS; i++) {
+            sum_float += float_rank((double) etx[i] / LINK_ESTIMATOR_ETX_ONE, rank[i],
+                                    DEFAULT_MIN_HOP_RANK_INCREASE);
+        }
+    }
+
+    c_float = cycles() - start;
+    start = cycles();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < PARENTS; i++) {
+            sum_fixed += of_mrhof_rank(etx[i], rank[i], DEFAULT_MIN_HOP_RANK_INCREASE);
+        }
+    }
+
+    c_fixed = cycles() - start;
+    start = cycles();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < PARENTS; i++) {
+            sum_div += rpl_calc_rank(rank[i], dodag.minhoprankincrease);
+        }
+    }
+
+    c_div = cycles() - start;
+    start = cycles();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < PARENTS; i++) {
+            sum_shift += rpl_dag_rank(&dodag, rank[i]);
+        }
+    }
+
+    c_shift = cycles() - start;
+    sink = sum_float + sum_fixed + sum_div + sum_shift;
+    (void) sink;
+
+    printf("%d parents, %d rounds\n", PARENTS, ROUNDS);
+    report("MRHOF rank, double ETX:", c_float);
+    report("MRHOF rank, fixed point ETX:", c_fixed);
+    report("DAGRank, division:", c_div);
+    report("DAGRank, precomputed shift:", c_shift);
+
+    if (sum_float != sum_fixed || sum_div != sum_shift) {
+        puts("ERROR: the ranks differ");
+    }
+    else {
+        puts("done");
+    }
+
+    return 0;
+}
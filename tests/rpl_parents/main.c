@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Parent switches of a node with a flapping parent
+ *
+ * The node hears a DIO from each of its three parents every second.
+ * The link to parent A flaps every five seconds between a rank better
+ * and a rank worse than that of parent B, and parent A is gone for good
+ * after ten minutes. A node that always takes the best parent switches
+ * twice per flap, every switch with a No-Path DAO, DAOs for all targets
+ * and a trickle reset. The test counts the switches and the calls of
+ * the objective function.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+#include "of0.h"
+
+#define PARENTS     (3)
+#define DURATION    (900)
+#define FLAP        (5)
+#define GONE_TIME   (600)
+
+static rpl_of_t counting_of;
+static rpl_of_t *of0;
+static unsigned calc_rank_calls, which_parent_calls;
+
+static uint16_t calc_rank(rpl_parent_t *parent, uint16_t base_rank)
+{
+    calc_rank_calls++;
+    return of0->calc_rank(parent, base_rank);
+}
+
+static rpl_parent_t *which_parent(rpl_parent_t *p1, rpl_parent_t *p2)
+{
+    which_parent_calls++;
+    return of0->which_parent(p1, p2);
+}
+
+/* the advertised rank of parent i at second t */
+static uint16_t parent_rank(int i, int t)
+{
+    switch (i) {
+        case 0:
+            if (t >= GONE_TIME) {
+                return INFINITE_RANK;
+            }
+
+            return ((t / FLAP) % 2) ? 4 * DEFAULT_MIN_HOP_RANK_INCREASE : DEFAULT_MIN_HOP_RANK_INCREASE;
+
+        case 1:
+            return 2 * DEFAULT_MIN_HOP_RANK_INCREASE + DEFAULT_MIN_HOP_RANK_INCREASE / 2;
+
+        default:
+            return 3 * DEFAULT_MIN_HOP_RANK_INCREASE;
+    }
+}
+
+int main(void)
+{
+    rpl_instance_t *inst;
+    rpl_dodag_t *dodag;
+    rpl_parent_t *parent[PARENTS];
+    ipv6_addr_t addr;
+    unsigned dios = 0, naive_switches = 0;
+    int naive = -1;
+
+    of0 = rpl_get_of0();
+    counting_of = *of0;
+    counting_of.calc_rank = calc_rank;
+    counting_of.which_parent = which_parent;
+
+    ipv6_addr_init(&addr, 0xabcd, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1);
+    inst = rpl_new_instance(RPL_DEFAULT_INSTANCE);
+    dodag = rpl_new_dodag(RPL_DEFAULT_INSTANCE, &addr);
+
+    if (inst == NULL || dodag == NULL) {
+        puts("ERROR: no DODAG");
+        return 1;
+    }
+
+    /* no DAOs, the trickle timer is not running */
+    dodag->of = &counting_of;
+    dodag->mop = RPL_NO_DOWNWARD_ROUTES;
+    rpl_set_min_hop_rank_increase(dodag, DEFAULT_MIN_HOP_RANK_INCREASE);
+    dodag->default_lifetime = RPL_DEFAULT_LIFETIME;
+    dodag->lifetime_unit = RPL_LIFETIME_UNIT;
+    dodag->node_status = NORMAL_NODE;
+    dodag->joined = 1;
+
+    for (int i = 0; i < PARENTS; i++) {
+        ipv6_addr_init(&addr, 0xfe80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x10 + i);
+        parent[i] = rpl_new_parent(dodag, &addr, parent_rank(i, 0));
+    }
+
+    for (int t = 0; t < DURATION; t++) {
+        int best = -1;
+
+        for (int i = 0; i < PARENTS; i++) {
+            parent[i]->rank = parent_rank(i, t);
+            rpl_parent_update(dodag, parent[i]);
+            dios++;
+
+            if (parent[i]->rank != INFINITE_RANK &&
+                (best == -1 || parent[i]->rank < parent[best]->rank)) {
+                best = i;
+            }
+        }
+
+        /* the node that always takes the best parent */
+        if (naive != -1 && naive != best) {
+            naive_switches++;
+        }
+
+        naive = best;
+
+        /* what the RPL timer does every second */
+        if (dodag->parent_hold > 0) {
+            dodag->parent_hold--;
+        }
+
+        if (t == GONE_TIME && dodag->my_preferred_parent != parent[1]) {
+            printf("ERROR: parent B not taken right after parent A is gone\n");
+        }
+    }
+
+    printf("%d seconds, %u DIOs, threshold %u, hold %u s\n", DURATION, dios,
+           RPL_PARENT_SWITCH_THRESHOLD, RPL_PARENT_SWITCH_HOLD);
+    printf("always the best parent: %u switches\n", naive_switches);
+    printf("with hysteresis:        %u switches, %u held back\n",
+           dodag->parent_switches, dodag->parent_switches_held);
+    printf("objective function calls per DIO: %u.%02u calc_rank, %u which_parent\n",
+           calc_rank_calls / dios, (calc_rank_calls % dios) * 100 / dios, which_parent_calls);
+
+    if (dodag->my_preferred_parent != parent[1] || dodag->my_rank != parent[1]->cost) {
+        puts("ERROR: wrong parent in the end");
+    }
+    else if (dodag->parent_switches < naive_switches) {
+        puts("done");
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Routing table of an instance against a plain model of it
+ *
+ * Every second random routes are added, refreshed and deleted, and the
+ * routes that expire are taken from the table. The test checks that
+ * exactly the routes of the model expire and that lookups agree.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rpl.h"
+#include "rpl_routing.h"
+
+#define DESTINATIONS    (RPL_MAX_ROUTING_ENTRIES + RPL_MAX_ROUTING_ENTRIES / 2)
+#define DURATION        (3600)
+#define CHANGES         (16)    /* per second */
+#define MAX_LIFETIME    (600)
+
+static rpl_instance_t inst;
+
+/* the model, expires is 0 for destinations without a route */
+static uint32_t expires[DESTINATIONS];
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void destination(unsigned d, ipv6_addr_t *addr)
+{
+    ipv6_addr_init(addr, 0x2001, 0x0db8, 0x0, 0x0, 0x0, 0x0, d >> 16, d & 0xffff);
+}
+
+int main(void)
+{
+    ipv6_addr_t addr, hop;
+    unsigned errors = 0, expired = 0, refreshed = 0, full = 0, routes = 0;
+
+    ipv6_addr_init(&hop, 0xfe80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1);
+
+    for (int t = 1; t <= DURATION && errors < 10; t++) {
+        rpl_routing_entry_t *entry;
+
+        for (int c = 0; c < CHANGES; c++) {
+            unsigned d = rng() % DESTINATIONS;
+
+            destination(d, &addr);
+
+            if (rng() % 8 == 0) {
+                rpl_del_routing_entry(&inst, &addr);
+                routes -= (expires[d] != 0);
+                expires[d] = 0;
+                continue;
+            }
+
+            uint16_t lifetime = 1 + rng() % MAX_LIFETIME;
+
+            refreshed += (expires[d] != 0);
+
+            if (expires[d] == 0 && routes == RPL_MAX_ROUTING_ENTRIES) {
+                full++;
+                continue;
+            }
+
+            routes += (expires[d] == 0);
+
+            rpl_add_routing_entry(&inst, &addr, &hop, lifetime);
+            expires[d] = inst.rt_time + lifetime;
+        }
+
+        /* one second of the routing table clock */
+        rpl_rt_tick(&inst);
+
+        while ((entry = rpl_rt_next_expired(&inst)) != NULL) {
+            unsigned d = (entry->address.uint8[14] << 8) | entry->address.uint8[15];
+
+            if (expires[d] == 0 || expires[d] > inst.rt_time) {
+                printf("ERROR: route %u expired at %d, expected at %lu\n", d, t,
+                       (unsigned long) expires[d]);
+                errors++;
+            }
+
+            rpl_rt_free(&inst, entry);
+            expired++;
+        }
+
+        for (unsigned d = 0; d < DESTINATIONS; d++) {
+            destination(d, &addr);
+            entry = rpl_find_routing_entry(&inst, &addr);
+
+            /* the model decides when a route is over, the table must agree */
+            if (expires[d] != 0 && expires[d] <= inst.rt_time) {
+                if (entry != NULL) {
+                    printf("ERROR: route %u did not expire at %d\n", d, t);
+                    errors++;
+                }
+
+                routes--;
+                expires[d] = 0;
+                continue;
+            }
+
+            if ((entry != NULL) != (expires[d] != 0) ||
+                (entry != NULL && rpl_get_routing_entry_lifetime(&inst, entry) !=
+                 expires[d] - inst.rt_time)) {
+                printf("ERROR: route %u at %d\n", d, t);
+                errors++;
+            }
+        }
+    }
+
+    printf("%u entries, %d seconds: %u refreshed, %u expired, %u not added to a full table\n",
+           RPL_MAX_ROUTING_ENTRIES, DURATION, refreshed, expired, full);
+    printf("%u routes in the end\n", routes);
+
+    if (errors == 0) {
+        puts("done");
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief   Counts the TCP segments needed to transfer a KB in small writes,
+ *          with Nagle coalescing and with TCP_NODELAY
+ *
+ * Start two native instances on a bridged tap pair, the receiver first:
+ *
+ *     R_ADDR=2 make term PORT=tap1
+ *     R_ADDR=1 make term PORT=tap0
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net_if.h"
+#include "sixlowpan.h"
+#include "ipv6.h"
+#include "socket_base/in.h"
+#include "socket_base/socket.h"
+#include "tcp_stats.h"
+
+#ifndef R_ADDR
+#define R_ADDR      (1)
+#endif
+
+#ifndef WRITE_SIZE
+#define WRITE_SIZE  (8)
+#endif
+
+#define PORT        (1234)
+#define TRANSFER    (1024)
+
+static int init_local_address(uint16_t r_addr)
+{
+    ipv6_addr_t std_addr;
+    ipv6_addr_init(&std_addr, 0xabcd, 0xef12, 0, 0, 0x1034, 0x00ff, 0xfe00,
+                   0);
+    net_if_set_src_address_mode(0, NET_IF_TRANS_ADDR_M_SHORT);
+    return net_if_set_hardware_address(0, r_addr) &&
+           sixlowpan_lowpan_init_adhoc_interface(0, &std_addr);
+}
+
+#if R_ADDR == 1
+/* Sends TRANSFER bytes in WRITE_SIZE writes, returns the segments sent and
+ * received for it, handshake and teardown included */
+static int32_t transfer(int nodelay)
+{
+    uint8_t buf[WRITE_SIZE];
+    sockaddr6_t addr;
+    tcp_stats_t before, after;
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_port = HTONS(PORT);
+    ipv6_addr_init(&addr.sin6_addr, 0xabcd, 0xef12, 0, 0, 0x1034, 0x00ff,
+                   0xfe00, 2);
+    memset(buf, 'x', sizeof(buf));
+
+    if ((s < 0) ||
+        (socket_base_setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay,
+                                sizeof(nodelay)) < 0)) {
+        return -1;
+    }
+
+    tcp_stats_get(0, &before);
+
+    if (socket_base_connect(s, &addr, sizeof(addr)) < 0) {
+        socket_base_close(s);
+        return -1;
+    }
+
+    for (int sent = 0; sent < TRANSFER; sent += WRITE_SIZE) {
+        if (socket_base_send(s, buf, WRITE_SIZE, 0) < 0) {
+            socket_base_close(s);
+            return -1;
+        }
+    }
+
+    socket_base_close(s);
+    tcp_stats_get(0, &after);
+
+    return (after.segs_out - before.segs_out) + (after.segs_in - before.segs_in);
+}
+#endif
+
+int main(void)
+{
+    if (!init_local_address(R_ADDR)) {
+        printf("ERROR: Can not initialize IP for hardware address %d.\n", R_ADDR);
+        return 1;
+    }
+
+#if R_ADDR == 1
+    int32_t nagle = transfer(0);
+    int32_t nodelay = transfer(1);
+
+    if ((nagle < 0) || (nodelay < 0)) {
+        puts("ERROR: transfer failed");
+        return 1;
+    }
+
+    printf("%u byte writes, frames per KB: Nagle %" PRIi32 ", TCP_NODELAY %" PRIi32 "\n",
+           WRITE_SIZE, nagle * 1024 / TRANSFER, nodelay * 1024 / TRANSFER);
+    tcp_stats_print(0);
+#else
+    uint8_t buf[TRANSPORT_LAYER_SOCKET_STATIC_MSS];
+    sockaddr6_t addr;
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_port = HTONS(PORT);
+
+    if ((socket_base_bind(s, &addr, sizeof(addr)) < 0) ||
+        (socket_base_listen(s, 1) < 0)) {
+        puts("ERROR: Can not listen");
+        return 1;
+    }
+
+    while (1) {
+        int c = socket_base_accept(s, NULL, NULL);
+        int32_t received = 0, res;
+
+        while ((res = socket_base_recv(c, buf, sizeof(buf), 0)) > 0) {
+            received += res;
+        }
+
+        socket_base_close(c);
+        printf("Received %" PRIi32 " bytes\n", received);
+    }
+#endif
+
+    return 0;
+}
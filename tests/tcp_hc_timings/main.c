@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup   tests
+ * @{
+ *
+ * @file
+ * @brief     Measure the per-segment cost of TCP header compression
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hwtimer.h"
+
+#include "socket_base/socket.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_hc.h"
+
+#define TIMEOUT_S (5)
+#define TIMEOUT_US (TIMEOUT_S * 1000 * 1000)
+#define TIMEOUT (HWTIMER_TICKS(TIMEOUT_US))
+#define PER_ITERATION (4)
+
+static tcp_hc_context_t context;
+static ipv6_hdr_t ipv6_header;
+static uint16_t context_ids[MAX_SOCKETS];
+
+static void callback(void *done_)
+{
+    volatile int *done = done_;
+    *done = 1;
+}
+
+static void run_test(const char *name, void (*test)(unsigned))
+{
+    volatile int done = 0;
+    unsigned i = 0;
+    unsigned long count = 0;
+
+    hwtimer_set(TIMEOUT, callback, (void *) &done);
+    do {
+        for (unsigned j = 0; j < PER_ITERATION; ++j) {
+            test(i++);
+        }
+
+        ++count;
+    } while (done == 0);
+
+    printf("+ %s: %lu iterations per second\r\n", name, PER_ITERATION * count / TIMEOUT_S);
+}
+
+#define run_test(test) run_test(#test, test)
+
+static void compress_decompress(unsigned i)
+{
+    uint8_t buf[TCP_HC_MAX_HDR_LEN];
+    tcp_hdr_t header;
+
+    memset(&header, 0, sizeof(header));
+    header.seq_nr = context.seq_snd + (i & 0x3f);
+    header.ack_nr = context.ack_snd;
+    header.window = context.wnd_snd;
+    header.reserved_flags = TCP_ACK;
+
+    tcp_hc_compress_header(buf, &header, &context, COMPRESSED_HEADER);
+    tcp_hc_decompress_header(&header, buf, &context);
+}
+
+static void lookup_by_context(unsigned i)
+{
+    volatile socket_internal_t *sock;
+    sock = get_tcp_socket_by_context(&ipv6_header, context_ids[i % MAX_SOCKETS]);
+    (void) sock;
+}
+
+int main(void)
+{
+    printf("Start.\r\n");
+
+    context.context_id = 0x42;
+    context.seq_snd = context.seq_rcv = 0x10000000;
+    context.ack_snd = context.ack_rcv = 0x20000000;
+    context.wnd_snd = context.wnd_rcv = TRANSPORT_LAYER_SOCKET_STATIC_WINDOW;
+
+    ipv6_addr_set_loopback_addr(&ipv6_header.destaddr);
+    ipv6_addr_set_loopback_addr(&ipv6_header.srcaddr);
+
+    /* fill the socket table with established connections */
+    for (int i = 0; i < MAX_SOCKETS; i++) {
+        int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+        socket_internal_t *sock = socket_base_get_socket(s);
+
+        sock->socket_values.local_address.sin6_addr = ipv6_header.destaddr;
+        sock->socket_values.foreign_address.sin6_addr = ipv6_header.srcaddr;
+        sock->socket_values.tcp_control.tcp_context.context_id = 0x100 + 7 * i;
+        sock->socket_values.tcp_control.state = TCP_ESTABLISHED;
+        context_ids[i] = 0x100 + 7 * i;
+        tcp_hc_context_add(sock);
+    }
+
+    run_test(compress_decompress);
+    run_test(lookup_by_context);
+
+    printf("Done.\r\n");
+    return 0;
+}
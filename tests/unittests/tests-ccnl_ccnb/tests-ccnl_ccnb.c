@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "hwtimer.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+
+#include "tests-ccnl_ccnb.h"
+
+#define FRAME_SIZE  (200)
+#define FUZZ_RUNS   (2000)
+#define BENCH_RUNS  (1000)
+
+static char *name[] = { "riot", "text", "7", NULL };
+static unsigned int nonce_value = 0x01020304;
+static unsigned char frame[FRAME_SIZE];
+static uint32_t seed;
+
+static uint32_t fuzz_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static int interest_frame(unsigned char *out)
+{
+    return mkInterest(name, &nonce_value, out);
+}
+
+static int content_frame(unsigned char *out)
+{
+    return mkContent(name, "hello", 5, out);
+}
+
+static int parse(unsigned char *f, int len, struct ccnl_pkt_view_s *v)
+{
+    unsigned char *data = f + 2;
+    int datalen = len - 2;
+
+    return ccnl_ccnb_parse(&data, &datalen, v);
+}
+
+static int in_frame(unsigned char *f, int len, unsigned char *p, int plen)
+{
+    return !p || (p >= f && plen >= 0 && p + plen <= f + len);
+}
+
+// everything a view points to must lie within the frame it was parsed from
+static int view_in_frame(struct ccnl_pkt_view_s *v, unsigned char *f, int len)
+{
+    if (v->start != f || v->len > len || v->compcnt > CCNL_MAX_NAME_COMP) {
+        return 0;
+    }
+
+    for (int k = 0; k < v->compcnt; k++) {
+        if (!in_frame(f, len, v->comp[k], v->complen[k])) {
+            return 0;
+        }
+    }
+
+    return in_frame(f, len, v->nonce, v->noncelen)
+           && in_frame(f, len, v->ppkd, v->ppkdlen)
+           && in_frame(f, len, v->content, v->contlen)
+           && in_frame(f, len, v->finalblock, v->finalblocklen);
+}
+
+static void set_up(void)
+{
+    memset(frame, 0, sizeof(frame));
+    seed = 42;
+}
+
+static void test_ccnl_ccnb_parse_interest(void)
+{
+    struct ccnl_pkt_view_s v;
+    int len = interest_frame(frame);
+
+    TEST_ASSERT_EQUAL_INT(0, parse(frame, len, &v));
+    TEST_ASSERT_EQUAL_INT(len, v.len);
+    TEST_ASSERT_EQUAL_INT(3, v.compcnt);
+    TEST_ASSERT_EQUAL_INT(4, v.complen[1]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(v.comp[1], "text", 4));
+    TEST_ASSERT_NULL(v.comp[3]);
+    TEST_ASSERT_EQUAL_INT(sizeof(unsigned int), v.noncelen);
+    TEST_ASSERT_NULL(v.content);
+    TEST_ASSERT_EQUAL_INT(3, v.scope);
+    TEST_ASSERT(view_in_frame(&v, frame, len));
+}
+
+static void test_ccnl_ccnb_parse_content(void)
+{
+    struct ccnl_pkt_view_s v;
+    int len = content_frame(frame);
+
+    TEST_ASSERT_EQUAL_INT(0, parse(frame, len, &v));
+    TEST_ASSERT_EQUAL_INT(len, v.len);
+    TEST_ASSERT_EQUAL_INT(3, v.compcnt);
+    TEST_ASSERT_EQUAL_INT(5, v.contlen);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(v.content, "hello", 5));
+    TEST_ASSERT_NULL(v.nonce);
+    TEST_ASSERT_NULL(v.finalblock);
+}
+
+static void test_ccnl_ccnb_parse_final_block(void)
+{
+    struct ccnl_pkt_view_s v;
+    int len = mkChunk(name, "12", "hello", 5, frame);
+
+    TEST_ASSERT_EQUAL_INT(0, parse(frame, len, &v));
+    TEST_ASSERT_EQUAL_INT(len, v.len);
+    TEST_ASSERT_EQUAL_INT(3, v.compcnt);
+    TEST_ASSERT_EQUAL_INT(2, v.finalblocklen);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(v.finalblock, "12", 2));
+    TEST_ASSERT_EQUAL_INT(5, v.contlen);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(v.content, "hello", 5));
+    TEST_ASSERT(view_in_frame(&v, frame, len));
+}
+
+static void test_ccnl_ccnb_view_copy(void)
+{
+    struct ccnl_pkt_view_s v;
+    struct ccnl_prefix_s *p;
+    struct ccnl_buf_s *buf;
+    unsigned char *content;
+    int len = content_frame(frame);
+
+    TEST_ASSERT_EQUAL_INT(0, parse(frame, len, &v));
+    buf = ccnl_pkt_view_copy(&v, &p, &content);
+    TEST_ASSERT_NOT_NULL(buf);
+
+    /* the copy does not refer to the frame anymore */
+    memset(frame, 0, sizeof(frame));
+
+    TEST_ASSERT_EQUAL_INT(len, (int) buf->datalen);
+    TEST_ASSERT_EQUAL_INT(3, p->compcnt);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(p->comp[0], "riot", 4));
+    TEST_ASSERT(p->comp[2] > buf->data && p->comp[2] < buf->data + len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(content, "hello", 5));
+
+    free_prefix(p);
+    ccnl_buf_free(buf);
+}
+
+static void test_ccnl_ccnb_extract(void)
+{
+    unsigned char *data = frame + 2, *content;
+    int len = interest_frame(frame), datalen = len - 2, contlen;
+    int scope = 3, aok = 3, minsfx = 0, maxsfx = CCNL_MAX_NAME_COMP;
+    struct ccnl_buf_s *buf, *nonce = NULL, *ppkd = NULL;
+    struct ccnl_prefix_s *p = NULL;
+
+    buf = ccnl_extract_prefix_nonce_ppkd(&data, &datalen, &scope, &aok, &minsfx,
+                                         &maxsfx, &p, &nonce, &ppkd, &content,
+                                         &contlen);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL_INT(len, (int) buf->datalen);
+    TEST_ASSERT_EQUAL_INT(0, datalen);
+    TEST_ASSERT_EQUAL_INT(3, p->compcnt);
+    TEST_ASSERT_NOT_NULL(nonce);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(nonce->data, &nonce_value, sizeof(nonce_value)));
+    TEST_ASSERT_NULL(ppkd);
+
+    free_prefix(p);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(nonce);
+}
+
+static void test_ccnl_ccnb_truncated(void)
+{
+    struct ccnl_pkt_view_s v;
+    int len = content_frame(frame);
+
+    for (int cut = 2; cut < len; cut++) {
+        if (parse(frame, cut, &v) == 0) {
+            TEST_ASSERT(view_in_frame(&v, frame, cut));
+        }
+    }
+}
+
+static void test_ccnl_ccnb_fuzz(void)
+{
+    struct ccnl_pkt_view_s v;
+    unsigned char template[2][FRAME_SIZE];
+    int tlen[2] = { interest_frame(template[0]), content_frame(template[1]) };
+
+    for (int run = 0; run < FUZZ_RUNS; run++) {
+        int t = run & 1, len = tlen[t];
+
+        memcpy(frame, template[t], len);
+
+        /* flip a few bytes and maybe cut the tail */
+        for (int k = fuzz_rand() % 4; k >= 0; k--) {
+            frame[2 + fuzz_rand() % (len - 2)] = fuzz_rand();
+        }
+
+        if (fuzz_rand() & 1) {
+            len = 2 + fuzz_rand() % (len - 2);
+        }
+
+        if (parse(frame, len, &v) == 0) {
+            TEST_ASSERT(view_in_frame(&v, frame, len));
+        }
+    }
+
+    /* and plain noise */
+    for (int run = 0; run < FUZZ_RUNS; run++) {
+        int len = 2 + fuzz_rand() % (FRAME_SIZE - 2);
+
+        for (int k = 0; k < len; k++) {
+            frame[k] = fuzz_rand();
+        }
+
+        if (parse(frame, len, &v) == 0) {
+            TEST_ASSERT(view_in_frame(&v, frame, len));
+        }
+    }
+}
+
+static void test_ccnl_ccnb_bench(void)
+{
+    struct ccnl_pkt_view_s v;
+    unsigned long start, view_ticks, extract_ticks;
+    int len = content_frame(frame), ok = 0;
+
+    start = hwtimer_now();
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        ok += (parse(frame, len, &v) == 0);
+    }
+
+    view_ticks = hwtimer_now() - start;
+    start = hwtimer_now();
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        unsigned char *data = frame + 2, *content;
+        int datalen = len - 2, contlen;
+        struct ccnl_prefix_s *p = NULL;
+        struct ccnl_buf_s *buf, *nonce = NULL, *ppkd = NULL;
+
+        buf = ccnl_extract_prefix_nonce_ppkd(&data, &datalen, NULL, NULL, NULL,
+                                             NULL, &p, &nonce, &ppkd, &content,
+                                             &contlen);
+        ok += (buf != NULL);
+        free_prefix(p);
+        ccnl_buf_free(buf);
+        ccnl_buf_free(nonce);
+        ccnl_buf_free(ppkd);
+    }
+
+    extract_ticks = hwtimer_now() - start;
+
+    printf("\nccnb parser, %d packets: view %lu us, copy %lu us\n", BENCH_RUNS,
+           (unsigned long) HWTIMER_TICKS_TO_US(view_ticks),
+           (unsigned long) HWTIMER_TICKS_TO_US(extract_ticks));
+
+    TEST_ASSERT_EQUAL_INT(2 * BENCH_RUNS, ok);
+}
+
+Test *tests_ccnl_ccnb_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_ccnb_parse_interest),
+        new_TestFixture(test_ccnl_ccnb_parse_content),
+        new_TestFixture(test_ccnl_ccnb_parse_final_block),
+        new_TestFixture(test_ccnl_ccnb_view_copy),
+        new_TestFixture(test_ccnl_ccnb_extract),
+        new_TestFixture(test_ccnl_ccnb_truncated),
+        new_TestFixture(test_ccnl_ccnb_fuzz),
+        new_TestFixture(test_ccnl_ccnb_bench),
+    };
+
+    EMB_UNIT_TESTCALLER(ccnl_ccnb_tests, set_up, NULL, fixtures);
+
+    return (Test *)&ccnl_ccnb_tests;
+}
+
+void tests_ccnl_ccnb(void)
+{
+    TESTS_RUN(tests_ccnl_ccnb_tests());
+}
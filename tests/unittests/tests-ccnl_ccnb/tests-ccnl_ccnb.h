@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-ccnl_ccnb.h
+ * @brief       Unittests, fuzzing and a benchmark for the ccnb parser of
+ *              the ``ccn_lite`` module
+ */
+#ifndef __TESTS_CCNL_CCNB_H_
+#define __TESTS_CCNL_CCNB_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_ccnl_ccnb(void);
+
+/**
+ * @brief   Generates tests for ccnl-ccnb.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_ccnl_ccnb_tests(void);
+
+#endif /* __TESTS_CCNL_CCNB_H_ */
+/** @} */
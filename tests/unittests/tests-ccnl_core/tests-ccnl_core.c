@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-includes.h"
+#include "ccnl-platform.h"
+
+#include "tests-ccnl_core.h"
+
+/* one more than a probe window holds */
+#define COLLIDING   (CCNL_NONCE_PROBES + 2)
+#define TIMERS      (4)
+#define SEC         (1000 * 1000)
+#define RETRANSMIT  TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC)
+
+static struct ccnl_relay_s relay;
+static uint32_t colliding[COLLIDING];
+static struct ccnl_timer_s timers[TIMERS];
+static int fired[TIMERS], fired_cnt;
+
+static void set_up(void)
+{
+    memset(&relay, 0, sizeof(relay));
+}
+
+static void tear_down(void)
+{
+    ccnl_core_cleanup(&relay);
+    ccnl_timer_cleanup();
+    memset(timers, 0, sizeof(timers));
+    fired_cnt = 0;
+}
+
+static int nonce(uint32_t value)
+{
+    return ccnl_nonce_find_or_append(&relay, (unsigned char *) &value, sizeof(value));
+}
+
+static int home(uint32_t value)
+{
+    return ccnl_hash_comp(CCNL_HASH_INIT, (unsigned char *) &value, sizeof(value))
+           & (CCNL_MAX_NONCES - 1);
+}
+
+/* nonces that all start probing at the slot of 0 */
+static void find_colliding(void)
+{
+    int n = 0;
+
+    for (uint32_t value = 0; n < COLLIDING; value++) {
+        if (home(value) == home(0)) {
+            colliding[n++] = value;
+        }
+    }
+}
+
+static struct ccnl_nonce_s *slot_of(uint32_t value)
+{
+    for (int k = 0; k < CCNL_MAX_NONCES; k++) {
+        if (relay.nonces[k].len == sizeof(value)
+            && !memcmp(relay.nonces[k].data, &value, sizeof(value))) {
+            return &relay.nonces[k];
+        }
+    }
+
+    return NULL;
+}
+
+static int used_slots(void)
+{
+    int n = 0;
+
+    for (int k = 0; k < CCNL_MAX_NONCES; k++) {
+        n += relay.nonces[k].len != 0;
+    }
+
+    return n;
+}
+
+static void test_ccnl_core_nonce_known(void)
+{
+    unsigned char longer[2][CCNL_NONCE_LEN + 4];
+
+    TEST_ASSERT_EQUAL_INT(0, nonce(1));
+    TEST_ASSERT_EQUAL_INT(-1, nonce(1));
+    TEST_ASSERT_EQUAL_INT(0, nonce(2));
+    TEST_ASSERT_EQUAL_INT(-1, nonce(1));
+    TEST_ASSERT_EQUAL_INT(2, used_slots());
+
+    /* nonces longer than the stored bytes are told apart by their hash */
+    memset(longer, 0xaa, sizeof(longer));
+    longer[1][CCNL_NONCE_LEN + 3] = 0x55;
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, longer[0],
+                          sizeof(longer[0])));
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, longer[1],
+                          sizeof(longer[1])));
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_nonce_find_or_append(&relay, longer[1],
+                          sizeof(longer[1])));
+}
+
+static void test_ccnl_core_nonce_probes(void)
+{
+    find_colliding();
+
+    /* the window takes CCNL_NONCE_PROBES nonces of the same slot */
+    for (int k = 0; k < CCNL_NONCE_PROBES; k++) {
+        TEST_ASSERT_EQUAL_INT(0, nonce(colliding[k]));
+    }
+
+    for (int k = 0; k < CCNL_NONCE_PROBES; k++) {
+        TEST_ASSERT_EQUAL_INT(-1, nonce(colliding[k]));
+        TEST_ASSERT(slot_of(colliding[k]) - relay.nonces
+                    == ((home(0) + k) & (CCNL_MAX_NONCES - 1)));
+    }
+
+    /* a full window gives up its oldest nonce */
+    slot_of(colliding[3])->created -= 10;
+    TEST_ASSERT_EQUAL_INT(0, nonce(colliding[CCNL_NONCE_PROBES]));
+    TEST_ASSERT_EQUAL_INT(CCNL_NONCE_PROBES, used_slots());
+    TEST_ASSERT_NULL(slot_of(colliding[3]));
+
+    for (int k = 0; k <= CCNL_NONCE_PROBES; k++) {
+        if (k != 3) {
+            TEST_ASSERT_EQUAL_INT(-1, nonce(colliding[k]));
+        }
+    }
+}
+
+static void test_ccnl_core_nonce_expiry(void)
+{
+    find_colliding();
+
+    TEST_ASSERT_EQUAL_INT(0, nonce(colliding[0]));
+    slot_of(colliding[0])->created -= CCNL_NONCE_TIMEOUT_MS + 1;
+
+    /* an expired nonce is new again */
+    TEST_ASSERT_EQUAL_INT(0, nonce(colliding[0]));
+    TEST_ASSERT_EQUAL_INT(-1, nonce(colliding[0]));
+    memset(relay.nonces, 0, sizeof(relay.nonces));
+
+    /* a full window takes an expired slot before its oldest nonce */
+    for (int k = 0; k < CCNL_NONCE_PROBES; k++) {
+        TEST_ASSERT_EQUAL_INT(0, nonce(colliding[k]));
+    }
+
+    slot_of(colliding[2])->created -= 10;
+    slot_of(colliding[5])->created -= CCNL_NONCE_TIMEOUT_MS + 1;
+    TEST_ASSERT_EQUAL_INT(0, nonce(colliding[CCNL_NONCE_PROBES]));
+    TEST_ASSERT_NULL(slot_of(colliding[5]));
+    TEST_ASSERT_EQUAL_INT(-1, nonce(colliding[2]));
+
+    /* then the oldest one goes */
+    TEST_ASSERT_EQUAL_INT(0, nonce(colliding[CCNL_NONCE_PROBES + 1]));
+    TEST_ASSERT_NULL(slot_of(colliding[2]));
+    TEST_ASSERT_EQUAL_INT(-1, nonce(colliding[CCNL_NONCE_PROBES]));
+}
+
+static void record(void *aux1, void *aux2)
+{
+    (void) aux2;
+
+    fired[fired_cnt++] = (struct ccnl_timer_s *) aux1 - timers;
+}
+
+/* arms timers[k] usec from now, in the past if negative */
+static void arm(int k, long usec)
+{
+    struct timeval base;
+
+    ccnl_get_timeval(&base);
+    base.tv_sec -= 2;
+    TEST_ASSERT_EQUAL_INT(0, ccnl_timer_set(&timers[k], &base, 2 * SEC + usec,
+                                            record, &timers[k], NULL));
+}
+
+/* lets the timer t of an entry fire at the next ccnl_run_events() */
+static void expire(struct ccnl_timer_s *t)
+{
+    struct timeval now;
+
+    ccnl_get_timeval(&now);
+    now.tv_sec--;
+    ccnl_timer_set(t, &now, 0, t->fct, t->aux1, t->aux2);
+}
+
+/* moves the time an entry was last used usec back */
+static void backdate(struct timeval *last_used, long usec)
+{
+    last_used->tv_sec -= usec / SEC;
+    last_used->tv_usec -= usec % SEC;
+}
+
+static void test_ccnl_core_timer_order(void)
+{
+    long usec;
+
+    arm(0, -3000);
+    arm(1, -1000);
+    arm(2, 10 * SEC);
+    arm(3, -2000);
+    TEST_ASSERT(ccnl_timer_first() == &timers[0]);
+
+    /* the expired ones by deadline, then the time to the next */
+    usec = ccnl_run_events();
+    TEST_ASSERT_EQUAL_INT(3, fired_cnt);
+    TEST_ASSERT_EQUAL_INT(0, fired[0]);
+    TEST_ASSERT_EQUAL_INT(3, fired[1]);
+    TEST_ASSERT_EQUAL_INT(1, fired[2]);
+    TEST_ASSERT(usec > 9 * SEC && usec <= 10 * SEC);
+    TEST_ASSERT_EQUAL_INT(0, timers[0].pos);
+    TEST_ASSERT(ccnl_timer_first() == &timers[2]);
+
+    /* re-arming moves a timer in the heap */
+    arm(2, -1000);
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_run_events());
+    TEST_ASSERT_EQUAL_INT(4, fired_cnt);
+    TEST_ASSERT_EQUAL_INT(2, fired[3]);
+    TEST_ASSERT_NULL(ccnl_timer_first());
+}
+
+static void test_ccnl_core_timer_cancel(void)
+{
+    arm(0, -3000);
+    arm(1, -2000);
+    arm(2, -1000);
+    arm(3, SEC);
+
+    ccnl_timer_cancel(&timers[1]);
+    TEST_ASSERT_EQUAL_INT(0, timers[1].pos);
+    ccnl_timer_cancel(&timers[1]);
+
+    /* cancelling the last one of the heap */
+    ccnl_timer_cancel(&timers[3]);
+
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_run_events());
+    TEST_ASSERT_EQUAL_INT(2, fired_cnt);
+    TEST_ASSERT_EQUAL_INT(0, fired[0]);
+    TEST_ASSERT_EQUAL_INT(2, fired[1]);
+}
+
+static struct ccnl_face_s *face_of(uint16_t faceid)
+{
+    for (struct ccnl_face_s *f = relay.faces; f; f = f->next) {
+        if (f->faceid == faceid) {
+            return f;
+        }
+    }
+
+    return NULL;
+}
+
+static void test_ccnl_core_timer_face(void)
+{
+    long timeout = TIMEOUT_TO_US(CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC);
+    struct ccnl_face_s *f = ccnl_get_face_or_create(&relay, RIOT_MSG_IDX, 7);
+
+    TEST_ASSERT_NOT_NULL(f);
+
+    /* a face used since its timer was armed gets a new deadline */
+    expire(&f->timer);
+    ccnl_run_events();
+    TEST_ASSERT(face_of(7) == f);
+    TEST_ASSERT(f->timer.pos != 0);
+    TEST_ASSERT_EQUAL_INT(timeout, timevaldelta(&f->timer.timeout, &f->last_used));
+
+    /* an idle one goes */
+    backdate(&f->last_used, timeout);
+    expire(&f->timer);
+    ccnl_run_events();
+    TEST_ASSERT_NULL(face_of(7));
+}
+
+static void test_ccnl_core_timer_forward(void)
+{
+    long timeout = TIMEOUT_TO_US(CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC);
+    struct ccnl_face_s *f = ccnl_get_face_or_create(&relay, RIOT_MSG_IDX, 7);
+    struct ccnl_prefix_s *p = ccnl_prefix_new(1);
+    struct ccnl_forward_s *fwd;
+
+    p->compcnt = 1;
+    p->comp[0] = (unsigned char *) "a";
+    p->complen[0] = 1;
+    ccnl_content_learn_name_route(&relay, p, f, 0, 0);
+    free_prefix(p);
+    fwd = relay.fib;
+    TEST_ASSERT_NOT_NULL(fwd);
+
+    expire(&fwd->timer);
+    ccnl_run_events();
+    TEST_ASSERT(relay.fib == fwd);
+    TEST_ASSERT_EQUAL_INT(timeout, timevaldelta(&fwd->timer.timeout, &fwd->last_used));
+
+    /* the face outlives its route */
+    backdate(&fwd->last_used, timeout);
+    expire(&fwd->timer);
+    ccnl_run_events();
+    TEST_ASSERT_NULL(relay.fib);
+    TEST_ASSERT(face_of(7) == f);
+}
+
+static void test_ccnl_core_timer_interest(void)
+{
+    long timeout = TIMEOUT_TO_US(CCNL_INTEREST_TIMEOUT_SEC, CCNL_INTEREST_TIMEOUT_USEC);
+    struct ccnl_buf_s *pkt = ccnl_buf_new("i", 1), *ppkd = NULL;
+    struct ccnl_prefix_s *p = ccnl_prefix_new(1);
+    struct ccnl_interest_s *i;
+
+    p->compcnt = 1;
+    p->comp[0] = (unsigned char *) "a";
+    p->complen[0] = 1;
+    i = ccnl_interest_new(&relay, NULL, &pkt, &p, 0, CCNL_MAX_NAME_COMP, &ppkd);
+    TEST_ASSERT_NOT_NULL(i);
+    TEST_ASSERT_EQUAL_INT(RETRANSMIT, timevaldelta(&i->timer.timeout, &i->last_used));
+
+    /* every period without an answer sends it again */
+    for (int k = 1; k <= CCNL_MAX_INTEREST_RETRANSMIT + 1; k++) {
+        expire(&i->timer);
+        ccnl_run_events();
+        TEST_ASSERT(relay.pit == i);
+        TEST_ASSERT_EQUAL_INT(k, i->retries);
+        TEST_ASSERT_EQUAL_INT(RETRANSMIT, timevaldelta(&i->timer.timeout, &i->last_used));
+    }
+
+    /* then it waits for the rest of its lifetime ... */
+    expire(&i->timer);
+    ccnl_run_events();
+    TEST_ASSERT(relay.pit == i);
+    TEST_ASSERT_EQUAL_INT(CCNL_MAX_INTEREST_RETRANSMIT + 1, i->retries);
+    TEST_ASSERT_EQUAL_INT(timeout, timevaldelta(&i->timer.timeout, &i->last_used));
+
+    /* ... and expires */
+    backdate(&i->last_used, timeout);
+    expire(&i->timer);
+    ccnl_run_events();
+    TEST_ASSERT_NULL(relay.pit);
+    TEST_ASSERT_NULL(ccnl_timer_first());
+}
+
+Test *tests_ccnl_core_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_core_nonce_known),
+        new_TestFixture(test_ccnl_core_nonce_probes),
+        new_TestFixture(test_ccnl_core_nonce_expiry),
+        new_TestFixture(test_ccnl_core_timer_order),
+        new_TestFixture(test_ccnl_core_timer_cancel),
+        new_TestFixture(test_ccnl_core_timer_face),
+        new_TestFixture(test_ccnl_core_timer_forward),
+        new_TestFixture(test_ccnl_core_timer_interest),
+    };
+
+    EMB_UNIT_TESTCALLER(ccnl_core_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&ccnl_core_tests;
+}
+
+void tests_ccnl_core(void)
+{
+    TESTS_RUN(tests_ccnl_core_tests());
+}
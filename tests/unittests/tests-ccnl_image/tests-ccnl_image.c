@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "hwtimer.h"
+#include "crypto/sha256.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+
+#include "tests-ccnl_image.h"
+
+#define CHUNKS      (20)
+#define CHUNK_SIZE  (100)
+#define BENCH_RUNS  (1000)
+
+static unsigned char image[CHUNKS * CHUNK_SIZE];
+static int image_len;
+static int offset[CHUNKS];
+static struct ccnl_relay_s relay;
+
+// the chunks are /riot/fw/<k>, in the image the last one comes first
+static void set_up(void)
+{
+    char seq[4], data[16];
+    char *name[] = { "riot", "fw", seq, NULL };
+
+    memset(&relay, 0, sizeof(relay));
+    image_len = 0;
+
+    for (int k = CHUNKS - 1; k >= 0; k--) {
+        sprintf(seq, "%d", k);
+        sprintf(data, "chunk %d", k);
+        offset[k] = image_len;
+        image_len += mkContent(name, data, strlen(data), image + image_len);
+    }
+}
+
+static void tear_down(void)
+{
+    ccnl_image_cleanup(&relay);
+}
+
+static struct ccnl_buf_s *lookup(char **name, int minsfx, int maxsfx)
+{
+    unsigned char *comp[CCNL_MAX_NAME_COMP + 1];
+    int complen[CCNL_MAX_NAME_COMP];
+    struct ccnl_prefix_s p = { comp, complen, 0, NULL };
+
+    for (; name[p.compcnt]; p.compcnt++) {
+        comp[p.compcnt] = (unsigned char *) name[p.compcnt];
+        complen[p.compcnt] = strlen(name[p.compcnt]);
+    }
+
+    comp[p.compcnt] = NULL;
+    return ccnl_image_lookup(&relay, &p, NULL, minsfx, maxsfx);
+}
+
+static int is_chunk(struct ccnl_buf_s *buf, int k)
+{
+    return buf && buf->data == image + offset[k];
+}
+
+static void test_ccnl_image_add(void)
+{
+    TEST_ASSERT_EQUAL_INT(CHUNKS, ccnl_image_add(&relay, image, image_len));
+    TEST_ASSERT_EQUAL_INT(CHUNKS, relay.imagecnt);
+
+    /* adding the same objects again does not index them twice */
+    TEST_ASSERT_EQUAL_INT(0, ccnl_image_add(&relay, image, image_len));
+    TEST_ASSERT_EQUAL_INT(CHUNKS, relay.imagecnt);
+}
+
+static void test_ccnl_image_add_garbage(void)
+{
+    unsigned char noise[] = { 0x01, 0xd2, 0xf2, 0xfa, 0x00, 0x00 };
+
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_image_add(&relay, noise, sizeof(noise)));
+    TEST_ASSERT_EQUAL_INT(0, relay.imagecnt);
+}
+
+static void test_ccnl_image_lookup_exact(void)
+{
+    char *name[] = { "riot", "fw", "13", NULL };
+    struct ccnl_buf_s *buf;
+
+    ccnl_image_add(&relay, image, image_len);
+    buf = lookup(name, 0, CCNL_MAX_NAME_COMP);
+
+    /* the answer borrows the object from the image */
+    TEST_ASSERT(is_chunk(buf, 13));
+    TEST_ASSERT_EQUAL_INT(offset[12] - offset[13], (int) buf->datalen);
+    ccnl_buf_free(buf);
+}
+
+static void test_ccnl_image_lookup_prefix(void)
+{
+    char *fw[] = { "riot", "fw", NULL };
+    char *riot[] = { "riot", NULL };
+    char *other[] = { "riot", "text", NULL };
+    struct ccnl_buf_s *buf;
+
+    ccnl_image_add(&relay, image, image_len);
+
+    /* shorter components sort first, so /riot/fw/0 before /riot/fw/10 */
+    buf = lookup(fw, 0, CCNL_MAX_NAME_COMP);
+    TEST_ASSERT(is_chunk(buf, 0));
+    ccnl_buf_free(buf);
+
+    buf = lookup(riot, 0, CCNL_MAX_NAME_COMP);
+    TEST_ASSERT(is_chunk(buf, 0));
+    ccnl_buf_free(buf);
+
+    /* one more component and the digest */
+    TEST_ASSERT_NULL(lookup(fw, 0, 1));
+    TEST_ASSERT_NULL(lookup(riot, 0, 2));
+    TEST_ASSERT_NULL(lookup(other, 0, CCNL_MAX_NAME_COMP));
+}
+
+static void test_ccnl_image_lookup_digest(void)
+{
+    char *name[] = { "riot", "fw", "5", NULL, NULL };
+    unsigned char md[SHA256_DIGEST_LENGTH];
+    unsigned char *comp[5] = { (unsigned char *) "riot", (unsigned char *) "fw",
+                               (unsigned char *) "5", md, NULL
+                             };
+    int complen[4] = { 4, 2, 1, SHA256_DIGEST_LENGTH };
+    struct ccnl_prefix_s p = { comp, complen, 4, NULL };
+    struct ccnl_buf_s *buf;
+
+    ccnl_image_add(&relay, image, image_len);
+    buf = lookup(name, 0, CCNL_MAX_NAME_COMP);
+    TEST_ASSERT(is_chunk(buf, 5));
+
+    sha256(buf->data, buf->datalen, md);
+    ccnl_buf_free(buf);
+
+    buf = ccnl_image_lookup(&relay, &p, NULL, 0, CCNL_MAX_NAME_COMP);
+    TEST_ASSERT(is_chunk(buf, 5));
+    ccnl_buf_free(buf);
+
+    md[0] ^= 1;
+    TEST_ASSERT_NULL(ccnl_image_lookup(&relay, &p, NULL, 0, CCNL_MAX_NAME_COMP));
+}
+
+static void test_ccnl_image_bench(void)
+{
+    char seq[4];
+    char *name[] = { "riot", "fw", seq, NULL };
+    unsigned long start, ticks;
+    int ok = 0;
+
+    ccnl_image_add(&relay, image, image_len);
+    start = hwtimer_now();
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        int k = run % CHUNKS;
+        struct ccnl_buf_s *buf;
+
+        sprintf(seq, "%d", k);
+        buf = lookup(name, 0, CCNL_MAX_NAME_COMP);
+        ok += is_chunk(buf, k);
+        ccnl_buf_free(buf);
+    }
+
+    ticks = hwtimer_now() - start;
+
+    printf("\ncontent image, %d objects in %d bytes, index %d bytes: "
+           "%d lookups %lu us\n", CHUNKS, image_len,
+           (int)(relay.image_size * sizeof(*relay.image)), BENCH_RUNS,
+           (unsigned long) HWTIMER_TICKS_TO_US(ticks));
+
+    TEST_ASSERT_EQUAL_INT(BENCH_RUNS, ok);
+}
+
+Test *tests_ccnl_image_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_image_add),
+        new_TestFixture(test_ccnl_image_add_garbage),
+        new_TestFixture(test_ccnl_image_lookup_exact),
+        new_TestFixture(test_ccnl_image_lookup_prefix),
+        new_TestFixture(test_ccnl_image_lookup_digest),
+        new_TestFixture(test_ccnl_image_bench),
+    };
+
+    EMB_UNIT_TESTCALLER(ccnl_image_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&ccnl_image_tests;
+}
+
+void tests_ccnl_image(void)
+{
+    TESTS_RUN(tests_ccnl_image_tests());
+}
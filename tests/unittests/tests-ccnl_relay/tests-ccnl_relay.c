@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ccnl.h"
+#include "ccnl-includes.h"
+#include "ccnl-core.h"
+#include "ccnl-riot-compat.h"
+
+#include "tests-ccnl_relay.h"
+
+#define IF_MTU      (1280)
+
+static struct ccnl_relay_s relay;
+static int added_if = -1;
+static uint8_t sent[4];
+static uint16_t sent_size, sent_to;
+static int sent_count;
+
+static int if_send(uint8_t *buf, uint16_t size, uint16_t to)
+{
+    memcpy(sent, buf, size < sizeof(sent) ? size : sizeof(sent));
+    sent_size = size;
+    sent_to = to;
+    sent_count++;
+    return size;
+}
+
+static void set_up(void)
+{
+    memset(&relay, 0, sizeof(relay));
+    sent_count = 0;
+}
+
+static void tear_down(void)
+{
+    ccnl_core_cleanup(&relay);
+}
+
+/* the interfaces are registered once per process, the relay picks them up
+ * every time it is configured */
+static void add_interface(void)
+{
+    if (added_if < 0) {
+        added_if = ccnl_riot_relay_add_interface(if_send, IF_MTU);
+    }
+}
+
+static void test_ccnl_relay_add_interface(void)
+{
+    add_interface();
+    TEST_ASSERT_EQUAL_INT(RIOT_TRANS_IDX + 1, added_if);
+
+    /* the default leaves room for exactly one */
+    TEST_ASSERT_EQUAL_INT(CCNL_MAX_INTERFACES, RIOT_TRANS_IDX + 2);
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_riot_relay_add_interface(if_send, IF_MTU));
+}
+
+static void test_ccnl_relay_config(void)
+{
+    struct ccnl_if_s *ifc;
+
+    add_interface();
+    ccnl_relay_config(&relay, CCNL_DEFAULT_MAX_CACHE_ENTRIES, 0, 0);
+
+    TEST_ASSERT_EQUAL_INT(added_if + 1, relay.ifcount);
+    ifc = &relay.ifs[added_if];
+    TEST_ASSERT(ifc->sendfunc == if_send);
+    TEST_ASSERT_EQUAL_INT(IF_MTU, ifc->mtu);
+
+    /* the msg interface is the only one without a broadcast face */
+    TEST_ASSERT_NULL(relay.ifs[RIOT_MSG_IDX].broadcast_face);
+    TEST_ASSERT_NOT_NULL(relay.ifs[RIOT_TRANS_IDX].broadcast_face);
+    TEST_ASSERT_NOT_NULL(ifc->broadcast_face);
+    TEST_ASSERT_EQUAL_INT(added_if, ifc->broadcast_face->ifndx);
+}
+
+static void test_ccnl_relay_broadcast(void)
+{
+    struct ccnl_buf_s *buf;
+
+    add_interface();
+    ccnl_relay_config(&relay, CCNL_DEFAULT_MAX_CACHE_ENTRIES, 0, 0);
+
+    buf = ccnl_buf_new("ccn", sizeof("ccn"));
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL_INT(0, ccnl_face_enqueue(&relay,
+                          relay.ifs[added_if].broadcast_face, buf));
+
+    /* the frame goes out at once through the send function of the driver */
+    TEST_ASSERT_EQUAL_INT(1, sent_count);
+    TEST_ASSERT_EQUAL_INT(sizeof("ccn"), sent_size);
+    TEST_ASSERT(memcmp("ccn", sent, sizeof("ccn")) == 0);
+    TEST_ASSERT_EQUAL_INT(RIOT_BROADCAST, sent_to);
+    TEST_ASSERT_EQUAL_INT(0, relay.ifs[added_if].qlen);
+}
+
+Test *tests_ccnl_relay_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_relay_add_interface),
+        new_TestFixture(test_ccnl_relay_config),
+        new_TestFixture(test_ccnl_relay_broadcast),
+    };
+
+    EMB_UNIT_TESTCALLER(ccnl_relay_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&ccnl_relay_tests;
+}
+
+void tests_ccnl_relay(void)
+{
+    TESTS_RUN(tests_ccnl_relay_tests());
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-ccnl_relay.h
+ * @brief       Unittests for the interfaces of the relay of the ``ccn_lite``
+ *              module
+ */
+#ifndef __TESTS_CCNL_RELAY_H_
+#define __TESTS_CCNL_RELAY_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_ccnl_relay(void);
+
+/**
+ * @brief   Generates tests for ccn-lite-relay.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_ccnl_relay_tests(void);
+
+#endif /* __TESTS_CCNL_RELAY_H_ */
+/** @} */
@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "crypto/sha256.h"
+
+#include "tests-ccnl_trie.h"
+
+#define NAMES       (40)
+#define DIGEST_LEN  (32)
+
+static struct ccnl_relay_s relay;
+static char names[NAMES][4];
+
+static void set_up(void)
+{
+    memset(&relay, 0, sizeof(relay));
+}
+
+static void tear_down(void)
+{
+    ccnl_core_cleanup(&relay);
+}
+
+/* a prefix of the NULL terminated components, which it borrows */
+static struct ccnl_prefix_s *prefix(char **comp)
+{
+    struct ccnl_prefix_s *p;
+    int n = 0;
+
+    while (comp[n]) {
+        n++;
+    }
+
+    p = ccnl_prefix_new(n);
+    p->compcnt = n;
+
+    for (int k = 0; k < n; k++) {
+        p->comp[k] = (unsigned char *) comp[k];
+        p->complen[k] = strlen(comp[k]);
+    }
+
+    return p;
+}
+
+static void add_interest(struct ccnl_interest_s *i, char **comp)
+{
+    memset(i, 0, sizeof(*i));
+    i->prefix = prefix(comp);
+    TEST_ASSERT_EQUAL_INT(0, ccnl_trie_add_interest(&relay, i));
+}
+
+static void remove_interest(struct ccnl_interest_s *i)
+{
+    ccnl_trie_remove_interest(&relay, i);
+    free_prefix(i->prefix);
+}
+
+static void add_forward(struct ccnl_forward_s *fwd, char **comp, int flags)
+{
+    memset(fwd, 0, sizeof(*fwd));
+    fwd->prefix = prefix(comp);
+    fwd->flags = flags;
+    TEST_ASSERT_EQUAL_INT(0, ccnl_trie_add_forward(&relay, fwd));
+}
+
+static void remove_forward(struct ccnl_forward_s *fwd)
+{
+    ccnl_trie_remove_forward(&relay, fwd);
+    free_prefix(fwd->prefix);
+}
+
+static void test_ccnl_trie_release(void)
+{
+    char *abc[] = { "a", "b", "c", NULL }, *ab[] = { "a", "b", NULL };
+    struct ccnl_interest_s i;
+    struct ccnl_forward_s fwd;
+
+    add_interest(&i, abc);
+    TEST_ASSERT_EQUAL_INT(3, relay.trie_nodes);
+    add_forward(&fwd, ab, CCNL_FORWARD_FLAGS_STATIC);
+    TEST_ASSERT_EQUAL_INT(3, relay.trie_nodes);
+    TEST_ASSERT(fwd.trie == i.trie->parent);
+
+    /* /a/b is still referred to by the FIB entry */
+    remove_interest(&i);
+    TEST_ASSERT_NULL(i.trie);
+    TEST_ASSERT_EQUAL_INT(2, relay.trie_nodes);
+    TEST_ASSERT_NULL(fwd.trie->children);
+    TEST_ASSERT_EQUAL_INT(1, fwd.trie->refs);
+
+    /* the last entry takes all its ancestors with it */
+    remove_forward(&fwd);
+    TEST_ASSERT_EQUAL_INT(0, relay.trie_nodes);
+    TEST_ASSERT_NULL(relay.trie.children);
+    TEST_ASSERT_EQUAL_INT(0, relay.trie.refs);
+
+    for (int k = 0; k < relay.trie_index_size; k++) {
+        TEST_ASSERT_NULL(relay.trie_index[k]);
+    }
+}
+
+static void test_ccnl_trie_shared(void)
+{
+    char *abc[] = { "a", "b", "c", NULL }, *abd[] = { "a", "b", "d", NULL };
+    struct ccnl_interest_s i[2];
+
+    add_interest(&i[0], abc);
+    add_interest(&i[1], abd);
+    TEST_ASSERT_EQUAL_INT(4, relay.trie_nodes);
+    TEST_ASSERT(i[0].trie->parent == i[1].trie->parent);
+    TEST_ASSERT_EQUAL_INT(2, i[0].trie->parent->refs);
+
+    /* the sibling keeps the common part alive */
+    remove_interest(&i[0]);
+    TEST_ASSERT_EQUAL_INT(3, relay.trie_nodes);
+    TEST_ASSERT(ccnl_trie_find_interest(&relay, i[1].prefix, 0, 0, NULL) == &i[1]);
+
+    remove_interest(&i[1]);
+    TEST_ASSERT_EQUAL_INT(0, relay.trie_nodes);
+}
+
+static void test_ccnl_trie_index_grow(void)
+{
+    struct ccnl_interest_s i[NAMES];
+    char *comp[NAMES][2];
+
+    for (int k = 0; k < NAMES; k++) {
+        snprintf(names[k], sizeof(names[k]), "n%02d", k);
+        comp[k][0] = names[k];
+        comp[k][1] = NULL;
+        add_interest(&i[k], comp[k]);
+
+        if (k == 0) {
+            TEST_ASSERT_EQUAL_INT(CCNL_TRIE_INDEX_MIN_SIZE, relay.trie_index_size);
+        }
+    }
+
+    /* doubled once the nodes reached twice the buckets */
+    TEST_ASSERT_EQUAL_INT(NAMES, relay.trie_nodes);
+    TEST_ASSERT_EQUAL_INT(2 * CCNL_TRIE_INDEX_MIN_SIZE, relay.trie_index_size);
+
+    /* every node is found through the new index */
+    for (int k = 0; k < NAMES; k++) {
+        TEST_ASSERT(ccnl_trie_find_interest(&relay, i[k].prefix, 0, 0, NULL) == &i[k]);
+    }
+
+    for (int k = 0; k < NAMES; k++) {
+        remove_interest(&i[k]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, relay.trie_nodes);
+}
+
+static void test_ccnl_trie_find_aggregate(void)
+{
+    char *abc[] = { "a", "b", "c", NULL }, *ax[] = { "a", "x", NULL };
+    char *abd[] = { "a", "b", "d", NULL }, *axy[] = { "a", "x", "y", NULL };
+    char *z[] = { "z", NULL };
+    struct ccnl_forward_s dynamic, fixed;
+    struct ccnl_prefix_s *p;
+    int match_len = -1;
+
+    add_forward(&dynamic, abc, 0);
+    add_forward(&fixed, ax, CCNL_FORWARD_FLAGS_STATIC);
+
+    /* the longest common prefix with a dynamic entry below it */
+    p = prefix(abd);
+    TEST_ASSERT(ccnl_trie_find_aggregate(&relay, p, 1, &match_len) == &dynamic);
+    TEST_ASSERT_EQUAL_INT(2, match_len);
+    TEST_ASSERT_NULL(ccnl_trie_find_aggregate(&relay, p, 3, &match_len));
+    free_prefix(p);
+
+    /* a static entry is never aggregated */
+    p = prefix(axy);
+    TEST_ASSERT(ccnl_trie_find_aggregate(&relay, p, 1, &match_len) == &dynamic);
+    TEST_ASSERT_EQUAL_INT(1, match_len);
+    free_prefix(p);
+
+    p = prefix(z);
+    TEST_ASSERT_NULL(ccnl_trie_find_aggregate(&relay, p, 1, &match_len));
+    free_prefix(p);
+
+    remove_forward(&dynamic);
+    p = prefix(abd);
+    TEST_ASSERT_NULL(ccnl_trie_find_aggregate(&relay, p, 0, &match_len));
+    free_prefix(p);
+
+    remove_forward(&fixed);
+}
+
+/* comp followed by a binary digest component */
+static struct ccnl_prefix_s *digest_prefix(char **comp, unsigned char *digest)
+{
+    struct ccnl_prefix_s *p = prefix(comp), *d = ccnl_prefix_new(p->compcnt + 1);
+
+    d->compcnt = p->compcnt + 1;
+
+    for (int k = 0; k < p->compcnt; k++) {
+        d->comp[k] = p->comp[k];
+        d->complen[k] = p->complen[k];
+    }
+
+    d->comp[p->compcnt] = digest;
+    d->complen[p->compcnt] = DIGEST_LEN;
+    free_prefix(p);
+    return d;
+}
+
+static struct ccnl_interest_s *new_interest(struct ccnl_prefix_s *p)
+{
+    struct ccnl_buf_s *pkt = ccnl_buf_new("i", 1), *ppkd = NULL;
+
+    return ccnl_interest_new(&relay, NULL, &pkt, &p, 0, CCNL_MAX_NAME_COMP, &ppkd);
+}
+
+static int pending(struct ccnl_interest_s *i)
+{
+    for (struct ccnl_interest_s *n = relay.pit; n; n = n->next) {
+        if (n == i) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void test_ccnl_trie_serve_digest(void)
+{
+    unsigned char digest[DIGEST_LEN], wrong[DIGEST_LEN];
+    char *ab[] = { "a", "b", NULL }, *a[] = { "a", NULL }, *ac[] = { "a", "c", NULL };
+    struct ccnl_interest_s *by_prefix, *by_digest, *by_wrong, *other;
+    struct ccnl_buf_s *pkt = ccnl_buf_new("content of /a/b", 15);
+    struct ccnl_prefix_s *name = prefix(ab);
+    struct ccnl_content_s *c = ccnl_content_new(&relay, &pkt, &name, NULL, NULL, 0);
+
+    TEST_ASSERT_NOT_NULL(c);
+    memcpy(digest, compute_ccnx_digest(c->pkt), DIGEST_LEN);
+    memcpy(wrong, digest, DIGEST_LEN);
+    wrong[DIGEST_LEN - 1] ^= 1;
+
+    by_prefix = new_interest(prefix(a));
+    by_digest = new_interest(digest_prefix(ab, digest));
+    by_wrong = new_interest(digest_prefix(ab, wrong));
+    other = new_interest(prefix(ac));
+    TEST_ASSERT_NOT_NULL(by_prefix);
+    TEST_ASSERT_NOT_NULL(by_digest);
+    TEST_ASSERT_NOT_NULL(by_wrong);
+    TEST_ASSERT_NOT_NULL(other);
+
+    /* nobody waits on a face, the matching interests are just satisfied */
+    TEST_ASSERT_EQUAL_INT(0, ccnl_content_serve_pending(&relay, c, NULL));
+    TEST_ASSERT(!pending(by_prefix));
+    TEST_ASSERT(!pending(by_digest));
+    TEST_ASSERT(pending(by_wrong));
+    TEST_ASSERT(pending(other));
+
+    /* /a/c and the wrong digest below /a/b keep their nodes */
+    TEST_ASSERT_EQUAL_INT(4, relay.trie_nodes);
+
+    free_content(c);
+}
+
+static struct ccnl_content_s *cache(char **comp)
+{
+    struct ccnl_buf_s *pkt = ccnl_buf_new(comp[0], 1);
+    struct ccnl_prefix_s *name = prefix(comp);
+
+    return ccnl_content_add2cache(&relay, ccnl_content_new(&relay, &pkt, &name,
+                                  NULL, NULL, 0));
+}
+
+static struct ccnl_content_s *lookup(char **comp, int minsuffix, int maxsuffix)
+{
+    struct ccnl_prefix_s *p = prefix(comp);
+    struct ccnl_content_s *c = ccnl_content_lookup(&relay, p, NULL, minsuffix,
+                               maxsuffix);
+
+    free_prefix(p);
+    return c;
+}
+
+static void test_ccnl_trie_content(void)
+{
+    char *abc[] = { "a", "b", "c", NULL }, *abde[] = { "a", "b", "d", "e", NULL };
+    char *x[] = { "x", NULL }, *a[] = { "a", NULL }, *abd[] = { "a", "b", "d", NULL };
+    char *aq[] = { "a", "q", NULL };
+    struct ccnl_content_s *c_abc, *c_abde, *c_x;
+
+    relay.max_cache_entries = -1;
+    c_abc = cache(abc);
+    c_abde = cache(abde);
+    c_x = cache(x);
+    TEST_ASSERT_NOT_NULL(c_abc);
+    TEST_ASSERT_NOT_NULL(c_abde);
+    TEST_ASSERT_NOT_NULL(c_x);
+    TEST_ASSERT_EQUAL_INT(6, relay.trie_nodes);
+    TEST_ASSERT_EQUAL_INT(3, relay.trie.cached);
+
+    /* the suffix limits the depth walked below the prefix */
+    TEST_ASSERT(lookup(a, 0, 3) == c_abc);
+    TEST_ASSERT_NULL(lookup(a, 0, 2));
+    TEST_ASSERT(lookup(abd, 0, 2) == c_abde);
+    TEST_ASSERT(lookup(abd, 2, CCNL_MAX_NAME_COMP) == c_abde);
+    TEST_ASSERT_NULL(lookup(abd, 3, CCNL_MAX_NAME_COMP));
+    TEST_ASSERT_NULL(lookup(aq, 0, CCNL_MAX_NAME_COMP));
+    TEST_ASSERT(lookup(x, 0, 1) == c_x);
+
+    /* removed contents no longer hold their nodes */
+    ccnl_content_remove(&relay, c_abc);
+    TEST_ASSERT(lookup(a, 0, CCNL_MAX_NAME_COMP) == c_abde);
+    TEST_ASSERT_EQUAL_INT(5, relay.trie_nodes);
+
+    ccnl_content_cleanup(&relay);
+    TEST_ASSERT_EQUAL_INT(0, relay.trie_nodes);
+    TEST_ASSERT_EQUAL_INT(0, relay.trie.cached);
+}
+
+Test *tests_ccnl_trie_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_trie_release),
+        new_TestFixture(test_ccnl_trie_shared),
+        new_TestFixture(test_ccnl_trie_index_grow),
+        new_TestFixture(test_ccnl_trie_find_aggregate),
+        new_TestFixture(test_ccnl_trie_serve_digest),
+        new_TestFixture(test_ccnl_trie_content),
+    };
+
+    EMB_UNIT_TESTCALLER(ccnl_trie_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&ccnl_trie_tests;
+}
+
+void tests_ccnl_trie(void)
+{
+    TESTS_RUN(tests_ccnl_trie_tests());
+}
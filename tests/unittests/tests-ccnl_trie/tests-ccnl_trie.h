@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-ccnl_trie.h
+ * @brief       Unittests for the name trie of the ``ccn_lite`` module
+ */
+#ifndef __TESTS_CCNL_TRIE_H_
+#define __TESTS_CCNL_TRIE_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_ccnl_trie(void);
+
+/**
+ * @brief   Generates tests for ccnl-trie.c and the PIT lookup of content
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_ccnl_trie_tests(void);
+
+#endif /* __TESTS_CCNL_TRIE_H_ */
+/** @} */
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ip.h"
+
+#include "tests-ipv6_srh.h"
+
+#define PAYLOAD_LEN (8)
+#define HOPS        (2)
+
+static uint8_t buf[IPV6_MTU];
+static ipv6_hdr_t *packet = (ipv6_hdr_t *) buf;
+static ipv6_addr_t route[HOPS];
+static uint8_t payload[PAYLOAD_LEN] = "payload";
+
+/* the route to 2001:db8::4 leads over 2001:db8::2 and 2001:db8::3 */
+static int source_route(ipv6_addr_t *dest, ipv6_rpl_opt_t *opt,
+                        ipv6_addr_t *hops, int max_hops)
+{
+    (void) opt;
+
+    if (dest->uint8[15] != 4 || max_hops < HOPS) {
+        return -1;
+    }
+
+    memcpy(hops, route, sizeof(route));
+    return HOPS;
+}
+
+static void set_up(void)
+{
+    memset(buf, 0, sizeof(buf));
+    packet->version_trafficclass = IPV6_VER;
+    packet->nextheader = IPV6_PROTO_NUM_UDP;
+    packet->length = HTONS(PAYLOAD_LEN);
+    packet->hoplimit = MULTIHOP_HOPLIMIT;
+    ipv6_addr_init(&packet->srcaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+    ipv6_addr_init(&packet->destaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 4);
+    memcpy(buf + IPV6_HDR_LEN, payload, PAYLOAD_LEN);
+
+    ipv6_addr_init(&route[0], 0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+    ipv6_addr_init(&route[1], 0x2001, 0xdb8, 0, 0, 0, 0, 0, 3);
+    ipv6_iface_set_srh_provider(source_route);
+}
+
+static void tear_down(void)
+{
+    ipv6_iface_set_srh_provider(NULL);
+}
+
+static ipv6_srh_t *srh(void)
+{
+    return (ipv6_srh_t *)(buf + IPV6_HDR_LEN);
+}
+
+static void test_ipv6_srh_insert(void)
+{
+    ipv6_addr_t dest;
+    int len;
+
+    len = ipv6_srh_insert(packet);
+
+    /* 8 bytes of header, both addresses elided to their last octet and
+     * padded to 8 */
+    TEST_ASSERT_EQUAL_INT(16, len);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN + len, NTOHS(packet->length));
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_ROUTING, packet->nextheader);
+    TEST_ASSERT(ipv6_addr_is_equal(&route[0], &packet->destaddr));
+
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, srh()->nextheader);
+    TEST_ASSERT_EQUAL_INT(1, srh()->hdrextlen);
+    TEST_ASSERT_EQUAL_INT(IPV6_SRH_ROUTING_TYPE, srh()->routing_type);
+    TEST_ASSERT_EQUAL_INT(HOPS, srh()->segments_left);
+    TEST_ASSERT_EQUAL_INT(0xff, srh()->cmpri_cmpre);
+    TEST_ASSERT_EQUAL_INT(6 << 4, srh()->pad_reserved);
+    TEST_ASSERT_EQUAL_INT(3, srh()->addresses[0]);
+    TEST_ASSERT_EQUAL_INT(4, srh()->addresses[1]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(payload, buf + IPV6_HDR_LEN + len, PAYLOAD_LEN));
+
+    /* no route, no header */
+    set_up();
+    ipv6_addr_init(&dest, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 5);
+    packet->destaddr = dest;
+    TEST_ASSERT_EQUAL_INT(0, ipv6_srh_insert(packet));
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, packet->nextheader);
+    TEST_ASSERT(ipv6_addr_is_equal(&dest, &packet->destaddr));
+}
+
+static void test_ipv6_srh_insert_routed(void)
+{
+    uint8_t copy[IPV6_HDR_LEN + 16 + PAYLOAD_LEN];
+
+    TEST_ASSERT_EQUAL_INT(16, ipv6_srh_insert(packet));
+    memcpy(copy, buf, sizeof(copy));
+
+    /* on its way the packet passes a node that knows a source route to
+     * the hop it is addressed to */
+    packet->destaddr.uint8[15] = 4;
+    copy[IPV6_HDR_LEN - 1] = 4;
+    TEST_ASSERT_EQUAL_INT(0, ipv6_srh_insert(packet));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(copy, buf, sizeof(copy)));
+}
+
+static void test_ipv6_srh_process(void)
+{
+    ipv6_addr_t dest = packet->destaddr;
+
+    ipv6_srh_insert(packet);
+
+    /* the first hop forwards to the second */
+    TEST_ASSERT_EQUAL_INT(1, ipv6_srh_process(packet));
+    TEST_ASSERT(ipv6_addr_is_equal(&route[1], &packet->destaddr));
+    TEST_ASSERT_EQUAL_INT(1, srh()->segments_left);
+
+    /* the second to the destination */
+    TEST_ASSERT_EQUAL_INT(1, ipv6_srh_process(packet));
+    TEST_ASSERT(ipv6_addr_is_equal(&dest, &packet->destaddr));
+    TEST_ASSERT_EQUAL_INT(0, srh()->segments_left);
+
+    /* which removes the header */
+    TEST_ASSERT_EQUAL_INT(0, ipv6_srh_process(packet));
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, packet->nextheader);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, NTOHS(packet->length));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(payload, buf + IPV6_HDR_LEN, PAYLOAD_LEN));
+}
+
+static void test_ipv6_srh_process_invalid(void)
+{
+    ipv6_srh_insert(packet);
+
+    /* more segments left than addresses */
+    srh()->segments_left = HOPS + 1;
+    TEST_ASSERT_EQUAL_INT(-1, ipv6_srh_process(packet));
+
+    /* a route that leads to a group */
+    set_up();
+    ipv6_addr_init(&route[1], 0xff02, 0, 0, 0, 0, 0, 0, 1);
+    ipv6_srh_insert(packet);
+    TEST_ASSERT_EQUAL_INT(-1, ipv6_srh_process(packet));
+
+    /* a header longer than the packet */
+    set_up();
+    ipv6_srh_insert(packet);
+    srh()->hdrextlen = 3;
+    TEST_ASSERT_EQUAL_INT(-1, ipv6_srh_process(packet));
+}
+
+Test *tests_ipv6_srh_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ipv6_srh_insert),
+        new_TestFixture(test_ipv6_srh_insert_routed),
+        new_TestFixture(test_ipv6_srh_process),
+        new_TestFixture(test_ipv6_srh_process_invalid),
+    };
+
+    EMB_UNIT_TESTCALLER(ipv6_srh_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&ipv6_srh_tests;
+}
+
+void tests_ipv6_srh(void)
+{
+    TESTS_RUN(tests_ipv6_srh_tests());
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-ipv6_srh.h
+ * @brief       Unittests for the RFC 6554 source routing header of the
+ *              ``sixlowpan`` module
+ */
+#ifndef __TESTS_IPV6_SRH_H_
+#define __TESTS_IPV6_SRH_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_ipv6_srh(void);
+
+/**
+ * @brief   Generates tests for the source routing header of ip.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_ipv6_srh_tests(void);
+
+#endif /* __TESTS_IPV6_SRH_H_ */
+/** @} */
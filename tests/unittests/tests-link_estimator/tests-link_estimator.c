@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "sixlowpan/ip.h"
+#include "link_estimator.h"
+
+#include "tests-link_estimator.h"
+
+#define ETX_ONE     (LINK_ESTIMATOR_ETX_ONE)
+
+/* the neighbor with the short address 0x0005 and its link local address */
+static net_if_eui64_t neighbor;
+static ipv6_addr_t neighbor_addr;
+
+static void set_up(void)
+{
+    link_estimator_init();
+
+    neighbor.uint32[0] = HTONL(0x000000ff);
+    neighbor.uint16[2] = HTONS(0xfe00);
+    neighbor.uint16[3] = HTONS(0x0005);
+    ipv6_addr_init(&neighbor_addr, 0xfe80, 0, 0, 0, 0, 0x00ff, 0xfe00, 0x0005);
+}
+
+static void tx(sixlowpan_mac_link_event_t event, int times)
+{
+    for (int i = 0; i < times; i++) {
+        link_estimator_handler(event, &neighbor, 0, 0);
+    }
+}
+
+static void test_link_estimator_ewma(void)
+{
+    /* an eighth of the difference */
+    TEST_ASSERT_EQUAL_INT(144, link_estimator_ewma(128, 256));
+    TEST_ASSERT_EQUAL_INT(240, link_estimator_ewma(256, 128));
+
+    /* but at least 1 */
+    TEST_ASSERT_EQUAL_INT(129, link_estimator_ewma(128, 131));
+    TEST_ASSERT_EQUAL_INT(130, link_estimator_ewma(131, 128));
+    TEST_ASSERT_EQUAL_INT(128, link_estimator_ewma(128, 128));
+}
+
+static void test_link_estimator_ewma_converges(void)
+{
+    uint16_t value = LINK_ESTIMATOR_ETX_MAX;
+    int steps = 0;
+
+    while (value != ETX_ONE && steps < 100) {
+        value = link_estimator_ewma(value, ETX_ONE);
+        steps++;
+    }
+
+    TEST_ASSERT_EQUAL_INT(ETX_ONE, value);
+}
+
+static void test_link_estimator_tx_ok(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, link_estimator_get_etx(&neighbor_addr));
+
+    /* a received frame adds the neighbor, but is no sample of the ETX */
+    link_estimator_handler(SIXLOWPAN_MAC_LINK_RX, &neighbor, 200, 100);
+    TEST_ASSERT_EQUAL_INT(LINK_ESTIMATOR_ETX_INIT, link_estimator_get_etx(&neighbor_addr));
+
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 1);
+    TEST_ASSERT_EQUAL_INT(240, link_estimator_get_etx(&neighbor_addr));
+
+    /* without failures the ETX ends up at 1 */
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 100);
+    TEST_ASSERT_EQUAL_INT(ETX_ONE, link_estimator_get_etx(&neighbor_addr));
+}
+
+static void test_link_estimator_tx_fail(void)
+{
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 1);
+    TEST_ASSERT_EQUAL_INT(240, link_estimator_get_etx(&neighbor_addr));
+
+    /* the failures are only counted until the next success */
+    tx(SIXLOWPAN_MAC_LINK_TX_FAIL, LINK_ESTIMATOR_MAX_TX - 1);
+    TEST_ASSERT_EQUAL_INT(240, link_estimator_get_etx(&neighbor_addr));
+
+    /* which is a sample of 4 */
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 1);
+    TEST_ASSERT_EQUAL_INT(274, link_estimator_get_etx(&neighbor_addr));
+
+    /* LINK_ESTIMATOR_MAX_TX in a row are a sample of LINK_ESTIMATOR_ETX_MAX */
+    tx(SIXLOWPAN_MAC_LINK_TX_FAIL, LINK_ESTIMATOR_MAX_TX - 1);
+    TEST_ASSERT_EQUAL_INT(274, link_estimator_get_etx(&neighbor_addr));
+    tx(SIXLOWPAN_MAC_LINK_TX_FAIL, 1);
+    TEST_ASSERT_EQUAL_INT(367, link_estimator_get_etx(&neighbor_addr));
+
+    /* and start counting anew */
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 1);
+    TEST_ASSERT_EQUAL_INT(338, link_estimator_get_etx(&neighbor_addr));
+}
+
+static void test_link_estimator_get_etx_long(void)
+{
+    ipv6_addr_t addr;
+
+    /* ipv6_addr_set_by_eui64() flips the universal/local bit */
+    neighbor.uint32[0] = HTONL(0x021234ff);
+    neighbor.uint16[2] = HTONS(0xfe56);
+    neighbor.uint16[3] = HTONS(0x789a);
+    ipv6_addr_init(&addr, 0xfe80, 0, 0, 0, 0x0012, 0x34ff, 0xfe56, 0x789a);
+
+    tx(SIXLOWPAN_MAC_LINK_TX_OK, 1);
+    TEST_ASSERT_EQUAL_INT(240, link_estimator_get_etx(&addr));
+    TEST_ASSERT_EQUAL_INT(0, link_estimator_get_etx(&neighbor_addr));
+}
+
+Test *tests_link_estimator_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_link_estimator_ewma),
+        new_TestFixture(test_link_estimator_ewma_converges),
+        new_TestFixture(test_link_estimator_tx_ok),
+        new_TestFixture(test_link_estimator_tx_fail),
+        new_TestFixture(test_link_estimator_get_etx_long),
+    };
+
+    EMB_UNIT_TESTCALLER(link_estimator_tests, set_up, NULL, fixtures);
+
+    return (Test *)&link_estimator_tests;
+}
+
+void tests_link_estimator(void)
+{
+    TESTS_RUN(tests_link_estimator_tests());
+}
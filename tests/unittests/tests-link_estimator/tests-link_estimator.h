@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-link_estimator.h
+ * @brief       Unittests for the link estimator of ``rpl``
+ */
+#ifndef __TESTS_LINK_ESTIMATOR_H_
+#define __TESTS_LINK_ESTIMATOR_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_link_estimator(void);
+
+/**
+ * @brief   Generates tests for link_estimator.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_link_estimator_tests(void);
+
+#endif /* __TESTS_LINK_ESTIMATOR_H_ */
+/** @} */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+#include "link_estimator.h"
+#include "of_mrhof.h"
+
+#include "tests-rpl_of.h"
+
+/* parent ranks tested, spread over the whole range */
+#define RANK_STEP   (61)
+
+static rpl_dodag_t dodag;
+
+/*
+ * MRHOF as it was with the ETX in a double, to compare the fixed point
+ * implementation against. The sum of the link metric and the parent rank
+ * was converted to uint16_t, which is undefined beyond UINT16_MAX, so the
+ * reference takes such a path as too expensive.
+ */
+static uint16_t float_path_cost(double etx_value, uint16_t parent_rank)
+{
+    if (etx_value != 0) {
+        if (etx_value * ETX_RANK_MULTIPLIER > MAX_LINK_METRIC) {
+            return MAX_PATH_COST;
+        }
+
+        if (etx_value * ETX_RANK_MULTIPLIER + parent_rank > UINT16_MAX) {
+            return MAX_PATH_COST;
+        }
+
+        return etx_value * ETX_RANK_MULTIPLIER + parent_rank;
+    }
+
+    return MAX_PATH_COST;
+}
+
+static uint16_t float_rank(double etx_value, uint16_t parent_rank, uint16_t minhoprankincrease)
+{
+    uint16_t calculated_pcost = float_path_cost(etx_value, parent_rank);
+
+    if (calculated_pcost < MAX_PATH_COST) {
+        if ((parent_rank + minhoprankincrease) > calculated_pcost) {
+            return parent_rank + minhoprankincrease;
+        }
+
+        return calculated_pcost;
+    }
+
+    return INFINITE_RANK;
+}
+
+static void check_mrhof(uint16_t minhoprankincrease)
+{
+    for (uint16_t etx = 0; etx <= LINK_ESTIMATOR_ETX_MAX + 1; etx++) {
+        double etx_value = (double) etx / LINK_ESTIMATOR_ETX_ONE;
+
+        for (uint32_t rank = 0; rank <= UINT16_MAX; rank += RANK_STEP) {
+            uint16_t expected = float_rank(etx_value, rank, minhoprankincrease);
+
+            if (of_mrhof_rank(etx, rank, minhoprankincrease) != expected) {
+                TEST_ASSERT_EQUAL_INT(expected, of_mrhof_rank(etx, rank, minhoprankincrease));
+                return;
+            }
+        }
+    }
+}
+
+static void test_rpl_of_mrhof_rank(void)
+{
+    check_mrhof(DEFAULT_MIN_HOP_RANK_INCREASE);
+}
+
+static void test_rpl_of_mrhof_rank_min_hop_rank_increase(void)
+{
+    check_mrhof(ETX_RANK_MULTIPLIER);
+    check_mrhof(3 * DEFAULT_MIN_HOP_RANK_INCREASE);
+}
+
+static void test_rpl_of_mrhof_rank_limits(void)
+{
+    uint16_t rank = 2 * DEFAULT_MIN_HOP_RANK_INCREASE;
+
+    /* an unknown link and a link with an ETX of more than 4 */
+    TEST_ASSERT_EQUAL_INT(INFINITE_RANK, of_mrhof_rank(0, rank, DEFAULT_MIN_HOP_RANK_INCREASE));
+    TEST_ASSERT_EQUAL_INT(INFINITE_RANK, of_mrhof_rank(4 * LINK_ESTIMATOR_ETX_ONE + 1, rank,
+                                                       DEFAULT_MIN_HOP_RANK_INCREASE));
+    TEST_ASSERT_EQUAL_INT(rank + 4 * ETX_RANK_MULTIPLIER,
+                          of_mrhof_rank(4 * LINK_ESTIMATOR_ETX_ONE, rank,
+                                        DEFAULT_MIN_HOP_RANK_INCREASE));
+    /* a path cost over MAX_PATH_COST */
+    TEST_ASSERT_EQUAL_INT(INFINITE_RANK, of_mrhof_rank(LINK_ESTIMATOR_ETX_ONE,
+                                                       MAX_PATH_COST - ETX_RANK_MULTIPLIER,
+                                                       DEFAULT_MIN_HOP_RANK_INCREASE));
+}
+
+static void check_dag_rank(uint16_t minhoprankincrease)
+{
+    rpl_set_min_hop_rank_increase(&dodag, minhoprankincrease);
+    TEST_ASSERT_EQUAL_INT(minhoprankincrease, dodag.minhoprankincrease);
+
+    for (uint32_t rank = 0; rank <= UINT16_MAX; rank++) {
+        if (rpl_dag_rank(&dodag, rank) != rpl_calc_rank(rank, minhoprankincrease)) {
+            TEST_ASSERT_EQUAL_INT(rpl_calc_rank(rank, minhoprankincrease),
+                                  rpl_dag_rank(&dodag, rank));
+            return;
+        }
+    }
+}
+
+static void test_rpl_of_dag_rank_power_of_two(void)
+{
+    check_dag_rank(1);
+    check_dag_rank(ETX_RANK_MULTIPLIER);
+    check_dag_rank(DEFAULT_MIN_HOP_RANK_INCREASE);
+    check_dag_rank(0x8000);
+    TEST_ASSERT(dodag.minhoprank_shift != 0);
+}
+
+static void test_rpl_of_dag_rank_other(void)
+{
+    check_dag_rank(3);
+    check_dag_rank(DEFAULT_MIN_HOP_RANK_INCREASE + 1);
+    check_dag_rank(UINT16_MAX);
+    TEST_ASSERT_EQUAL_INT(0, dodag.minhoprank_shift);
+}
+
+/* a DODAG that was not set up with rpl_set_min_hop_rank_increase() */
+static void test_rpl_of_dag_rank_unset(void)
+{
+    memset(&dodag, 0, sizeof(dodag));
+    dodag.minhoprankincrease = DEFAULT_MIN_HOP_RANK_INCREASE;
+
+    TEST_ASSERT_EQUAL_INT(3, rpl_dag_rank(&dodag, 3 * DEFAULT_MIN_HOP_RANK_INCREASE + 1));
+}
+
+/* joined from a DIO without a DODAG configuration option */
+static void test_rpl_of_dag_rank_zero(void)
+{
+    rpl_set_min_hop_rank_increase(&dodag, 0);
+    TEST_ASSERT_EQUAL_INT(DEFAULT_MIN_HOP_RANK_INCREASE, dodag.minhoprankincrease);
+    TEST_ASSERT_EQUAL_INT(3, rpl_dag_rank(&dodag, 3 * DEFAULT_MIN_HOP_RANK_INCREASE + 1));
+}
+
+Test *tests_rpl_of_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_rpl_of_mrhof_rank),
+        new_TestFixture(test_rpl_of_mrhof_rank_min_hop_rank_increase),
+        new_TestFixture(test_rpl_of_mrhof_rank_limits),
+        new_TestFixture(test_rpl_of_dag_rank_power_of_two),
+        new_TestFixture(test_rpl_of_dag_rank_other),
+        new_TestFixture(test_rpl_of_dag_rank_unset),
+        new_TestFixture(test_rpl_of_dag_rank_zero),
+    };
+
+    EMB_UNIT_TESTCALLER(rpl_of_tests, NULL, NULL, fixtures);
+
+    return (Test *)&rpl_of_tests;
+}
+
+void tests_rpl_of(void)
+{
+    TESTS_RUN(tests_rpl_of_tests());
+}
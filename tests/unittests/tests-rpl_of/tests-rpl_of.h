@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-rpl_of.h
+ * @brief       Unittests for the objective functions of ``rpl``
+ */
+#ifndef __TESTS_RPL_OF_H_
+#define __TESTS_RPL_OF_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_rpl_of(void);
+
+/**
+ * @brief   Generates tests for of_mrhof.c and the rank calculation
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_rpl_of_tests(void);
+
+#endif /* __TESTS_RPL_OF_H_ */
+/** @} */
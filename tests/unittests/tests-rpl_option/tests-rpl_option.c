@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ip.h"
+#include "rpl.h"
+#include "rpl/rpl_dodag.h"
+
+#include "tests-rpl_option.h"
+
+#define PAYLOAD_LEN     (8)
+#define INSTANCE_UP     (1)     /* only the way to the root */
+#define INSTANCE_DOWN   (2)     /* knows a route to CHILD */
+#define PORT_UP         (61616)
+#define PORT_DOWN       (5683)
+#define PORT_UNMAPPED   (7)
+#define PARENT_UP       (0x10)
+#define PARENT_DOWN     (0x20)
+#define CHILD           (0x5)
+#define MY_RANK         (2 * DEFAULT_MIN_HOP_RANK_INCREASE)
+#define LIFETIME        (0xff)
+
+static uint8_t buf[IPV6_MTU];
+static ipv6_hdr_t *packet = (ipv6_hdr_t *) buf;
+static uint8_t payload[PAYLOAD_LEN];
+static rpl_dodag_t *dodag_up, *dodag_down;
+
+static void addr(ipv6_addr_t *a, uint16_t last)
+{
+    ipv6_addr_init(a, 0x2001, 0xdb8, 0, 0, 0, 0, 0, last);
+}
+
+/* a DODAG of instance *id* this node joined with MY_RANK below *parent* */
+static rpl_dodag_t *join(uint8_t id, uint16_t parent)
+{
+    rpl_dodag_t *dodag;
+    ipv6_addr_t a;
+
+    rpl_new_instance(id)->joined = 1;
+    addr(&a, id);
+    dodag = rpl_new_dodag(id, &a);
+    rpl_set_min_hop_rank_increase(dodag, DEFAULT_MIN_HOP_RANK_INCREASE);
+    addr(&a, parent);
+    dodag->my_preferred_parent = rpl_new_parent(dodag, &a, DEFAULT_MIN_HOP_RANK_INCREASE);
+    dodag->my_rank = MY_RANK;
+    dodag->joined = 1;
+
+    return dodag;
+}
+
+/* a UDP datagram from 2001:db8::1 to *dest* and *port* */
+static void udp(uint16_t dest, uint16_t port)
+{
+    memset(buf, 0, sizeof(buf));
+    packet->version_trafficclass = IPV6_VER;
+    packet->nextheader = IPV6_PROTO_NUM_UDP;
+    packet->length = HTONS(PAYLOAD_LEN);
+    packet->hoplimit = MULTIHOP_HOPLIMIT;
+    addr(&packet->srcaddr, 1);
+    addr(&packet->destaddr, dest);
+
+    /* source port, destination port, length and checksum */
+    memset(payload, 0, sizeof(payload));
+    payload[0] = PORT_UNMAPPED >> 8;
+    payload[1] = PORT_UNMAPPED & 0xff;
+    payload[2] = port >> 8;
+    payload[3] = port & 0xff;
+    payload[5] = PAYLOAD_LEN;
+    memcpy(buf + IPV6_HDR_LEN, payload, PAYLOAD_LEN);
+}
+
+static ipv6_rpl_opt_t *opt(void)
+{
+    return (ipv6_rpl_opt_t *)(buf + IPV6_HDR_LEN);
+}
+
+static void set_up(void)
+{
+    ipv6_addr_t child;
+
+    rpl_instances_init();
+    dodag_up = join(INSTANCE_UP, PARENT_UP);
+    dodag_down = join(INSTANCE_DOWN, PARENT_DOWN);
+    addr(&child, CHILD);
+    rpl_add_routing_entry(dodag_down->instance, &child, &child, LIFETIME);
+
+    rpl_map_port(PORT_UP, INSTANCE_UP);
+    rpl_map_port(PORT_DOWN, INSTANCE_DOWN);
+    ipv6_iface_set_rpl_option_provider(rpl_set_option, rpl_get_next_hop_for_option);
+}
+
+static void tear_down(void)
+{
+    ipv6_iface_set_rpl_option_provider(NULL, NULL);
+    rpl_unmap_port(PORT_UP);
+    rpl_unmap_port(PORT_DOWN);
+
+    rpl_delete_all_parents(dodag_up);
+    rpl_delete_all_parents(dodag_down);
+    rpl_del_dodag(dodag_up);
+    rpl_del_dodag(dodag_down);
+}
+
+static void test_rpl_option_insert(void)
+{
+    udp(CHILD, PORT_DOWN);
+    TEST_ASSERT_EQUAL_INT(sizeof(ipv6_rpl_opt_t), ipv6_rpl_opt_insert(packet));
+
+    /* the option goes right after the IPv6 header, the datagram after it */
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_HOP_BY_HOP, packet->nextheader);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN + sizeof(ipv6_rpl_opt_t), NTOHS(packet->length));
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, opt()->nextheader);
+    TEST_ASSERT_EQUAL_INT(0, opt()->hdrextlen);
+    TEST_ASSERT_EQUAL_INT(IPV6_OPT_TYPE_RPL, opt()->type);
+    TEST_ASSERT_EQUAL_INT(IPV6_OPT_RPL_LEN, opt()->length);
+    TEST_ASSERT_EQUAL_INT(0, opt()->flags);
+    TEST_ASSERT_EQUAL_INT(INSTANCE_DOWN, opt()->instance_id);
+    TEST_ASSERT_EQUAL_INT(MY_RANK, NTOHS(opt()->sender_rank));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf + IPV6_HDR_LEN + sizeof(ipv6_rpl_opt_t),
+                                    payload, PAYLOAD_LEN));
+
+    /* a packet carries one option at most */
+    TEST_ASSERT_EQUAL_INT(0, ipv6_rpl_opt_insert(packet));
+
+    /* the other port gets the other instance */
+    udp(CHILD, PORT_UP);
+    TEST_ASSERT_EQUAL_INT(sizeof(ipv6_rpl_opt_t), ipv6_rpl_opt_insert(packet));
+    TEST_ASSERT_EQUAL_INT(INSTANCE_UP, opt()->instance_id);
+}
+
+static void test_rpl_option_remove(void)
+{
+    udp(CHILD, PORT_DOWN);
+    ipv6_rpl_opt_insert(packet);
+    ipv6_rpl_opt_remove(packet);
+
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, packet->nextheader);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, NTOHS(packet->length));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf + IPV6_HDR_LEN, payload, PAYLOAD_LEN));
+
+    /* without an option there is nothing to remove */
+    ipv6_rpl_opt_remove(packet);
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, packet->nextheader);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, NTOHS(packet->length));
+}
+
+static void test_rpl_option_not_mapped(void)
+{
+    udp(CHILD, PORT_UNMAPPED);
+    TEST_ASSERT_EQUAL_INT(0, ipv6_rpl_opt_insert(packet));
+    TEST_ASSERT_EQUAL_INT(IPV6_PROTO_NUM_UDP, packet->nextheader);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, NTOHS(packet->length));
+
+    /* multicast is not routed along an instance */
+    udp(CHILD, PORT_DOWN);
+    ipv6_addr_set_all_nodes_addr(&packet->destaddr);
+    TEST_ASSERT_EQUAL_INT(0, ipv6_rpl_opt_insert(packet));
+
+    /* a port of an instance this node did not join */
+    dodag_down->joined = 0;
+    udp(CHILD, PORT_DOWN);
+    TEST_ASSERT_EQUAL_INT(0, ipv6_rpl_opt_insert(packet));
+    dodag_down->joined = 1;
+
+    /* no option without a provider */
+    ipv6_iface_set_rpl_option_provider(NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, ipv6_rpl_opt_insert(packet));
+}
+
+static void test_rpl_option_next_hop(void)
+{
+    ipv6_addr_t dest, next;
+    ipv6_rpl_opt_t option;
+
+    addr(&dest, CHILD);
+
+    /* an instance without a route to the child sends it up */
+    memset(&option, 0, sizeof(option));
+    option.instance_id = INSTANCE_UP;
+    option.sender_rank = HTONS(3 * DEFAULT_MIN_HOP_RANK_INCREASE);
+    addr(&next, PARENT_UP);
+    TEST_ASSERT(ipv6_addr_is_equal(&next, rpl_get_next_hop_for_option(&dest, &option)));
+    TEST_ASSERT_EQUAL_INT(0, option.flags);
+    TEST_ASSERT_EQUAL_INT(MY_RANK, NTOHS(option.sender_rank));
+
+    /* the same packet in the other instance goes down */
+    memset(&option, 0, sizeof(option));
+    option.instance_id = INSTANCE_DOWN;
+    option.sender_rank = HTONS(3 * DEFAULT_MIN_HOP_RANK_INCREASE);
+    TEST_ASSERT(ipv6_addr_is_equal(&dest, rpl_get_next_hop_for_option(&dest, &option)));
+    TEST_ASSERT_EQUAL_INT(IPV6_OPT_RPL_FLAG_O, option.flags);
+    TEST_ASSERT_EQUAL_INT(MY_RANK, NTOHS(option.sender_rank));
+
+    /* an instance this node did not join */
+    option.instance_id = INSTANCE_DOWN + 1;
+    TEST_ASSERT_NULL(rpl_get_next_hop_for_option(&dest, &option));
+}
+
+static void test_rpl_option_rank_error(void)
+{
+    ipv6_addr_t dest, next;
+    ipv6_rpl_opt_t option;
+
+    addr(&dest, CHILD);
+    addr(&next, PARENT_UP);
+
+    /* going up from a node closer to the root: marked, still forwarded */
+    memset(&option, 0, sizeof(option));
+    option.instance_id = INSTANCE_UP;
+    option.sender_rank = HTONS(DEFAULT_MIN_HOP_RANK_INCREASE);
+    TEST_ASSERT(ipv6_addr_is_equal(&next, rpl_get_next_hop_for_option(&dest, &option)));
+    TEST_ASSERT_EQUAL_INT(IPV6_OPT_RPL_FLAG_R, option.flags);
+
+    /* the second error drops the packet */
+    option.sender_rank = HTONS(DEFAULT_MIN_HOP_RANK_INCREASE);
+    TEST_ASSERT_NULL(rpl_get_next_hop_for_option(&dest, &option));
+
+    /* going down from a deeper node */
+    memset(&option, 0, sizeof(option));
+    option.flags = IPV6_OPT_RPL_FLAG_O;
+    option.instance_id = INSTANCE_DOWN;
+    option.sender_rank = HTONS(3 * DEFAULT_MIN_HOP_RANK_INCREASE);
+    TEST_ASSERT(ipv6_addr_is_equal(&dest, rpl_get_next_hop_for_option(&dest, &option)));
+    TEST_ASSERT_EQUAL_INT((IPV6_OPT_RPL_FLAG_O | IPV6_OPT_RPL_FLAG_R), option.flags);
+
+    option.sender_rank = HTONS(3 * DEFAULT_MIN_HOP_RANK_INCREASE);
+    TEST_ASSERT_NULL(rpl_get_next_hop_for_option(&dest, &option));
+
+    /* the same DAGRank is no error in either direction */
+    memset(&option, 0, sizeof(option));
+    option.instance_id = INSTANCE_UP;
+    option.sender_rank = HTONS(MY_RANK + 1);
+    TEST_ASSERT_NOT_NULL(rpl_get_next_hop_for_option(&dest, &option));
+    TEST_ASSERT_EQUAL_INT(0, option.flags);
+}
+
+Test *tests_rpl_option_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_rpl_option_insert),
+        new_TestFixture(test_rpl_option_remove),
+        new_TestFixture(test_rpl_option_not_mapped),
+        new_TestFixture(test_rpl_option_next_hop),
+        new_TestFixture(test_rpl_option_rank_error),
+    };
+
+    EMB_UNIT_TESTCALLER(rpl_option_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&rpl_option_tests;
+}
+
+void tests_rpl_option(void)
+{
+    TESTS_RUN(tests_rpl_option_tests());
+}
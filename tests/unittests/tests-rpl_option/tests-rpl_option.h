@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-rpl_option.h
+ * @brief       Unittests for the RPL option of ``rpl`` and ``sixlowpan``
+ */
+#ifndef __TESTS_RPL_OPTION_H_
+#define __TESTS_RPL_OPTION_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_rpl_option(void);
+
+/**
+ * @brief   Generates tests for the port mapping, the RPL option of ip.c
+ *          and the next hop of an instance
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_rpl_option_tests(void);
+
+#endif /* __TESTS_RPL_OPTION_H_ */
+/** @} */
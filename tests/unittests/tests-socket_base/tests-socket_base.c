@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "kernel.h"
+#include "msg.h"
+#include "thread.h"
+
+#include "socket_base/socket.h"
+
+#include "net_help.h"
+
+#include "socket.h"
+
+#include "tests-socket_base.h"
+
+#define PAYLOAD_LEN (32)
+#define PORT        (0x1234)
+#define SEGMENT_LEN (TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER / 2)
+
+static char stack_loan[KERNEL_CONF_STACKSIZE_DEFAULT];
+static char stack_copy[KERNEL_CONF_STACKSIZE_DEFAULT];
+static char stack_tcp[KERNEL_CONF_STACKSIZE_DEFAULT];
+
+static uint8_t packet[IPV6_HDR_LEN + UDP_HDR_LEN + PAYLOAD_LEN];
+static volatile int released;
+
+static uint8_t segment[IPV6_HDR_LEN + TCP_HDR_LEN + SEGMENT_LEN];
+static socket_internal_t *tcp_socket;
+static volatile int accepted;
+
+/* plays the UDP packet handler: hands the packet over to the socket bound
+ * to its port and waits for the receiver to be done with it */
+static void *run_handler(void *arg)
+{
+    (void) arg;
+
+    msg_t m_send, m_recv;
+    socket_internal_t *udp_socket = get_udp_socket((udp_hdr_t *)(packet + IPV6_HDR_LEN));
+
+    if (udp_socket == NULL) {
+        return NULL;
+    }
+
+    m_send.content.ptr = (char *) packet;
+    msg_send_receive(&m_send, &m_recv, udp_socket->recv_pid);
+    released = 1;
+
+    return NULL;
+}
+
+/* plays the TCP packet handler: delivers a segment each time it is woken,
+ * the segment's payload bytes are the segment's number */
+static void *run_tcp_handler(void *arg)
+{
+    (void) arg;
+
+    msg_t m_recv;
+    ipv6_hdr_t *ipv6_header = (ipv6_hdr_t *) segment;
+    tcp_hdr_t *tcp_header = (tcp_hdr_t *)(segment + IPV6_HDR_LEN);
+    uint8_t *payload = segment + IPV6_HDR_LEN + TCP_HDR_LEN;
+
+    memset(segment, 0, sizeof(segment));
+    ipv6_header->length = HTONS(TCP_HDR_LEN + SEGMENT_LEN);
+
+    for (int i = 1; i <= 2; i++) {
+        msg_receive(&m_recv);
+        memset(payload, i, SEGMENT_LEN);
+        accepted = handle_payload(ipv6_header, tcp_header, tcp_socket, payload);
+    }
+
+    return NULL;
+}
+
+static int set_up_socket(char *stack, int stacksize)
+{
+    udp_hdr_t *udp_header = (udp_hdr_t *)(packet + IPV6_HDR_LEN);
+
+    memset(packet, 0, sizeof(packet));
+    udp_header->dst_port = HTONS(PORT);
+    udp_header->length = HTONS(UDP_HDR_LEN + PAYLOAD_LEN);
+
+    for (int i = 0; i < PAYLOAD_LEN; i++) {
+        packet[IPV6_HDR_LEN + UDP_HDR_LEN + i] = i;
+    }
+
+    memset(&socket_base_stats, 0, sizeof(socket_base_stats));
+    released = 0;
+
+    int s = socket_base_socket(PF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    socket_base_get_socket(s)->socket_values.local_address.sin6_port = HTONS(PORT);
+
+    /* lower priority: runs as soon as the receiver blocks */
+    thread_create(stack, stacksize, PRIORITY_MAIN + 1, CREATE_STACKTEST,
+                  run_handler, NULL, "handler");
+
+    return s;
+}
+
+static void tear_down(void)
+{
+    memset(socket_base_sockets, 0, sizeof(socket_base_sockets));
+}
+
+static void test_socket_base_recvfrom_loan(void)
+{
+    uint8_t *buf = NULL;
+    sockaddr6_t from;
+    socklen_t fromlen;
+    int s = set_up_socket(stack_loan, sizeof(stack_loan));
+
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN,
+                          socket_base_recvfrom_loan(s, &buf, 0, &from, &fromlen));
+    TEST_ASSERT(buf == &packet[IPV6_HDR_LEN + UDP_HDR_LEN]);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN - 1, buf[PAYLOAD_LEN - 1]);
+
+    /* the network buffer is held until released */
+    TEST_ASSERT_EQUAL_INT(0, released);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, socket_base_stats.rx_delivered);
+    TEST_ASSERT_EQUAL_INT(0, socket_base_stats.rx_copied);
+
+    TEST_ASSERT_EQUAL_INT(0, socket_base_recv_release(s));
+    TEST_ASSERT_EQUAL_INT(-1, socket_base_recv_release(s));
+}
+
+static void test_socket_base_recvfrom_copy(void)
+{
+    uint8_t buf[PAYLOAD_LEN];
+    sockaddr6_t from;
+    socklen_t fromlen;
+    int s = set_up_socket(stack_copy, sizeof(stack_copy));
+
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN,
+                          socket_base_recvfrom(s, buf, sizeof(buf), 0, &from, &fromlen));
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN - 1, buf[PAYLOAD_LEN - 1]);
+
+    /* every delivered byte was copied once */
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, socket_base_stats.rx_delivered);
+    TEST_ASSERT_EQUAL_INT(PAYLOAD_LEN, socket_base_stats.rx_copied);
+    TEST_ASSERT_EQUAL_INT(-1, socket_base_recv_release(s));
+}
+
+static void test_socket_base_recv_loan_tcp(void)
+{
+    uint8_t *buf = NULL;
+    msg_t m_send;
+    kernel_pid_t pid_handler;
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+
+    tcp_socket = socket_base_get_socket(s);
+    tcp_socket->socket_values.tcp_control.rcv_wnd = TRANSPORT_LAYER_SOCKET_STATIC_WINDOW;
+    memset(&socket_base_stats, 0, sizeof(socket_base_stats));
+
+    /* higher priority: delivers a segment as soon as it is woken */
+    pid_handler = thread_create(stack_tcp, sizeof(stack_tcp), PRIORITY_MAIN - 1,
+                                CREATE_STACKTEST, run_tcp_handler, NULL, "tcp handler");
+
+    accepted = 0;
+    msg_send(&m_send, pid_handler, true);
+    TEST_ASSERT_EQUAL_INT(SEGMENT_LEN, accepted);
+
+    TEST_ASSERT_EQUAL_INT(SEGMENT_LEN, socket_base_recvfrom_loan(s, &buf, 0, NULL, NULL));
+    TEST_ASSERT(buf == tcp_socket->tcp_input_buffer);
+    TEST_ASSERT_EQUAL_INT(-1, socket_base_recvfrom_loan(s, &buf, 0, NULL, NULL));
+
+    /* the next segment is taken without waiting for the release and
+     * leaves the loaned bytes alone */
+    accepted = 0;
+    msg_send(&m_send, pid_handler, true);
+    TEST_ASSERT_EQUAL_INT(SEGMENT_LEN, accepted);
+    TEST_ASSERT_EQUAL_INT(1, buf[0]);
+    TEST_ASSERT_EQUAL_INT(1, buf[SEGMENT_LEN - 1]);
+    TEST_ASSERT_EQUAL_INT(0, tcp_socket->socket_values.tcp_control.rcv_wnd);
+
+    TEST_ASSERT_EQUAL_INT(0, socket_base_recv_release(s));
+    TEST_ASSERT_EQUAL_INT(SEGMENT_LEN, tcp_socket->socket_values.tcp_control.rcv_wnd);
+
+    TEST_ASSERT_EQUAL_INT(SEGMENT_LEN, socket_base_recvfrom_loan(s, &buf, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(2, buf[0]);
+    TEST_ASSERT_EQUAL_INT(2, buf[SEGMENT_LEN - 1]);
+    TEST_ASSERT_EQUAL_INT(0, socket_base_recv_release(s));
+    TEST_ASSERT_EQUAL_INT(-1, socket_base_recv_release(s));
+    TEST_ASSERT_EQUAL_INT(TRANSPORT_LAYER_SOCKET_STATIC_WINDOW,
+                          tcp_socket->socket_values.tcp_control.rcv_wnd);
+
+    /* only the copy into the socket's buffer */
+    TEST_ASSERT_EQUAL_INT(2 * SEGMENT_LEN, socket_base_stats.rx_delivered);
+    TEST_ASSERT_EQUAL_INT(2 * SEGMENT_LEN, socket_base_stats.rx_copied);
+}
+
+Test *tests_socket_base_recv_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_socket_base_recvfrom_loan),
+        new_TestFixture(test_socket_base_recvfrom_copy),
+        new_TestFixture(test_socket_base_recv_loan_tcp),
+    };
+
+    EMB_UNIT_TESTCALLER(socket_base_recv_tests, NULL, tear_down, fixtures);
+
+    return (Test *)&socket_base_recv_tests;
+}
+
+void tests_socket_base(void)
+{
+    TESTS_RUN(tests_socket_base_recv_tests());
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-socket_base.h
+ * @brief       Unittests for the ``socket_base`` module
+ */
+#ifndef __TESTS_SOCKET_BASE_H_
+#define __TESTS_SOCKET_BASE_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_socket_base(void);
+
+/**
+ * @brief   Generates tests for the receive functions of socket_base/socket.h
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_socket_base_recv_tests(void);
+
+#endif /* __TESTS_SOCKET_BASE_H_ */
+/** @} */
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-tcp_hc.h"
+
+#include "socket_base/socket.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_hc.h"
+
+#define TEST_CONTEXT_ID (0x1234)
+
+static tcp_hc_context_t snd_context, rcv_context;
+
+static void set_up(void)
+{
+    memset(&snd_context, 0, sizeof(snd_context));
+    snd_context.context_id = TEST_CONTEXT_ID;
+    snd_context.seq_snd = 0x11223344;
+    snd_context.ack_snd = 0x55667788;
+    snd_context.wnd_snd = 0x1020;
+
+    /* the receiver's context mirrors what the sender sent last */
+    memset(&rcv_context, 0, sizeof(rcv_context));
+    rcv_context.context_id = TEST_CONTEXT_ID;
+    rcv_context.seq_rcv = snd_context.seq_snd;
+    rcv_context.ack_rcv = snd_context.ack_snd;
+    rcv_context.wnd_rcv = snd_context.wnd_snd;
+}
+
+static void tear_down(void)
+{
+    memset(socket_base_sockets, 0, sizeof(socket_base_sockets));
+}
+
+static void set_header(tcp_hdr_t *header, uint32_t seq_nr, uint32_t ack_nr,
+                       uint16_t window, uint8_t flags)
+{
+    memset(header, 0, sizeof(tcp_hdr_t));
+    header->seq_nr = seq_nr;
+    header->ack_nr = ack_nr;
+    header->window = window;
+    header->reserved_flags = flags;
+    header->checksum = 0xbeef;
+}
+
+/* the compressed length, 0 if the decompression consumed a different one */
+static uint16_t roundtrip(tcp_hdr_t *in, tcp_hdr_t *out, uint8_t hc_type)
+{
+    uint8_t buf[TCP_HC_MAX_HDR_LEN];
+    uint16_t len = tcp_hc_compress_header(buf, in, &snd_context, hc_type);
+
+    memset(out, 0, sizeof(tcp_hdr_t));
+
+    return (tcp_hc_decompress_header(out, buf, &rcv_context) == len) ? len : 0;
+}
+
+static void test_tcp_hc_unchanged_fields(void)
+{
+    tcp_hdr_t in, out;
+
+    set_header(&in, snd_context.seq_snd, snd_context.ack_snd,
+               snd_context.wnd_snd, 0);
+
+    /* dispatch, context ID and checksum only */
+    TEST_ASSERT_EQUAL_INT(6, roundtrip(&in, &out, COMPRESSED_HEADER));
+    TEST_ASSERT(in.seq_nr == out.seq_nr);
+    TEST_ASSERT(in.ack_nr == out.ack_nr);
+    TEST_ASSERT_EQUAL_INT(in.window, out.window);
+    TEST_ASSERT_EQUAL_INT(in.checksum, out.checksum);
+    TEST_ASSERT_EQUAL_INT(0, out.reserved_flags);
+}
+
+static void test_tcp_hc_partial_fields(void)
+{
+    tcp_hdr_t in, out;
+
+    /* 8 bit sequence number, 16 bit acknowledgment number, window LSB */
+    set_header(&in, 0x112233aa, 0x5566bbcc, 0x10dd, TCP_ACK);
+
+    TEST_ASSERT_EQUAL_INT(10, roundtrip(&in, &out, COMPRESSED_HEADER));
+    TEST_ASSERT(in.seq_nr == out.seq_nr);
+    TEST_ASSERT(in.ack_nr == out.ack_nr);
+    TEST_ASSERT_EQUAL_INT(in.window, out.window);
+    TEST_ASSERT_EQUAL_INT(TCP_ACK, out.reserved_flags);
+}
+
+static void test_tcp_hc_window_msb(void)
+{
+    tcp_hdr_t in, out;
+
+    set_header(&in, snd_context.seq_snd, snd_context.ack_snd, 0x4020, 0);
+
+    TEST_ASSERT_EQUAL_INT(7, roundtrip(&in, &out, COMPRESSED_HEADER));
+    TEST_ASSERT_EQUAL_INT(0x4020, out.window);
+}
+
+static void test_tcp_hc_inline_fields(void)
+{
+    tcp_hdr_t in, out;
+
+    set_header(&in, 0xa1b2c3d4, 0xe5f60718, 0x8899, TCP_ACK);
+
+    TEST_ASSERT_EQUAL_INT(TCP_HC_MAX_HDR_LEN,
+                          roundtrip(&in, &out, COMPRESSED_HEADER));
+    TEST_ASSERT(in.seq_nr == out.seq_nr);
+    TEST_ASSERT(in.ack_nr == out.ack_nr);
+    TEST_ASSERT_EQUAL_INT(in.window, out.window);
+}
+
+static void test_tcp_hc_mostly_compressed(void)
+{
+    tcp_hdr_t in, out;
+
+    /* mostly compressed headers never elide fields */
+    set_header(&in, snd_context.seq_snd, snd_context.ack_snd,
+               snd_context.wnd_snd, TCP_FIN_ACK);
+
+    TEST_ASSERT_EQUAL_INT(TCP_HC_MAX_HDR_LEN,
+                          roundtrip(&in, &out, MOSTLY_COMPRESSED_HEADER));
+    TEST_ASSERT(in.seq_nr == out.seq_nr);
+    TEST_ASSERT(in.ack_nr == out.ack_nr);
+    TEST_ASSERT_EQUAL_INT(TCP_FIN, out.reserved_flags);
+}
+
+static void test_tcp_hc_fin_ack(void)
+{
+    tcp_hdr_t in, out;
+
+    set_header(&in, snd_context.seq_snd, snd_context.ack_snd + 1,
+               snd_context.wnd_snd, TCP_FIN_ACK);
+
+    TEST_ASSERT_EQUAL_INT(7, roundtrip(&in, &out, COMPRESSED_HEADER));
+    TEST_ASSERT_EQUAL_INT(TCP_FIN_ACK, out.reserved_flags);
+}
+
+/* the context ID table needs the sockets to be built with TCP_HC */
+#ifdef TCP_HC
+static void test_tcp_hc_context_lookup(void)
+{
+    ipv6_hdr_t ipv6_header;
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    socket_internal_t *sock = socket_base_get_socket(s);
+
+    memset(&ipv6_header, 0, sizeof(ipv6_header));
+    ipv6_addr_set_loopback_addr(&ipv6_header.destaddr);
+    ipv6_header.srcaddr.uint8[15] = 2;
+
+    sock->socket_values.local_address.sin6_addr = ipv6_header.destaddr;
+    sock->socket_values.foreign_address.sin6_addr = ipv6_header.srcaddr;
+    sock->socket_values.tcp_control.tcp_context.context_id = TEST_CONTEXT_ID;
+    tcp_hc_context_add(sock);
+
+    TEST_ASSERT(sock == get_tcp_socket_by_context(&ipv6_header,
+                                                  TEST_CONTEXT_ID));
+    TEST_ASSERT_NULL(get_tcp_socket_by_context(&ipv6_header,
+                                               TEST_CONTEXT_ID + 1));
+
+    /* a cleared socket must not be found through a stale table entry */
+    memset(sock, 0, sizeof(socket_internal_t));
+    TEST_ASSERT_NULL(get_tcp_socket_by_context(&ipv6_header,
+                                               TEST_CONTEXT_ID));
+}
+#endif
+
+Test *tests_tcp_hc_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tcp_hc_unchanged_fields),
+        new_TestFixture(test_tcp_hc_partial_fields),
+        new_TestFixture(test_tcp_hc_window_msb),
+        new_TestFixture(test_tcp_hc_inline_fields),
+        new_TestFixture(test_tcp_hc_mostly_compressed),
+        new_TestFixture(test_tcp_hc_fin_ack),
+#ifdef TCP_HC
+        new_TestFixture(test_tcp_hc_context_lookup),
+#endif
+    };
+
+    EMB_UNIT_TESTCALLER(tcp_hc_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&tcp_hc_tests;
+}
+
+void tests_tcp_hc(void)
+{
+    TESTS_RUN(tests_tcp_hc_tests());
+}
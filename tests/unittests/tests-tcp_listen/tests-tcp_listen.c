@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "kernel.h"
+#include "thread.h"
+
+#include "tests-tcp_listen.h"
+
+#include "socket_base/socket.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_stats.h"
+
+#define LOCAL_PORT  (80)
+#define ISS         (5000)
+#define BURST       (50)
+
+static char stack_closer[KERNEL_CONF_STACKSIZE_DEFAULT];
+static char stack_peer[KERNEL_CONF_STACKSIZE_DEFAULT];
+static ipv6_hdr_t ipv6_header;
+static tcp_hdr_t tcp_header;
+static int listener;
+
+static void set_up(void)
+{
+    tcp_listen_init();
+    memset(&tcp_stats_global, 0, sizeof(tcp_stats_global));
+}
+
+static void tear_down(void)
+{
+    /* the SYN queue is shared by all listeners */
+    if (socket_base_get_socket(listener) != NULL) {
+        tcp_listen_flush(socket_base_get_socket(listener));
+    }
+
+    memset(socket_base_sockets, 0, sizeof(socket_base_sockets));
+}
+
+static void listen_on(int backlog)
+{
+    listener = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    socket_base_get_socket(listener)->socket_values.local_address.sin6_port = LOCAL_PORT;
+    TEST_ASSERT_EQUAL_INT(0, tcp_listen(listener, backlog));
+}
+
+/* fills in the segment from *peer*, each peer has its own address, port and
+ * initial sequence number. The addresses are off-link and there is no route,
+ * so the SYN-ACKs end in ipv6_sendto() without a network interface. */
+static void segment(uint16_t peer, uint8_t flags, uint32_t seq_nr, uint32_t ack_nr)
+{
+    memset(&ipv6_header, 0, sizeof(ipv6_header));
+    ipv6_addr_init(&ipv6_header.srcaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, peer);
+    ipv6_addr_init(&ipv6_header.destaddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+
+    memset(&tcp_header, 0, sizeof(tcp_header));
+    tcp_header.src_port = 1000 + peer;
+    tcp_header.dst_port = LOCAL_PORT;
+    tcp_header.seq_nr = seq_nr;
+    tcp_header.ack_nr = ack_nr;
+    tcp_header.data_offset = TCP_HDR_LEN / 4;
+    tcp_header.reserved_flags = flags;
+    tcp_header.window = TRANSPORT_LAYER_SOCKET_STATIC_WINDOW;
+}
+
+static uint32_t irs(uint16_t peer)
+{
+    return 100000 * peer;
+}
+
+static void syn(uint16_t peer)
+{
+    global_sequence_counter = ISS;
+    segment(peer, TCP_SYN, irs(peer), 0);
+    tcp_listen_handle_syn(&ipv6_header, &tcp_header, socket_base_get_socket(listener));
+}
+
+static void ack(uint16_t peer, uint32_t iss)
+{
+    segment(peer, TCP_ACK, irs(peer) + 1, iss + 1);
+    tcp_listen_handle_ack(&ipv6_header, &tcp_header, socket_base_get_socket(listener));
+}
+
+/* the SYN cookie the listener answers the SYN of *peer* with */
+static uint32_t cookie(uint16_t peer)
+{
+    segment(peer, TCP_SYN, irs(peer), 0);
+    return tcp_listen_syn_cookie(&ipv6_header, &tcp_header);
+}
+
+static tcp_listen_queue_t *queue(void)
+{
+    return &socket_base_get_socket(listener)->tcp_listen_queue;
+}
+
+/* UINT32_MAX, which no test expects, if the listener has no statistics */
+static uint32_t syn_cookies(void)
+{
+    tcp_stats_t stats;
+
+    return (tcp_stats_get(listener, &stats) == 0) ? stats.syn_cookies : UINT32_MAX;
+}
+
+static void test_tcp_listen_syn_queue(void)
+{
+    listen_on(2);
+
+    syn(2);
+    syn(3);
+    TEST_ASSERT_EQUAL_INT(2, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(0, syn_cookies());
+
+    /* the backlog is full, the third peer gets a cookie */
+    syn(4);
+    TEST_ASSERT_EQUAL_INT(2, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(1, syn_cookies());
+
+    /* a retransmitted SYN finds its entry */
+    syn(2);
+    TEST_ASSERT_EQUAL_INT(2, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(1, syn_cookies());
+}
+
+static void test_tcp_listen_accept_queue(void)
+{
+    sockaddr6_t addr;
+    socklen_t addrlen;
+    int s;
+
+    listen_on(2);
+    syn(2);
+    syn(3);
+
+    /* the ACKs complete the handshakes in the other order */
+    ack(3, ISS);
+    TEST_ASSERT_EQUAL_INT(1, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(1, queue()->accept_count);
+    ack(2, ISS);
+    TEST_ASSERT_EQUAL_INT(0, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(2, queue()->accept_count);
+
+    /* first come, first accepted */
+    s = tcp_accept(listener, &addr, &addrlen);
+    TEST_ASSERT(s > 0);
+    TEST_ASSERT_EQUAL_INT(1003, addr.sin6_port);
+    TEST_ASSERT_EQUAL_INT(TCP_ESTABLISHED,
+                          socket_base_get_socket(s)->socket_values.tcp_control.state);
+    TEST_ASSERT(socket_base_get_socket(s)->socket_values.tcp_control.rcv_nxt == irs(3) + 1);
+
+    s = tcp_accept(listener, &addr, &addrlen);
+    TEST_ASSERT(s > 0);
+    TEST_ASSERT_EQUAL_INT(1002, addr.sin6_port);
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_count);
+
+    /* nobody waited, so nobody was sent a message */
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_waiting);
+}
+
+static void test_tcp_listen_syn_cookie(void)
+{
+    listen_on(1);
+    syn(2);
+
+    syn(3);
+    TEST_ASSERT_EQUAL_INT(1, syn_cookies());
+
+    /* an ACK with a wrong cookie is dropped */
+    ack(3, cookie(3) + 1);
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_count);
+    ack(4, cookie(3));
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_count);
+
+    /* the right cookie establishes the connection without a SYN queue entry */
+    ack(3, cookie(3));
+    TEST_ASSERT_EQUAL_INT(1, queue()->accept_count);
+    TEST_ASSERT_EQUAL_INT(1, queue()->syn_count);
+}
+
+static void test_tcp_listen_syn_flood(void)
+{
+    listen_on(2);
+
+    for (int peer = 2; peer < 2 + BURST; peer++) {
+        syn(peer);
+    }
+
+    /* the flood takes up two entries, everything else is stateless */
+    TEST_ASSERT_EQUAL_INT(2, queue()->syn_count);
+    TEST_ASSERT_EQUAL_INT(BURST - 2, syn_cookies());
+
+    /* a peer of the flood that completes its handshake still gets in */
+    ack(2 + BURST - 1, cookie(2 + BURST - 1));
+    TEST_ASSERT_EQUAL_INT(1, queue()->accept_count);
+}
+
+static void *run_closer(void *arg)
+{
+    (void) arg;
+
+    socket_base_close(listener);
+
+    return NULL;
+}
+
+static void test_tcp_listen_accept_closed(void)
+{
+    listen_on(2);
+
+    /* lower priority: closes the listener once the accept blocks */
+    thread_create(stack_closer, sizeof(stack_closer), PRIORITY_MAIN + 1,
+                  CREATE_STACKTEST, run_closer, NULL, "closer");
+
+    TEST_ASSERT_EQUAL_INT(-1, tcp_accept(listener, NULL, NULL));
+    TEST_ASSERT_NULL(socket_base_get_socket(listener));
+}
+
+static void *run_peer(void *arg)
+{
+    (void) arg;
+
+    syn(2);
+    ack(2, ISS);
+
+    return NULL;
+}
+
+static void test_tcp_listen_accept_wait(void)
+{
+    sockaddr6_t addr;
+    socklen_t addrlen;
+    int s;
+
+    listen_on(2);
+
+    /* lower priority: completes a handshake once the accept blocks */
+    thread_create(stack_peer, sizeof(stack_peer), PRIORITY_MAIN + 1,
+                  CREATE_STACKTEST, run_peer, NULL, "peer");
+
+    s = tcp_accept(listener, &addr, &addrlen);
+    TEST_ASSERT(s > 0);
+    TEST_ASSERT_EQUAL_INT(1002, addr.sin6_port);
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_count);
+    TEST_ASSERT_EQUAL_INT(0, queue()->accept_waiting);
+}
+
+Test *tests_tcp_listen_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tcp_listen_syn_queue),
+        new_TestFixture(test_tcp_listen_accept_queue),
+        new_TestFixture(test_tcp_listen_syn_cookie),
+        new_TestFixture(test_tcp_listen_syn_flood),
+        new_TestFixture(test_tcp_listen_accept_closed),
+        new_TestFixture(test_tcp_listen_accept_wait),
+    };
+
+    EMB_UNIT_TESTCALLER(tcp_listen_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&tcp_listen_tests;
+}
+
+void tests_tcp_listen(void)
+{
+    TESTS_RUN(tests_tcp_listen_tests());
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-tcp_listen.h
+ * @brief       Unittests for the listen backlog of the ``tcp`` module
+ */
+#ifndef __TESTS_TCP_LISTEN_H_
+#define __TESTS_TCP_LISTEN_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_tcp_listen(void);
+
+/**
+ * @brief   Generates tests for tcp_listen.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_tcp_listen_tests(void);
+
+#endif /* __TESTS_TCP_LISTEN_H_ */
+/** @} */
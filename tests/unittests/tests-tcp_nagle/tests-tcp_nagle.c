@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "kernel.h"
+#include "thread.h"
+
+#include "tests-tcp_nagle.h"
+
+#include "socket_base/socket.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_stats.h"
+#include "tcp_timer.h"
+
+#define RCV_NXT     (1000)
+#define SEND_UNA    (5000)
+#define WRITE_SIZE  (4)
+
+static char stack_peer[KERNEL_CONF_STACKSIZE_DEFAULT];
+static char stack_reset[KERNEL_CONF_STACKSIZE_DEFAULT];
+static uint8_t data[WRITE_SIZE] = "abc";
+static ipv6_hdr_t ipv6_header;
+static tcp_hdr_t tcp_header;
+static int sock;
+
+static void tear_down(void)
+{
+    memset(socket_base_sockets, 0, sizeof(socket_base_sockets));
+}
+
+/* an established connection to an off-link peer without a route, the
+ * segments end in ipv6_sendto() */
+static void establish(uint16_t mss)
+{
+    socket_internal_t *s;
+    tcp_cb_t *tcp_control;
+
+    sock = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    s = socket_base_get_socket(sock);
+    tcp_control = &s->socket_values.tcp_control;
+
+    ipv6_addr_init(&s->socket_values.foreign_address.sin6_addr,
+                   0x2001, 0xdb8, 0, 0, 0, 0, 0, 2);
+    ipv6_addr_init(&s->socket_values.local_address.sin6_addr,
+                   0x2001, 0xdb8, 0, 0, 0, 0, 0, 1);
+    s->socket_values.foreign_address.sin6_port = 1002;
+    s->socket_values.local_address.sin6_port = 80;
+
+    set_tcp_cb(tcp_control, RCV_NXT, TRANSPORT_LAYER_SOCKET_STATIC_WINDOW,
+               SEND_UNA, SEND_UNA, TRANSPORT_LAYER_SOCKET_STATIC_WINDOW);
+    tcp_control->mss = mss;
+    tcp_control->rto = TCP_INITIAL_ACK_TIMEOUT;
+    tcp_control->state = TCP_ESTABLISHED;
+}
+
+static void segment(uint32_t ack_nr, uint8_t payload_len)
+{
+    memset(&ipv6_header, 0, sizeof(ipv6_header));
+    ipv6_header.length = HTONS(TCP_HDR_LEN + payload_len);
+
+    memset(&tcp_header, 0, sizeof(tcp_header));
+    tcp_header.src_port = 1002;
+    tcp_header.dst_port = 80;
+    tcp_header.seq_nr = RCV_NXT;
+    tcp_header.ack_nr = ack_nr;
+    tcp_header.data_offset = TCP_HDR_LEN / 4;
+    tcp_header.reserved_flags = TCP_ACK;
+    tcp_header.window = TRANSPORT_LAYER_SOCKET_STATIC_WINDOW;
+}
+
+/* the peer acknowledges everything up to *ack_nr* */
+static void ack(uint32_t ack_nr)
+{
+    segment(ack_nr, 0);
+    handle_tcp_ack_packet(&ipv6_header, &tcp_header, socket_base_get_socket(sock));
+}
+
+/* UINT32_MAX, which no test expects, if the socket has no statistics */
+static uint32_t segs_out(void)
+{
+    tcp_stats_t stats;
+
+    return (tcp_stats_get(sock, &stats) == 0) ? stats.segs_out : UINT32_MAX;
+}
+
+static void test_tcp_nagle_coalesce(void)
+{
+    socket_internal_t *s;
+
+    establish(TRANSPORT_LAYER_SOCKET_STATIC_MSS);
+    s = socket_base_get_socket(sock);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    }
+
+    /* the first write goes out, the others wait for its ACK */
+    TEST_ASSERT_EQUAL_INT(1, segs_out());
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, s->tcp_output_in_flight);
+    TEST_ASSERT_EQUAL_INT(3 * WRITE_SIZE, s->tcp_output_buffer_end);
+
+    ack(SEND_UNA + WRITE_SIZE);
+    TEST_ASSERT_EQUAL_INT(2, segs_out());
+    TEST_ASSERT_EQUAL_INT(2 * WRITE_SIZE, s->tcp_output_in_flight);
+
+    ack(SEND_UNA + 3 * WRITE_SIZE);
+    TEST_ASSERT_EQUAL_INT(2, segs_out());
+    TEST_ASSERT_EQUAL_INT(0, s->tcp_output_in_flight);
+    TEST_ASSERT_EQUAL_INT(0, s->tcp_output_buffer_end);
+}
+
+static void test_tcp_nagle_ack_delayed(void)
+{
+    socket_internal_t *s;
+
+    establish(TRANSPORT_LAYER_SOCKET_STATIC_MSS);
+    s = socket_base_get_socket(sock);
+
+    /* the first segment waits for a second one or for the timer */
+    segment(SEND_UNA, WRITE_SIZE);
+    handle_tcp_no_flags_packet(&ipv6_header, &tcp_header, s, data, WRITE_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(0, segs_out());
+    TEST_ASSERT_EQUAL_INT(1, s->socket_values.tcp_control.ack_pending);
+    TEST_ASSERT(s->socket_values.tcp_control.rcv_nxt == RCV_NXT + WRITE_SIZE);
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, s->tcp_input_buffer_end);
+
+    segment(SEND_UNA, WRITE_SIZE);
+    tcp_header.seq_nr = RCV_NXT + WRITE_SIZE;
+    handle_tcp_no_flags_packet(&ipv6_header, &tcp_header, s, data, WRITE_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(1, segs_out());
+    TEST_ASSERT_EQUAL_INT(0, s->socket_values.tcp_control.ack_pending);
+    TEST_ASSERT(s->socket_values.tcp_control.rcv_nxt == RCV_NXT + 2 * WRITE_SIZE);
+}
+
+static void test_tcp_nagle_ack_piggyback(void)
+{
+    socket_internal_t *s;
+
+    establish(TRANSPORT_LAYER_SOCKET_STATIC_MSS);
+    s = socket_base_get_socket(sock);
+
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(1, segs_out());
+
+    /* data acknowledging the first write, the ACK of it rides on the
+     * second write */
+    segment(SEND_UNA + WRITE_SIZE, WRITE_SIZE);
+    handle_tcp_no_flags_packet(&ipv6_header, &tcp_header, s, data, WRITE_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(2, segs_out());
+    TEST_ASSERT_EQUAL_INT(0, s->socket_values.tcp_control.ack_pending);
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, s->tcp_output_in_flight);
+}
+
+static void *run_peer(void *arg)
+{
+    (void) arg;
+
+    ack(SEND_UNA + WRITE_SIZE);
+    ack(SEND_UNA + 2 * WRITE_SIZE);
+
+    return NULL;
+}
+
+static void test_tcp_nagle_drain(void)
+{
+    establish(2 * WRITE_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+
+    /* lower priority: acknowledges both writes once the third one waits
+     * for the buffer to drain */
+    thread_create(stack_peer, sizeof(stack_peer), PRIORITY_MAIN + 1,
+                  CREATE_STACKTEST, run_peer, NULL, "peer");
+
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(3, segs_out());
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE,
+                          socket_base_get_socket(sock)->tcp_output_in_flight);
+}
+
+static void *run_reset(void *arg)
+{
+    (void) arg;
+
+    segment(SEND_UNA, 0);
+    tcp_header.reserved_flags = TCP_RST;
+    handle_tcp_rst_packet(&ipv6_header, &tcp_header, socket_base_get_socket(sock));
+
+    return NULL;
+}
+
+static void test_tcp_nagle_drain_reset(void)
+{
+    socket_internal_t *s;
+
+    establish(2 * WRITE_SIZE);
+    s = socket_base_get_socket(sock);
+
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(WRITE_SIZE, tcp_send(sock, data, WRITE_SIZE, 0));
+
+    /* the peer resets the connection while the third write waits */
+    thread_create(stack_reset, sizeof(stack_reset), PRIORITY_MAIN + 1,
+                  CREATE_STACKTEST, run_reset, NULL, "reset");
+
+    TEST_ASSERT_EQUAL_INT(-1, tcp_send(sock, data, WRITE_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT(TCP_CLOSED, s->socket_values.tcp_control.state);
+    TEST_ASSERT_EQUAL_INT(0, s->tcp_output_buffer_end);
+    TEST_ASSERT_EQUAL_INT(0, s->tcp_output_in_flight);
+}
+
+Test *tests_tcp_nagle_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tcp_nagle_coalesce),
+        new_TestFixture(test_tcp_nagle_ack_delayed),
+        new_TestFixture(test_tcp_nagle_ack_piggyback),
+        new_TestFixture(test_tcp_nagle_drain),
+        new_TestFixture(test_tcp_nagle_drain_reset),
+    };
+
+    EMB_UNIT_TESTCALLER(tcp_nagle_tests, NULL, tear_down, fixtures);
+
+    return (Test *)&tcp_nagle_tests;
+}
+
+void tests_tcp_nagle(void)
+{
+    TESTS_RUN(tests_tcp_nagle_tests());
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-tcp_nagle.h
+ * @brief       Unittests for Nagle coalescing and ACKs of the ``tcp`` module
+ */
+#ifndef __TESTS_TCP_NAGLE_H_
+#define __TESTS_TCP_NAGLE_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_tcp_nagle(void);
+
+/**
+ * @brief   Generates tests for tcp_nagle.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_tcp_nagle_tests(void);
+
+#endif /* __TESTS_TCP_NAGLE_H_ */
+/** @} */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-tcp_stats.h"
+
+#include "socket_base/socket.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_stats.h"
+
+#define MS  (1000)
+
+static void set_up(void)
+{
+    memset(&tcp_stats_global, 0, sizeof(tcp_stats_global));
+}
+
+static void tear_down(void)
+{
+    memset(socket_base_sockets, 0, sizeof(socket_base_sockets));
+}
+
+/* a TCP socket with the control block of an established connection */
+static int tcp_socket(void)
+{
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+
+    set_tcp_cb(&socket_base_get_socket(s)->socket_values.tcp_control, 1,
+               TRANSPORT_LAYER_SOCKET_STATIC_WINDOW, 1, 1,
+               TRANSPORT_LAYER_SOCKET_STATIC_WINDOW);
+    return s;
+}
+
+static void test_tcp_stats_histogram_buckets(void)
+{
+    tcp_stats_t stats;
+    int s = tcp_socket();
+    tcp_cb_t *tcp_control = &socket_base_get_socket(s)->socket_values.tcp_control;
+
+    tcp_stats_rtt(tcp_control, 63 * MS, 64 * MS);
+    tcp_stats_rtt(tcp_control, 200 * MS, 1000 * MS);
+    tcp_stats_rtt(tcp_control, 4095 * MS, 60000 * MS);
+
+    TEST_ASSERT_EQUAL_INT(0, tcp_stats_get(s, &stats));
+    TEST_ASSERT_EQUAL_INT(1, stats.rtt_hist[0]);
+    TEST_ASSERT_EQUAL_INT(1, stats.rtt_hist[2]);
+    TEST_ASSERT_EQUAL_INT(1, stats.rtt_hist[6]);
+    TEST_ASSERT_EQUAL_INT(1, stats.rto_hist[1]);
+    TEST_ASSERT_EQUAL_INT(1, stats.rto_hist[4]);
+    TEST_ASSERT_EQUAL_INT(1, stats.rto_hist[TCP_STATS_HIST_LEN - 1]);
+}
+
+static void test_tcp_stats_global_totals(void)
+{
+    tcp_stats_t stats;
+    int s1 = tcp_socket();
+    int s2 = tcp_socket();
+
+    TCP_STATS_INC(&socket_base_get_socket(s1)->socket_values.tcp_control,
+                  retransmissions);
+    TCP_STATS_INC(&socket_base_get_socket(s2)->socket_values.tcp_control,
+                  retransmissions);
+    tcp_stats_handshake(&socket_base_get_socket(s2)->socket_values.tcp_control,
+                        150 * MS);
+
+    TEST_ASSERT_EQUAL_INT(0, tcp_stats_get(s1, &stats));
+    TEST_ASSERT_EQUAL_INT(1, stats.retransmissions);
+    TEST_ASSERT_EQUAL_INT(0, stats.handshakes);
+
+    TEST_ASSERT_EQUAL_INT(0, tcp_stats_get(0, &stats));
+    TEST_ASSERT_EQUAL_INT(2, stats.retransmissions);
+    TEST_ASSERT_EQUAL_INT(1, stats.handshakes);
+    TEST_ASSERT(stats.handshake_time == 150 * MS);
+}
+
+static void test_tcp_stats_no_tcp_socket(void)
+{
+    tcp_stats_t stats;
+    int s = socket_base_socket(PF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+
+    TEST_ASSERT_EQUAL_INT(-1, tcp_stats_get(s, &stats));
+    TEST_ASSERT_EQUAL_INT(-1, tcp_stats_get(MAX_SOCKETS + 1, &stats));
+}
+
+Test *tests_tcp_stats_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tcp_stats_histogram_buckets),
+        new_TestFixture(test_tcp_stats_global_totals),
+        new_TestFixture(test_tcp_stats_no_tcp_socket),
+    };
+
+    EMB_UNIT_TESTCALLER(tcp_stats_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&tcp_stats_tests;
+}
+
+void tests_tcp_stats(void)
+{
+    TESTS_RUN(tests_tcp_stats_tests());
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-tcp_stats.h
+ * @brief       Unittests for the connection statistics of the ``tcp`` module
+ */
+#ifndef __TESTS_TCP_STATS_H_
+#define __TESTS_TCP_STATS_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_tcp_stats(void);
+
+/**
+ * @brief   Generates tests for tcp_stats.h
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_tcp_stats_tests(void);
+
+#endif /* __TESTS_TCP_STATS_H_ */
+/** @} */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "msg.h"
+#include "thread.h"
+#include "vtimer.h"
+#include "trickle.h"
+
+#include "tests-trickle.h"
+
+#define IMIN        (16)
+#define INSTANCES   (8)
+
+static char stack_receiver[KERNEL_CONF_STACKSIZE_DEFAULT];
+static msg_t queue[INSTANCES];
+static kernel_pid_t receiver = KERNEL_PID_UNDEF, test_pid;
+static trickle_t trickles[INSTANCES];
+static int sent[INSTANCES];
+
+/* queues the timer messages of the instances, which may expire while the
+ * test is busy, and hands them to the test one by one */
+static void *run_receiver(void *arg)
+{
+    msg_t m;
+
+    (void) arg;
+    msg_init_queue(queue, INSTANCES);
+
+    while (1) {
+        msg_receive(&m);
+        msg_send(&m, test_pid, true);
+    }
+
+    return NULL;
+}
+
+static void count(void *arg)
+{
+    sent[(trickle_t *) arg - trickles]++;
+}
+
+/* handles the next timer message of any instance, 0 on timeout */
+static trickle_t *next(uint32_t timeout_ms)
+{
+    msg_t m;
+    trickle_t *trickle;
+
+    if (vtimer_msg_receive_timeout(&m, timex_set(0, timeout_ms * 1000)) < 0) {
+        return NULL;
+    }
+
+    if (m.type != MSG_TIMER) {
+        return NULL;
+    }
+
+    trickle = (trickle_t *) m.content.ptr;
+    trickle_callback(trickle);
+    return trickle;
+}
+
+static void start(int i, uint8_t Imax, uint8_t k)
+{
+    trickle_start(receiver, &trickles[i], count, &trickles[i], IMIN, Imax, k);
+}
+
+static void set_up(void)
+{
+    if (receiver == KERNEL_PID_UNDEF) {
+        test_pid = thread_getpid();
+        receiver = thread_create(stack_receiver, sizeof(stack_receiver),
+                                 PRIORITY_MAIN - 1, CREATE_STACKTEST,
+                                 run_receiver, NULL, "trickle receiver");
+    }
+
+    memset(trickles, 0, sizeof(trickles));
+    memset(sent, 0, sizeof(sent));
+}
+
+static void tear_down(void)
+{
+    for (int i = 0; i < INSTANCES; i++) {
+        trickle_stop(&trickles[i]);
+    }
+
+    /* drain messages that were queued before the timers were removed */
+    while (next(IMIN));
+}
+
+static void test_trickle_start(void)
+{
+    start(0, 2, 0);
+
+    TEST_ASSERT(trickles[0].I >= IMIN && trickles[0].I <= (IMIN << 2));
+    TEST_ASSERT(trickles[0].t >= trickles[0].I / 2 && trickles[0].t < trickles[0].I);
+    TEST_ASSERT_EQUAL_INT(0, trickles[0].c);
+}
+
+static void test_trickle_doubling(void)
+{
+    uint32_t I, expected;
+
+    start(0, 2, 0);
+
+    /* one transmission and one interval end per interval */
+    for (int interval = 0; interval < 4; interval++) {
+        I = trickles[0].I;
+
+        TEST_ASSERT(next(2 * I) == &trickles[0]);
+        TEST_ASSERT_EQUAL_INT(interval + 1, sent[0]);
+        TEST_ASSERT(next(2 * I) == &trickles[0]);
+
+        expected = (I >= (IMIN << 1)) ? (IMIN << 2) : 2 * I;
+        TEST_ASSERT_EQUAL_INT(expected, trickles[0].I);
+    }
+}
+
+static void test_trickle_suppression(void)
+{
+    start(0, 0, 1);
+
+    /* a consistent transmission was heard, so the instance keeps quiet */
+    trickle_increment_counter(&trickles[0]);
+    TEST_ASSERT(next(2 * IMIN) == &trickles[0]);
+    TEST_ASSERT_EQUAL_INT(0, sent[0]);
+
+    /* the counter starts over in the next interval */
+    TEST_ASSERT(next(2 * IMIN) == &trickles[0]);
+    TEST_ASSERT_EQUAL_INT(0, trickles[0].c);
+    TEST_ASSERT(next(2 * IMIN) == &trickles[0]);
+    TEST_ASSERT_EQUAL_INT(1, sent[0]);
+}
+
+static void test_trickle_reset(void)
+{
+    start(0, 6, 0);
+
+    /* grow the interval beyond Imin */
+    while (trickles[0].I == IMIN) {
+        next(2 * IMIN);
+        next(2 * IMIN);
+    }
+
+    trickle_reset_timer(&trickles[0]);
+    TEST_ASSERT_EQUAL_INT(IMIN, trickles[0].I);
+    TEST_ASSERT(trickles[0].t < IMIN);
+
+    /* resetting at Imin changes nothing */
+    trickles[0].t = IMIN - 1;
+    trickle_reset_timer(&trickles[0]);
+    TEST_ASSERT_EQUAL_INT(IMIN - 1, trickles[0].t);
+}
+
+static void test_trickle_stop(void)
+{
+    start(0, 2, 0);
+    trickle_stop(&trickles[0]);
+
+    TEST_ASSERT_NULL(next(8 * IMIN));
+
+    /* a message that was queued already does nothing */
+    trickle_callback(&trickles[0]);
+    TEST_ASSERT_EQUAL_INT(0, sent[0]);
+}
+
+static void test_trickle_instances(void)
+{
+    for (int i = 0; i < INSTANCES; i++) {
+        start(i, i % 4, 0);
+    }
+
+    trickle_stop(&trickles[INSTANCES - 1]);
+
+    /* the longest first interval is IMIN << 3 */
+    for (int i = 0; i < INSTANCES - 1; i++) {
+        while (sent[i] == 0) {
+            TEST_ASSERT_NOT_NULL(next(2 * (IMIN << 3)));
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, sent[INSTANCES - 1]);
+}
+
+Test *tests_trickle_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_trickle_start),
+        new_TestFixture(test_trickle_doubling),
+        new_TestFixture(test_trickle_suppression),
+        new_TestFixture(test_trickle_reset),
+        new_TestFixture(test_trickle_stop),
+        new_TestFixture(test_trickle_instances),
+    };
+
+    EMB_UNIT_TESTCALLER(trickle_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&trickle_tests;
+}
+
+void tests_trickle(void)
+{
+    TESTS_RUN(tests_trickle_tests());
+}
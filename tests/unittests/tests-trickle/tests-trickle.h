@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-trickle.h
+ * @brief       Unittests for the ``trickle`` module
+ */
+#ifndef __TESTS_TRICKLE_H_
+#define __TESTS_TRICKLE_H_
+
+#include "../unittests.h"
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_trickle(void);
+
+/**
+ * @brief   Generates tests for trickle.c
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_trickle_tests(void);
+
+#endif /* __TESTS_TRICKLE_H_ */
+/** @} */